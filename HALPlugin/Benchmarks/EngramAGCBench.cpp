@@ -0,0 +1,97 @@
+//
+//  EngramAGCBench.cpp
+//  Engram Virtual Audio Device
+//
+//  Per-cycle cost of the input chain with and without the AGC stage, across
+//  cycle sizes and channel counts, on speech-like material that keeps the
+//  gain computer busy. The AGC has to stay a small, fixed slice of each
+//  cycle's real-time budget, whatever the HAL's buffer size.
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "../EngramDSP.h"
+#include "../EngramDenormal.h"
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define kBenchSampleRate 48000.0
+#define kBenchSeconds 5
+#define kBenchRuns 5
+// The AGC may cost at most this fraction of a cycle's duration
+#define kBenchMaxBudgetFraction 0.01
+
+static const UInt32 kBenchCycleFrames[] = { 64, 512, 4096 };
+static const UInt32 kBenchChannels[] = { 1, 2, 8 };
+
+static Float32 gSource[(UInt32)(kBenchSampleRate * kBenchSeconds) * kEngramMaxChannels];
+
+// Bursts of tone at shifting levels with pauses between them, so the gain
+// rises, falls and freezes over the run
+static void FillSource(UInt32 channels) {
+    UInt32 frames = (UInt32)(kBenchSampleRate * kBenchSeconds);
+    for (UInt32 i = 0; i < frames; i++) {
+        UInt32 word = i / 12000;
+        Boolean voiced = (i % 12000) < 9000;
+        Float32 level = voiced ? 0.02f * (Float32)(1 + word % 5) : 0.0005f;
+        Float32 x = level * sinf(2.0f * (Float32)M_PI * (Float32)(180 + 40 * (word % 3)) * (Float32)i / (Float32)kBenchSampleRate);
+        for (UInt32 ch = 0; ch < channels; ch++) {
+            gSource[i * channels + ch] = x;
+        }
+    }
+}
+
+// Median nanoseconds per cycle over kBenchRuns passes of the whole source
+static Float64 MeasureNsPerCycle(UInt32 channels, UInt32 cycleFrames, UInt32 stages) {
+    static Float32 buffer[4096 * kEngramMaxChannels];
+    UInt32 cycles = (UInt32)(kBenchSampleRate * kBenchSeconds) / cycleFrames;
+    Float64 runs[kBenchRuns];
+
+    for (UInt32 run = 0; run < kBenchRuns; run++) {
+        EngramDSPChain chain;
+        EngramDSPChain_Init(&chain, kBenchSampleRate, channels, stages);
+        Float64 elapsedNs = 0.0;
+
+        for (UInt32 cycle = 0; cycle < cycles; cycle++) {
+            memcpy(buffer, gSource + (size_t)cycle * cycleFrames * channels, sizeof(Float32) * cycleFrames * channels);
+            auto start = std::chrono::steady_clock::now();
+            {
+                ENGRAM_DENORMAL_GUARD();
+                EngramDSPChain_Process(&chain, buffer, cycleFrames);
+            }
+            elapsedNs += (Float64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        }
+        runs[run] = elapsedNs / cycles;
+    }
+
+    std::sort(runs, runs + kBenchRuns);
+    return runs[kBenchRuns / 2];
+}
+
+int main(void) {
+    printf("AGC benchmark: %d s of bursty speech-like input, median of %d runs\n", kBenchSeconds, kBenchRuns);
+    printf("%8s %8s %14s %14s %12s %12s\n", "channels", "frames", "dc ns/cycle", "dc+agc ns", "agc ns", "% of cycle");
+
+    int failures = 0;
+    for (UInt32 channels : kBenchChannels) {
+        FillSource(channels);
+        for (UInt32 frames : kBenchCycleFrames) {
+            Float64 base = MeasureNsPerCycle(channels, frames, kEngramDSPStageDCBlock);
+            Float64 withAGC = MeasureNsPerCycle(channels, frames, kEngramDSPStageDCBlock | kEngramDSPStageAGC);
+            Float64 agcNs = std::max(withAGC - base, 0.0);
+            Float64 cycleNs = frames * 1.0e9 / kBenchSampleRate;
+            Float64 fraction = agcNs / cycleNs;
+            printf("%8u %8u %14.0f %14.0f %12.0f %11.3f%%\n", channels, frames, base, withAGC, agcNs, fraction * 100.0);
+
+            if (fraction > kBenchMaxBudgetFraction) {
+                fprintf(stderr, "FAIL: AGC costs %.2f%% of a %u-frame cycle at %u channels\n", fraction * 100.0, frames, channels);
+                failures++;
+            }
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
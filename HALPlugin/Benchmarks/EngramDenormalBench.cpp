@@ -0,0 +1,141 @@
+//
+//  EngramDenormalBench.cpp
+//  Engram Virtual Audio Device
+//
+//  Feeds a long silence tail through recursive stages and reports per-cycle
+//  cost over time. Without protection, cost climbs once filter state decays
+//  into the denormal range; with FTZ/DAZ or state flushing it stays flat.
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "../EngramDSP.h"
+#include "../EngramDenormal.h"
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define kBenchSampleRate 48000.0
+#define kBenchChannels 2
+#define kBenchFrames 512
+#define kBenchSilenceSeconds 30
+#define kBenchWindows kBenchSilenceSeconds
+#define kBenchStagesPerChannel 8
+// Guarded variants fail the run if the median one-second window is this much
+// slower than the first (which still contains the audible part of the tail)
+#define kBenchMaxWindowRatio 2.0
+
+typedef enum {
+    kVariantUnprotected = 0,   // plain biquads, FTZ off
+    kVariantFTZ,               // plain biquads, FTZ on
+    kVariantStateFlush,        // EngramBiquad_Process (flushes state), FTZ off
+    kVariantChain,             // EngramBiquad_Process with the IO-path guard
+    kVariantCount
+} BenchVariant;
+
+static const char* kVariantNames[kVariantCount] = {
+    "unprotected", "ftz-daz", "state-flush", "state-flush+ftz"
+};
+
+// Reference biquad without any denormal handling.
+static void ProcessUnprotected(const EngramBiquadCoefficients* c, EngramBiquadState* state,
+                               Float32* samples, UInt32 frames, UInt32 stride) {
+    Float32 z1 = state->z1;
+    Float32 z2 = state->z2;
+    for (UInt32 i = 0; i < frames; i++) {
+        Float32 x = samples[i * stride];
+        Float32 y = c->b0 * x + z1;
+        z1 = c->b1 * x - c->a1 * y + z2;
+        z2 = c->b2 * x - c->a2 * y;
+        samples[i * stride] = y;
+    }
+    state->z1 = z1;
+    state->z2 = z2;
+}
+
+static void RunVariant(BenchVariant variant, Float64 outWindowNsPerCycle[kBenchWindows]) {
+    EngramBiquadCoefficients coefficients;
+    EngramBiquad_MakeLowPass(&coefficients, kBenchSampleRate, 200.0, 4.0);
+
+    EngramBiquadState states[kBenchChannels][kBenchStagesPerChannel];
+    memset(states, 0, sizeof(states));
+
+    Float32 buffer[kBenchFrames * kBenchChannels];
+    UInt32 totalCycles = (UInt32)(kBenchSilenceSeconds * kBenchSampleRate / kBenchFrames);
+    UInt32 cyclesPerWindow = totalCycles / kBenchWindows;
+
+    UInt64 previousControl = 0;
+    Boolean useFTZ = (variant == kVariantFTZ || variant == kVariantChain);
+    if (!useFTZ) {
+        // Make sure a previous variant did not leave FTZ enabled
+        previousControl = EngramDenormal_GetControl();
+        EngramDenormal_SetControl(previousControl & ~(UInt64)kEngramDenormalControlBits);
+    }
+
+    for (UInt32 window = 0; window < kBenchWindows; window++) {
+        auto start = std::chrono::steady_clock::now();
+
+        for (UInt32 cycle = 0; cycle < cyclesPerWindow; cycle++) {
+            memset(buffer, 0, sizeof(buffer));
+            if (window == 0 && cycle == 0) {
+                for (UInt32 ch = 0; ch < kBenchChannels; ch++) {
+                    buffer[ch] = 1.0f;   // one impulse, then silence forever
+                }
+            }
+
+            UInt64 saved = useFTZ ? EngramDenormal_Enable() : 0;
+            for (UInt32 ch = 0; ch < kBenchChannels; ch++) {
+                for (UInt32 stage = 0; stage < kBenchStagesPerChannel; stage++) {
+                    if (variant == kVariantUnprotected || variant == kVariantFTZ) {
+                        ProcessUnprotected(&coefficients, &states[ch][stage], buffer + ch, kBenchFrames, kBenchChannels);
+                    } else {
+                        EngramBiquad_Process(&coefficients, &states[ch][stage], buffer + ch, kBenchFrames, kBenchChannels);
+                    }
+                }
+            }
+            if (useFTZ) {
+                EngramDenormal_Restore(saved);
+            }
+        }
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        outWindowNsPerCycle[window] = (Float64)elapsed.count() / cyclesPerWindow;
+    }
+
+    if (!useFTZ) {
+        EngramDenormal_SetControl(previousControl);
+    }
+}
+
+int main(void) {
+    printf("Denormal benchmark: %d s of silence after one impulse, %d ch x %d biquads, %d-frame cycles\n",
+           kBenchSilenceSeconds, kBenchChannels, kBenchStagesPerChannel, kBenchFrames);
+    printf("%-16s %12s %12s %12s %10s\n", "variant", "first s", "median s", "worst s", "median/first");
+
+    int failures = 0;
+    Float64 medians[kVariantCount];
+    for (int v = 0; v < kVariantCount; v++) {
+        Float64 windows[kBenchWindows];
+        RunVariant((BenchVariant)v, windows);
+
+        Float64 sorted[kBenchWindows];
+        memcpy(sorted, windows, sizeof(sorted));
+        std::sort(sorted, sorted + kBenchWindows);
+
+        medians[v] = sorted[kBenchWindows / 2];
+        Float64 ratio = medians[v] / windows[0];
+        printf("%-16s %9.0f ns %9.0f ns %9.0f ns %11.2fx\n",
+               kVariantNames[v], windows[0], medians[v], sorted[kBenchWindows - 1], ratio);
+
+        if (v != kVariantUnprotected && ratio > kBenchMaxWindowRatio) {
+            fprintf(stderr, "FAIL: %s per-cycle cost is not flat (%.2fx)\n", kVariantNames[v], ratio);
+            failures++;
+        }
+    }
+
+    printf("Unprotected silence tail costs %.1fx the guarded IO path\n", medians[kVariantUnprotected] / medians[kVariantChain]);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,339 @@
+//
+//  EngramIOBench.cpp
+//  Engram Virtual Audio Device
+//
+//  Per-cycle cost of the IO path: EngramDevice_DoIOOperation through the
+//  driver interface, the ring buffer on its own, the DSP chain (specialized
+//  kernel and generic reference) and the glitch stage. Sweeps buffer sizes (16-4096 frames), channel counts and producer
+//  contention (idle, or a thread hammering the ring) and prints JSON so
+//  results can be diffed between releases.
+//  Usage: EngramIOBench [--quick] [--output results.json]
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "../EngramDSP.h"
+#include "../EngramDenormal.h"
+#include "../EngramGlitch.h"
+#include "../EngramHalPlugin.h"
+#include "../EngramIO.h"
+#include "../EngramRingBuffer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#define kBenchVersion 1
+#define kBenchMaxFrames 4096
+#define kBenchMaxChannels 8
+#define kBenchProducerBlock 256
+
+static const UInt32 kBufferSizes[] = { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+static const UInt32 kChannelCounts[] = { 1, 2, 8 };
+
+typedef enum {
+    kContentionIdle = 0,     // producer tops up the ring between cycles, untimed
+    kContentionHammer,       // a second thread writes to the ring as fast as it can
+    kContentionCount
+} BenchContention;
+
+static const char* kContentionNames[kContentionCount] = { "idle", "hammer" };
+
+typedef struct {
+    UInt32 iterationScale;
+    UInt32 minIterations;
+    Float64 cyclesPerNano;   // 0 when the CPU has no usable cycle counter
+    FILE* out;
+    UInt32 resultCount;
+} BenchContext;
+
+// MARK: - Timing
+
+static inline UInt64 BenchNow(void) {
+    return (UInt64)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// TSC ticks per nanosecond, measured against the steady clock. Modern x86
+// TSCs run at the nominal core frequency, which is what "cycles" means here.
+static Float64 BenchCalibrateCycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    UInt64 startNanos = BenchNow();
+    UInt64 startTicks = __rdtsc();
+    while (BenchNow() - startNanos < 50000000) {
+    }
+    UInt64 ticks = __rdtsc() - startTicks;
+    return (Float64)ticks / (Float64)(BenchNow() - startNanos);
+#else
+    return 0.0;
+#endif
+}
+
+static UInt32 BenchIterations(const BenchContext* context, UInt32 frames) {
+    UInt32 iterations = context->iterationScale / frames;
+    return (iterations < context->minIterations) ? context->minIterations : iterations;
+}
+
+// MARK: - Results
+
+static void BenchReport(BenchContext* context, const char* name, UInt32 frames, UInt32 channels,
+                        BenchContention contention, std::vector<UInt64>& samples) {
+    std::sort(samples.begin(), samples.end());
+    size_t count = samples.size();
+    Float64 total = 0.0;
+    for (UInt64 sample : samples) {
+        total += (Float64)sample;
+    }
+    Float64 meanNs = total / (Float64)count;
+    UInt64 p50 = samples[count / 2];
+    UInt64 p99 = samples[std::min(count - 1, (size_t)((Float64)count * 0.99))];
+    UInt64 p999 = samples[std::min(count - 1, (size_t)((Float64)count * 0.999))];
+
+    FILE* out = context->out;
+    fprintf(out, "%s    {\"name\": \"%s\", \"bufferFrames\": %u, \"channels\": %u, \"contention\": \"%s\", "
+                 "\"iterations\": %zu, \"meanNs\": %.1f, \"nsPerFrame\": %.3f, \"p50Ns\": %llu, \"p99Ns\": %llu, "
+                 "\"p999Ns\": %llu, \"maxNs\": %llu, ",
+            (context->resultCount++ > 0) ? ",\n" : "", name, frames, channels, kContentionNames[contention],
+            count, meanNs, meanNs / frames, (unsigned long long)p50, (unsigned long long)p99,
+            (unsigned long long)p999, (unsigned long long)samples[count - 1]);
+    if (context->cyclesPerNano > 0.0) {
+        fprintf(out, "\"cyclesPerSample\": %.3f}", meanNs * context->cyclesPerNano / (Float64)(frames * channels));
+    } else {
+        fprintf(out, "\"cyclesPerSample\": null}");
+    }
+    fflush(out);
+}
+
+// Runs `body` once per iteration, optionally against a producer thread
+// hammering `ring`. `body` does any untimed setup and returns the start
+// time of the section being measured.
+template <typename Body>
+static void BenchMeasure(BenchContext* context, const char* name, UInt32 frames, UInt32 channels,
+                         BenchContention contention, EngramRingBuffer* ring, Body body) {
+    UInt32 iterations = BenchIterations(context, frames);
+    std::vector<UInt64> samples(iterations);
+
+    std::atomic<Boolean> running(true);
+    std::thread producer;
+    if (contention == kContentionHammer && ring != NULL) {
+        producer = std::thread([ring, &running]() {
+            Float32 block[kBenchProducerBlock] = {};
+            while (running.load(std::memory_order_relaxed)) {
+                EngramRingBuffer_Write(ring, block, kBenchProducerBlock);
+            }
+        });
+    }
+
+    // Warm caches and branch predictors before timing
+    for (UInt32 i = 0; i < 64; i++) {
+        body();
+    }
+    for (UInt32 i = 0; i < iterations; i++) {
+        UInt64 start = body();
+        samples[i] = BenchNow() - start;
+    }
+
+    running.store(false, std::memory_order_relaxed);
+    if (producer.joinable()) {
+        producer.join();
+    }
+    BenchReport(context, name, frames, channels, contention, samples);
+}
+
+// MARK: - Benchmarks
+
+static void BenchRingBuffer(BenchContext* context) {
+    static Float32 storage[kEngramRingBufferSize];
+    static Float32 block[kBenchMaxFrames * kBenchMaxChannels];
+    static EngramRingBuffer ring;
+
+    for (UInt32 channels : kChannelCounts) {
+        for (UInt32 frames : kBufferSizes) {
+            UInt32 samples = frames * channels;
+            if (samples >= kEngramRingBufferSize / 2) {
+                continue;
+            }
+
+            EngramRingBuffer_Init(&ring, storage, kEngramRingBufferSize);
+            BenchMeasure(context, "EngramRingBuffer_Write", frames, channels, kContentionIdle, NULL,
+                         [&]() -> UInt64 {
+                // Keep room for the write without timing the read that makes it
+                if (EngramRingBuffer_GetAvailableWrite(&ring) < samples) {
+                    EngramRingBuffer_Read(&ring, block, samples);
+                }
+                UInt64 start = BenchNow();
+                EngramRingBuffer_Write(&ring, block, samples);
+                return start;
+            });
+
+            for (int contention = 0; contention < kContentionCount; contention++) {
+                EngramRingBuffer_Init(&ring, storage, kEngramRingBufferSize);
+                BenchMeasure(context, "EngramRingBuffer_Read", frames, channels, (BenchContention)contention, &ring,
+                             [&]() -> UInt64 {
+                    if (contention == kContentionIdle && EngramRingBuffer_GetAvailableRead(&ring) < samples) {
+                        EngramRingBuffer_Write(&ring, block, samples);
+                    }
+                    UInt64 start = BenchNow();
+                    EngramRingBuffer_Read(&ring, block, samples);
+                    return start;
+                });
+            }
+        }
+    }
+}
+
+static void BenchDSP(BenchContext* context) {
+    static Float32 block[kBenchMaxFrames * kBenchMaxChannels];
+    for (UInt32 i = 0; i < kBenchMaxFrames * kBenchMaxChannels; i++) {
+        block[i] = 0.25f * (Float32)((i * 2654435761u) >> 16) / 65536.0f;
+    }
+
+    for (UInt32 channels : kChannelCounts) {
+        EngramDSPChain chain;
+        EngramDSPChain_Init(&chain, kEngramSampleRate, channels, kEngramDefaultDSPStages);
+
+        EngramArena arena;
+        EngramArena_Reserve(&arena, EngramGlitch_RequiredBytes(channels));
+        EngramGlitchDetector* glitch = EngramGlitch_Create(&arena, kEngramSampleRate, channels);
+
+        for (UInt32 frames : kBufferSizes) {
+            ENGRAM_DENORMAL_GUARD();
+
+            BenchMeasure(context, "EngramDSPChain_Process", frames, channels, kContentionIdle, NULL,
+                         [&]() -> UInt64 {
+                UInt64 start = BenchNow();
+                EngramDSPChain_Process(&chain, block, frames);
+                return start;
+            });
+
+            // The runtime-looped path the specialized kernels replace
+            BenchMeasure(context, "EngramDSPChain_ProcessGeneric", frames, channels, kContentionIdle, NULL,
+                         [&]() -> UInt64 {
+                UInt64 start = BenchNow();
+                EngramDSPChain_ProcessGeneric(&chain, block, frames);
+                return start;
+            });
+
+            EngramGlitch_Reset(glitch);
+            BenchMeasure(context, "EngramGlitch_Observe", frames, channels, kContentionIdle, NULL,
+                         [&]() -> UInt64 {
+                EngramGlitchCycle cycle = {};
+                cycle.frames = frames;
+                cycle.sampleTime = (Float64)glitch->expectedSampleTime;
+                UInt64 start = BenchNow();
+                EngramGlitch_Observe(glitch, &cycle, block);
+                return start;
+            });
+        }
+
+        EngramArena_Release(&arena);
+    }
+}
+
+static void BenchDoIOOperation(BenchContext* context) {
+    AudioServerPlugInDriverRef driver = (AudioServerPlugInDriverRef)EngramPlugIn_Create(NULL, kAudioServerPlugInTypeUUID);
+    AudioServerPlugInDriverInterface* interface = *driver;
+    interface->Initialize(driver, NULL);
+    AudioObjectID deviceID = kAudioObjectUnknown;
+    interface->CreateDevice(driver, NULL, NULL, &deviceID);
+    interface->StartIO(driver, deviceID, 1);
+
+    UInt32 channels = gDevice.channels;
+    static Float32 buffer[kBenchMaxFrames * kBenchMaxChannels];
+    static Float32 input[kBenchMaxFrames * kBenchMaxChannels];
+    for (UInt32 i = 0; i < kBenchMaxFrames * kBenchMaxChannels; i++) {
+        input[i] = 0.1f * (Float32)(i % 97) / 97.0f;
+    }
+
+    AudioServerPlugInIOCycleInfo cycleInfo;
+    memset(&cycleInfo, 0, sizeof(cycleInfo));
+    Float64 sampleTime = 0.0;
+
+    for (UInt32 frames : kBufferSizes) {
+        for (int contention = 0; contention < kContentionCount; contention++) {
+            BenchMeasure(context, "EngramDevice_DoIOOperation", frames, channels, (BenchContention)contention,
+                         &gDevice.ringBuffer, [&]() -> UInt64 {
+                if (contention == kContentionIdle) {
+                    EngramDevice_WriteInput(input, frames * channels);
+                }
+                cycleInfo.mIOCycleCounter++;
+                cycleInfo.mNominalIOBufferFrameSize = frames;
+                cycleInfo.mInputTime.mSampleTime = sampleTime;
+                sampleTime += frames;
+
+                UInt64 start = BenchNow();
+                interface->DoIOOperation(driver, deviceID, kAudioObjectUnknown, 1, kAudioServerPlugInIOOperationReadInput,
+                                         frames, &cycleInfo, buffer, NULL);
+                return start;
+            });
+
+            // Leave an empty ring for the next configuration
+            while (EngramRingBuffer_Read(&gDevice.ringBuffer, buffer, frames * channels) > 0) {
+            }
+        }
+    }
+
+    interface->StopIO(driver, deviceID, 1);
+    interface->Release(driver);
+}
+
+// MARK: - Main
+
+int main(int argc, char** argv) {
+    BenchContext context = {};
+    context.iterationScale = 1u << 22;
+    context.minIterations = 2000;
+    context.out = stdout;
+    const char* outputPath = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0) {
+            context.iterationScale = 1u << 18;
+            context.minIterations = 200;
+        } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else {
+            fprintf(stderr, "usage: EngramIOBench [--quick] [--output results.json]\n");
+            return 2;
+        }
+    }
+    if (outputPath != NULL) {
+        context.out = fopen(outputPath, "w");
+        if (context.out == NULL) {
+            fprintf(stderr, "EngramIOBench: cannot open %s\n", outputPath);
+            return 1;
+        }
+    }
+
+    context.cyclesPerNano = BenchCalibrateCycles();
+
+    fprintf(context.out, "{\n");
+    fprintf(context.out, "  \"benchmark\": \"engram-io\",\n");
+    fprintf(context.out, "  \"version\": %d,\n", kBenchVersion);
+    fprintf(context.out, "  \"sampleRate\": %.0f,\n", kEngramSampleRate);
+    fprintf(context.out, "  \"hardwareThreads\": %u,\n", std::thread::hardware_concurrency());
+    if (context.cyclesPerNano > 0.0) {
+        fprintf(context.out, "  \"cycleCounterGHz\": %.3f,\n", context.cyclesPerNano);
+    } else {
+        fprintf(context.out, "  \"cycleCounterGHz\": null,\n");
+    }
+    fprintf(context.out, "  \"results\": [\n");
+
+    BenchRingBuffer(&context);
+    BenchDSP(&context);
+    BenchDoIOOperation(&context);
+
+    fprintf(context.out, "\n  ]\n}\n");
+    if (context.out != stdout) {
+        fclose(context.out);
+    }
+    return 0;
+}
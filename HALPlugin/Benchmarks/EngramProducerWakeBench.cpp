@@ -0,0 +1,222 @@
+//
+//  EngramProducerWakeBench.cpp
+//  Engram Virtual Audio Device
+//
+//  What keeping the ring topped up costs the producer: timer polling at a few
+//  intervals against sleeping on the low-water event. A real-time-paced IO
+//  thread reads one buffer per cycle through the driver interface while the
+//  producer refills to a target whenever the fill drops below a threshold.
+//  Reports producer CPU time and wakeups per second, the delay from the read
+//  that crossed the threshold to the refill, and underruns, as JSON.
+//  Usage: EngramProducerWakeBench [--quick] [--output results.json]
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "../EngramHalPlugin.h"
+#include "../EngramIO.h"
+#include "../EngramWait.h"
+#include <algorithm>
+#include <atomic>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <time.h>
+#include <vector>
+
+#define kBenchVersion 1
+#define kBenchBufferFrames 256
+#define kBenchThresholdFrames (2 * kBenchBufferFrames)
+#define kBenchTargetFrames (4 * kBenchBufferFrames)
+#define kBenchNanosPerSecond 1000000000ull
+
+typedef struct {
+    const char* name;
+    UInt64 pollNanos;        // 0: wait for the low-water event instead
+} BenchMode;
+
+static const BenchMode kModes[] = {
+    { "poll-500us", 500000 },
+    { "poll-1ms", 1000000 },
+    { "poll-2ms", 2000000 },
+    { "event", 0 },
+};
+
+typedef struct {
+    UInt64 producerCpuNs;
+    UInt64 wakeups;
+    UInt64 refills;
+    UInt64 cycles;
+    UInt64 underruns;
+    std::vector<UInt64> refillDelays;
+} BenchResult;
+
+// MARK: - Timing
+
+static UInt64 BenchThreadCpuNow(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return (UInt64)now.tv_sec * kBenchNanosPerSecond + (UInt64)now.tv_nsec;
+}
+
+// Relative sleeps, since macOS has no clock_nanosleep; `deadline` is on EngramWait_Now's clock
+static void BenchSleepUntil(UInt64 deadline) {
+    for (UInt64 now = EngramWait_Now(); now < deadline; now = EngramWait_Now()) {
+        UInt64 remaining = deadline - now;
+        struct timespec pause = { (time_t)(remaining / kBenchNanosPerSecond), (long)(remaining % kBenchNanosPerSecond) };
+        nanosleep(&pause, NULL);
+    }
+}
+
+// MARK: - Benchmark
+
+static void BenchRun(AudioServerPlugInDriverRef driver, AudioObjectID deviceID, const BenchMode* mode,
+                     UInt64 durationNanos, BenchResult* result) {
+    UInt32 channels = gDevice.channels;
+    static Float32 block[kBenchTargetFrames * kEngramMaxChannels];
+    static Float32 buffer[kBenchBufferFrames * kEngramMaxChannels];
+
+    // When the IO thread's read took the fill below the threshold; the refill clears it
+    std::atomic<UInt64> crossedAt(0);
+    std::atomic<Boolean> running(true);
+
+    (*driver)->StartIO(driver, deviceID, 1);
+    EngramDevice_WriteInput(block, kBenchTargetFrames * channels);
+
+    std::thread producer([&]() {
+        UInt64 cpuStart = BenchThreadCpuNow();
+        while (running.load(std::memory_order_relaxed)) {
+            if (mode->pollNanos != 0) {
+                struct timespec pause = { 0, (long)mode->pollNanos };
+                nanosleep(&pause, NULL);
+            } else if (!EngramDevice_WaitForLowWater(kBenchThresholdFrames, 100000000)) {
+                continue;
+            }
+            result->wakeups++;
+
+            UInt32 fill = EngramRingBuffer_GetAvailableRead(&gDevice.ringBuffer) / channels;
+            if (fill >= kBenchThresholdFrames) {
+                continue;
+            }
+            EngramDevice_WriteInput(block, (kBenchTargetFrames - fill) * channels);
+            result->refills++;
+            UInt64 crossed = crossedAt.exchange(0, std::memory_order_acq_rel);
+            if (crossed != 0) {
+                result->refillDelays.push_back(EngramWait_Now() - crossed);
+            }
+        }
+        result->producerCpuNs = BenchThreadCpuNow() - cpuStart;
+    });
+
+    AudioServerPlugInIOCycleInfo cycleInfo;
+    memset(&cycleInfo, 0, sizeof(cycleInfo));
+    UInt64 cycleNanos = (UInt64)((Float64)kBenchBufferFrames * 1.0e9 / kEngramSampleRate);
+    UInt64 start = EngramWait_Now();
+    UInt64 deadline = start;
+    while (deadline - start < durationNanos) {
+        deadline += cycleNanos;
+        BenchSleepUntil(deadline);
+
+        // Stamped before the read, since an event-mode producer may refill
+        // before this thread gets to look at the ring again
+        UInt32 before = EngramRingBuffer_GetAvailableRead(&gDevice.ringBuffer) / channels;
+        if (before >= kBenchThresholdFrames && before - kBenchBufferFrames < kBenchThresholdFrames) {
+            UInt64 expected = 0;
+            crossedAt.compare_exchange_strong(expected, EngramWait_Now(), std::memory_order_acq_rel);
+        }
+
+        cycleInfo.mIOCycleCounter++;
+        cycleInfo.mNominalIOBufferFrameSize = kBenchBufferFrames;
+        (*driver)->DoIOOperation(driver, deviceID, kAudioObjectUnknown, 1, kAudioServerPlugInIOOperationReadInput,
+                                 kBenchBufferFrames, &cycleInfo, buffer, NULL);
+
+        result->cycles++;
+        if (before < kBenchBufferFrames) {
+            result->underruns++;
+        }
+    }
+
+    running.store(false, std::memory_order_relaxed);
+    // The last StopIO releases an event-mode producer from its wait
+    (*driver)->StopIO(driver, deviceID, 1);
+    producer.join();
+
+    while (EngramRingBuffer_Read(&gDevice.ringBuffer, buffer, kBenchBufferFrames * channels) > 0) {
+    }
+}
+
+static void BenchReport(FILE* out, const BenchMode* mode, UInt64 durationNanos, BenchResult* result, Boolean first) {
+    std::vector<UInt64>& delays = result->refillDelays;
+    std::sort(delays.begin(), delays.end());
+    size_t count = delays.size();
+    UInt64 p50 = (count > 0) ? delays[count / 2] : 0;
+    UInt64 p99 = (count > 0) ? delays[std::min(count - 1, (size_t)((Float64)count * 0.99))] : 0;
+    UInt64 max = (count > 0) ? delays[count - 1] : 0;
+    Float64 seconds = (Float64)durationNanos / 1.0e9;
+
+    fprintf(out, "%s    {\"mode\": \"%s\", \"pollNs\": %llu, \"cycles\": %llu, \"underruns\": %llu, "
+                 "\"producerCpuUsPerSecond\": %.1f, \"wakeupsPerSecond\": %.1f, \"refillsPerSecond\": %.1f, "
+                 "\"refillDelayP50Ns\": %llu, \"refillDelayP99Ns\": %llu, \"refillDelayMaxNs\": %llu}",
+            first ? "" : ",\n", mode->name, (unsigned long long)mode->pollNanos,
+            (unsigned long long)result->cycles, (unsigned long long)result->underruns,
+            (Float64)result->producerCpuNs / 1000.0 / seconds, (Float64)result->wakeups / seconds,
+            (Float64)result->refills / seconds, (unsigned long long)p50, (unsigned long long)p99,
+            (unsigned long long)max);
+    fflush(out);
+}
+
+// MARK: - Main
+
+int main(int argc, char** argv) {
+    UInt64 durationNanos = 4 * kBenchNanosPerSecond;
+    FILE* out = stdout;
+    const char* outputPath = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0) {
+            durationNanos = kBenchNanosPerSecond;
+        } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else {
+            fprintf(stderr, "usage: EngramProducerWakeBench [--quick] [--output results.json]\n");
+            return 2;
+        }
+    }
+    if (outputPath != NULL) {
+        out = fopen(outputPath, "w");
+        if (out == NULL) {
+            fprintf(stderr, "EngramProducerWakeBench: cannot open %s\n", outputPath);
+            return 1;
+        }
+    }
+
+    AudioServerPlugInDriverRef driver = (AudioServerPlugInDriverRef)EngramPlugIn_Create(NULL, kAudioServerPlugInTypeUUID);
+    (*driver)->Initialize(driver, NULL);
+    AudioObjectID deviceID = kAudioObjectUnknown;
+    (*driver)->CreateDevice(driver, NULL, NULL, &deviceID);
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"benchmark\": \"engram-producer-wake\",\n");
+    fprintf(out, "  \"version\": %d,\n", kBenchVersion);
+    fprintf(out, "  \"sampleRate\": %.0f,\n", kEngramSampleRate);
+    fprintf(out, "  \"bufferFrames\": %d,\n", kBenchBufferFrames);
+    fprintf(out, "  \"thresholdFrames\": %d,\n", kBenchThresholdFrames);
+    fprintf(out, "  \"targetFrames\": %d,\n", kBenchTargetFrames);
+    fprintf(out, "  \"seconds\": %.1f,\n", (Float64)durationNanos / 1.0e9);
+    fprintf(out, "  \"hardwareThreads\": %u,\n", std::thread::hardware_concurrency());
+    fprintf(out, "  \"results\": [\n");
+
+    for (size_t i = 0; i < sizeof(kModes) / sizeof(kModes[0]); i++) {
+        BenchResult result = {};
+        BenchRun(driver, deviceID, &kModes[i], durationNanos, &result);
+        BenchReport(out, &kModes[i], durationNanos, &result, i == 0);
+    }
+
+    fprintf(out, "\n  ]\n}\n");
+    if (out != stdout) {
+        fclose(out);
+    }
+    (*driver)->Release(driver);
+    return 0;
+}
@@ -0,0 +1,282 @@
+//
+//  EngramArena.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramArena.h"
+#include "EngramLog.h"
+#include <atomic>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#if ENGRAM_DEBUG_ALLOC_GUARD && defined(__APPLE__)
+#include <mach/mach.h>
+#include <malloc/malloc.h>
+#endif
+
+static std::atomic<Boolean> gArenaGuardArmed;
+
+static void EngramArena_InstallHeapGuard(void);
+
+// MARK: - Arena
+
+Boolean EngramArena_Reserve(EngramArena* arena, size_t capacity) {
+    capacity = EngramArena_AlignedSize(capacity);
+
+    void* base = NULL;
+    if (posix_memalign(&base, kEngramArenaAlignment, capacity) != 0) {
+        memset(arena, 0, sizeof(EngramArena));
+        return false;
+    }
+
+    // Touch every page now so the IO thread never takes a first-use fault,
+    // and wire them if the process is allowed to.
+    memset(base, 0, capacity);
+
+    arena->base = (UInt8*)base;
+    arena->capacity = capacity;
+    arena->used = 0;
+    arena->sealed = false;
+    arena->wired = (mlock(base, capacity) == 0);
+    return true;
+}
+
+void EngramArena_Release(EngramArena* arena) {
+    if (arena->base != NULL) {
+        if (arena->wired) {
+            munlock(arena->base, arena->capacity);
+        }
+        free(arena->base);
+    }
+    memset(arena, 0, sizeof(EngramArena));
+    gArenaGuardArmed.store(false, std::memory_order_relaxed);
+}
+
+void* EngramArena_Alloc(EngramArena* arena, size_t size) {
+    size = EngramArena_AlignedSize(size);
+
+    if (arena->sealed) {
+#if ENGRAM_DEBUG_ALLOC_GUARD
+        fprintf(stderr, "EngramArena: %zu-byte allocation after seal\n", size);
+        abort();
+#endif
+        ENGRAM_LOG_ERROR("Arena allocation of %llu bytes after seal", size);
+        return NULL;
+    }
+
+    if (arena->base == NULL || size > arena->capacity - arena->used) {
+        ENGRAM_LOG_ERROR("Arena exhausted: %llu bytes requested, %llu of %llu used",
+                         size, arena->used, arena->capacity);
+        return NULL;
+    }
+
+    void* block = arena->base + arena->used;
+    arena->used += size;
+    return block;
+}
+
+void EngramArena_Seal(EngramArena* arena) {
+    arena->sealed = true;
+    EngramArena_InstallHeapGuard();
+    gArenaGuardArmed.store(true, std::memory_order_relaxed);
+    ENGRAM_LOG_INFO("Arena sealed: %llu of %llu bytes used (wired %llu)",
+                    arena->used, arena->capacity, arena->wired);
+}
+
+// MARK: - Debug Allocation Guard
+
+#if ENGRAM_DEBUG_ALLOC_GUARD
+
+// Initial-exec, so reading it from inside malloc never allocates
+#if ENGRAM_ALLOC_GUARD_WATCHES_MALLOC
+static thread_local UInt32 gAllocGuardDepth __attribute__((tls_model("initial-exec"))) = 0;
+#else
+static thread_local UInt32 gAllocGuardDepth = 0;
+#endif
+
+void EngramArena_BeginGuard(void) {
+    gAllocGuardDepth++;
+}
+
+void EngramArena_EndGuard(void) {
+    gAllocGuardDepth--;
+}
+
+UInt32 EngramArena_BeginPermit(void) {
+    UInt32 depth = gAllocGuardDepth;
+    gAllocGuardDepth = 0;
+    return depth;
+}
+
+void EngramArena_EndPermit(UInt32 depth) {
+    gAllocGuardDepth = depth;
+}
+
+void EngramArena_CheckHeapAllocation(size_t size) {
+    if (gAllocGuardDepth > 0 && gArenaGuardArmed.load(std::memory_order_relaxed)) {
+        // Lifted first, in case reporting allocates
+        gAllocGuardDepth = 0;
+        fprintf(stderr, "EngramArena: %zu-byte heap allocation inside a driver callback after Initialize\n", size);
+        abort();
+    }
+}
+
+#if !ENGRAM_ALLOC_GUARD_WATCHES_MALLOC
+
+static void EngramArena_InstallHeapGuard(void) {}
+
+#elif defined(__APPLE__)
+
+// The default zone's own entry points, which the wrappers forward to
+static malloc_zone_t gSystemZone;
+static std::atomic<Boolean> gHeapGuardInstalled;
+
+static void* EngramArena_ZoneMalloc(malloc_zone_t* zone, size_t size) {
+    EngramArena_CheckHeapAllocation(size);
+    return gSystemZone.malloc(zone, size);
+}
+
+static void* EngramArena_ZoneCalloc(malloc_zone_t* zone, size_t count, size_t size) {
+    EngramArena_CheckHeapAllocation(count * size);
+    return gSystemZone.calloc(zone, count, size);
+}
+
+static void* EngramArena_ZoneValloc(malloc_zone_t* zone, size_t size) {
+    EngramArena_CheckHeapAllocation(size);
+    return gSystemZone.valloc(zone, size);
+}
+
+static void* EngramArena_ZoneRealloc(malloc_zone_t* zone, void* block, size_t size) {
+    EngramArena_CheckHeapAllocation(size);
+    return gSystemZone.realloc(zone, block, size);
+}
+
+// posix_memalign and aligned_alloc arrive here
+static void* EngramArena_ZoneMemalign(malloc_zone_t* zone, size_t alignment, size_t size) {
+    EngramArena_CheckHeapAllocation(size);
+    return gSystemZone.memalign(zone, alignment, size);
+}
+
+// Once per process; the wrappers stay in place and check nothing until sealed
+static void EngramArena_InstallHeapGuard(void) {
+    if (gHeapGuardInstalled.exchange(true)) {
+        return;
+    }
+    malloc_zone_t* zone = malloc_default_zone();
+    gSystemZone = *zone;
+
+    // Zones from version 8 on are kept read-only between updates
+    Boolean protectedZone = (zone->version >= 8);
+    if (protectedZone) {
+        vm_protect(mach_task_self(), (vm_address_t)zone, sizeof(malloc_zone_t), 0, VM_PROT_READ | VM_PROT_WRITE);
+    }
+    zone->malloc = EngramArena_ZoneMalloc;
+    zone->calloc = EngramArena_ZoneCalloc;
+    zone->valloc = EngramArena_ZoneValloc;
+    zone->realloc = EngramArena_ZoneRealloc;
+    if (zone->version >= 5) {
+        zone->memalign = EngramArena_ZoneMemalign;
+    }
+    if (protectedZone) {
+        vm_protect(mach_task_self(), (vm_address_t)zone, sizeof(malloc_zone_t), 0, VM_PROT_READ);
+    }
+}
+
+#elif defined(__GLIBC__)
+
+// glibc's allocator under its internal names. Defining the public ones here
+// interposes them for the whole process; free needs no wrapper.
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* block, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void* __libc_valloc(size_t size);
+
+void* malloc(size_t size) {
+    EngramArena_CheckHeapAllocation(size);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    EngramArena_CheckHeapAllocation(count * size);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* block, size_t size) {
+    EngramArena_CheckHeapAllocation(size);
+    return __libc_realloc(block, size);
+}
+
+void* memalign(size_t alignment, size_t size) {
+    EngramArena_CheckHeapAllocation(size);
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    EngramArena_CheckHeapAllocation(size);
+    return __libc_memalign(alignment, size);
+}
+
+void* valloc(size_t size) {
+    EngramArena_CheckHeapAllocation(size);
+    return __libc_valloc(size);
+}
+
+int posix_memalign(void** outBlock, size_t alignment, size_t size) {
+    if (alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+    EngramArena_CheckHeapAllocation(size);
+    void* block = __libc_memalign(alignment, size);
+    if (block == NULL) {
+        return ENOMEM;
+    }
+    *outBlock = block;
+    return 0;
+}
+}
+
+static void EngramArena_InstallHeapGuard(void) {}
+
+#endif
+
+static void* EngramArena_GuardedNew(size_t size) {
+    EngramArena_CheckHeapAllocation(size);
+    void* block = malloc(size ? size : 1);
+    if (block == NULL) {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+void* operator new(size_t size) { return EngramArena_GuardedNew(size); }
+void* operator new[](size_t size) { return EngramArena_GuardedNew(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    EngramArena_CheckHeapAllocation(size);
+    return malloc(size ? size : 1);
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    EngramArena_CheckHeapAllocation(size);
+    return malloc(size ? size : 1);
+}
+void operator delete(void* block) noexcept { free(block); }
+void operator delete[](void* block) noexcept { free(block); }
+void operator delete(void* block, size_t) noexcept { free(block); }
+void operator delete[](void* block, size_t) noexcept { free(block); }
+
+#else
+
+void EngramArena_CheckHeapAllocation(size_t size) {
+    (void)size;
+}
+
+static void EngramArena_InstallHeapGuard(void) {}
+
+#endif
@@ -0,0 +1,104 @@
+//
+//  EngramArena.h
+//  Engram Virtual Audio Device
+//
+//  Preallocated arena for the plugin's lifetime
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#ifndef EngramArena_h
+#define EngramArena_h
+
+#include "EngramTypes.h"
+#include <new>
+#include <stddef.h>
+
+#define kEngramArenaAlignment 64
+
+// MARK: - Arena
+//
+// All plugin memory is reserved once, while the plugin is created, and carved
+// up with a bump pointer. Once sealed (end of Initialize) the arena refuses
+// further carving. State that comes and goes with clients at runtime lives in
+// fixed tables carved before sealing, whose slots are claimed and freed with a
+// CAS on the owner's ID (see EngramMixMinus).
+
+typedef struct {
+    UInt8* base;
+    size_t capacity;
+    size_t used;
+    Boolean sealed;
+    Boolean wired;
+} EngramArena;
+
+// Rounds a request up so per-module sizes can be summed into a reservation.
+static inline size_t EngramArena_AlignedSize(size_t size) {
+    return (size + kEngramArenaAlignment - 1) & ~(size_t)(kEngramArenaAlignment - 1);
+}
+
+Boolean EngramArena_Reserve(EngramArena* arena, size_t capacity);
+void EngramArena_Release(EngramArena* arena);
+void* EngramArena_Alloc(EngramArena* arena, size_t size);
+void EngramArena_Seal(EngramArena* arena);
+
+#define ENGRAM_ARENA_NEW_ARRAY(arena, Type, count) \
+    ((Type*)EngramArena_Alloc((arena), sizeof(Type) * (size_t)(count)))
+
+// MARK: - Debug Allocation Guard
+//
+// Builds with ENGRAM_DEBUG_ALLOC_GUARD=1 abort if a thread inside a driver
+// callback allocates from the heap once the plugin arena has been sealed, or if
+// the arena itself is asked for memory after sealing. Every route to the heap
+// is watched: operator new, and malloc, calloc, realloc and the aligned
+// allocators, which is also where CoreFoundation's allocations land. On macOS
+// the default malloc zone is wrapped when the arena is first sealed; on Linux
+// glibc's allocator entry points are interposed. Under a sanitizer, which
+// owns malloc itself, or another C library, only operator new is watched
+// (ENGRAM_ALLOC_GUARD_WATCHES_MALLOC is 0).
+//
+// Allocations the host API demands, like the CF objects GetPropertyData hands
+// back for the caller to release, are made inside ENGRAM_ALLOC_PERMIT().
+
+void EngramArena_CheckHeapAllocation(size_t size);
+
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(thread_sanitizer)
+#define ENGRAM_ALLOC_GUARD_SANITIZED 1
+#endif
+#endif
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__) || defined(ENGRAM_ALLOC_GUARD_SANITIZED)
+#define ENGRAM_ALLOC_GUARD_WATCHES_MALLOC 0
+#elif defined(__APPLE__) || defined(__GLIBC__)
+#define ENGRAM_ALLOC_GUARD_WATCHES_MALLOC ENGRAM_DEBUG_ALLOC_GUARD
+#else
+#define ENGRAM_ALLOC_GUARD_WATCHES_MALLOC 0
+#endif
+
+#if ENGRAM_DEBUG_ALLOC_GUARD
+// Nesting depth of guarded scopes on this thread. Permit returns the depth it
+// lifted, for EndPermit to put back.
+void EngramArena_BeginGuard(void);
+void EngramArena_EndGuard(void);
+UInt32 EngramArena_BeginPermit(void);
+void EngramArena_EndPermit(UInt32 depth);
+
+struct EngramAllocGuardScope {
+    EngramAllocGuardScope() { EngramArena_BeginGuard(); }
+    ~EngramAllocGuardScope() { EngramArena_EndGuard(); }
+};
+
+struct EngramAllocPermitScope {
+    UInt32 depth;
+    EngramAllocPermitScope() : depth(EngramArena_BeginPermit()) {}
+    ~EngramAllocPermitScope() { EngramArena_EndPermit(depth); }
+};
+
+#define ENGRAM_ALLOC_GUARD() EngramAllocGuardScope engramAllocGuardScope
+#define ENGRAM_ALLOC_PERMIT() EngramAllocPermitScope engramAllocPermitScope
+#else
+#define ENGRAM_ALLOC_GUARD() do {} while (0)
+#define ENGRAM_ALLOC_PERMIT() do {} while (0)
+#endif
+
+#endif /* EngramArena_h */
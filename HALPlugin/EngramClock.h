@@ -0,0 +1,57 @@
+//
+//  EngramClock.h
+//  Engram Virtual Audio Device
+//
+//  Device timeline configuration and zero-timestamp math
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#ifndef EngramClock_h
+#define EngramClock_h
+
+#include "EngramTypes.h"
+
+// Frames between successive zero timestamps reported to the HAL
+#define kEngramZeroTimeStampPeriod 16384
+
+// MARK: - Clock Configuration
+
+// Everything GetZeroTimeStamp needs, published as one snapshot so the anchor,
+// rate and period are always read together.
+typedef struct {
+    UInt64 anchorHostTime;
+    UInt64 seed;                // bumped with every new anchor
+    Float64 sampleRate;
+    Float64 hostTicksPerFrame;
+    Float64 nanosPerHostTick;
+    UInt32 periodFrames;
+    UInt32 reserved;
+} EngramClockConfig;
+
+// MARK: - Clock Math
+
+static inline Float64 EngramClock_NanosPerHostTick(UInt32 timebaseNumer, UInt32 timebaseDenom) {
+    return (Float64)timebaseNumer / (Float64)timebaseDenom;
+}
+
+static inline UInt64 EngramClock_HostTicksToNanos(const EngramClockConfig* config, UInt64 ticks) {
+    return (UInt64)((Float64)ticks * config->nanosPerHostTick);
+}
+
+static inline Float64 EngramClock_HostTicksPerFrame(Float64 sampleRate, UInt32 timebaseNumer, UInt32 timebaseDenom) {
+    return 1000000000.0 / sampleRate * (Float64)timebaseDenom / (Float64)timebaseNumer;
+}
+
+// Returns the most recent period boundary at or before `hostTime`.
+static inline void EngramClock_GetZeroTimeStamp(const EngramClockConfig* config, UInt64 hostTime,
+                                                Float64* outSampleTime, UInt64* outHostTime) {
+    Float64 hostTicksPerPeriod = config->hostTicksPerFrame * (Float64)config->periodFrames;
+    UInt64 elapsed = (hostTime > config->anchorHostTime) ? (hostTime - config->anchorHostTime) : 0;
+    UInt64 periods = (UInt64)((Float64)elapsed / hostTicksPerPeriod);
+
+    *outSampleTime = (Float64)(periods * config->periodFrames);
+    *outHostTime = config->anchorHostTime + (UInt64)((Float64)periods * hostTicksPerPeriod);
+}
+
+#endif /* EngramClock_h */
@@ -0,0 +1,278 @@
+//
+//  EngramDSP.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramDSP.h"
+#include <math.h>
+#include <string.h>
+
+// MARK: - Biquad Design (RBJ cookbook)
+
+static void EngramBiquad_Normalize(EngramBiquadCoefficients* c, Float64 b0, Float64 b1, Float64 b2,
+                                   Float64 a0, Float64 a1, Float64 a2) {
+    c->b0 = (Float32)(b0 / a0);
+    c->b1 = (Float32)(b1 / a0);
+    c->b2 = (Float32)(b2 / a0);
+    c->a1 = (Float32)(a1 / a0);
+    c->a2 = (Float32)(a2 / a0);
+}
+
+void EngramBiquad_MakeHighPass(EngramBiquadCoefficients* coefficients, Float64 sampleRate, Float64 cutoffHz, Float64 q) {
+    Float64 w0 = 2.0 * M_PI * cutoffHz / sampleRate;
+    Float64 cosW0 = cos(w0);
+    Float64 alpha = sin(w0) / (2.0 * q);
+
+    EngramBiquad_Normalize(coefficients,
+                           (1.0 + cosW0) / 2.0, -(1.0 + cosW0), (1.0 + cosW0) / 2.0,
+                           1.0 + alpha, -2.0 * cosW0, 1.0 - alpha);
+}
+
+void EngramBiquad_MakeLowPass(EngramBiquadCoefficients* coefficients, Float64 sampleRate, Float64 cutoffHz, Float64 q) {
+    Float64 w0 = 2.0 * M_PI * cutoffHz / sampleRate;
+    Float64 cosW0 = cos(w0);
+    Float64 alpha = sin(w0) / (2.0 * q);
+
+    EngramBiquad_Normalize(coefficients,
+                           (1.0 - cosW0) / 2.0, 1.0 - cosW0, (1.0 - cosW0) / 2.0,
+                           1.0 + alpha, -2.0 * cosW0, 1.0 - alpha);
+}
+
+void EngramBiquad_MakeNotch(EngramBiquadCoefficients* coefficients, Float64 sampleRate, Float64 centerHz, Float64 q) {
+    Float64 w0 = 2.0 * M_PI * centerHz / sampleRate;
+    Float64 cosW0 = cos(w0);
+    Float64 alpha = sin(w0) / (2.0 * q);
+
+    EngramBiquad_Normalize(coefficients,
+                           1.0, -2.0 * cosW0, 1.0,
+                           1.0 + alpha, -2.0 * cosW0, 1.0 - alpha);
+}
+
+// MARK: - Automatic Gain Control
+
+static void EngramAGC_Init(EngramAGCState* agc, Float64 sampleRate) {
+    Float64 blockSeconds = kEngramAGCBlockFrames / sampleRate;
+    agc->levelCoefficient = (Float32)(1.0 - exp(-blockSeconds / kEngramAGCLevelSeconds));
+    agc->maxFallDb = (Float32)(kEngramAGCFallDbPerSecond * blockSeconds);
+    agc->maxRiseDb = (Float32)(kEngramAGCRiseDbPerSecond * blockSeconds);
+    agc->gateMeanSquare = powf(10.0f, kEngramAGCGateDbfs / 10.0f);
+}
+
+static void EngramAGC_Reset(EngramAGCState* agc) {
+    // As if speech had been at the target all along, so the gain starts at
+    // unity and moves only once there is something to measure
+    agc->levelMeanSquare = powf(10.0f, kEngramAGCTargetDbfs / 10.0f);
+    agc->gainDb = 0.0f;
+    agc->targetGain = 1.0f;
+    agc->gain = 1.0f;
+    agc->gainStep = 0.0f;
+    agc->blockFill = 0;
+    memset(agc->blockSumSquares, 0, sizeof(agc->blockSumSquares));
+    memset(agc->blockPeak, 0, sizeof(agc->blockPeak));
+}
+
+// The gain computer, once per block: from the block just measured, where the
+// next block's ramp should end. Two transcendentals, whatever the cycle size.
+static void EngramAGC_EndBlock(EngramAGCState* agc, UInt32 channels) {
+    Float32 sumSquares = 0.0f;
+    Float32 peak = 0.0f;
+    for (UInt32 ch = 0; ch < channels; ch++) {
+        sumSquares += agc->blockSumSquares[ch];
+        peak = fmaxf(peak, agc->blockPeak[ch]);
+    }
+    Float32 meanSquare = sumSquares / (Float32)(kEngramAGCBlockFrames * channels);
+    Float32 gainDb = agc->gainDb;
+
+    // The energy gate is the voice activity decision unless the chain was
+    // told otherwise; below it, hold
+    if (agc->decision == kEngramAGCDecisionHold) {
+        gainDb = fminf(gainDb, 0.0f);
+    } else if (meanSquare >= agc->gateMeanSquare) {
+        agc->levelMeanSquare += agc->levelCoefficient * (meanSquare - agc->levelMeanSquare);
+        Float32 wantedDb = kEngramAGCTargetDbfs - 10.0f * log10f(agc->levelMeanSquare);
+        wantedDb = fminf(fmaxf(wantedDb, kEngramAGCMinGainDb), kEngramAGCMaxGainDb);
+        gainDb += fminf(fmaxf(wantedDb - gainDb, -agc->maxFallDb), agc->maxRiseDb);
+    }
+
+    Float32 gain = powf(10.0f, gainDb / 20.0f);
+    if (peak * gain > kEngramAGCPeakCeiling) {
+        gain = fmaxf(kEngramAGCPeakCeiling / peak, powf(10.0f, kEngramAGCMinGainDb / 20.0f));
+        gainDb = 20.0f * log10f(gain);
+    }
+
+    // The last ramp lands exactly, not wherever the additions drifted to
+    agc->gain = agc->targetGain;
+    agc->gainDb = gainDb;
+    agc->targetGain = gain;
+    agc->gainStep = (gain - agc->gain) / (Float32)kEngramAGCBlockFrames;
+    agc->blockFill = 0;
+    memset(agc->blockSumSquares, 0, sizeof(agc->blockSumSquares));
+    memset(agc->blockPeak, 0, sizeof(agc->blockPeak));
+}
+
+// Measures each frame before its gain is applied. kChannels == 0 takes the
+// channel count from the chain; otherwise the inner loop has a constant trip
+// count. The arithmetic is the same either way, so results are bit-identical.
+template <UInt32 kChannels>
+static inline void EngramAGC_Process(EngramDSPChain* chain, Float32* samples, UInt32 frames) {
+    EngramAGCState* agc = &chain->agc;
+    const UInt32 channels = (kChannels != 0) ? kChannels : chain->channels;
+    // Locals, since the samples could alias the state as far as the compiler knows
+    Float32 gain = agc->gain;
+    Float32 step = agc->gainStep;
+    UInt32 fill = agc->blockFill;
+    Float32 sumSquares[kEngramMaxChannels];
+    Float32 peak[kEngramMaxChannels];
+    memcpy(sumSquares, agc->blockSumSquares, sizeof(sumSquares));
+    memcpy(peak, agc->blockPeak, sizeof(peak));
+
+    for (UInt32 i = 0; i < frames; i++) {
+        Float32* frame = samples + i * channels;
+        for (UInt32 ch = 0; ch < channels; ch++) {
+            Float32 x = frame[ch];
+            Float32 magnitude = fabsf(x);
+            sumSquares[ch] += x * x;
+            // Not fmaxf, whose NaN rules keep it out of a max instruction
+            peak[ch] = (magnitude > peak[ch]) ? magnitude : peak[ch];
+            frame[ch] = x * gain;
+        }
+        gain += step;
+
+        if (++fill == kEngramAGCBlockFrames) {
+            memcpy(agc->blockSumSquares, sumSquares, sizeof(sumSquares));
+            memcpy(agc->blockPeak, peak, sizeof(peak));
+            EngramAGC_EndBlock(agc, channels);
+            gain = agc->gain;
+            step = agc->gainStep;
+            fill = 0;
+            memset(sumSquares, 0, sizeof(sumSquares));
+            memset(peak, 0, sizeof(peak));
+        }
+    }
+
+    agc->gain = gain;
+    agc->blockFill = fill;
+    memcpy(agc->blockSumSquares, sumSquares, sizeof(sumSquares));
+    memcpy(agc->blockPeak, peak, sizeof(peak));
+}
+
+// MARK: - Processing Chain
+
+void EngramDSPChain_Init(EngramDSPChain* chain, Float64 sampleRate, UInt32 channels, UInt32 enabledStages) {
+    memset(chain, 0, sizeof(EngramDSPChain));
+    chain->sampleRate = sampleRate;
+    chain->channels = channels;
+    chain->enabledStages = enabledStages;
+    chain->kernel = EngramDSPKernel_Select(channels, enabledStages);
+
+    EngramBiquad_MakeHighPass(&chain->dcBlock, sampleRate, kEngramDCBlockCutoffHz, M_SQRT1_2);
+    EngramAGC_Init(&chain->agc, sampleRate);
+    EngramAGC_Reset(&chain->agc);
+}
+
+void EngramDSPChain_Reset(EngramDSPChain* chain) {
+    memset(chain->dcBlockState, 0, sizeof(chain->dcBlockState));
+    EngramAGC_Reset(&chain->agc);
+}
+
+void EngramDSPChain_SetStages(EngramDSPChain* chain, UInt32 enabledStages) {
+    UInt32 added = enabledStages & ~chain->enabledStages;
+    if (added & kEngramDSPStageDCBlock) {
+        memset(chain->dcBlockState, 0, sizeof(chain->dcBlockState));
+    }
+    if (added & kEngramDSPStageAGC) {
+        EngramAGC_Reset(&chain->agc);
+    }
+    chain->enabledStages = enabledStages;
+    chain->kernel = EngramDSPKernel_Select(chain->channels, enabledStages);
+}
+
+void EngramDSPChain_ProcessGeneric(EngramDSPChain* chain, Float32* samples, UInt32 frames) {
+    UInt32 channels = (chain->channels < kEngramMaxChannels) ? chain->channels : kEngramMaxChannels;
+
+    if (chain->enabledStages & kEngramDSPStageDCBlock) {
+        for (UInt32 ch = 0; ch < channels; ch++) {
+            EngramBiquad_Process(&chain->dcBlock, &chain->dcBlockState[ch], samples + ch, frames, chain->channels);
+        }
+    }
+    if ((chain->enabledStages & kEngramDSPStageAGC) && chain->channels <= kEngramMaxChannels) {
+        EngramAGC_Process<0>(chain, samples, frames);
+    }
+}
+
+// MARK: - Specialized Kernels
+
+// Frame-major over a fixed channel count: the per-channel states live in
+// registers and the inner loop has a constant trip count, so the compiler
+// unrolls it and packs the channels into vector lanes. The arithmetic per
+// channel is exactly EngramBiquad_Process's, so results are bit-identical.
+template <UInt32 kChannels>
+static inline void EngramDSPKernel_DCBlock(EngramDSPChain* chain, Float32* samples, UInt32 frames) {
+    const EngramBiquadCoefficients c = chain->dcBlock;
+    Float32 z1[kChannels];
+    Float32 z2[kChannels];
+    for (UInt32 ch = 0; ch < kChannels; ch++) {
+        z1[ch] = chain->dcBlockState[ch].z1;
+        z2[ch] = chain->dcBlockState[ch].z2;
+    }
+
+    for (UInt32 i = 0; i < frames; i++) {
+        Float32* frame = samples + i * kChannels;
+        for (UInt32 ch = 0; ch < kChannels; ch++) {
+            Float32 x = frame[ch];
+            Float32 y = c.b0 * x + z1[ch];
+            z1[ch] = c.b1 * x - c.a1 * y + z2[ch];
+            z2[ch] = c.b2 * x - c.a2 * y;
+            frame[ch] = y;
+        }
+    }
+
+    for (UInt32 ch = 0; ch < kChannels; ch++) {
+        chain->dcBlockState[ch].z1 = EngramDSP_FlushDenormal(z1[ch]);
+        chain->dcBlockState[ch].z2 = EngramDSP_FlushDenormal(z2[ch]);
+    }
+}
+
+template <UInt32 kChannels, UInt32 kStages>
+static void EngramDSPKernel_Process(EngramDSPChain* chain, Float32* samples, UInt32 frames) {
+    if constexpr ((kStages & kEngramDSPStageDCBlock) != 0) {
+        EngramDSPKernel_DCBlock<kChannels>(chain, samples, frames);
+    }
+    if constexpr ((kStages & kEngramDSPStageAGC) != 0) {
+        EngramAGC_Process<kChannels>(chain, samples, frames);
+    }
+}
+
+template <UInt32 kChannels>
+static EngramDSPKernel EngramDSPKernel_ForStages(UInt32 enabledStages) {
+    switch (enabledStages & kEngramDSPStageMask) {
+        case 0:
+            return EngramDSPKernel_Process<kChannels, 0>;
+        case kEngramDSPStageDCBlock:
+            return EngramDSPKernel_Process<kChannels, kEngramDSPStageDCBlock>;
+        case kEngramDSPStageAGC:
+            return EngramDSPKernel_Process<kChannels, kEngramDSPStageAGC>;
+        case kEngramDSPStageDCBlock | kEngramDSPStageAGC:
+            return EngramDSPKernel_Process<kChannels, kEngramDSPStageDCBlock | kEngramDSPStageAGC>;
+        default:
+            return EngramDSPChain_ProcessGeneric;
+    }
+}
+
+EngramDSPKernel EngramDSPKernel_Select(UInt32 channels, UInt32 enabledStages) {
+    // Stages this build doesn't know can only run generically
+    if ((enabledStages & ~kEngramDSPStageMask) != 0) {
+        return EngramDSPChain_ProcessGeneric;
+    }
+
+    switch (channels) {
+        case 1: return EngramDSPKernel_ForStages<1>(enabledStages);
+        case 2: return EngramDSPKernel_ForStages<2>(enabledStages);
+        case 4: return EngramDSPKernel_ForStages<4>(enabledStages);
+        case 8: return EngramDSPKernel_ForStages<8>(enabledStages);
+        default: return EngramDSPChain_ProcessGeneric;
+    }
+}
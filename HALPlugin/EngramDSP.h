@@ -0,0 +1,180 @@
+//
+//  EngramDSP.h
+//  Engram Virtual Audio Device
+//
+//  Processing stages applied to audio on the IO path
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#ifndef EngramDSP_h
+#define EngramDSP_h
+
+#include "EngramTypes.h"
+
+#define kEngramMaxChannels 8
+
+// Recursive state below this magnitude is inaudible (~ -300 dBFS) and is
+// flushed to zero at the end of every block, before it can decay into the
+// denormal range. This keeps stages cheap even where FTZ is unavailable.
+#define kEngramDenormalThreshold 1.0e-15f
+
+#define kEngramDCBlockCutoffHz 10.0
+
+// MARK: - Biquad
+
+typedef struct {
+    Float32 b0, b1, b2;
+    Float32 a1, a2;
+} EngramBiquadCoefficients;
+
+// Transposed direct form II state, one per channel
+typedef struct {
+    Float32 z1, z2;
+} EngramBiquadState;
+
+void EngramBiquad_MakeHighPass(EngramBiquadCoefficients* coefficients, Float64 sampleRate, Float64 cutoffHz, Float64 q);
+void EngramBiquad_MakeLowPass(EngramBiquadCoefficients* coefficients, Float64 sampleRate, Float64 cutoffHz, Float64 q);
+void EngramBiquad_MakeNotch(EngramBiquadCoefficients* coefficients, Float64 sampleRate, Float64 centerHz, Float64 q);
+
+static inline Float32 EngramDSP_FlushDenormal(Float32 value) {
+    return (value < kEngramDenormalThreshold && value > -kEngramDenormalThreshold) ? 0.0f : value;
+}
+
+// Zeroes NaN and infinite samples in place and returns how many there were.
+// One bad client must not poison a mix, or the filter state downstream of it.
+static inline UInt32 EngramDSP_ScrubNonFinite(Float32* samples, UInt32 count) {
+    UInt32 scrubbed = 0;
+    for (UInt32 i = 0; i < count; i++) {
+        Float32 x = samples[i];
+        // False for NaN as well as for +/-inf
+        Boolean finite = (x - x == 0.0f);
+        samples[i] = finite ? x : 0.0f;
+        scrubbed += finite ? 0 : 1;
+    }
+    return scrubbed;
+}
+
+// Processes one channel of an interleaved buffer in place.
+static inline void EngramBiquad_Process(const EngramBiquadCoefficients* c, EngramBiquadState* state,
+                                       Float32* samples, UInt32 frames, UInt32 stride) {
+    Float32 z1 = state->z1;
+    Float32 z2 = state->z2;
+
+    for (UInt32 i = 0; i < frames; i++) {
+        Float32 x = samples[i * stride];
+        Float32 y = c->b0 * x + z1;
+        z1 = c->b1 * x - c->a1 * y + z2;
+        z2 = c->b2 * x - c->a2 * y;
+        samples[i * stride] = y;
+    }
+
+    state->z1 = EngramDSP_FlushDenormal(z1);
+    state->z2 = EngramDSP_FlushDenormal(z2);
+}
+
+// MARK: - Automatic Gain Control
+
+// Brings speech towards kEngramAGCTargetDbfs RMS. Every kEngramAGCBlockFrames,
+// whatever the cycle size, the block just measured sets the gain the next
+// block ramps to. Blocks quieter than the gate are taken as pauses: the level
+// estimate and the gain are frozen, so background noise is never pumped up
+// between words. A suppressor upstream can overrule the gate through
+// EngramDSPChain_SetAGCDecision.
+#define kEngramAGCBlockFrames 256
+#define kEngramAGCTargetDbfs -20.0f
+#define kEngramAGCMaxGainDb 24.0f
+#define kEngramAGCMinGainDb -12.0f
+#define kEngramAGCGateDbfs -50.0f
+// Time constant of the speech level estimate
+#define kEngramAGCLevelSeconds 0.4
+// The gain falls faster than it rises, so a loud talker is caught quickly
+#define kEngramAGCFallDbPerSecond 30.0
+#define kEngramAGCRiseDbPerSecond 6.0
+// A block peaking past this (-1 dBFS) at its gain pulls the next one under it
+#define kEngramAGCPeakCeiling 0.891f
+
+// What the gain computer makes of the blocks it measures
+typedef enum {
+    kEngramAGCDecisionGate = 0,     // the energy gate tells speech from pauses
+    kEngramAGCDecisionHold          // feedback is being suppressed: the level estimate is
+                                    // frozen and the gain pinned at unity or below, so a cut
+                                    // howl is never made up again
+} EngramAGCDecision;
+
+typedef struct {
+    // Fixed by EngramDSPChain_Init
+    Float32 levelCoefficient;   // one block's step of the level estimate
+    Float32 maxFallDb;          // per block
+    Float32 maxRiseDb;
+    Float32 gateMeanSquare;
+
+    UInt32 decision;            // an EngramAGCDecision, applied from the next block on
+    Float32 levelMeanSquare;    // speech level, updated only while voiced
+    Float32 gainDb;             // where the current ramp ends
+    Float32 targetGain;         // the same, linear
+    Float32 gain;               // applied to the next frame
+    Float32 gainStep;           // per frame, over the current block
+    UInt32 blockFill;           // frames measured into the current block
+    // Per channel, so a specialized kernel keeps one lane per channel
+    Float32 blockSumSquares[kEngramMaxChannels];
+    Float32 blockPeak[kEngramMaxChannels];
+} EngramAGCState;
+
+// MARK: - Processing Chain
+
+typedef enum {
+    kEngramDSPStageDCBlock = 1u << 0,
+    kEngramDSPStageAGC = 1u << 1        // after the DC block, so an offset never reads as level
+} EngramDSPStage;
+
+#define kEngramDefaultDSPStages kEngramDSPStageDCBlock
+#define kEngramDSPStageMask (kEngramDSPStageDCBlock | kEngramDSPStageAGC)
+
+struct EngramDSPChain;
+
+// Processes an interleaved Float32 buffer in place; picked per chain
+typedef void (*EngramDSPKernel)(struct EngramDSPChain* chain, Float32* samples, UInt32 frames);
+
+typedef struct EngramDSPChain {
+    UInt32 enabledStages;
+    UInt32 channels;
+    Float64 sampleRate;
+    EngramDSPKernel kernel;     // chosen by Init from channels and enabledStages
+
+    EngramBiquadCoefficients dcBlock;
+    EngramBiquadState dcBlockState[kEngramMaxChannels];
+
+    EngramAGCState agc;
+} EngramDSPChain;
+
+// Configures the chain and selects its kernel. Changing channels means
+// calling Init again.
+void EngramDSPChain_Init(EngramDSPChain* chain, Float64 sampleRate, UInt32 channels, UInt32 enabledStages);
+void EngramDSPChain_Reset(EngramDSPChain* chain);
+// Switches stages without disturbing the ones that stay on; a stage turned on
+// starts from its reset state. Only on the thread that runs the chain.
+void EngramDSPChain_SetStages(EngramDSPChain* chain, UInt32 enabledStages);
+
+// Overrules the AGC's energy gate until changed; the chain starts at
+// kEngramAGCDecisionGate. Only on the thread that runs the chain.
+static inline void EngramDSPChain_SetAGCDecision(EngramDSPChain* chain, EngramAGCDecision decision) {
+    chain->agc.decision = decision;
+}
+
+// Runs every enabled stage over an interleaved buffer in place. Real-time safe.
+static inline void EngramDSPChain_Process(EngramDSPChain* chain, Float32* samples, UInt32 frames) {
+    chain->kernel(chain, samples, frames);
+}
+
+// The runtime-looped reference every specialized kernel must match bit for bit.
+void EngramDSPChain_ProcessGeneric(EngramDSPChain* chain, Float32* samples, UInt32 frames);
+
+// MARK: - Specialized Kernels
+
+// The instantiation for this channel count and stage mask, with the channel
+// loop and stage branches resolved at compile time, or the generic kernel if
+// there is none. Channel counts 1, 2, 4 and 8 are specialized.
+EngramDSPKernel EngramDSPKernel_Select(UInt32 channels, UInt32 enabledStages);
+
+#endif /* EngramDSP_h */
@@ -0,0 +1,82 @@
+//
+//  EngramDenormal.h
+//  Engram Virtual Audio Device
+//
+//  Flush-to-zero / denormals-are-zero control for real-time code
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#ifndef EngramDenormal_h
+#define EngramDenormal_h
+
+#include "EngramTypes.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <xmmintrin.h>
+#endif
+
+// MARK: - Floating-Point Control
+//
+// x86: MXCSR FTZ (bit 15) and DAZ (bit 6).
+// arm64: FPCR FZ (bit 24), which flushes both inputs and results.
+// Other targets compile to no-ops; recursive stages still flush their own
+// state (see EngramDSP.h), so they stay safe without hardware help.
+
+#if defined(__x86_64__) || defined(__i386__)
+#define kEngramDenormalControlBits 0x8040u
+#elif defined(__aarch64__)
+#define kEngramDenormalControlBits (1ull << 24)
+#else
+#define kEngramDenormalControlBits 0u
+#endif
+
+static inline UInt64 EngramDenormal_GetControl(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return _mm_getcsr();
+#elif defined(__aarch64__)
+    UInt64 fpcr;
+    __asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr));
+    return fpcr;
+#else
+    return 0;
+#endif
+}
+
+static inline void EngramDenormal_SetControl(UInt64 control) {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_setcsr((unsigned int)control);
+#elif defined(__aarch64__)
+    __asm__ __volatile__("msr fpcr, %0" : : "r"(control));
+#else
+    (void)control;
+#endif
+}
+
+// Enables flush-to-zero and returns the previous control word for Restore.
+// Writing the control register is not free, so it is skipped when the bits
+// are already set (the common case once the host thread has been through here).
+static inline UInt64 EngramDenormal_Enable(void) {
+    UInt64 previous = EngramDenormal_GetControl();
+    if ((previous & kEngramDenormalControlBits) != kEngramDenormalControlBits) {
+        EngramDenormal_SetControl(previous | kEngramDenormalControlBits);
+    }
+    return previous;
+}
+
+static inline void EngramDenormal_Restore(UInt64 previous) {
+    if ((previous & kEngramDenormalControlBits) != kEngramDenormalControlBits) {
+        EngramDenormal_SetControl(previous);
+    }
+}
+
+// Scoped FTZ/DAZ for the duration of a callback.
+struct EngramDenormalScope {
+    UInt64 previous;
+    EngramDenormalScope() : previous(EngramDenormal_Enable()) {}
+    ~EngramDenormalScope() { EngramDenormal_Restore(previous); }
+};
+
+#define ENGRAM_DENORMAL_GUARD() EngramDenormalScope engramDenormalScope
+
+#endif /* EngramDenormal_h */
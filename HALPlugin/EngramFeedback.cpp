@@ -0,0 +1,334 @@
+//
+//  EngramFeedback.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramFeedback.h"
+#include "EngramSIMD.h"
+#include <math.h>
+#include <string.h>
+
+// A full-scale sine through the Hann window peaks at N/4: 20 log10(1024 / 4)
+#define kEngramFeedbackFullScaleDb 48.1648f
+
+size_t EngramFeedback_RequiredBytes(void) {
+    return EngramArena_AlignedSize(sizeof(EngramFeedbackDetector)) +
+           6 * EngramArena_AlignedSize(sizeof(Float32) * kEngramFeedbackFFTSize);
+}
+
+EngramFeedbackDetector* EngramFeedback_Create(EngramArena* arena, Float64 sampleRate, UInt32 channels) {
+    if (channels == 0 || channels > kEngramMaxChannels) {
+        return NULL;
+    }
+
+    EngramFeedbackDetector* detector = ENGRAM_ARENA_NEW_ARRAY(arena, EngramFeedbackDetector, 1);
+    if (detector == NULL) {
+        return NULL;
+    }
+    detector->window = ENGRAM_ARENA_NEW_ARRAY(arena, Float32, kEngramFeedbackFFTSize);
+    detector->analysis = ENGRAM_ARENA_NEW_ARRAY(arena, Float32, kEngramFeedbackFFTSize);
+    detector->re = ENGRAM_ARENA_NEW_ARRAY(arena, Float32, kEngramFeedbackFFTSize);
+    detector->im = ENGRAM_ARENA_NEW_ARRAY(arena, Float32, kEngramFeedbackFFTSize);
+    detector->twiddleRe = ENGRAM_ARENA_NEW_ARRAY(arena, Float32, kEngramFeedbackFFTSize);
+    detector->twiddleIm = ENGRAM_ARENA_NEW_ARRAY(arena, Float32, kEngramFeedbackFFTSize);
+    if (detector->window == NULL || detector->analysis == NULL || detector->re == NULL || detector->im == NULL ||
+        detector->twiddleRe == NULL || detector->twiddleIm == NULL) {
+        return NULL;
+    }
+
+    detector->sampleRate = sampleRate;
+    detector->channels = channels;
+    for (UInt32 i = 0; i < kEngramFeedbackFFTSize; i++) {
+        detector->window[i] = (Float32)(0.5 - 0.5 * cos(2.0 * M_PI * i / kEngramFeedbackFFTSize));
+    }
+    // Laid out pass by pass, so the butterfly kernel reads them contiguously
+    for (UInt32 half = 1; half < kEngramFeedbackFFTSize; half <<= 1) {
+        for (UInt32 k = 0; k < half; k++) {
+            detector->twiddleRe[half - 1 + k] = (Float32)cos(M_PI * k / half);
+            detector->twiddleIm[half - 1 + k] = (Float32)-sin(M_PI * k / half);
+        }
+    }
+
+    detector->enabled.store(true, std::memory_order_relaxed);
+    detector->events.store(0, std::memory_order_relaxed);
+    EngramFeedback_Reset(detector);
+    return detector;
+}
+
+void EngramFeedback_Reset(EngramFeedbackDetector* detector) {
+    detector->analysisFill = 0;
+    detector->quietFrames = 0;
+    detector->gain = 1.0f;
+    detector->targetGain = 1.0f;
+    detector->candidateCount = 0;
+    detector->notchCount = 0;
+    memset(detector->notchQuietFrames, 0, sizeof(detector->notchQuietFrames));
+    memset(detector->notchStates, 0, sizeof(detector->notchStates));
+    detector->activeNotches.store(0, std::memory_order_relaxed);
+    detector->gainCut.store(false, std::memory_order_relaxed);
+}
+
+// MARK: - Analysis
+
+// In-place iterative radix-2 FFT over kEngramFeedbackFFTSize points.
+static void EngramFeedback_FFT(const EngramFeedbackDetector* detector, Float32* re, Float32* im) {
+    const UInt32 n = kEngramFeedbackFFTSize;
+    const EngramSIMDKernels* simd = EngramSIMD_Kernels();
+
+    for (UInt32 i = 1, j = 0; i < n; i++) {
+        UInt32 bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j |= bit;
+        if (i < j) {
+            Float32 t = re[i];
+            re[i] = re[j];
+            re[j] = t;
+            t = im[i];
+            im[i] = im[j];
+            im[j] = t;
+        }
+    }
+
+    for (UInt32 half = 1; half < n; half <<= 1) {
+        simd->fftButterflies(re, im, detector->twiddleRe + half - 1, detector->twiddleIm + half - 1, n, half);
+    }
+}
+
+static inline Float32 EngramFeedback_PowerToDbfs(Float32 power) {
+    return 10.0f * log10f(power + 1.0e-30f) - kEngramFeedbackFullScaleDb;
+}
+
+// Fills up to `maxPeaks` of the strongest qualifying peaks, strongest first,
+// and leaves the power spectrum in detector->re.
+static UInt32 EngramFeedback_Analyse(EngramFeedbackDetector* detector, const Float32* mono,
+                                     UInt32* outBins, Float32* outDb, UInt32 maxPeaks) {
+    const UInt32 bins = kEngramFeedbackFFTSize / 2;
+    Float32* re = detector->re;
+    Float32* im = detector->im;
+
+    for (UInt32 i = 0; i < kEngramFeedbackFFTSize; i++) {
+        re[i] = mono[i] * detector->window[i];
+        im[i] = 0.0f;
+    }
+    EngramFeedback_FFT(detector, re, im);
+
+    // Bins 0 and 1 hold DC and the window's spread of it
+    Float32 total = 0.0f;
+    for (UInt32 k = 0; k < bins; k++) {
+        re[k] = re[k] * re[k] + im[k] * im[k];
+        total += (k >= 2) ? re[k] : 0.0f;
+    }
+    Float32 mean = total / (Float32)(bins - 2);
+    Float32 threshold = mean * powf(10.0f, kEngramFeedbackPeakRatioDb / 10.0f);
+    Float32 floorPower = powf(10.0f, (kEngramFeedbackFloorDbfs + kEngramFeedbackFullScaleDb) / 10.0f);
+    threshold = (threshold > floorPower) ? threshold : floorPower;
+
+    UInt32 count = 0;
+    Float32 powers[kEngramFeedbackMaxCandidates];
+    for (UInt32 k = 2; k + 1 < bins; k++) {
+        Float32 p = re[k];
+        if (p <= threshold || p <= re[k - 1] || p < re[k + 1]) {
+            continue;
+        }
+        // Insertion into the strongest-first list
+        UInt32 at = count;
+        while (at > 0 && powers[at - 1] < p) {
+            at--;
+        }
+        if (at >= maxPeaks) {
+            continue;
+        }
+        UInt32 last = (count < maxPeaks) ? count : maxPeaks - 1;
+        for (UInt32 i = last; i > at; i--) {
+            powers[i] = powers[i - 1];
+            outBins[i] = outBins[i - 1];
+        }
+        powers[at] = p;
+        outBins[at] = k;
+        count = (count < maxPeaks) ? count + 1 : count;
+    }
+
+    for (UInt32 i = 0; i < count; i++) {
+        outDb[i] = EngramFeedback_PowerToDbfs(powers[i]);
+    }
+    return count;
+}
+
+Boolean EngramFeedback_FindPeak(EngramFeedbackDetector* detector, const Float32* mono, UInt32* outBin, Float32* outDb) {
+    return EngramFeedback_Analyse(detector, mono, outBin, outDb, 1) == 1;
+}
+
+// Where between its neighbours the peak really is, from the log magnitudes
+static Float32 EngramFeedback_PeakHz(const EngramFeedbackDetector* detector, UInt32 bin) {
+    const Float32* power = detector->re;
+    Float32 left = log10f(power[bin - 1] + 1.0e-30f);
+    Float32 centre = log10f(power[bin] + 1.0e-30f);
+    Float32 right = log10f(power[bin + 1] + 1.0e-30f);
+    Float32 curvature = left - 2.0f * centre + right;
+    Float32 offset = (curvature < 0.0f) ? 0.5f * (left - right) / curvature : 0.0f;
+    return ((Float32)bin + offset) * (Float32)(detector->sampleRate / kEngramFeedbackFFTSize);
+}
+
+// The notch within a bin of `hz`, or notchCount if there is none
+static UInt32 EngramFeedback_NotchNear(const EngramFeedbackDetector* detector, Float32 hz) {
+    Float32 binHz = (Float32)(detector->sampleRate / kEngramFeedbackFFTSize);
+    for (UInt32 n = 0; n < detector->notchCount; n++) {
+        if (fabsf(detector->notchHz[n] - hz) <= binHz) {
+            return n;
+        }
+    }
+    return detector->notchCount;
+}
+
+// A howl at `hz`: notch it, or if it is already notched or there are no
+// notches left, turn everything down.
+static void EngramFeedback_Engage(EngramFeedbackDetector* detector, Float32 hz) {
+    Float32 binHz = (Float32)(detector->sampleRate / kEngramFeedbackFFTSize);
+    Boolean notched = (EngramFeedback_NotchNear(detector, hz) < detector->notchCount);
+
+    if (!notched && detector->notchCount < kEngramFeedbackMaxNotches) {
+        UInt32 n = detector->notchCount;
+        // At least a bin wide, so the estimate's error stays inside the notch
+        Float64 q = (hz / binHz < kEngramFeedbackNotchQ) ? hz / binHz : kEngramFeedbackNotchQ;
+        EngramBiquad_MakeNotch(&detector->notches[n], detector->sampleRate, hz, q);
+        memset(detector->notchStates[n], 0, sizeof(detector->notchStates[n]));
+        detector->notchHz[n] = hz;
+        detector->notchQuietFrames[n] = 0;
+        detector->notchCount = n + 1;
+        detector->activeNotches.store(detector->notchCount, std::memory_order_relaxed);
+    } else {
+        detector->targetGain = kEngramFeedbackCutGain;
+        detector->gainCut.store(true, std::memory_order_relaxed);
+    }
+    detector->events.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Holds every notch something still rings near, and lets go of those that
+// have been quiet long enough. A released notch is dropped outright: by then
+// it has only been cutting a sliver out of ordinary program.
+static void EngramFeedback_HoldNotches(EngramFeedbackDetector* detector, const UInt32* bins, UInt32 peaks) {
+    if (detector->notchCount == 0) {
+        return;
+    }
+    for (UInt32 n = 0; n < detector->notchCount; n++) {
+        detector->notchQuietFrames[n]++;
+    }
+    for (UInt32 p = 0; p < peaks; p++) {
+        UInt32 n = EngramFeedback_NotchNear(detector, EngramFeedback_PeakHz(detector, bins[p]));
+        if (n < detector->notchCount) {
+            detector->notchQuietFrames[n] = 0;
+        }
+    }
+
+    UInt32 n = 0;
+    while (n < detector->notchCount) {
+        if (detector->notchQuietFrames[n] < kEngramFeedbackNotchReleaseFrames) {
+            n++;
+            continue;
+        }
+        // The filters are in series, so order doesn't matter: the last fills the gap
+        UInt32 last = detector->notchCount - 1;
+        detector->notches[n] = detector->notches[last];
+        detector->notchHz[n] = detector->notchHz[last];
+        detector->notchQuietFrames[n] = detector->notchQuietFrames[last];
+        memcpy(detector->notchStates[n], detector->notchStates[last], sizeof(detector->notchStates[n]));
+        detector->notchCount = last;
+    }
+    detector->activeNotches.store(detector->notchCount, std::memory_order_relaxed);
+}
+
+// One full analysis buffer: follows peaks from the previous frame and acts
+// on any that have become feedback. Returns the howls found.
+static UInt32 EngramFeedback_AnalyseFrame(EngramFeedbackDetector* detector) {
+    UInt32 bins[kEngramFeedbackMaxCandidates];
+    Float32 levels[kEngramFeedbackMaxCandidates];
+    UInt32 peaks = EngramFeedback_Analyse(detector, detector->analysis, bins, levels, kEngramFeedbackMaxCandidates);
+    EngramFeedback_HoldNotches(detector, bins, peaks);
+
+    EngramFeedbackCandidate next[kEngramFeedbackMaxCandidates];
+    UInt32 found = 0;
+    for (UInt32 p = 0; p < peaks; p++) {
+        EngramFeedbackCandidate candidate = { bins[p], 1, levels[p], levels[p] };
+        for (UInt32 c = 0; c < detector->candidateCount; c++) {
+            const EngramFeedbackCandidate* previous = &detector->candidates[c];
+            UInt32 distance = (previous->bin > bins[p]) ? previous->bin - bins[p] : bins[p] - previous->bin;
+            if (distance > 1 || previous->frames == 0) {
+                continue;
+            }
+            if (levels[p] >= previous->lastDb - kEngramFeedbackMaxDropDb) {
+                candidate.frames = previous->frames + 1;
+                candidate.baselineDb = (candidate.frames == 2) ? levels[p] : previous->baselineDb;
+            }
+            detector->candidates[c].frames = 0;
+            break;
+        }
+
+        if (candidate.frames >= kEngramFeedbackHoldFrames &&
+            (candidate.lastDb - candidate.baselineDb >= kEngramFeedbackGrowthDb ||
+             candidate.lastDb >= kEngramFeedbackHotDbfs)) {
+            EngramFeedback_Engage(detector, EngramFeedback_PeakHz(detector, candidate.bin));
+            found++;
+            // Judged afresh from here, through whatever was just engaged
+            candidate.frames = 1;
+            candidate.baselineDb = candidate.lastDb;
+        }
+        next[p] = candidate;
+    }
+
+    memcpy(detector->candidates, next, sizeof(EngramFeedbackCandidate) * peaks);
+    detector->candidateCount = peaks;
+
+    detector->quietFrames = (found > 0) ? 0 : detector->quietFrames + 1;
+    if (detector->quietFrames >= kEngramFeedbackReleaseFrames) {
+        detector->targetGain = 1.0f;
+    }
+    return found;
+}
+
+// MARK: - Processing
+
+UInt32 EngramFeedback_Process(EngramFeedbackDetector* detector, Float32* samples, UInt32 frames) {
+    if (!detector->enabled.load(std::memory_order_relaxed)) {
+        return 0;
+    }
+
+    const EngramSIMDKernels* simd = EngramSIMD_Kernels();
+    UInt32 channels = detector->channels;
+    for (UInt32 n = 0; n < detector->notchCount; n++) {
+        simd->biquad(&detector->notches[n], detector->notchStates[n], samples, frames, channels);
+    }
+
+    if (detector->gain != detector->targetGain) {
+        Float32 step = (frames >= kEngramFeedbackRampFrames) ? 1.0f : (Float32)frames / kEngramFeedbackRampFrames;
+        Float32 end = detector->gain + (detector->targetGain - detector->gain) * step;
+        end = (fabsf(end - detector->targetGain) < 1.0e-3f) ? detector->targetGain : end;
+        simd->gainRamp(samples, frames, channels, detector->gain, end);
+        detector->gain = end;
+        if (end == 1.0f) {
+            detector->gainCut.store(false, std::memory_order_relaxed);
+        }
+    } else if (detector->gain != 1.0f) {
+        simd->gainRamp(samples, frames, channels, detector->gain, detector->gain);
+    }
+
+    // Analysed after suppression, so an engaged notch stops its own howl
+    UInt32 found = 0;
+    Float32 scale = 1.0f / (Float32)channels;
+    for (UInt32 frame = 0; frame < frames; frame++) {
+        Float32 sum = 0.0f;
+        for (UInt32 ch = 0; ch < channels; ch++) {
+            sum += samples[frame * channels + ch];
+        }
+        detector->analysis[detector->analysisFill++] = sum * scale;
+        if (detector->analysisFill == kEngramFeedbackFFTSize) {
+            found += EngramFeedback_AnalyseFrame(detector);
+            detector->analysisFill = 0;
+        }
+    }
+    return found;
+}
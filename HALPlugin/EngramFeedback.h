@@ -0,0 +1,117 @@
+//
+//  EngramFeedback.h
+//  Engram Virtual Audio Device
+//
+//  Howl detection and suppression on the input path. Every
+//  kEngramFeedbackFFTSize frames the input is analysed for narrow peaks
+//  standing well clear of the rest of the spectrum; one that persists and
+//  keeps growing, or sits just below full scale, is feedback. Each one found
+//  gets a notch filter, held for as long as anything still rings near it;
+//  once the notches run out the whole input is turned down until the howl
+//  has been gone a while.
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#ifndef EngramFeedback_h
+#define EngramFeedback_h
+
+#include "EngramArena.h"
+#include "EngramDSP.h"
+#include <atomic>
+
+// 21 ms at 48 kHz, so bins are ~47 Hz apart
+#define kEngramFeedbackFFTSize 1024
+#define kEngramFeedbackFFTLog2 10
+#define kEngramFeedbackMaxNotches 4
+// Peaks followed from one analysis frame to the next
+#define kEngramFeedbackMaxCandidates 8
+
+// A peak must stand this far above the spectrum's mean power
+#define kEngramFeedbackPeakRatioDb 20.0f
+// and be louder than this to be considered at all
+#define kEngramFeedbackFloorDbfs -60.0f
+// It is feedback once tracked for this many frames (~170 ms) while growing
+// by kEngramFeedbackGrowthDb, or while sitting at kEngramFeedbackHotDbfs
+#define kEngramFeedbackHoldFrames 8
+#define kEngramFeedbackGrowthDb 6.0f
+#define kEngramFeedbackHotDbfs -3.0f
+// Dropping more than this between frames starts the track over
+#define kEngramFeedbackMaxDropDb 3.0f
+
+#define kEngramFeedbackNotchQ 20.0
+// A notch with no peak near it for this many frames (~10 s) is let go,
+// freeing it for the next howl
+#define kEngramFeedbackNotchReleaseFrames 470
+
+// Gain cut once every notch is in use, held until no howl for ~2 s
+#define kEngramFeedbackCutGain 0.25f
+#define kEngramFeedbackReleaseFrames 94
+// Gain changes are ramped over at least this many frames
+#define kEngramFeedbackRampFrames 480
+
+typedef struct {
+    UInt32 bin;
+    UInt32 frames;          // consecutive analysis frames this peak was seen
+    Float32 baselineDb;     // level in its second frame; the first may be an onset
+    Float32 lastDb;
+} EngramFeedbackCandidate;
+
+typedef struct {
+    Float64 sampleRate;
+    UInt32 channels;
+
+    // Arena storage, set up by Create
+    Float32* window;        // Hann
+    Float32* twiddleRe;     // every pass's twiddles, the pass of half h at h - 1
+    Float32* twiddleIm;
+    Float32* analysis;      // mono input, filled to kEngramFeedbackFFTSize
+    Float32* re;
+    Float32* im;
+
+    // Owned by the IO thread
+    UInt32 analysisFill;
+    UInt32 quietFrames;     // analysis frames since the last howl
+    Float32 gain;
+    Float32 targetGain;
+    UInt32 candidateCount;
+    EngramFeedbackCandidate candidates[kEngramFeedbackMaxCandidates];
+
+    UInt32 notchCount;
+    Float32 notchHz[kEngramFeedbackMaxNotches];
+    UInt32 notchQuietFrames[kEngramFeedbackMaxNotches];  // analysis frames with no peak near it
+    EngramBiquadCoefficients notches[kEngramFeedbackMaxNotches];
+    EngramBiquadState notchStates[kEngramFeedbackMaxNotches][kEngramMaxChannels];
+
+    // Read by anyone
+    std::atomic<Boolean> enabled;
+    std::atomic<UInt64> events;         // howls found: notches engaged plus gain cuts
+    std::atomic<UInt32> activeNotches;
+    std::atomic<Boolean> gainCut;
+} EngramFeedbackDetector;
+
+size_t EngramFeedback_RequiredBytes(void);
+// Enabled from the start. NULL for an unsupported channel count or a short arena.
+EngramFeedbackDetector* EngramFeedback_Create(EngramArena* arena, Float64 sampleRate, UInt32 channels);
+// Drops every notch and the gain cut; the first StartIO begins afresh.
+void EngramFeedback_Reset(EngramFeedbackDetector* detector);
+
+// Suppresses what has been found so far in place, then analyses the result.
+// Real-time safe; an analysis frame costs one 1024-point FFT, its passes
+// run through the EngramSIMD butterfly kernel. Returns the
+// number of howls newly found in this block.
+UInt32 EngramFeedback_Process(EngramFeedbackDetector* detector, Float32* samples, UInt32 frames);
+
+// Whether a notch or the gain cut is in, so nothing downstream may turn the
+// input back up. Read from the IO thread after Process.
+static inline Boolean EngramFeedback_IsSuppressing(const EngramFeedbackDetector* detector) {
+    return detector->gainCut.load(std::memory_order_relaxed) ||
+           detector->activeNotches.load(std::memory_order_relaxed) != 0;
+}
+
+// The analysis, exposed for tests: the strongest peak kEngramFeedbackFFTSize
+// mono samples hold, as a bin index and level in dBFS. Returns false when no
+// peak clears the ratio and floor.
+Boolean EngramFeedback_FindPeak(EngramFeedbackDetector* detector, const Float32* mono, UInt32* outBin, Float32* outDb);
+
+#endif /* EngramFeedback_h */
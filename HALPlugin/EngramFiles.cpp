@@ -0,0 +1,95 @@
+//
+//  EngramFiles.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramFiles.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// MARK: - Paths
+
+Boolean EngramFiles_DiagnosticsDirectory(char* outPath, size_t pathSize) {
+    const char* configured = getenv(kEngramDiagnosticsDirectoryEnvironment);
+    if (configured != NULL && configured[0] != '\0') {
+        return (size_t)snprintf(outPath, pathSize, "%s", configured) < pathSize;
+    }
+
+    // Per user, so a directory some other user created first is never ours
+    const char* base = getenv("TMPDIR");
+    if (base == NULL || base[0] != '/') {
+        base = "/tmp";
+    }
+    size_t baseLength = strlen(base);
+    while (baseLength > 1 && base[baseLength - 1] == '/') {
+        baseLength--;
+    }
+    int length = snprintf(outPath, pathSize, "%.*s/%s.%u", (int)baseLength, base,
+                          kEngramDiagnosticsDirectoryPrefix, (unsigned)geteuid());
+    return length > 0 && (size_t)length < pathSize;
+}
+
+Boolean EngramFiles_Join(char* outPath, size_t pathSize, const char* directory, const char* name) {
+    int length = snprintf(outPath, pathSize, "%s/%s", directory, name);
+    return length > 0 && (size_t)length < pathSize;
+}
+
+// MARK: - Private Files
+
+Boolean EngramFiles_MakePrivateDirectory(const char* path) {
+    if (mkdir(path, 0700) != 0 && errno != EEXIST) {
+        return false;
+    }
+
+    struct stat info;
+    if (lstat(path, &info) != 0) {
+        return false;
+    }
+    if (!S_ISDIR(info.st_mode) || info.st_uid != geteuid() || (info.st_mode & 077) != 0) {
+        errno = EPERM;
+        return false;
+    }
+    return true;
+}
+
+FILE* EngramFiles_CreatePrivate(const char* path) {
+    int fd = open(path, O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        return NULL;
+    }
+    FILE* file = fdopen(fd, "wb");
+    if (file == NULL) {
+        close(fd);
+        unlink(path);
+    }
+    return file;
+}
+
+FILE* EngramFiles_AppendPrivate(const char* path) {
+    int fd = open(path, O_WRONLY | O_APPEND | O_CREAT | O_NOFOLLOW | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    // Another user's file, or a hard link to somebody's file, is not ours to extend
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_uid != geteuid() ||
+        info.st_nlink != 1 || (info.st_mode & 077) != 0) {
+        close(fd);
+        errno = EPERM;
+        return NULL;
+    }
+
+    FILE* file = fdopen(fd, "ab");
+    if (file == NULL) {
+        close(fd);
+    }
+    return file;
+}
@@ -0,0 +1,52 @@
+//
+//  EngramFiles.h
+//  Engram Virtual Audio Device
+//
+//  Where diagnostics (traces, glitch snapshots, latency logs) go on disk, and
+//  how they are opened. The plugin runs inside coreaudiod and writes audio
+//  from the microphone, so nothing it writes may land in a directory another
+//  user controls, follow a symlink someone planted, or be readable by others.
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#ifndef EngramFiles_h
+#define EngramFiles_h
+
+#include "EngramTypes.h"
+#include <stddef.h>
+#include <stdio.h>
+
+// Overrides the diagnostics directory; tests point it at a temporary one
+#define kEngramDiagnosticsDirectoryEnvironment "ENGRAM_HAL_DIAGNOSTICS_DIR"
+// Otherwise: "<$TMPDIR or /tmp>/engram-hal.<uid>"
+#define kEngramDiagnosticsDirectoryPrefix "engram-hal"
+#define kEngramMaxPathLength 1024
+
+// MARK: - Paths
+
+// The directory this process writes diagnostics into. Only resolves the
+// name; EngramFiles_MakePrivateDirectory creates it.
+Boolean EngramFiles_DiagnosticsDirectory(char* outPath, size_t pathSize);
+// "<directory>/<name>"; false if it does not fit.
+Boolean EngramFiles_Join(char* outPath, size_t pathSize, const char* directory, const char* name);
+
+// MARK: - Private Files
+//
+// None of these are real-time safe.
+
+// Creates `path` with mode 0700 if it is missing, then checks that it is a
+// directory (not a symlink to one), owned by this user and closed to everyone
+// else. An existing path that fails the check is left alone.
+Boolean EngramFiles_MakePrivateDirectory(const char* path);
+
+// Creates a new file only this user can read (O_CREAT | O_EXCL | O_NOFOLLOW,
+// mode 0600). Fails if anything, symlinks included, already has the name.
+FILE* EngramFiles_CreatePrivate(const char* path);
+
+// Opens `path` for appending, creating it like EngramFiles_CreatePrivate if
+// it is missing. An existing file must be a regular file owned by this user,
+// with no other links and no group or world access.
+FILE* EngramFiles_AppendPrivate(const char* path);
+
+#endif /* EngramFiles_h */
@@ -0,0 +1,115 @@
+//
+//  EngramGate.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramGate.h"
+#include "EngramWait.h"
+#include <stddef.h>
+
+void EngramGate_Init(EngramGate* gate) {
+    gate->clients.store(0, std::memory_order_relaxed);
+    gate->activations.store(0, std::memory_order_relaxed);
+}
+
+// MARK: - Plugin Side
+
+void EngramGate_Started(EngramGate* gate) {
+    if (gate->clients.fetch_add(1, std::memory_order_acq_rel) == 0) {
+        gate->activations.fetch_add(1, std::memory_order_release);
+        EngramWait_WakeAll(&gate->clients);
+    }
+}
+
+void EngramGate_Stopped(EngramGate* gate) {
+    gate->clients.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void EngramGate_Close(EngramGate* gate) {
+    gate->clients.fetch_or(kEngramGateClosed, std::memory_order_acq_rel);
+    EngramWait_WakeAll(&gate->clients);
+}
+
+// MARK: - Waiting
+
+Boolean EngramGate_WaitForIO(const std::atomic<UInt32>* clients, UInt64 timeoutNanos) {
+    UInt64 deadline = (timeoutNanos != 0) ? EngramWait_Now() + timeoutNanos : 0;
+    for (;;) {
+        UInt32 value = clients->load(std::memory_order_acquire);
+        if ((value & kEngramGateClosed) != 0) {
+            return false;
+        }
+        if (value != 0) {
+            return true;
+        }
+
+        UInt64 remaining = 0;
+        if (deadline != 0) {
+            UInt64 now = EngramWait_Now();
+            if (now >= deadline) {
+                return false;
+            }
+            remaining = deadline - now;
+        }
+        EngramWait_WhileEqual(clients, 0, remaining);
+    }
+}
+
+// MARK: - Low Water
+
+void EngramLowWater_Init(EngramLowWater* lowWater, std::atomic<UInt32>* sequenceMirror, std::atomic<UInt32>* framesMirror) {
+    lowWater->sequence.store(0, std::memory_order_relaxed);
+    lowWater->armed.store(kEngramLowWaterDisarmed, std::memory_order_relaxed);
+    lowWater->frames.store(0, std::memory_order_relaxed);
+    lowWater->sequenceMirror = sequenceMirror;
+    lowWater->framesMirror = framesMirror;
+    if (sequenceMirror != NULL) {
+        sequenceMirror->store(0, std::memory_order_relaxed);
+    }
+}
+
+UInt32 EngramLowWater_Arm(EngramLowWater* lowWater, EngramLowWaterArm arm, UInt32 thresholdFrames) {
+    UInt32 sequence = lowWater->sequence.load(std::memory_order_acquire);
+    lowWater->frames.store(thresholdFrames, std::memory_order_relaxed);
+    if (lowWater->framesMirror != NULL) {
+        lowWater->framesMirror->store(thresholdFrames, std::memory_order_relaxed);
+    }
+    lowWater->armed.store(arm, std::memory_order_seq_cst);
+    return sequence;
+}
+
+void EngramLowWater_Disarm(EngramLowWater* lowWater) {
+    lowWater->armed.store(kEngramLowWaterDisarmed, std::memory_order_relaxed);
+}
+
+// Moves both copies of the sequence on; returns the word the producer armed with
+static std::atomic<UInt32>* EngramLowWater_Advance(EngramLowWater* lowWater, UInt32 arm) {
+    UInt32 sequence = lowWater->sequence.fetch_add(1, std::memory_order_release) + 1;
+    if (lowWater->sequenceMirror == NULL) {
+        return &lowWater->sequence;
+    }
+    lowWater->sequenceMirror->store(sequence, std::memory_order_release);
+    return (arm == kEngramLowWaterArmedShared) ? lowWater->sequenceMirror : &lowWater->sequence;
+}
+
+Boolean EngramLowWater_Signal(EngramLowWater* lowWater) {
+    // Claim the sleeper so later cycles don't repeat the system call
+    UInt32 arm = lowWater->armed.exchange(kEngramLowWaterDisarmed, std::memory_order_acq_rel);
+    if (arm == kEngramLowWaterDisarmed) {
+        return false;
+    }
+    EngramWait_WakeAll(EngramLowWater_Advance(lowWater, arm));
+    return true;
+}
+
+void EngramLowWater_Release(EngramLowWater* lowWater) {
+    lowWater->armed.store(kEngramLowWaterDisarmed, std::memory_order_relaxed);
+    EngramLowWater_Advance(lowWater, kEngramLowWaterDisarmed);
+    EngramWait_WakeAll(&lowWater->sequence);
+    if (lowWater->sequenceMirror != NULL) {
+        EngramWait_WakeAll(lowWater->sequenceMirror);
+    }
+}
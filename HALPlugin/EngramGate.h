@@ -0,0 +1,103 @@
+//
+//  EngramGate.h
+//  Engram Virtual Audio Device
+//
+//  Producer pacing. The IO gate says whether any client is running IO:
+//  nobody reads the ring while none is, so producers and background work can
+//  stop entirely and sleep on the gate until the first StartIO wakes them.
+//  The low-water mark wakes a producer once the ring runs low, so it tops the
+//  ring up when needed instead of polling. Both are plugin state; the stats
+//  page carries read-only mirrors for producers in other processes.
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#ifndef EngramGate_h
+#define EngramGate_h
+
+#include "EngramTypes.h"
+#include <atomic>
+
+// Set in the clients word as the plugin tears down; it never reopens
+#define kEngramGateClosed 0x80000000u
+
+typedef struct {
+    std::atomic<UInt32> clients;        // clients running IO, plus kEngramGateClosed
+    std::atomic<UInt64> activations;    // idle -> running transitions; each one starts a fresh timeline
+} EngramGate;
+
+// Starts open with no clients.
+void EngramGate_Init(EngramGate* gate);
+
+// MARK: - Plugin Side
+//
+// The count is kept by atomic increments, so concurrent Start/StopIO calls
+// can't leave it out of order. The first start wakes every waiter.
+
+void EngramGate_Started(EngramGate* gate);
+void EngramGate_Stopped(EngramGate* gate);
+// Wakes every waiter for good; called as teardown begins.
+void EngramGate_Close(EngramGate* gate);
+
+// MARK: - Waiting
+//
+// These take the clients word itself, so they work on the stats page's
+// mirror as well as on the gate.
+
+static inline Boolean EngramGate_IsRunning(UInt32 clients) {
+    return clients != 0 && (clients & kEngramGateClosed) == 0;
+}
+
+// Sleeps until a client is running IO (returns true), or until `timeoutNanos`
+// passes (0 waits without limit) or the gate closes (false). Not real-time safe.
+Boolean EngramGate_WaitForIO(const std::atomic<UInt32>* clients, UInt64 timeoutNanos);
+
+// MARK: - Low Water
+//
+// A producer announces a threshold and sleeps; the IO thread wakes it from
+// the read that takes the fill below the threshold. In-process producers arm
+// through EngramDevice_WaitForLowWater and sleep on `sequence`; producers in
+// other processes arm through kEngramPropertyLowWater and sleep on the
+// mirror. The IO thread's part is a claim, a store and, only when a producer
+// is actually asleep and only once per sleep, one non-blocking wake. The
+// announcement and the read are not fenced against each other, so in the
+// rare race the wake comes from the next cycle's read instead.
+
+typedef enum {
+    kEngramLowWaterDisarmed = 0,
+    kEngramLowWaterArmedLocal,      // producer sleeps on sequence
+    kEngramLowWaterArmedShared      // producer sleeps on sequenceMirror
+} EngramLowWaterArm;
+
+typedef struct {
+    std::atomic<UInt32> sequence;   // bumped by every signal and release
+    std::atomic<UInt32> armed;      // EngramLowWaterArm
+    std::atomic<UInt32> frames;     // ring fill below which the armed producer wants waking
+    // Copies in the stats page, kept in step with sequence and frames; may be NULL
+    std::atomic<UInt32>* sequenceMirror;
+    std::atomic<UInt32>* framesMirror;
+} EngramLowWater;
+
+void EngramLowWater_Init(EngramLowWater* lowWater, std::atomic<UInt32>* sequenceMirror, std::atomic<UInt32>* framesMirror);
+
+// Producer side: arm before the final fill check, then sleep on the returned
+// sequence value (the mirror holds the same value).
+UInt32 EngramLowWater_Arm(EngramLowWater* lowWater, EngramLowWaterArm arm, UInt32 thresholdFrames);
+void EngramLowWater_Disarm(EngramLowWater* lowWater);
+
+// IO thread, after each read. A single load while nobody is armed. Returns
+// true when it woke the producer.
+Boolean EngramLowWater_Signal(EngramLowWater* lowWater);
+static inline Boolean EngramLowWater_Check(EngramLowWater* lowWater, UInt32 fillFrames) {
+    if (lowWater->armed.load(std::memory_order_acquire) != kEngramLowWaterDisarmed &&
+        fillFrames < lowWater->frames.load(std::memory_order_relaxed)) {
+        return EngramLowWater_Signal(lowWater);
+    }
+    return false;
+}
+
+// Disarms and wakes a sleeping producer without a signal so it re-checks the
+// gate; the last StopIO and teardown call it.
+void EngramLowWater_Release(EngramLowWater* lowWater);
+
+#endif /* EngramGate_h */
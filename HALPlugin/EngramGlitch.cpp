@@ -0,0 +1,409 @@
+//
+//  EngramGlitch.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramGlitch.h"
+#include "EngramFiles.h"
+#include "EngramLog.h"
+#include "EngramWait.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static size_t EngramGlitch_HistoryBytes(UInt32 channels) {
+    return EngramArena_AlignedSize(sizeof(Float32) * kEngramGlitchHistoryFrames * channels);
+}
+
+static size_t EngramGlitch_SlotAudioBytes(UInt32 channels) {
+    return EngramArena_AlignedSize(sizeof(Float32) * (kEngramGlitchHistoryFrames + kEngramGlitchMaxCycleFrames) * channels);
+}
+
+size_t EngramGlitch_RequiredBytes(UInt32 channels) {
+    return EngramArena_AlignedSize(sizeof(EngramGlitchDetector)) +
+           EngramGlitch_HistoryBytes(channels) +
+           kEngramGlitchSlotCount * EngramGlitch_SlotAudioBytes(channels);
+}
+
+EngramGlitchDetector* EngramGlitch_Create(EngramArena* arena, Float64 sampleRate, UInt32 channels) {
+    if (channels == 0 || channels > kEngramMaxChannels) {
+        return NULL;
+    }
+
+    EngramGlitchDetector* detector = ENGRAM_ARENA_NEW_ARRAY(arena, EngramGlitchDetector, 1);
+    Float32* history = ENGRAM_ARENA_NEW_ARRAY(arena, Float32, kEngramGlitchHistoryFrames * channels);
+    if (detector == NULL || history == NULL) {
+        return NULL;
+    }
+
+    detector->sampleRate = sampleRate;
+    detector->channels = channels;
+    detector->history = history;
+    detector->sequence = 0;
+    detector->droppedSnapshots.store(0, std::memory_order_relaxed);
+    detector->savedSnapshots.store(0, std::memory_order_relaxed);
+
+    for (UInt32 i = 0; i < kEngramGlitchSlotCount; i++) {
+        EngramGlitchSlot* slot = &detector->slots[i];
+        slot->audio = ENGRAM_ARENA_NEW_ARRAY(arena, Float32, (kEngramGlitchHistoryFrames + kEngramGlitchMaxCycleFrames) * channels);
+        if (slot->audio == NULL) {
+            return NULL;
+        }
+        memset(&slot->info, 0, sizeof(slot->info));
+        slot->state.store(kEngramGlitchSlotFree, std::memory_order_relaxed);
+    }
+
+    EngramGlitch_Reset(detector);
+    return detector;
+}
+
+void EngramGlitch_Reset(EngramGlitchDetector* detector) {
+    detector->haveExpected = false;
+    detector->expectedSampleTime = 0.0;
+    detector->hfEnergyMean = 0.0f;
+    detector->warmupCycles = 0;
+    memset(detector->previous, 0, sizeof(detector->previous));
+    memset(detector->history, 0, sizeof(Float32) * kEngramGlitchHistoryFrames * detector->channels);
+    detector->historyWrite = 0;
+    detector->historyFrames = 0;
+}
+
+// MARK: - Detection
+
+static void EngramGlitch_AppendHistory(EngramGlitchDetector* detector, const Float32* samples, UInt32 frames) {
+    UInt32 channels = detector->channels;
+    if (frames > kEngramGlitchHistoryFrames) {
+        samples += (frames - kEngramGlitchHistoryFrames) * channels;
+        frames = kEngramGlitchHistoryFrames;
+    }
+
+    UInt32 firstPart = kEngramGlitchHistoryFrames - detector->historyWrite;
+    if (firstPart > frames) {
+        firstPart = frames;
+    }
+    memcpy(detector->history + detector->historyWrite * channels, samples, sizeof(Float32) * firstPart * channels);
+    memcpy(detector->history, samples + firstPart * channels, sizeof(Float32) * (frames - firstPart) * channels);
+
+    detector->historyWrite = (detector->historyWrite + frames) % kEngramGlitchHistoryFrames;
+    detector->historyFrames = (detector->historyFrames + frames < kEngramGlitchHistoryFrames)
+        ? detector->historyFrames + frames : kEngramGlitchHistoryFrames;
+}
+
+static void EngramGlitch_Capture(EngramGlitchDetector* detector, const EngramGlitchInfo* info, const Float32* samples) {
+    EngramGlitchSlot* slot = NULL;
+    for (UInt32 i = 0; i < kEngramGlitchSlotCount && slot == NULL; i++) {
+        UInt32 expected = kEngramGlitchSlotFree;
+        if (detector->slots[i].state.compare_exchange_strong(expected, kEngramGlitchSlotFilling, std::memory_order_acquire)) {
+            slot = &detector->slots[i];
+        }
+    }
+    if (slot == NULL) {
+        // Writer is behind; the stats counters still record the glitch
+        detector->droppedSnapshots.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    UInt32 channels = detector->channels;
+    slot->info = *info;
+
+    // History oldest-first, then the glitching cycle itself
+    UInt32 historyFrames = detector->historyFrames;
+    UInt32 start = (detector->historyWrite + kEngramGlitchHistoryFrames - historyFrames) % kEngramGlitchHistoryFrames;
+    UInt32 firstPart = kEngramGlitchHistoryFrames - start;
+    if (firstPart > historyFrames) {
+        firstPart = historyFrames;
+    }
+    memcpy(slot->audio, detector->history + start * channels, sizeof(Float32) * firstPart * channels);
+    memcpy(slot->audio + firstPart * channels, detector->history, sizeof(Float32) * (historyFrames - firstPart) * channels);
+    memcpy(slot->audio + historyFrames * channels, samples, sizeof(Float32) * info->capturedFrames * channels);
+
+    slot->info.historyFrames = historyFrames;
+    slot->state.store(kEngramGlitchSlotReady, std::memory_order_release);
+}
+
+UInt32 EngramGlitch_Observe(EngramGlitchDetector* detector, const EngramGlitchCycle* cycle, const Float32* samples) {
+    UInt32 kinds = 0;
+    UInt32 channels = detector->channels;
+    UInt32 frames = cycle->frames;
+
+    if (cycle->missingFrames > 0) {
+        kinds |= kEngramGlitchUnderrun;
+    }
+
+    Float64 expectedSampleTime = detector->expectedSampleTime;
+    if (detector->haveExpected && cycle->sampleTime != expectedSampleTime) {
+        kinds |= kEngramGlitchDiscontinuity;
+    }
+    detector->haveExpected = true;
+    detector->expectedSampleTime = cycle->sampleTime + (Float64)frames;
+
+    // Second difference as a cheap high-pass; a click is a step or spike
+    // whose energy towers over what the program normally carries up there.
+    Float32 energySum = 0.0f;
+    Float32 peakEnergy = 0.0f;
+    UInt32 peakFrame = 0;
+    for (UInt32 channel = 0; channel < channels; channel++) {
+        Float32 previous1 = detector->previous[channel][0];
+        Float32 previous2 = detector->previous[channel][1];
+        const Float32* sample = samples + channel;
+        for (UInt32 frame = 0; frame < frames; frame++, sample += channels) {
+            Float32 highPass = *sample - 2.0f * previous1 + previous2;
+            Float32 energy = highPass * highPass;
+            energySum += energy;
+            if (energy > peakEnergy) {
+                peakEnergy = energy;
+                peakFrame = frame;
+            }
+            previous2 = previous1;
+            previous1 = *sample;
+        }
+        detector->previous[channel][0] = previous1;
+        detector->previous[channel][1] = previous2;
+    }
+
+    Float32 meanEnergy = (frames > 0) ? energySum / (Float32)(frames * channels) : 0.0f;
+    Float32 reference = (detector->hfEnergyMean > kEngramDenormalThreshold) ? detector->hfEnergyMean : kEngramDenormalThreshold;
+    Float32 clickRatio = peakEnergy / reference;
+    if (detector->warmupCycles >= kEngramClickWarmupCycles &&
+        peakEnergy > kEngramClickEnergyFloor && clickRatio > kEngramClickRatio) {
+        kinds |= kEngramGlitchClick;
+    } else {
+        // Clicks stay out of the baseline so a burst cannot mask the next one
+        detector->hfEnergyMean = EngramDSP_FlushDenormal(detector->hfEnergyMean + 0.05f * (meanEnergy - detector->hfEnergyMean));
+    }
+    if (detector->warmupCycles < kEngramClickWarmupCycles) {
+        detector->warmupCycles++;
+    }
+
+    if (kinds != 0) {
+        EngramGlitchInfo info;
+        info.sequence = ++detector->sequence;
+        info.kinds = kinds;
+        info.channels = channels;
+        info.sampleRate = detector->sampleRate;
+        info.cycle = *cycle;
+        info.expectedSampleTime = expectedSampleTime;
+        info.historyFrames = 0;
+        info.capturedFrames = (frames < kEngramGlitchMaxCycleFrames) ? frames : kEngramGlitchMaxCycleFrames;
+        info.clickFrame = peakFrame;
+        info.clickRatio = clickRatio;
+        EngramGlitch_Capture(detector, &info, samples);
+    }
+
+    EngramGlitch_AppendHistory(detector, samples, frames);
+    return kinds;
+}
+
+// MARK: - Persistence
+
+static void EngramGlitch_WriteUInt32(FILE* file, UInt32 value) {
+    UInt8 bytes[4] = { (UInt8)value, (UInt8)(value >> 8), (UInt8)(value >> 16), (UInt8)(value >> 24) };
+    fwrite(bytes, 1, sizeof(bytes), file);
+}
+
+static void EngramGlitch_WriteUInt16(FILE* file, UInt16 value) {
+    UInt8 bytes[2] = { (UInt8)value, (UInt8)(value >> 8) };
+    fwrite(bytes, 1, sizeof(bytes), file);
+}
+
+// 32-bit IEEE float WAV, readable by any audio editor or soundfile/numpy.
+static Boolean EngramGlitch_WriteWave(const char* path, const EngramGlitchSlot* slot) {
+    FILE* file = EngramFiles_CreatePrivate(path);
+    if (file == NULL) {
+        return false;
+    }
+
+    UInt32 channels = slot->info.channels;
+    UInt32 frames = slot->info.historyFrames + slot->info.capturedFrames;
+    UInt32 dataBytes = frames * channels * (UInt32)sizeof(Float32);
+    UInt32 sampleRate = (UInt32)slot->info.sampleRate;
+
+    fwrite("RIFF", 1, 4, file);
+    EngramGlitch_WriteUInt32(file, 36 + dataBytes);
+    fwrite("WAVEfmt ", 1, 8, file);
+    EngramGlitch_WriteUInt32(file, 16);
+    EngramGlitch_WriteUInt16(file, 3);   // WAVE_FORMAT_IEEE_FLOAT
+    EngramGlitch_WriteUInt16(file, (UInt16)channels);
+    EngramGlitch_WriteUInt32(file, sampleRate);
+    EngramGlitch_WriteUInt32(file, sampleRate * channels * (UInt32)sizeof(Float32));
+    EngramGlitch_WriteUInt16(file, (UInt16)(channels * sizeof(Float32)));
+    EngramGlitch_WriteUInt16(file, 32);
+    fwrite("data", 1, 4, file);
+    EngramGlitch_WriteUInt32(file, dataBytes);
+    fwrite(slot->audio, sizeof(Float32), (size_t)frames * channels, file);
+
+    return fclose(file) == 0;
+}
+
+static Boolean EngramGlitch_WriteInfo(const char* path, const EngramGlitchSlot* slot, Float64 nanosPerHostTick) {
+    FILE* file = EngramFiles_CreatePrivate(path);
+    if (file == NULL) {
+        return false;
+    }
+
+    const EngramGlitchInfo* info = &slot->info;
+
+    // Place the glitch on the wall clock so it can be matched to user reports
+    UInt64 ageNanos = EngramLog_NowNanos() - (UInt64)((Float64)info->cycle.hostTime * nanosPerHostTick);
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    time_t wallSeconds = now.tv_sec - (time_t)(ageNanos / 1000000000ull);
+    struct tm wall;
+    localtime_r(&wallSeconds, &wall);
+    char wallTime[64];
+    strftime(wallTime, sizeof(wallTime), "%Y-%m-%dT%H:%M:%S%z", &wall);
+
+    fprintf(file, "{\n");
+    fprintf(file, "  \"sequence\": %llu,\n", (unsigned long long)info->sequence);
+    fprintf(file, "  \"wallTime\": \"%s\",\n", wallTime);
+    fprintf(file, "  \"underrun\": %s,\n", (info->kinds & kEngramGlitchUnderrun) ? "true" : "false");
+    fprintf(file, "  \"discontinuity\": %s,\n", (info->kinds & kEngramGlitchDiscontinuity) ? "true" : "false");
+    fprintf(file, "  \"click\": %s,\n", (info->kinds & kEngramGlitchClick) ? "true" : "false");
+    fprintf(file, "  \"hostTime\": %llu,\n", (unsigned long long)info->cycle.hostTime);
+    fprintf(file, "  \"nanosPerHostTick\": %.9f,\n", nanosPerHostTick);
+    fprintf(file, "  \"ioCycle\": %llu,\n", (unsigned long long)info->cycle.cycle);
+    fprintf(file, "  \"sampleTime\": %.0f,\n", info->cycle.sampleTime);
+    fprintf(file, "  \"expectedSampleTime\": %.0f,\n", info->expectedSampleTime);
+    fprintf(file, "  \"frames\": %u,\n", info->cycle.frames);
+    fprintf(file, "  \"missingFrames\": %u,\n", info->cycle.missingFrames);
+    fprintf(file, "  \"ringFillFrames\": %u,\n", info->cycle.ringFillFrames);
+    fprintf(file, "  \"ringReadIndex\": %u,\n", info->cycle.ringReadIndex);
+    fprintf(file, "  \"ringWriteIndex\": %u,\n", info->cycle.ringWriteIndex);
+    fprintf(file, "  \"ringSize\": %u,\n", info->cycle.ringSize);
+    fprintf(file, "  \"clickFrame\": %u,\n", info->clickFrame);
+    fprintf(file, "  \"clickRatio\": %.1f,\n", (double)info->clickRatio);
+    fprintf(file, "  \"sampleRate\": %.1f,\n", info->sampleRate);
+    fprintf(file, "  \"channels\": %u,\n", info->channels);
+    fprintf(file, "  \"historyFrames\": %u,\n", info->historyFrames);
+    fprintf(file, "  \"capturedFrames\": %u\n", info->capturedFrames);
+    fprintf(file, "}\n");
+
+    return fclose(file) == 0;
+}
+
+UInt32 EngramGlitch_PersistPending(EngramGlitchDetector* detector, const char* directory, const char* session,
+                                   Float64 nanosPerHostTick) {
+    UInt32 written = 0;
+    // Checked once per batch, and only when there is something to write
+    Boolean checked = false;
+    Boolean writable = false;
+
+    for (UInt32 i = 0; i < kEngramGlitchSlotCount; i++) {
+        EngramGlitchSlot* slot = &detector->slots[i];
+        if (slot->state.load(std::memory_order_acquire) != kEngramGlitchSlotReady) {
+            continue;
+        }
+        if (!checked) {
+            checked = true;
+            writable = EngramFiles_MakePrivateDirectory(directory);
+        }
+
+        Boolean saved = false;
+        if (writable) {
+            char path[kEngramMaxPathLength];
+            snprintf(path, sizeof(path), "%s/glitch-%s-%06llu.wav", directory, session, (unsigned long long)slot->info.sequence);
+            saved = EngramGlitch_WriteWave(path, slot);
+            snprintf(path, sizeof(path), "%s/glitch-%s-%06llu.json", directory, session, (unsigned long long)slot->info.sequence);
+            saved = EngramGlitch_WriteInfo(path, slot, nanosPerHostTick) && saved;
+        }
+
+        if (saved) {
+            detector->savedSnapshots.fetch_add(1, std::memory_order_relaxed);
+            written++;
+        } else {
+            ENGRAM_LOG_WARNING("Could not save glitch snapshot %llu (errno %llu)", slot->info.sequence, (UInt64)errno);
+        }
+        slot->state.store(kEngramGlitchSlotFree, std::memory_order_release);
+    }
+
+    return written;
+}
+
+// MARK: - Writer Thread
+
+static pthread_t gGlitchThread;
+static pthread_mutex_t gGlitchThreadLock = PTHREAD_MUTEX_INITIALIZER;
+static Boolean gGlitchThreadRunning = false;
+static std::atomic<Boolean> gGlitchStopRequested;
+
+static EngramGlitchDetector* gGlitchDetector = NULL;
+static char gGlitchDirectory[kEngramMaxPathLength];
+static char gGlitchSession[32];
+static Float64 gGlitchNanosPerHostTick = 1.0;
+static const std::atomic<UInt32>* gGlitchIOGate = NULL;
+
+static void* EngramGlitch_WriterThread(void* context) {
+#if defined(__APPLE__)
+    pthread_set_qos_class_self_np(QOS_CLASS_UTILITY, 0);
+#endif
+
+    while (!gGlitchStopRequested.load(std::memory_order_acquire)) {
+        EngramGlitch_PersistPending(gGlitchDetector, gGlitchDirectory, gGlitchSession, gGlitchNanosPerHostTick);
+        // Everything captured before IO stopped has just been written. Teardown
+        // closes the gate before stopping the writer, so this never delays it.
+        if (gGlitchIOGate != NULL && gGlitchIOGate->load(std::memory_order_acquire) == 0) {
+            EngramWait_WhileEqual(gGlitchIOGate, 0, kEngramGlitchWriterIdleWaitNs);
+        } else {
+            usleep(kEngramGlitchWriterIntervalUs);
+        }
+    }
+
+    EngramGlitch_PersistPending(gGlitchDetector, gGlitchDirectory, gGlitchSession, gGlitchNanosPerHostTick);
+    return NULL;
+}
+
+void EngramGlitch_StartWriter(EngramGlitchDetector* detector, const char* directory, Float64 nanosPerHostTick,
+                              const std::atomic<UInt32>* ioGate) {
+    if (detector == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&gGlitchThreadLock);
+
+    if (!gGlitchThreadRunning) {
+        gGlitchDetector = detector;
+        snprintf(gGlitchDirectory, sizeof(gGlitchDirectory), "%s", directory);
+        gGlitchNanosPerHostTick = nanosPerHostTick;
+        gGlitchIOGate = ioGate;
+        // Sequences restart with every plugin instance; the session keeps
+        // their snapshots apart from earlier ones in the same directory
+        time_t now = time(NULL);
+        struct tm wall;
+        localtime_r(&now, &wall);
+        strftime(gGlitchSession, sizeof(gGlitchSession), "%Y%m%d-%H%M%S", &wall);
+        gGlitchStopRequested.store(false, std::memory_order_release);
+
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+#if !defined(__APPLE__)
+        pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+        pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+#endif
+        if (pthread_create(&gGlitchThread, &attr, EngramGlitch_WriterThread, NULL) == 0) {
+            gGlitchThreadRunning = true;
+        }
+        pthread_attr_destroy(&attr);
+    }
+
+    pthread_mutex_unlock(&gGlitchThreadLock);
+}
+
+void EngramGlitch_StopWriter(void) {
+    pthread_mutex_lock(&gGlitchThreadLock);
+
+    if (gGlitchThreadRunning) {
+        gGlitchStopRequested.store(true, std::memory_order_release);
+        pthread_join(gGlitchThread, NULL);
+        gGlitchThreadRunning = false;
+        gGlitchDetector = NULL;
+        gGlitchIOGate = NULL;
+    }
+
+    pthread_mutex_unlock(&gGlitchThreadLock);
+}
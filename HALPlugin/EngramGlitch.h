@@ -0,0 +1,131 @@
+//
+//  EngramGlitch.h
+//  Engram Virtual Audio Device
+//
+//  IO-path glitch detection with snapshots of the surrounding audio
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#ifndef EngramGlitch_h
+#define EngramGlitch_h
+
+#include "EngramArena.h"
+#include "EngramDSP.h"
+#include "EngramTypes.h"
+#include <atomic>
+#include <stddef.h>
+
+#define kEngramGlitchSlotCount 8
+// Audio kept from the cycles before a glitch (~43 ms at 48 kHz)
+#define kEngramGlitchHistoryFrames 2048
+// Longest IO buffer captured in full; longer cycles are truncated
+#define kEngramGlitchMaxCycleFrames 4096
+#define kEngramGlitchWriterIntervalUs 100000
+// Longest the writer parks on an idle IO gate before looking again
+#define kEngramGlitchWriterIdleWaitNs 1000000000ull
+
+// Click detection: the peak second-difference energy of a cycle against the
+// running mean of previous cycles. 256x is ~24 dB above the program's normal
+// high-frequency content; the floor keeps near-silence from tripping it.
+#define kEngramClickRatio 256.0f
+#define kEngramClickEnergyFloor 1.0e-4f
+#define kEngramClickWarmupCycles 8
+
+// MARK: - Snapshots
+
+typedef enum {
+    kEngramGlitchUnderrun      = 1 << 0,   // the ring could not fill the cycle
+    kEngramGlitchDiscontinuity = 1 << 1,   // mSampleTime did not follow the previous cycle
+    kEngramGlitchClick         = 1 << 2    // high-pass energy spike in the audio
+} EngramGlitchKind;
+
+// What the IO thread knows about the cycle being checked.
+typedef struct {
+    UInt64 hostTime;
+    UInt64 cycle;
+    Float64 sampleTime;
+    UInt32 frames;
+    UInt32 missingFrames;
+    UInt32 ringFillFrames;      // queued before the read
+    UInt32 ringReadIndex;
+    UInt32 ringWriteIndex;
+    UInt32 ringSize;
+} EngramGlitchCycle;
+
+typedef struct {
+    UInt64 sequence;
+    UInt32 kinds;               // EngramGlitchKind bits
+    UInt32 channels;
+    Float64 sampleRate;
+    EngramGlitchCycle cycle;
+    Float64 expectedSampleTime; // where the cycle should have started, if known
+    UInt32 historyFrames;       // audio frames preceding the glitching cycle
+    UInt32 capturedFrames;      // frames of the glitching cycle itself
+    UInt32 clickFrame;          // offset of the energy peak within the cycle
+    Float32 clickRatio;         // peak energy over the running mean
+} EngramGlitchInfo;
+
+enum {
+    kEngramGlitchSlotFree = 0,
+    kEngramGlitchSlotFilling,   // owned by the IO thread
+    kEngramGlitchSlotReady      // owned by the writer thread
+};
+
+typedef struct {
+    std::atomic<UInt32> state;
+    EngramGlitchInfo info;
+    Float32* audio;             // interleaved, historyFrames + capturedFrames
+} EngramGlitchSlot;
+
+// MARK: - Detector
+
+typedef struct {
+    Float64 sampleRate;
+    UInt32 channels;
+
+    // IO-thread state
+    Boolean haveExpected;
+    Float64 expectedSampleTime;
+    Float32 hfEnergyMean;
+    UInt32 warmupCycles;
+    Float32 previous[kEngramMaxChannels][2];
+    Float32* history;           // interleaved ring of the most recent frames
+    UInt32 historyWrite;
+    UInt32 historyFrames;
+    UInt64 sequence;
+
+    EngramGlitchSlot slots[kEngramGlitchSlotCount];
+    std::atomic<UInt64> droppedSnapshots;
+    std::atomic<UInt64> savedSnapshots;
+} EngramGlitchDetector;
+
+// Arena bytes for the detector and its audio buffers.
+size_t EngramGlitch_RequiredBytes(UInt32 channels);
+EngramGlitchDetector* EngramGlitch_Create(EngramArena* arena, Float64 sampleRate, UInt32 channels);
+// Forgets timing and audio history; call when IO (re)starts.
+void EngramGlitch_Reset(EngramGlitchDetector* detector);
+
+// Real-time safe. Checks one cycle of input, captures a snapshot if anything
+// is wrong and returns the EngramGlitchKind bits found (0 for a clean cycle).
+UInt32 EngramGlitch_Observe(EngramGlitchDetector* detector, const EngramGlitchCycle* cycle, const Float32* samples);
+
+// MARK: - Persistence
+
+// Writes every ready snapshot as <directory>/glitch-<session>-<sequence>.wav
+// plus a .json sidecar and frees the slots. `directory` is made private
+// first (see EngramFiles_MakePrivateDirectory) and nothing is written unless
+// it is; files are new and readable by this user only. Returns the number
+// written.
+UInt32 EngramGlitch_PersistPending(EngramGlitchDetector* detector, const char* directory, const char* session,
+                                   Float64 nanosPerHostTick);
+
+// Background thread that calls EngramGlitch_PersistPending periodically,
+// naming the session after the wall-clock time it started. Snapshots only
+// come from IO cycles, so while `ioGate` (an EngramGate clients word; may be
+// NULL) reads 0 the thread sleeps on it instead of polling.
+void EngramGlitch_StartWriter(EngramGlitchDetector* detector, const char* directory, Float64 nanosPerHostTick,
+                              const std::atomic<UInt32>* ioGate);
+void EngramGlitch_StopWriter(void);
+
+#endif /* EngramGlitch_h */
@@ -7,130 +7,249 @@
 //
 
 #include "EngramHalPlugin.h"
+#include "EngramIO.h"
+#include "EngramLog.h"
+#include "EngramNotify.h"
+#include "EngramProperties.h"
+#include "EngramSIMD.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
 
-// MARK: - Ring Buffer Implementation
+// AudioServerPlugIn callbacks implemented here; property and IO callbacks
+// live in EngramProperties.cpp and EngramIO.cpp
+static HRESULT EngramPlugIn_QueryInterface(void* driver, REFIID iid, LPVOID* ppv);
+static ULONG EngramPlugIn_AddRef(void* driver);
+static ULONG EngramPlugIn_Release(void* driver);
 
-void EngramRingBuffer_Init(EngramRingBuffer* rb, UInt32 size) {
-    rb->size = size;
-    rb->buffer = (Float32*)calloc(size, sizeof(Float32));
-    rb->writeIndex = 0;
-    rb->readIndex = 0;
-    pthread_mutex_init(&rb->lock, NULL);
-}
+static OSStatus EngramPlugIn_Initialize(AudioServerPlugInDriverRef driver, AudioServerPlugInHostRef host);
+static OSStatus EngramPlugIn_CreateDevice(AudioServerPlugInDriverRef driver, CFDictionaryRef description, const AudioServerPlugInClientInfo* clientInfo, AudioObjectID* outDeviceObjectID);
+static OSStatus EngramPlugIn_DestroyDevice(AudioServerPlugInDriverRef driver, AudioObjectID deviceObjectID);
 
-void EngramRingBuffer_Destroy(EngramRingBuffer* rb) {
-    if (rb->buffer) {
-        free(rb->buffer);
-        rb->buffer = NULL;
-    }
-    pthread_mutex_destroy(&rb->lock);
-}
+// MARK: - Global State
 
-UInt32 EngramRingBuffer_Write(EngramRingBuffer* rb, const Float32* data, UInt32 frames) {
-    pthread_mutex_lock(&rb->lock);
+EngramDevice gDevice;
+static EngramArena gArena;
+static AudioServerPlugInHostRef gHost = NULL;
 
-    UInt32 available = EngramRingBuffer_GetAvailableWrite(rb);
-    UInt32 toWrite = (frames < available) ? frames : available;
+// References come and go on any thread. Building and tearing down the plugin
+// happen under gLifecycleLock, and gLive (only touched under it) says which
+// of the two happened last, so a Create racing the final Release either
+// keeps the plugin alive or rebuilds it after teardown, never in the middle.
+static std::atomic<UInt32> gRefCount(0);
+static pthread_mutex_t gLifecycleLock = PTHREAD_MUTEX_INITIALIZER;
+static Boolean gLive = false;
+static Boolean gInitialized = false;
+
+#define kEngramLifecycleDrainPollUs 100
+
+static AudioServerPlugInDriverInterface gInterface = {
+    NULL, // _reserved
+    EngramPlugIn_QueryInterface,
+    EngramPlugIn_AddRef,
+    EngramPlugIn_Release,
+    EngramPlugIn_Initialize,
+    EngramPlugIn_CreateDevice,
+    EngramPlugIn_DestroyDevice,
+    NULL, // AddDeviceClient
+    NULL, // RemoveDeviceClient
+    NULL, // PerformDeviceConfigurationChange
+    NULL, // AbortDeviceConfigurationChange
+
+    // Property operations
+    EngramDevice_HasProperty,
+    EngramDevice_IsPropertySettable,
+    EngramDevice_GetPropertyDataSize,
+    EngramDevice_GetPropertyData,
+    EngramDevice_SetPropertyData,
+
+    // IO operations
+    EngramDevice_StartIO,
+    EngramDevice_StopIO,
+    EngramDevice_GetZeroTimeStamp,
+    EngramDevice_WillDoIOOperation,
+    EngramDevice_BeginIOOperation,
+    EngramDevice_DoIOOperation,
+    EngramDevice_EndIOOperation
+};
+
+// COM objects are a pointer to their interface pointer
+static AudioServerPlugInDriverInterface* gInterfacePtr = &gInterface;
+static AudioServerPlugInDriverRef const gDriverRef = &gInterfacePtr;
 
-    for (UInt32 i = 0; i < toWrite; i++) {
-        rb->buffer[rb->writeIndex] = data[i];
-        rb->writeIndex = (rb->writeIndex + 1) % rb->size;
-    }
+// MARK: - Plugin Factory
 
-    pthread_mutex_unlock(&rb->lock);
-    return toWrite;
+// Every block the plugin will ever need, sized from the configured limits.
+// Modules that need runtime storage add their share here.
+static size_t EngramPlugIn_ArenaBytes(void) {
+    size_t bytes = 0;
+    bytes += EngramArena_AlignedSize(kEngramRingBufferSize * sizeof(Float32));
+    bytes += EngramArena_AlignedSize(kEngramRingStampCapacity * sizeof(EngramRingStamp));
+    bytes += EngramArena_AlignedSize(sizeof(EngramDSPChain));
+    bytes += EngramArena_AlignedSize(kEngramMaxIOBufferFrames * kEngramChannels * sizeof(Float32));
+    bytes += EngramArena_AlignedSize(kEngramOutputRingSize * sizeof(Float32));
+    bytes += EngramArena_AlignedSize(sizeof(EngramDSPChain));
+    bytes += EngramArena_AlignedSize(sizeof(EngramStatsPage));
+    bytes += EngramArena_AlignedSize(EngramTrace_RequiredBytes());
+    bytes += EngramGlitch_RequiredBytes(kEngramChannels);
+    bytes += EngramArena_AlignedSize(sizeof(EngramLatencyLog));
+    bytes += EngramRender_RequiredBytes(kEngramChannels);
+    bytes += EngramMixMinus_RequiredBytes(kEngramChannels);
+    bytes += EngramFeedback_RequiredBytes();
+    return bytes;
 }
 
-UInt32 EngramRingBuffer_Read(EngramRingBuffer* rb, Float32* data, UInt32 frames) {
-    pthread_mutex_lock(&rb->lock);
-
-    UInt32 available = EngramRingBuffer_GetAvailableRead(rb);
-    UInt32 toRead = (frames < available) ? frames : available;
+// Builds everything the callbacks use. Called with gLifecycleLock held, only
+// while no previous instance is live.
+static void EngramPlugIn_Setup(void) {
+    gDevice.objectID = kAudioObjectUnknown;
+    gDevice.inputStreamID = kAudioObjectUnknown;
+    gDevice.outputStreamID = kAudioObjectUnknown;
+    gDevice.channels = kEngramChannels;
+    gDevice.ioClientCount.store(0, std::memory_order_relaxed);
+    EngramGate_Init(&gDevice.ioGate);
+    gDevice.lastCycleHostTime.store(0, std::memory_order_relaxed);
+    gDevice.lastCycleCounter.store(0, std::memory_order_relaxed);
+
+    // Reserve all plugin memory up front; nothing is allocated after Initialize
+    EngramArena_Reserve(&gArena, EngramPlugIn_ArenaBytes());
+    EngramRingBuffer_Init(&gDevice.ringBuffer,
+                          ENGRAM_ARENA_NEW_ARRAY(&gArena, Float32, kEngramRingBufferSize),
+                          kEngramRingBufferSize);
+    EngramRingBuffer_AttachStamps(&gDevice.ringBuffer,
+                                  ENGRAM_ARENA_NEW_ARRAY(&gArena, EngramRingStamp, kEngramRingStampCapacity),
+                                  kEngramRingStampCapacity);
+    gDevice.dsp = ENGRAM_ARENA_NEW_ARRAY(&gArena, EngramDSPChain, 1);
+    if (gDevice.dsp != NULL) {
+        EngramDSPChain_Init(gDevice.dsp, kEngramSampleRate, gDevice.channels, kEngramDefaultDSPStages);
+    }
+    gDevice.glitch = EngramGlitch_Create(&gArena, kEngramSampleRate, gDevice.channels);
+    gDevice.feedback = EngramFeedback_Create(&gArena, kEngramSampleRate, gDevice.channels);
+    gDevice.sharedInput = ENGRAM_ARENA_NEW_ARRAY(&gArena, Float32, kEngramMaxIOBufferFrames * kEngramChannels);
+    gDevice.sharedInputCycle = 0;
+    gDevice.sharedInputFrames = 0;
+
+    // The output side gets its own chain; its filter state follows the mix
+    EngramRingBuffer_Init(&gDevice.outputRing,
+                          ENGRAM_ARENA_NEW_ARRAY(&gArena, Float32, kEngramOutputRingSize),
+                          kEngramOutputRingSize);
+    gDevice.outputDsp = ENGRAM_ARENA_NEW_ARRAY(&gArena, EngramDSPChain, 1);
+    if (gDevice.outputDsp != NULL) {
+        EngramDSPChain_Init(gDevice.outputDsp, kEngramSampleRate, gDevice.channels, kEngramDefaultDSPStages);
+    }
+    // Loopback stays off until requested through kEngramPropertyLoopback
+    EngramMixMinus_Init(&gDevice.mixMinus, &gArena, gDevice.channels);
+
+    // Latency calibration stays off until requested through kEngramPropertyLatency
+    gDevice.latencyEnabled.store(false, std::memory_order_relaxed);
+    gDevice.dspStages.store(kEngramDefaultDSPStages, std::memory_order_relaxed);
+    EngramLatencyDetector_Init(&gDevice.latencyDetector, gDevice.channels, kEngramLatencyDefaultIntervalFrames / 2);
+    gDevice.latencyArrivals = ENGRAM_ARENA_NEW_ARRAY(&gArena, EngramLatencyLog, 1);
+    if (gDevice.latencyArrivals != NULL) {
+        EngramLatencyLog_Init(gDevice.latencyArrivals);
+    }
 
-    for (UInt32 i = 0; i < toRead; i++) {
-        data[i] = rb->buffer[rb->readIndex];
-        rb->readIndex = (rb->readIndex + 1) % rb->size;
+    // Pull mode stays off until a producer asks for it
+    EngramRender_Init(&gDevice.render, &gArena, gDevice.channels);
+
+    // Stats live in shared memory so monitoring does not have to go through the
+    // HAL; fall back to private arena storage if coreaudiod's sandbox says no,
+    // or if another running instance already publishes under the name.
+    EngramStatsPage* arenaStats = ENGRAM_ARENA_NEW_ARRAY(&gArena, EngramStatsPage, 1);
+    if (EngramStats_OpenSharedPage(EngramStats_SharedPageName(), &gDevice.statsShared)) {
+        gDevice.stats = gDevice.statsShared.page;
+    } else {
+        gDevice.stats = arenaStats;
+        if (gDevice.stats != NULL) {
+            EngramStats_InitPage(gDevice.stats);
+        }
     }
+    EngramLowWater_Init(&gDevice.lowWater,
+                        (gDevice.stats != NULL) ? &gDevice.stats->lowWaterSequence : NULL,
+                        (gDevice.stats != NULL) ? &gDevice.stats->lowWaterFrames : NULL);
 
-    // Zero-fill if not enough data
-    for (UInt32 i = toRead; i < frames; i++) {
-        data[i] = 0.0f;
+    // The directory is only created once there is something to write into it
+    if (!EngramFiles_DiagnosticsDirectory(gDevice.diagnosticsDirectory, sizeof(gDevice.diagnosticsDirectory))) {
+        gDevice.diagnosticsDirectory[0] = '\0';
     }
 
-    pthread_mutex_unlock(&rb->lock);
-    return toRead;
-}
+    // Tracing stays off until requested through kEngramPropertyTrace
+    EngramTrace_Attach(ENGRAM_ARENA_NEW_ARRAY(&gArena, EngramTraceSlot, kEngramTraceCapacity));
 
-UInt32 EngramRingBuffer_GetAvailableRead(EngramRingBuffer* rb) {
-    UInt32 w = rb->writeIndex;
-    UInt32 r = rb->readIndex;
-    return (w >= r) ? (w - r) : (rb->size - r + w);
-}
+    // Calculate host ticks per frame and publish the initial timeline
+    struct mach_timebase_info timebaseInfo;
+    mach_timebase_info(&timebaseInfo);
+
+    EngramClockConfig clock = {};
+    clock.seed = 1;
+    clock.sampleRate = kEngramSampleRate;
+    clock.hostTicksPerFrame = EngramClock_HostTicksPerFrame(clock.sampleRate, timebaseInfo.numer, timebaseInfo.denom);
+    clock.nanosPerHostTick = EngramClock_NanosPerHostTick(timebaseInfo.numer, timebaseInfo.denom);
+    clock.periodFrames = kEngramZeroTimeStampPeriod;
+    EngramSeqlock_Write(&gDevice.clock, clock);
 
-UInt32 EngramRingBuffer_GetAvailableWrite(EngramRingBuffer* rb) {
-    return rb->size - EngramRingBuffer_GetAvailableRead(rb) - 1;
+    // Callbacks may run from here on
+    gDevice.live.store(true, std::memory_order_seq_cst);
 }
 
-// MARK: - Global State
+// Stops new callbacks, waits out the ones already running, then frees
+// everything. Called with gLifecycleLock held.
+static void EngramPlugIn_Teardown(void) {
+    gDevice.live.store(false, std::memory_order_seq_cst);
+    // Producers sleeping on the IO gate hold a scope; send them home first
+    EngramGate_Close(&gDevice.ioGate);
+    if (gDevice.stats != NULL) {
+        EngramStats_PublishIO(gDevice.stats, &gDevice.ioGate);
+    }
+    EngramLowWater_Release(&gDevice.lowWater);
+    EngramRender_Nudge(&gDevice.render);
+    while (gDevice.callbacksInFlight.load(std::memory_order_seq_cst) != 0) {
+        usleep(kEngramLifecycleDrainPollUs);
+    }
 
-static EngramDevice gDevice;
-static AudioServerPlugInHostRef gHost = NULL;
-static UInt32 gRefCount = 0;
+    // The host should have stopped IO first; nothing can be running now either way
+    UInt32 clients = gDevice.ioClientCount.exchange(0, std::memory_order_acq_rel);
+    if (clients != 0) {
+        ENGRAM_LOG_WARNING("Engram HAL Plugin released with %llu IO clients still running", clients);
+    }
 
-// MARK: - Plugin Factory
+    // The host is still there for whatever the last callbacks announced
+    EngramNotify_Stop();
+    EngramGlitch_StopWriter();
+    gDevice.glitch = NULL;
+    gDevice.feedback = NULL;
+    gDevice.dsp = NULL;
+    gDevice.outputDsp = NULL;
+    gDevice.latencyArrivals = NULL;
+    EngramRingBuffer_Destroy(&gDevice.ringBuffer);
+    EngramRingBuffer_Destroy(&gDevice.outputRing);
+    EngramStats_CloseSharedPage(&gDevice.statsShared);
+    gDevice.stats = NULL;
+    gDevice.objectID = kAudioObjectUnknown;
+    EngramTrace_Attach(NULL);
+    EngramArena_Release(&gArena);
+    gHost = NULL;
+    gInitialized = false;
+    EngramLog_Stop();
+}
 
 extern "C" void* EngramPlugIn_Create(CFAllocatorRef allocator, CFUUIDRef requestedTypeUUID) {
-    // Initialize device
-    memset(&gDevice, 0, sizeof(EngramDevice));
-    gDevice.objectID = kAudioObjectUnknown;
-    gDevice.sampleRate = kEngramSampleRate;
-    gDevice.channels = kEngramChannels;
+    if (requestedTypeUUID == NULL || !CFEqual(requestedTypeUUID, kAudioServerPlugInTypeUUID)) {
+        return NULL;
+    }
 
-    EngramRingBuffer_Init(&gDevice.ringBuffer, kEngramRingBufferSize);
-    pthread_mutex_init(&gDevice.stateLock, NULL);
-    
-    // Calculate host ticks per frame
-    struct mach_timebase_info timebaseInfo;
-    mach_timebase_info(&timebaseInfo);
-    gDevice.hostTicksPerFrame = (UInt64)(1000000000.0 / gDevice.sampleRate * (Float64)timebaseInfo.denom / (Float64)timebaseInfo.numer);
-    
-    gRefCount = 1;
-    
-    // Return interface
-    static AudioServerPlugInDriverInterface interface = {
-        NULL, // _reserved
-        EngramPlugIn_QueryInterface,
-        EngramPlugIn_AddRef,
-        EngramPlugIn_Release,
-        EngramPlugIn_Initialize,
-        EngramPlugIn_CreateDevice,
-        EngramPlugIn_DestroyDevice,
-        NULL, // AddDeviceClient
-        NULL, // RemoveDeviceClient
-        NULL, // PerformDeviceConfigurationChange
-        NULL, // AbortDeviceConfigurationChange
-
-        // Property operations
-        EngramDevice_HasProperty,
-        EngramDevice_IsPropertySettable,
-        EngramDevice_GetPropertyDataSize,
-        EngramDevice_GetPropertyData,
-        EngramDevice_SetPropertyData,
-
-        // IO operations
-        EngramDevice_StartIO,
-        EngramDevice_StopIO,
-        EngramDevice_GetZeroTimeStamp,
-        EngramDevice_WillDoIOOperation,
-        EngramDevice_BeginIOOperation,
-        EngramDevice_DoIOOperation,
-        EngramDevice_EndIOOperation
-    };
-
-    return &interface;
+    // Later calls hand out another reference to the same instance
+    pthread_mutex_lock(&gLifecycleLock);
+    if (!gLive) {
+        EngramPlugIn_Setup();
+        gLive = true;
+    }
+    gRefCount.fetch_add(1, std::memory_order_acq_rel);
+    pthread_mutex_unlock(&gLifecycleLock);
+
+    return gDriverRef;
 }
 
 // MARK: - COM Interface
@@ -151,152 +270,87 @@ static HRESULT EngramPlugIn_QueryInterface(void* driver, REFIID iid, LPVOID* ppv
 }
 
 static ULONG EngramPlugIn_AddRef(void* driver) {
-    return ++gRefCount;
+    return gRefCount.fetch_add(1, std::memory_order_acq_rel) + 1;
 }
 
 static ULONG EngramPlugIn_Release(void* driver) {
-    UInt32 refCount = --gRefCount;
-
-    if (refCount == 0) {
-        EngramRingBuffer_Destroy(&gDevice.ringBuffer);
-        pthread_mutex_destroy(&gDevice.stateLock);
+    // An unbalanced Release must not wrap the count and tear down someone else's instance
+    UInt32 refCount = gRefCount.load(std::memory_order_relaxed);
+    do {
+        if (refCount == 0) {
+            return 0;
+        }
+    } while (!gRefCount.compare_exchange_weak(refCount, refCount - 1, std::memory_order_acq_rel));
+
+    if (refCount == 1) {
+        // A Create may have taken a new reference since; then the instance stays
+        pthread_mutex_lock(&gLifecycleLock);
+        if (gLive && gRefCount.load(std::memory_order_acquire) == 0) {
+            EngramPlugIn_Teardown();
+            gLive = false;
+        }
+        pthread_mutex_unlock(&gLifecycleLock);
     }
 
-    return refCount;
+    return refCount - 1;
 }
 
 // MARK: - Plugin Lifecycle
 
 static OSStatus EngramPlugIn_Initialize(AudioServerPlugInDriverRef driver, AudioServerPlugInHostRef host) {
+    pthread_mutex_lock(&gLifecycleLock);
+    if (!gLive || gInitialized) {
+        pthread_mutex_unlock(&gLifecycleLock);
+        return gLive ? kAudioHardwareIllegalOperationError : kAudioHardwareNotRunningError;
+    }
+
     gHost = host;
+    EngramLog_Start();
 
     // Register device
     gDevice.objectID = 1000; // Arbitrary but unique
 
-    printf("Engram HAL Plugin initialized\n");
+    // Properties that change on their own are announced rather than polled
+    EngramNotify_Register(gDevice.objectID, kAudioDevicePropertyDeviceIsRunning,
+                          kAudioObjectPropertyScopeGlobal, kAudioObjectPropertyElementMain);
+    EngramNotify_Register(gDevice.objectID, kEngramPropertyTrace,
+                          kAudioObjectPropertyScopeGlobal, kAudioObjectPropertyElementMain);
+    EngramNotify_Register(gDevice.objectID, kEngramPropertyLatency,
+                          kAudioObjectPropertyScopeGlobal, kAudioObjectPropertyElementMain);
+    EngramNotify_Register(gDevice.objectID, kEngramPropertyLoopback,
+                          kAudioObjectPropertyScopeGlobal, kAudioObjectPropertyElementMain);
+    EngramNotify_Register(gDevice.objectID, kEngramPropertyFeedback,
+                          kAudioObjectPropertyScopeGlobal, kAudioObjectPropertyElementMain);
+    EngramNotify_Register(gDevice.objectID, kEngramPropertyAGC,
+                          kAudioObjectPropertyScopeGlobal, kAudioObjectPropertyElementMain);
+    EngramNotify_Start(host);
+
+    EngramArena_Seal(&gArena);
+
+    EngramClockConfig clock = EngramSeqlock_Read(&gDevice.clock);
+    EngramGlitch_StartWriter(gDevice.glitch, gDevice.diagnosticsDirectory, clock.nanosPerHostTick, &gDevice.ioGate.clients);
+
+    // Picks the SIMD kernels now so the IO thread never pays for the CPU check
+    const EngramSIMDKernels* simd = EngramSIMD_Kernels();
+    gInitialized = true;
+    pthread_mutex_unlock(&gLifecycleLock);
+
+    // Records carry integers only; see EngramSIMDLevel for the names
+    ENGRAM_LOG_NOTICE("Engram HAL Plugin initialized (device %llu, SIMD level %llu)", gDevice.objectID, (UInt64)simd->level);
     return kAudioHardwareNoError;
 }
 
 static OSStatus EngramPlugIn_CreateDevice(AudioServerPlugInDriverRef driver, CFDictionaryRef description, const AudioServerPlugInClientInfo* clientInfo, AudioObjectID* outDeviceObjectID) {
+    ENGRAM_ALLOC_GUARD();
+    ENGRAM_CALLBACK_GUARD(kAudioHardwareNotRunningError);
+
     *outDeviceObjectID = gDevice.objectID;
     return kAudioHardwareNoError;
 }
 
 static OSStatus EngramPlugIn_DestroyDevice(AudioServerPlugInDriverRef driver, AudioObjectID deviceObjectID) {
-    return kAudioHardwareNoError;
-}
-
-// MARK: - Property Management (Simplified - Full implementation would be extensive)
-
-static Boolean EngramDevice_HasProperty(AudioServerPlugInDriverRef driver, AudioObjectID objectID, pid_t clientPID, const AudioObjectPropertyAddress* address) {
-    // Basic properties only
-    switch (address->mSelector) {
-        case kAudioObjectPropertyName:
-        case kAudioObjectPropertyManufacturer:
-        case kAudioDevicePropertyNominalSampleRate:
-        case kAudioDevicePropertyStreams:
-            return true;
-        default:
-            return false;
-    }
-}
-
-static OSStatus EngramDevice_IsPropertySettable(AudioServerPlugInDriverRef driver, AudioObjectID objectID, pid_t clientPID, const AudioObjectPropertyAddress* address, Boolean* outIsSettable) {
-    *outIsSettable = false;
-    return kAudioHardwareNoError;
-}
-
-static OSStatus EngramDevice_GetPropertyDataSize(AudioServerPlugInDriverRef driver, AudioObjectID objectID, pid_t clientPID, const AudioObjectPropertyAddress* address, UInt32 qualifierDataSize, const void* qualifierData, UInt32* outDataSize) {
-    switch (address->mSelector) {
-        case kAudioObjectPropertyName:
-        case kAudioObjectPropertyManufacturer:
-            *outDataSize = sizeof(CFStringRef);
-            break;
-        case kAudioDevicePropertyNominalSampleRate:
-            *outDataSize = sizeof(Float64);
-            break;
-        default:
-            *outDataSize = 0;
-    }
-
-    return kAudioHardwareNoError;
-}
-
-static OSStatus EngramDevice_GetPropertyData(AudioServerPlugInDriverRef driver, AudioObjectID objectID, pid_t clientPID, const AudioObjectPropertyAddress* address, UInt32 qualifierDataSize, const void* qualifierData, UInt32 inDataSize, UInt32* outDataSize, void* outData) {
-    switch (address->mSelector) {
-        case kAudioObjectPropertyName:
-            *((CFStringRef*)outData) = CFSTR(kEngramDeviceName);
-            *outDataSize = sizeof(CFStringRef);
-            break;
-        case kAudioObjectPropertyManufacturer:
-            *((CFStringRef*)outData) = CFSTR(kEngramDeviceManufacturer);
-            *outDataSize = sizeof(CFStringRef);
-            break;
-        case kAudioDevicePropertyNominalSampleRate:
-            *((Float64*)outData) = gDevice.sampleRate;
-            *outDataSize = sizeof(Float64);
-            break;
-        default:
-            return kAudioHardwareUnknownPropertyError;
-    }
-
-    return kAudioHardwareNoError;
-}
-
-static OSStatus EngramDevice_SetPropertyData(AudioServerPlugInDriverRef driver, AudioObjectID objectID, pid_t clientPID, const AudioObjectPropertyAddress* address, UInt32 qualifierDataSize, const void* qualifierData, UInt32 inDataSize, const void* inData) {
-    return kAudioHardwareUnsupportedOperationError;
-}
-
-// MARK: - IO Operations
-
-static OSStatus EngramDevice_StartIO(AudioServerPlugInDriverRef driver, AudioObjectID deviceObjectID, UInt32 clientID) {
-    pthread_mutex_lock(&gDevice.stateLock);
-    gDevice.isRunning = true;
-    gDevice.anchorHostTime = mach_absolute_time();
-    pthread_mutex_unlock(&gDevice.stateLock);
-
-    printf("Engram device started\n");
-    return kAudioHardwareNoError;
-}
-
-static OSStatus EngramDevice_StopIO(AudioServerPlugInDriverRef driver, AudioObjectID deviceObjectID, UInt32 clientID) {
-    pthread_mutex_lock(&gDevice.stateLock);
-    gDevice.isRunning = false;
-    pthread_mutex_unlock(&gDevice.stateLock);
-
-    printf("Engram device stopped\n");
-    return kAudioHardwareNoError;
-}
-
-static OSStatus EngramDevice_GetZeroTimeStamp(AudioServerPlugInDriverRef driver, AudioObjectID deviceObjectID, UInt32 clientID, Float64* outSampleTime, UInt64* outHostTime, UInt64* outSeed) {
-    *outSampleTime = 0;
-    *outHostTime = gDevice.anchorHostTime;
-    *outSeed = 1;
-
-    return kAudioHardwareNoError;
-}
-
-static OSStatus EngramDevice_WillDoIOOperation(AudioServerPlugInDriverRef driver, AudioObjectID deviceObjectID, UInt32 clientID, UInt32 operationID, Boolean* outWillDo, Boolean* outWillDoInPlace) {
-    *outWillDo = (operationID == kAudioServerPlugInIOOperationReadInput);
-    *outWillDoInPlace = true;
-
-    return kAudioHardwareNoError;
-}
-
-static OSStatus EngramDevice_BeginIOOperation(AudioServerPlugInDriverRef driver, AudioObjectID deviceObjectID, UInt32 clientID, UInt32 operationID, UInt32 ioBufferFrameSize, const AudioServerPlugInIOCycleInfo* ioCycleInfo) {
-    return kAudioHardwareNoError;
-}
-
-static OSStatus EngramDevice_DoIOOperation(AudioServerPlugInDriverRef driver, AudioObjectID deviceObjectID, AudioObjectID streamObjectID, UInt32 clientID, UInt32 operationID, UInt32 ioBufferFrameSize, const AudioServerPlugInIOCycleInfo* ioCycleInfo, void* ioMainBuffer, void* ioSecondaryBuffer) {
-    if (operationID == kAudioServerPlugInIOOperationReadInput) {
-        // Read from ring buffer (data injected by main app)
-        Float32* buffer = (Float32*)ioMainBuffer;
-        EngramRingBuffer_Read(&gDevice.ringBuffer, buffer, ioBufferFrameSize * gDevice.channels);
-    }
-
-    return kAudioHardwareNoError;
-}
+    ENGRAM_ALLOC_GUARD();
+    ENGRAM_CALLBACK_GUARD(kAudioHardwareNotRunningError);
 
-static OSStatus EngramDevice_EndIOOperation(AudioServerPlugInDriverRef driver, AudioObjectID deviceObjectID, UInt32 clientID, UInt32 operationID, UInt32 ioBufferFrameSize, const AudioServerPlugInIOCycleInfo* ioCycleInfo) {
     return kAudioHardwareNoError;
 }
@@ -13,7 +13,20 @@
 #include <CoreAudio/AudioServerPlugIn.h>
 #include <CoreFoundation/CoreFoundation.h>
 #include <mach/mach_time.h>
-#include <pthread.h>
+#include <atomic>
+#include "EngramArena.h"
+#include "EngramClock.h"
+#include "EngramDSP.h"
+#include "EngramFeedback.h"
+#include "EngramFiles.h"
+#include "EngramGlitch.h"
+#include "EngramLatency.h"
+#include "EngramMixMinus.h"
+#include "EngramRender.h"
+#include "EngramRingBuffer.h"
+#include "EngramSeqlock.h"
+#include "EngramStats.h"
+#include "EngramTrace.h"
 
 // Plugin UUID
 #define kEngramPlugInUID "dev.balakumar.engram.hal.plugin"
@@ -25,24 +38,29 @@
 #define kEngramSampleRate 48000.0
 #define kEngramChannels 2
 #define kEngramRingBufferSize 65536
-
-// MARK: - Ring Buffer
-
-typedef struct {
-    Float32* buffer;
-    UInt32 size;
-    volatile UInt32 writeIndex;
-    volatile UInt32 readIndex;
-    pthread_mutex_t lock;
-} EngramRingBuffer;
-
-// Ring buffer operations
-void EngramRingBuffer_Init(EngramRingBuffer* rb, UInt32 size);
-void EngramRingBuffer_Destroy(EngramRingBuffer* rb);
-UInt32 EngramRingBuffer_Write(EngramRingBuffer* rb, const Float32* data, UInt32 frames);
-UInt32 EngramRingBuffer_Read(EngramRingBuffer* rb, Float32* data, UInt32 frames);
-UInt32 EngramRingBuffer_GetAvailableRead(EngramRingBuffer* rb);
-UInt32 EngramRingBuffer_GetAvailableWrite(EngramRingBuffer* rb);
+// Timestamps riding alongside the ring, one per producer write
+#define kEngramRingStampCapacity 1024
+// Mixed client output waiting for a speaker-side consumer
+#define kEngramOutputRingSize 65536
+// IO buffer sizes the device takes, advertised through
+// kAudioDevicePropertyBufferFrameSizeRange. A cycle's processed input always
+// fits the copy shared between clients; DoIOOperation refuses anything bigger.
+#define kEngramMinIOBufferFrames 16
+#define kEngramMaxIOBufferFrames 4096
+
+// Custom properties, advertised through kAudioObjectPropertyCustomPropertyInfoList
+enum {
+    kEngramPropertyStats = 'enst',  // CFData holding an EngramStatsSnapshot
+    kEngramPropertyTrace = 'entr',  // get: CFData trace dump; set: CFBoolean enables tracing
+    kEngramPropertyLatency = 'enlt', // get: CFData of EngramLatencyRecord arrivals (drains); set: CFBoolean enables calibration
+    kEngramPropertyLoopback = 'enlb', // get/set: CFBoolean; clients' input also carries the other clients' output
+    kEngramPropertyFeedback = 'enfb', // get/set: CFBoolean; howl suppression on the input (on by default)
+    kEngramPropertyAGC = 'enag', // get/set: CFBoolean; automatic gain control on the input
+    kEngramPropertyLowWater = 'enlw' // get/set: CFData UInt32 frames; arms a wake on the stats page's lowWaterSequence, 0 disarms
+};
+
+// Repeated IO-path warnings are emitted at most this often
+#define kEngramUnderrunLogIntervalNs 1000000000ull
 
 // MARK: - Device State
 
@@ -51,46 +69,98 @@ typedef struct {
     AudioObjectID inputStreamID;
     AudioObjectID outputStreamID;
 
-    Float64 sampleRate;
     UInt32 channels;
 
     EngramRingBuffer ringBuffer;
+    EngramDSPChain* dsp;
+    // Requested input stages; ReadInput brings dsp into line at its next cycle
+    std::atomic<UInt32> dspStages;
+    EngramGlitchDetector* glitch;
+    EngramFeedbackDetector* feedback;
+
+    // This cycle's processed input, owned by the IO thread. The first client
+    // to read a cycle runs the input chain; the rest get a copy.
+    Float32* sharedInput;
+    UInt64 sharedInputCycle;
+    UInt32 sharedInputFrames;       // 0 while nothing is held
+
+    // Output side: WriteMix processes the clients' mix in place and queues it
+    // here for EngramDevice_ReadOutput. The IO thread is the producer.
+    EngramRingBuffer outputRing;
+    EngramDSPChain* outputDsp;
+
+    // Loopback of the output mix into ProcessInput, less each client's own share
+    EngramMixMinus mixMinus;
+
+    // Runtime flags and counters, updated from any thread without locks
+    std::atomic<UInt32> ioClientCount;
+    // Producer pacing; mirrored into the stats page
+    EngramGate ioGate;
+    EngramLowWater lowWater;
+    std::atomic<UInt64> lastCycleHostTime;
+    std::atomic<UInt64> lastCycleCounter;
+
+    // IO-path histograms; the shared-memory page when this instance could
+    // create one, private arena storage otherwise
+    EngramStatsPage* stats;
+    EngramStatsSharedPage statsShared;
+
+    // Private directory for trace dumps, glitch snapshots and latency logs
+    char diagnosticsDirectory[kEngramMaxPathLength];
+
+    // Latency calibration: probe onsets found in ReadInput, stamped at exit
+    std::atomic<Boolean> latencyEnabled;
+    EngramLatencyDetector latencyDetector;
+    EngramLatencyLog* latencyArrivals;
+
+    // Pull-mode input: requested from BeginIOOperation, collected in ReadInput
+    EngramRender render;
+
+    // Timeline configuration, read by real-time callbacks as one snapshot
+    EngramSeqlock<EngramClockConfig> clock;
+
+    // Set once Create has built everything above, cleared as teardown starts.
+    // Callbacks count themselves in and out so teardown can wait for them.
+    std::atomic<Boolean> live;
+    std::atomic<UInt32> callbacksInFlight;
+} EngramDevice;
 
-    Boolean isRunning;
-    UInt64 hostTicksPerFrame;
-    UInt64 anchorHostTime;
+// MARK: - Shared State
 
-    pthread_mutex_t stateLock;
-} EngramDevice;
+// The single device instance; owned by EngramHalPlugin.cpp and shared with
+// the property and IO modules.
+extern EngramDevice gDevice;
+
+// MARK: - Lifecycle
+//
+// Every callback that touches plugin-owned memory (the ring, the arena, the
+// stats page) opens a scope first. Once teardown has begun the scope is not
+// entered and the callback returns `failure` without touching anything;
+// teardown frees nothing until every open scope has closed. Both sides are
+// sequentially consistent, so either teardown sees the callback's count or
+// the callback sees teardown's flag.
+
+struct EngramCallbackScope {
+    Boolean entered;
+    EngramCallbackScope() {
+        gDevice.callbacksInFlight.fetch_add(1, std::memory_order_seq_cst);
+        entered = gDevice.live.load(std::memory_order_seq_cst);
+    }
+    ~EngramCallbackScope() { gDevice.callbacksInFlight.fetch_sub(1, std::memory_order_release); }
+};
+
+#define ENGRAM_CALLBACK_GUARD(failure)                                                  \
+    EngramCallbackScope engramCallbackScope;                                            \
+    if (!engramCallbackScope.entered) {                                                 \
+        return (failure);                                                               \
+    }
 
 // MARK: - Plugin Interface
 
-// Entry point
+// Factory entry point. Returns the driver reference (a pointer to the
+// interface pointer, as COM expects) holding one new reference, or NULL for
+// any type but kAudioServerPlugInTypeUUID. Safe from any thread; only the
+// first reference builds the plugin, and the last Release tears it down.
 extern "C" void* EngramPlugIn_Create(CFAllocatorRef allocator, CFUUIDRef requestedTypeUUID);
 
-// AudioServerPlugIn callbacks
-static HRESULT EngramPlugIn_QueryInterface(void* driver, REFIID iid, LPVOID* ppv);
-static ULONG EngramPlugIn_AddRef(void* driver);
-static ULONG EngramPlugIn_Release(void* driver);
-
-static OSStatus EngramPlugIn_Initialize(AudioServerPlugInDriverRef driver, AudioServerPlugInHostRef host);
-static OSStatus EngramPlugIn_CreateDevice(AudioServerPlugInDriverRef driver, CFDictionaryRef description, const AudioServerPlugInClientInfo* clientInfo, AudioObjectID* outDeviceObjectID);
-static OSStatus EngramPlugIn_DestroyDevice(AudioServerPlugInDriverRef driver, AudioObjectID deviceObjectID);
-
-// Device property management
-static Boolean EngramDevice_HasProperty(AudioServerPlugInDriverRef driver, AudioObjectID objectID, pid_t clientPID, const AudioObjectPropertyAddress* address);
-static OSStatus EngramDevice_IsPropertySettable(AudioServerPlugInDriverRef driver, AudioObjectID objectID, pid_t clientPID, const AudioObjectPropertyAddress* address, Boolean* outIsSettable);
-static OSStatus EngramDevice_GetPropertyDataSize(AudioServerPlugInDriverRef driver, AudioObjectID objectID, pid_t clientPID, const AudioObjectPropertyAddress* address, UInt32 qualifierDataSize, const void* qualifierData, UInt32* outDataSize);
-static OSStatus EngramDevice_GetPropertyData(AudioServerPlugInDriverRef driver, AudioObjectID objectID, pid_t clientPID, const AudioObjectPropertyAddress* address, UInt32 qualifierDataSize, const void* qualifierData, UInt32 inDataSize, UInt32* outDataSize, void* outData);
-static OSStatus EngramDevice_SetPropertyData(AudioServerPlugInDriverRef driver, AudioObjectID objectID, pid_t clientPID, const AudioObjectPropertyAddress* address, UInt32 qualifierDataSize, const void* qualifierData, UInt32 inDataSize, const void* inData);
-
-// IO operations
-static OSStatus EngramDevice_StartIO(AudioServerPlugInDriverRef driver, AudioObjectID deviceObjectID, UInt32 clientID);
-static OSStatus EngramDevice_StopIO(AudioServerPlugInDriverRef driver, AudioObjectID deviceObjectID, UInt32 clientID);
-static OSStatus EngramDevice_GetZeroTimeStamp(AudioServerPlugInDriverRef driver, AudioObjectID deviceObjectID, UInt32 clientID, Float64* outSampleTime, UInt64* outHostTime, UInt64* outSeed);
-static OSStatus EngramDevice_WillDoIOOperation(AudioServerPlugInDriverRef driver, AudioObjectID deviceObjectID, UInt32 clientID, UInt32 operationID, Boolean* outWillDo, Boolean* outWillDoInPlace);
-static OSStatus EngramDevice_BeginIOOperation(AudioServerPlugInDriverRef driver, AudioObjectID deviceObjectID, UInt32 clientID, UInt32 operationID, UInt32 ioBufferFrameSize, const AudioServerPlugInIOCycleInfo* ioCycleInfo);
-static OSStatus EngramDevice_DoIOOperation(AudioServerPlugInDriverRef driver, AudioObjectID deviceObjectID, AudioObjectID streamObjectID, UInt32 clientID, UInt32 operationID, UInt32 ioBufferFrameSize, const AudioServerPlugInIOCycleInfo* ioCycleInfo, void* ioMainBuffer, void* ioSecondaryBuffer);
-static OSStatus EngramDevice_EndIOOperation(AudioServerPlugInDriverRef driver, AudioObjectID deviceObjectID, UInt32 clientID, UInt32 operationID, UInt32 ioBufferFrameSize, const AudioServerPlugInIOCycleInfo* ioCycleInfo);
-
 #endif /* EngramHalPlugin_h */
@@ -0,0 +1,560 @@
+//
+//  EngramIO.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramIO.h"
+#include "EngramHalPlugin.h"
+#include "EngramDenormal.h"
+#include "EngramLog.h"
+#include "EngramNotify.h"
+#include "EngramWait.h"
+#include <string.h>
+
+static_assert(kEngramMixMinusMaxFrames >= kEngramMaxIOBufferFrames && kEngramRenderMaxFrames >= kEngramMaxIOBufferFrames,
+              "every buffer size the device advertises must fit the per-cycle tables");
+
+// MARK: - Producer Interface
+
+static inline UInt32 EngramDevice_RingFillFrames(void) {
+    return EngramRingBuffer_GetAvailableRead(&gDevice.ringBuffer) / gDevice.channels;
+}
+
+extern "C" UInt32 EngramDevice_WriteInput(const Float32* samples, UInt32 sampleCount) {
+    return EngramDevice_WriteInputAt(samples, sampleCount, mach_absolute_time());
+}
+
+extern "C" UInt32 EngramDevice_WriteInputAt(const Float32* samples, UInt32 sampleCount, UInt64 hostTime) {
+    ENGRAM_CALLBACK_GUARD(0);
+
+    UInt32 written = EngramRingBuffer_WriteStamped(&gDevice.ringBuffer, samples, sampleCount, hostTime);
+
+    ENGRAM_TRACE(kEngramTraceEventProducerWrite, mach_absolute_time(), 0, 0, 0.0,
+                 sampleCount / gDevice.channels, written / gDevice.channels, EngramDevice_RingFillFrames());
+    return written;
+}
+
+extern "C" Boolean EngramDevice_WaitForIO(UInt64 timeoutNanos) {
+    ENGRAM_CALLBACK_GUARD(false);
+
+    // Teardown closes the gate before it waits for this scope
+    return EngramGate_WaitForIO(&gDevice.ioGate.clients, timeoutNanos);
+}
+
+extern "C" Boolean EngramDevice_WaitForLowWater(UInt32 thresholdFrames, UInt64 timeoutNanos) {
+    ENGRAM_CALLBACK_GUARD(false);
+
+    EngramLowWater* lowWater = &gDevice.lowWater;
+    UInt64 deadline = (timeoutNanos != 0) ? EngramWait_Now() + timeoutNanos : 0;
+    for (;;) {
+        if (!EngramGate_IsRunning(gDevice.ioGate.clients.load(std::memory_order_acquire))) {
+            EngramLowWater_Disarm(lowWater);
+            return false;
+        }
+        UInt32 sequence = EngramLowWater_Arm(lowWater, kEngramLowWaterArmedLocal, thresholdFrames);
+        if (EngramDevice_RingFillFrames() < thresholdFrames) {
+            EngramLowWater_Disarm(lowWater);
+            return true;
+        }
+
+        UInt64 remaining = 0;
+        if (deadline != 0) {
+            UInt64 now = EngramWait_Now();
+            if (now >= deadline) {
+                EngramLowWater_Disarm(lowWater);
+                return false;
+            }
+            remaining = deadline - now;
+        }
+        // Teardown and the last StopIO bump the sequence too
+        EngramWait_WhileEqual(&lowWater->sequence, sequence, remaining);
+    }
+}
+
+// MARK: - Speaker Interface
+
+extern "C" UInt32 EngramDevice_ReadOutput(Float32* samples, UInt32 sampleCount) {
+    ENGRAM_CALLBACK_GUARD(0);
+
+    return EngramRingBuffer_Read(&gDevice.outputRing, samples, sampleCount);
+}
+
+// MARK: - Pull Mode
+
+extern "C" void EngramDevice_SetPullMode(Boolean enabled) {
+    EngramCallbackScope scope;
+    if (!scope.entered) {
+        return;
+    }
+
+    gDevice.render.enabled.store(enabled, std::memory_order_release);
+    // A producer waiting for requests that will no longer come goes back to its loop
+    if (!enabled) {
+        EngramRender_Nudge(&gDevice.render);
+    }
+}
+
+extern "C" Boolean EngramDevice_WaitForRenderRequest(EngramRenderRequest* outRequest, UInt64 timeoutNanos) {
+    ENGRAM_CALLBACK_GUARD(false);
+
+    EngramRender* render = &gDevice.render;
+    UInt64 deadline = (timeoutNanos != 0) ? EngramWait_Now() + timeoutNanos : 0;
+    for (;;) {
+        // Checked after arming: whatever stops requests coming nudges the word
+        // afterwards, so either these loads see it or the sleep below is cut short
+        UInt32 sequence = EngramRender_Arm(render);
+        if (!render->enabled.load(std::memory_order_acquire) || !gDevice.live.load(std::memory_order_acquire) ||
+            gDevice.ioClientCount.load(std::memory_order_acquire) == 0) {
+            EngramRender_Disarm(render);
+            return false;
+        }
+        if (EngramRender_Pending(render, outRequest)) {
+            EngramRender_Disarm(render);
+            return true;
+        }
+
+        UInt64 remaining = 0;
+        if (deadline != 0) {
+            UInt64 now = EngramWait_Now();
+            if (now >= deadline) {
+                EngramRender_Disarm(render);
+                return false;
+            }
+            remaining = deadline - now;
+        }
+        EngramWait_WhileEqual(&render->requested, sequence, remaining);
+    }
+}
+
+extern "C" void EngramDevice_CompleteRender(const EngramRenderRequest* request) {
+    EngramCallbackScope scope;
+    if (!scope.entered) {
+        return;
+    }
+
+    EngramRender_Complete(&gDevice.render, request);
+}
+
+// MARK: - IO Operations
+
+OSStatus EngramDevice_StartIO(AudioServerPlugInDriverRef driver, AudioObjectID deviceObjectID, UInt32 clientID) {
+    ENGRAM_ALLOC_GUARD();
+    ENGRAM_CALLBACK_GUARD(kAudioHardwareNotRunningError);
+
+    // Only the first client anchors the timeline; later clients join it. The
+    // seed moves with the anchor, so the HAL sees the discontinuity.
+    if (gDevice.ioClientCount.fetch_add(1, std::memory_order_acq_rel) == 0) {
+        EngramClockConfig clock = EngramSeqlock_Read(&gDevice.clock);
+        clock.anchorHostTime = mach_absolute_time();
+        clock.seed++;
+        EngramSeqlock_Write(&gDevice.clock, clock);
+
+        if (gDevice.dsp != NULL) {
+            EngramDSPChain_Reset(gDevice.dsp);
+        }
+        if (gDevice.outputDsp != NULL) {
+            EngramDSPChain_Reset(gDevice.outputDsp);
+        }
+        if (gDevice.glitch != NULL) {
+            EngramGlitch_Reset(gDevice.glitch);
+        }
+        if (gDevice.feedback != NULL) {
+            EngramFeedback_Reset(gDevice.feedback);
+        }
+        // Cycle counters start again with the new timeline
+        gDevice.sharedInputFrames = 0;
+        EngramNotify_Post(gDevice.objectID, kAudioDevicePropertyDeviceIsRunning);
+    }
+
+    // Each client running IO gets its own loopback contribution slot
+    if (!EngramMixMinus_Attach(&gDevice.mixMinus, clientID)) {
+        ENGRAM_LOG_WARNING("No mix-minus slot for client %llu; its loopback includes its own output", clientID);
+    }
+
+    // Producers parked on the gate resume only once the timeline is anchored
+    EngramGate_Started(&gDevice.ioGate);
+    if (gDevice.stats != NULL) {
+        EngramStats_PublishIO(gDevice.stats, &gDevice.ioGate);
+    }
+
+    ENGRAM_TRACE(kEngramTraceEventStartIO, mach_absolute_time(), 0, 0, 0.0, clientID, 0, 0);
+    ENGRAM_LOG_NOTICE("Engram device started (client %llu)", clientID);
+    return kAudioHardwareNoError;
+}
+
+OSStatus EngramDevice_StopIO(AudioServerPlugInDriverRef driver, AudioObjectID deviceObjectID, UInt32 clientID) {
+    ENGRAM_ALLOC_GUARD();
+    ENGRAM_CALLBACK_GUARD(kAudioHardwareNotRunningError);
+
+    UInt32 clients = gDevice.ioClientCount.load(std::memory_order_relaxed);
+    do {
+        if (clients == 0) {
+            return kAudioHardwareIllegalOperationError;
+        }
+    } while (!gDevice.ioClientCount.compare_exchange_weak(clients, clients - 1, std::memory_order_acq_rel));
+    EngramMixMinus_Detach(&gDevice.mixMinus, clientID);
+    EngramGate_Stopped(&gDevice.ioGate);
+    if (gDevice.stats != NULL) {
+        EngramStats_PublishIO(gDevice.stats, &gDevice.ioGate);
+    }
+    // A producer waiting for a render request or for low water stops waiting
+    // with the last client
+    if (clients == 1) {
+        EngramLowWater_Release(&gDevice.lowWater);
+        EngramRender_Nudge(&gDevice.render);
+        EngramNotify_Post(gDevice.objectID, kAudioDevicePropertyDeviceIsRunning);
+    }
+
+    ENGRAM_TRACE(kEngramTraceEventStopIO, mach_absolute_time(), 0, 0, 0.0, clientID, 0, 0);
+    ENGRAM_LOG_NOTICE("Engram device stopped (client %llu)", clientID);
+    return kAudioHardwareNoError;
+}
+
+OSStatus EngramDevice_GetZeroTimeStamp(AudioServerPlugInDriverRef driver, AudioObjectID deviceObjectID, UInt32 clientID, Float64* outSampleTime, UInt64* outHostTime, UInt64* outSeed) {
+    ENGRAM_ALLOC_GUARD();
+
+    EngramClockConfig clock = EngramSeqlock_Read(&gDevice.clock);
+
+    EngramClock_GetZeroTimeStamp(&clock, mach_absolute_time(), outSampleTime, outHostTime);
+    *outSeed = clock.seed;
+
+    return kAudioHardwareNoError;
+}
+
+OSStatus EngramDevice_WillDoIOOperation(AudioServerPlugInDriverRef driver, AudioObjectID deviceObjectID, UInt32 clientID, UInt32 operationID, Boolean* outWillDo, Boolean* outWillDoInPlace) {
+    ENGRAM_ALLOC_GUARD();
+
+    // The streams are the device's own Float32 layout, so there is nothing to
+    // convert. Work that belongs to the cycle runs once: the input chain in the
+    // first client's ReadInput, the output chain in WriteMix. Work that belongs
+    // to one client runs in its ProcessInput and ProcessOutput.
+    switch (operationID) {
+        case kAudioServerPlugInIOOperationReadInput:
+        case kAudioServerPlugInIOOperationProcessInput:
+        case kAudioServerPlugInIOOperationProcessOutput:
+        case kAudioServerPlugInIOOperationWriteMix:
+            *outWillDo = true;
+            break;
+        default:
+            *outWillDo = false;
+            break;
+    }
+    *outWillDoInPlace = true;
+
+    return kAudioHardwareNoError;
+}
+
+// Input operations are timed against mInputTime, everything else mOutputTime.
+static inline const AudioTimeStamp* EngramDevice_OperationTime(UInt32 operationID, const AudioServerPlugInIOCycleInfo* ioCycleInfo) {
+    switch (operationID) {
+        case kAudioServerPlugInIOOperationReadInput:
+        case kAudioServerPlugInIOOperationConvertInput:
+        case kAudioServerPlugInIOOperationProcessInput:
+            return &ioCycleInfo->mInputTime;
+        default:
+            return &ioCycleInfo->mOutputTime;
+    }
+}
+
+OSStatus EngramDevice_BeginIOOperation(AudioServerPlugInDriverRef driver, AudioObjectID deviceObjectID, UInt32 clientID, UInt32 operationID, UInt32 ioBufferFrameSize, const AudioServerPlugInIOCycleInfo* ioCycleInfo) {
+    ENGRAM_ALLOC_GUARD();
+    ENGRAM_CALLBACK_GUARD(kAudioHardwareNotRunningError);
+
+    if (EngramTrace_IsEnabled()) {
+        const AudioTimeStamp* time = EngramDevice_OperationTime(operationID, ioCycleInfo);
+        EngramTrace_RecordEvent(kEngramTraceEventBeginIO, mach_absolute_time(), ioCycleInfo->mIOCycleCounter,
+                                time->mHostTime, time->mSampleTime, operationID, ioBufferFrameSize,
+                                EngramDevice_RingFillFrames());
+    }
+
+    // Ask a pull-mode producer for this cycle's input while the HAL gets on
+    // with the rest of the cycle; ReadInput collects it
+    if (operationID == kAudioServerPlugInIOOperationReadInput) {
+        EngramRender_Request(&gDevice.render, ioCycleInfo->mIOCycleCounter, ioCycleInfo->mInputTime.mSampleTime,
+                             ioCycleInfo->mInputTime.mHostTime, ioBufferFrameSize);
+    }
+
+    return kAudioHardwareNoError;
+}
+
+// Hands a client this cycle's input. The first client to read a cycle takes
+// it from the pull-mode producer or the ring and runs the input chain over it
+// in place; clients reading the same cycle after it get a copy, so the ring,
+// the detectors and the chain's state each see every cycle exactly once.
+// DoIOOperation has already refused any cycle too big for the copy.
+static void EngramDevice_ReadInput(UInt32 operationID, UInt32 ioBufferFrameSize, const AudioServerPlugInIOCycleInfo* ioCycleInfo, void* ioMainBuffer) {
+    Float32* buffer = (Float32*)ioMainBuffer;
+    UInt32 samples = ioBufferFrameSize * gDevice.channels;
+    if (gDevice.sharedInputFrames == ioBufferFrameSize && gDevice.sharedInputCycle == ioCycleInfo->mIOCycleCounter) {
+        memcpy(buffer, gDevice.sharedInput, samples * sizeof(Float32));
+        return;
+    }
+
+    // Recursive stages decay toward denormals during silence
+    ENGRAM_DENORMAL_GUARD();
+
+    UInt64 cycleStart = mach_absolute_time();
+    EngramClockConfig clock = EngramSeqlock_Read(&gDevice.clock);
+    EngramStatsPage* stats = gDevice.stats;
+
+    // Scheduling jitter between consecutive cycles
+    UInt64 previousStart = gDevice.lastCycleHostTime.load(std::memory_order_relaxed);
+    UInt64 previousCounter = gDevice.lastCycleCounter.load(std::memory_order_relaxed);
+    if (stats != NULL && previousStart != 0 && previousCounter + 1 == ioCycleInfo->mIOCycleCounter) {
+        Float64 expected = (Float64)ioBufferFrameSize * clock.hostTicksPerFrame;
+        Float64 deviation = (Float64)(cycleStart - previousStart) - expected;
+        UInt64 jitterTicks = (UInt64)((deviation < 0.0) ? -deviation : deviation);
+        EngramHistogram_Record(&stats->cycleJitterNs, EngramClock_HostTicksToNanos(&clock, jitterTicks));
+    }
+    gDevice.lastCycleHostTime.store(cycleStart, std::memory_order_relaxed);
+    gDevice.lastCycleCounter.store(ioCycleInfo->mIOCycleCounter, std::memory_order_relaxed);
+
+    // Read from ring buffer (data injected by main app)
+    UInt32 queued = EngramRingBuffer_GetAvailableRead(&gDevice.ringBuffer);
+
+    ENGRAM_TRACE(kEngramTraceEventDoIOBegin, cycleStart, ioCycleInfo->mIOCycleCounter,
+                 ioCycleInfo->mInputTime.mHostTime, ioCycleInfo->mInputTime.mSampleTime,
+                 operationID, ioBufferFrameSize, queued / gDevice.channels);
+
+    // Pull mode: the producer renders this cycle into a slot, waited for
+    // up to a fraction of the cycle. A miss reads the ring as push mode does.
+    UInt32 samplesRead = 0;
+    UInt64 writtenAt = 0;
+    Boolean rendered = false;
+    if (gDevice.render.issued) {
+        UInt64 cycleNanos = EngramClock_HostTicksToNanos(&clock, (UInt64)((Float64)ioBufferFrameSize * clock.hostTicksPerFrame));
+        UInt64 waitNanos = 0;
+        rendered = EngramRender_Collect(&gDevice.render, buffer, ioBufferFrameSize,
+                                        cycleNanos / kEngramRenderBudgetDivisor, &waitNanos);
+        if (stats != NULL) {
+            EngramStats_Add(rendered ? &stats->renderCycles : &stats->renderMisses, 1);
+            EngramHistogram_Record(&stats->renderWaitNs, waitNanos);
+        }
+    }
+    if (rendered) {
+        samplesRead = samples;
+    } else {
+        samplesRead = EngramRingBuffer_ReadStamped(&gDevice.ringBuffer, buffer, samples, &writtenAt);
+    }
+
+    // Wake a producer waiting for room as early in the cycle as possible
+    if (EngramLowWater_Check(&gDevice.lowWater, EngramDevice_RingFillFrames()) && stats != NULL) {
+        EngramStats_Add(&stats->lowWaterSignals, 1);
+    }
+
+    if (samplesRead < samples) {
+        ENGRAM_TRACE(kEngramTraceEventUnderrun, mach_absolute_time(), ioCycleInfo->mIOCycleCounter,
+                     ioCycleInfo->mInputTime.mHostTime, ioCycleInfo->mInputTime.mSampleTime,
+                     operationID, (samples - samplesRead) / gDevice.channels, 0);
+        ENGRAM_LOG_RATE_LIMITED(kEngramUnderrunLogIntervalNs, kEngramLogLevelWarning,
+                                "Ring underrun: %llu of %llu samples available (cycle %llu)",
+                                samplesRead, samples, ioCycleInfo->mIOCycleCounter);
+    }
+
+    // Calibration probes are found in the raw ring data
+    SInt32 probeOnset = -1;
+    if (gDevice.latencyEnabled.load(std::memory_order_relaxed)) {
+        probeOnset = EngramLatencyDetector_Scan(&gDevice.latencyDetector, buffer, ioBufferFrameSize);
+    }
+
+    // Inspect what the producer delivered, before any processing
+    UInt32 glitches = 0;
+    if (gDevice.glitch != NULL) {
+        EngramGlitchCycle cycle;
+        cycle.hostTime = cycleStart;
+        cycle.cycle = ioCycleInfo->mIOCycleCounter;
+        cycle.sampleTime = ioCycleInfo->mInputTime.mSampleTime;
+        cycle.frames = ioBufferFrameSize;
+        cycle.missingFrames = (samples - samplesRead) / gDevice.channels;
+        cycle.ringFillFrames = queued / gDevice.channels;
+        cycle.ringReadIndex = gDevice.ringBuffer.readIndex.load(std::memory_order_relaxed);
+        cycle.ringWriteIndex = gDevice.ringBuffer.writeIndex.load(std::memory_order_relaxed);
+        cycle.ringSize = gDevice.ringBuffer.size;
+        glitches = EngramGlitch_Observe(gDevice.glitch, &cycle, buffer);
+        if (glitches & (kEngramGlitchDiscontinuity | kEngramGlitchClick)) {
+            ENGRAM_LOG_RATE_LIMITED(kEngramUnderrunLogIntervalNs, kEngramLogLevelWarning,
+                                    "Glitch in cycle %llu (kinds 0x%llx, sample time %llu)",
+                                    ioCycleInfo->mIOCycleCounter, glitches,
+                                    (UInt64)ioCycleInfo->mInputTime.mSampleTime);
+        }
+    }
+
+    UInt32 howls = 0;
+    if (gDevice.feedback != NULL) {
+        howls = EngramFeedback_Process(gDevice.feedback, buffer, ioBufferFrameSize);
+        if (howls != 0) {
+            ENGRAM_LOG_RATE_LIMITED(kEngramUnderrunLogIntervalNs, kEngramLogLevelWarning,
+                                    "Feedback suppressed in cycle %llu (%llu notches, gain cut %llu)",
+                                    ioCycleInfo->mIOCycleCounter, (UInt64)gDevice.feedback->notchCount,
+                                    (UInt64)gDevice.feedback->gainCut.load(std::memory_order_relaxed));
+        }
+    }
+
+    if (gDevice.dsp != NULL) {
+        UInt32 stages = gDevice.dspStages.load(std::memory_order_relaxed);
+        if (stages != gDevice.dsp->enabledStages) {
+            EngramDSPChain_SetStages(gDevice.dsp, stages);
+        }
+        // The AGC must not win back what the suppressor just took out
+        Boolean suppressing = (gDevice.feedback != NULL) && EngramFeedback_IsSuppressing(gDevice.feedback);
+        EngramDSPChain_SetAGCDecision(gDevice.dsp, suppressing ? kEngramAGCDecisionHold : kEngramAGCDecisionGate);
+        EngramDSPChain_Process(gDevice.dsp, buffer, ioBufferFrameSize);
+    }
+
+    if (stats != NULL) {
+        if (gDevice.feedback != NULL) {
+            EngramStats_Add(&stats->feedbackEvents, howls);
+            stats->feedbackNotches.store(gDevice.feedback->activeNotches.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            stats->feedbackGainCut.store(gDevice.feedback->gainCut.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        EngramStats_Add(&stats->ioCycles, 1);
+        if (samplesRead < samples) {
+            EngramStats_Add(&stats->underruns, 1);
+            EngramStats_Add(&stats->underrunSamples, samples - samplesRead);
+        }
+        if (glitches != 0) {
+            EngramStats_Add(&stats->glitches, 1);
+            if (glitches & kEngramGlitchDiscontinuity) {
+                EngramStats_Add(&stats->discontinuities, 1);
+            }
+            if (glitches & kEngramGlitchClick) {
+                EngramStats_Add(&stats->clicks, 1);
+            }
+            stats->glitchSnapshotsDropped.store(gDevice.glitch->droppedSnapshots.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        stats->overrunSamples.store(gDevice.ringBuffer.overrunSamples.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        EngramHistogram_Record(&stats->ringFillFrames, queued / gDevice.channels);
+        // How long the oldest sample handed over sat in the ring
+        if (writtenAt != 0 && writtenAt <= cycleStart) {
+            EngramHistogram_Record(&stats->queueResidencyNs, EngramClock_HostTicksToNanos(&clock, cycleStart - writtenAt));
+        }
+        stats->residencyStampsDropped.store(gDevice.ringBuffer.droppedStamps.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        EngramHistogram_Record(&stats->ioDurationNs, EngramClock_HostTicksToNanos(&clock, mach_absolute_time() - cycleStart));
+    }
+
+    // Stamp the probe as it leaves for the clients
+    if (probeOnset >= 0 && gDevice.latencyArrivals != NULL) {
+        EngramLatencyRecord arrival;
+        arrival.sequence = ++gDevice.latencyDetector.sequence;
+        arrival.hostTime = mach_absolute_time();
+        arrival.sampleTime = ioCycleInfo->mInputTime.mSampleTime + (Float64)probeOnset;
+        EngramLatencyLog_Push(gDevice.latencyArrivals, &arrival);
+    }
+
+    if (gDevice.sharedInput != NULL) {
+        memcpy(gDevice.sharedInput, buffer, samples * sizeof(Float32));
+        gDevice.sharedInputCycle = ioCycleInfo->mIOCycleCounter;
+        gDevice.sharedInputFrames = ioBufferFrameSize;
+    }
+
+    ENGRAM_TRACE(kEngramTraceEventDoIOEnd, mach_absolute_time(), ioCycleInfo->mIOCycleCounter,
+                 ioCycleInfo->mInputTime.mHostTime, ioCycleInfo->mInputTime.mSampleTime,
+                 operationID, ioBufferFrameSize, EngramDevice_RingFillFrames());
+}
+
+// Per client, after ReadInput has handed it the cycle's input: the loopback
+// is added on top, less this client's own output.
+static void EngramDevice_ProcessInput(UInt32 clientID, UInt32 ioBufferFrameSize, const AudioServerPlugInIOCycleInfo* ioCycleInfo, Float32* buffer) {
+    if (EngramMixMinus_Apply(&gDevice.mixMinus, clientID, ioCycleInfo->mIOCycleCounter, buffer, ioBufferFrameSize) &&
+        gDevice.stats != NULL) {
+        EngramStats_Add(&gDevice.stats->loopbackCycles, 1);
+    }
+}
+
+// Per client, before its output joins the mix. The client's buffer is
+// scrubbed in place; anything stateful waits for WriteMix, which sees each
+// cycle once rather than once per client.
+static void EngramDevice_ProcessOutput(UInt32 clientID, UInt32 ioBufferFrameSize, const AudioServerPlugInIOCycleInfo* ioCycleInfo, Float32* buffer) {
+    UInt32 scrubbed = EngramDSP_ScrubNonFinite(buffer, ioBufferFrameSize * gDevice.channels);
+    if (scrubbed != 0 && gDevice.stats != NULL) {
+        EngramStats_Add(&gDevice.stats->outputSamplesScrubbed, scrubbed);
+    }
+    // Kept so this client's ProcessInput can take it back out of the loopback
+    EngramMixMinus_Contribute(&gDevice.mixMinus, clientID, ioCycleInfo->mIOCycleCounter, buffer, ioBufferFrameSize);
+}
+
+// Once per cycle, with every client mixed: the output chain runs over the mix
+// in place and the result is queued for EngramDevice_ReadOutput. A full ring
+// drops the newest samples, as the input ring does, so the IO thread never waits.
+static void EngramDevice_WriteMix(UInt32 ioBufferFrameSize, const AudioServerPlugInIOCycleInfo* ioCycleInfo, Float32* buffer) {
+    ENGRAM_DENORMAL_GUARD();
+
+    // Loopback takes the mix as the clients made it, before the output chain,
+    // so each client's contribution subtracts out exactly
+    UInt32 samples = ioBufferFrameSize * gDevice.channels;
+    EngramMixMinus_CaptureMix(&gDevice.mixMinus, ioCycleInfo->mIOCycleCounter, buffer, ioBufferFrameSize);
+    if (gDevice.outputDsp != NULL) {
+        EngramDSPChain_Process(gDevice.outputDsp, buffer, ioBufferFrameSize);
+    }
+    EngramRingBuffer_Write(&gDevice.outputRing, buffer, samples);
+
+    EngramStatsPage* stats = gDevice.stats;
+    if (stats != NULL) {
+        EngramStats_Add(&stats->mixCycles, 1);
+        stats->mixOverrunSamples.store(gDevice.outputRing.overrunSamples.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+}
+
+// Every operation runs in place. Should the HAL hand over a separate
+// destination anyway, the samples are moved there once and processed there.
+static inline Float32* EngramDevice_OperationBuffer(UInt32 ioBufferFrameSize, void* ioMainBuffer, void* ioSecondaryBuffer) {
+    if (ioSecondaryBuffer == NULL || ioSecondaryBuffer == ioMainBuffer) {
+        return (Float32*)ioMainBuffer;
+    }
+    memcpy(ioSecondaryBuffer, ioMainBuffer, ioBufferFrameSize * gDevice.channels * sizeof(Float32));
+    return (Float32*)ioSecondaryBuffer;
+}
+
+OSStatus EngramDevice_DoIOOperation(AudioServerPlugInDriverRef driver, AudioObjectID deviceObjectID, AudioObjectID streamObjectID, UInt32 clientID, UInt32 operationID, UInt32 ioBufferFrameSize, const AudioServerPlugInIOCycleInfo* ioCycleInfo, void* ioMainBuffer, void* ioSecondaryBuffer) {
+    ENGRAM_ALLOC_GUARD();
+    ENGRAM_CALLBACK_GUARD(kAudioHardwareNotRunningError);
+
+    // The HAL keeps to the advertised range; a cycle outside it would overrun
+    // the shared input copy and the per-cycle tables, so it is refused
+    if (ioBufferFrameSize > kEngramMaxIOBufferFrames) {
+        if (operationID == kAudioServerPlugInIOOperationReadInput && ioMainBuffer != NULL) {
+            memset(ioMainBuffer, 0, (size_t)ioBufferFrameSize * gDevice.channels * sizeof(Float32));
+        }
+        ENGRAM_LOG_RATE_LIMITED(kEngramUnderrunLogIntervalNs, kEngramLogLevelError,
+                                "Refused a %llu-frame IO buffer (cycle %llu, at most %llu)",
+                                (UInt64)ioBufferFrameSize, ioCycleInfo->mIOCycleCounter,
+                                (UInt64)kEngramMaxIOBufferFrames);
+        return kAudioHardwareIllegalOperationError;
+    }
+
+    switch (operationID) {
+        case kAudioServerPlugInIOOperationReadInput:
+            EngramDevice_ReadInput(operationID, ioBufferFrameSize, ioCycleInfo, ioMainBuffer);
+            break;
+        case kAudioServerPlugInIOOperationProcessInput:
+            EngramDevice_ProcessInput(clientID, ioBufferFrameSize, ioCycleInfo, EngramDevice_OperationBuffer(ioBufferFrameSize, ioMainBuffer, ioSecondaryBuffer));
+            break;
+        case kAudioServerPlugInIOOperationProcessOutput:
+            EngramDevice_ProcessOutput(clientID, ioBufferFrameSize, ioCycleInfo, EngramDevice_OperationBuffer(ioBufferFrameSize, ioMainBuffer, ioSecondaryBuffer));
+            break;
+        case kAudioServerPlugInIOOperationWriteMix:
+            EngramDevice_WriteMix(ioBufferFrameSize, ioCycleInfo, EngramDevice_OperationBuffer(ioBufferFrameSize, ioMainBuffer, ioSecondaryBuffer));
+            break;
+        default:
+            break;
+    }
+
+    return kAudioHardwareNoError;
+}
+
+OSStatus EngramDevice_EndIOOperation(AudioServerPlugInDriverRef driver, AudioObjectID deviceObjectID, UInt32 clientID, UInt32 operationID, UInt32 ioBufferFrameSize, const AudioServerPlugInIOCycleInfo* ioCycleInfo) {
+    ENGRAM_ALLOC_GUARD();
+    ENGRAM_CALLBACK_GUARD(kAudioHardwareNotRunningError);
+
+    if (EngramTrace_IsEnabled()) {
+        const AudioTimeStamp* time = EngramDevice_OperationTime(operationID, ioCycleInfo);
+        EngramTrace_RecordEvent(kEngramTraceEventEndIO, mach_absolute_time(), ioCycleInfo->mIOCycleCounter,
+                                time->mHostTime, time->mSampleTime, operationID, ioBufferFrameSize,
+                                EngramDevice_RingFillFrames());
+    }
+
+    return kAudioHardwareNoError;
+}
@@ -0,0 +1,84 @@
+//
+//  EngramIO.h
+//  Engram Virtual Audio Device
+//
+//  IO dispatch: StartIO/StopIO, timestamps and the per-cycle IO operations
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#ifndef EngramIO_h
+#define EngramIO_h
+
+#include <CoreAudio/AudioServerPlugIn.h>
+#include "EngramRender.h"
+
+// MARK: - Producer Interface
+
+// Pushes interleaved samples into the device's input ring for clients to read.
+// Single producer at a time. Returns the number of samples accepted, which
+// is 0 before Create and once the last Release has begun tearing down.
+extern "C" UInt32 EngramDevice_WriteInput(const Float32* samples, UInt32 sampleCount);
+
+// WriteInput tagged with the mach_absolute_time at which the samples were
+// produced (a capture time, say) rather than the time of the call. ReadInput
+// records how long the oldest sample of each cycle sat queued against these
+// stamps, in the stats page's queueResidencyNs.
+extern "C" UInt32 EngramDevice_WriteInputAt(const Float32* samples, UInt32 sampleCount, UInt64 hostTime);
+
+// Sleeps until a client is running IO, so a producer can stop feeding a ring
+// nobody reads. Returns true once IO is running, false after `timeoutNanos`
+// (0 waits without limit) or once teardown begins. Wakes within a fraction of
+// a cycle of the first StartIO. Producers in other processes wait on the
+// gate's mirror in the stats page instead, through EngramStats_WaitForIO.
+extern "C" Boolean EngramDevice_WaitForIO(UInt64 timeoutNanos);
+
+// Sleeps until the ring holds fewer than `thresholdFrames`, so a producer can
+// top it up when it is actually needed rather than polling on a timer. The IO
+// thread wakes it from the read that crosses the threshold. Returns true when
+// the ring is below the threshold, false after `timeoutNanos` (0 waits
+// without limit), once the last client stops IO, or once teardown begins.
+// One waiting producer at a time, like WriteInput.
+extern "C" Boolean EngramDevice_WaitForLowWater(UInt32 thresholdFrames, UInt64 timeoutNanos);
+
+// MARK: - Speaker Interface
+
+// Takes up to `sampleCount` interleaved samples of the clients' mixed output,
+// after the output chain has run over it. Single consumer at a time. Returns
+// the number of samples taken; 0 before Create, once teardown has begun, or
+// when nothing is queued. Mix that is not taken before the ring fills is
+// dropped and counted in the stats page's mixOverrunSamples.
+extern "C" UInt32 EngramDevice_ReadOutput(Float32* samples, UInt32 sampleCount);
+
+// MARK: - Pull Mode
+//
+// Instead of keeping the ring topped up, a producer that can render on demand
+// waits for each cycle's request and renders exactly the frames asked for
+// into request.buffer. BeginIOOperation issues the request; ReadInput waits
+// up to 1/kEngramRenderBudgetDivisor of a cycle for it and reads the ring
+// instead if it is late, so a producer can fall back to pushing at any time.
+// One pull-mode producer at a time.
+
+// Switches pull mode on or off. Off (the default) never waits on a producer.
+extern "C" void EngramDevice_SetPullMode(Boolean enabled);
+
+// Sleeps until a cycle asks for input. Returns true with the request, or
+// false after `timeoutNanos` (0 waits without limit), while no client is
+// running IO or pull mode is off, and once teardown begins. A request that is
+// not completed in time is simply replaced by the next cycle's.
+extern "C" Boolean EngramDevice_WaitForRenderRequest(EngramRenderRequest* outRequest, UInt64 timeoutNanos);
+
+// Hands a rendered request back to the IO thread.
+extern "C" void EngramDevice_CompleteRender(const EngramRenderRequest* request);
+
+// MARK: - IO Callbacks
+
+OSStatus EngramDevice_StartIO(AudioServerPlugInDriverRef driver, AudioObjectID deviceObjectID, UInt32 clientID);
+OSStatus EngramDevice_StopIO(AudioServerPlugInDriverRef driver, AudioObjectID deviceObjectID, UInt32 clientID);
+OSStatus EngramDevice_GetZeroTimeStamp(AudioServerPlugInDriverRef driver, AudioObjectID deviceObjectID, UInt32 clientID, Float64* outSampleTime, UInt64* outHostTime, UInt64* outSeed);
+OSStatus EngramDevice_WillDoIOOperation(AudioServerPlugInDriverRef driver, AudioObjectID deviceObjectID, UInt32 clientID, UInt32 operationID, Boolean* outWillDo, Boolean* outWillDoInPlace);
+OSStatus EngramDevice_BeginIOOperation(AudioServerPlugInDriverRef driver, AudioObjectID deviceObjectID, UInt32 clientID, UInt32 operationID, UInt32 ioBufferFrameSize, const AudioServerPlugInIOCycleInfo* ioCycleInfo);
+OSStatus EngramDevice_DoIOOperation(AudioServerPlugInDriverRef driver, AudioObjectID deviceObjectID, AudioObjectID streamObjectID, UInt32 clientID, UInt32 operationID, UInt32 ioBufferFrameSize, const AudioServerPlugInIOCycleInfo* ioCycleInfo, void* ioMainBuffer, void* ioSecondaryBuffer);
+OSStatus EngramDevice_EndIOOperation(AudioServerPlugInDriverRef driver, AudioObjectID deviceObjectID, UInt32 clientID, UInt32 operationID, UInt32 ioBufferFrameSize, const AudioServerPlugInIOCycleInfo* ioCycleInfo);
+
+#endif /* EngramIO_h */
@@ -0,0 +1,171 @@
+//
+//  EngramLatency.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramLatency.h"
+#include "EngramFiles.h"
+#include <stdio.h>
+#include <string.h>
+
+// MARK: - Records
+
+void EngramLatencyLog_Init(EngramLatencyLog* log) {
+    log->writeIndex.store(0, std::memory_order_relaxed);
+    log->readIndex.store(0, std::memory_order_relaxed);
+    log->dropped.store(0, std::memory_order_relaxed);
+}
+
+Boolean EngramLatencyLog_Push(EngramLatencyLog* log, const EngramLatencyRecord* record) {
+    UInt32 w = log->writeIndex.load(std::memory_order_relaxed);
+    UInt32 r = log->readIndex.load(std::memory_order_acquire);
+    if (w - r >= kEngramLatencyRecordCapacity) {
+        log->dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    log->records[w % kEngramLatencyRecordCapacity] = *record;
+    log->writeIndex.store(w + 1, std::memory_order_release);
+    return true;
+}
+
+UInt32 EngramLatencyLog_Pop(EngramLatencyLog* log, EngramLatencyRecord* outRecords, UInt32 maxRecords) {
+    UInt32 r = log->readIndex.load(std::memory_order_relaxed);
+    UInt32 w = log->writeIndex.load(std::memory_order_acquire);
+    UInt32 count = 0;
+    while (r != w && count < maxRecords) {
+        outRecords[count++] = log->records[r % kEngramLatencyRecordCapacity];
+        r++;
+    }
+    log->readIndex.store(r, std::memory_order_release);
+    return count;
+}
+
+Boolean EngramLatencyLog_AppendCSV(EngramLatencyLog* log, const char* path, Float64 nanosPerHostTick) {
+    FILE* file = EngramFiles_AppendPrivate(path);
+    if (file == NULL) {
+        return false;
+    }
+
+    EngramLatencyRecord records[64];
+    UInt32 count;
+    while ((count = EngramLatencyLog_Pop(log, records, 64)) > 0) {
+        for (UInt32 i = 0; i < count; i++) {
+            fprintf(file, "%llu,%llu,%.0f\n",
+                    (unsigned long long)records[i].sequence,
+                    (unsigned long long)((Float64)records[i].hostTime * nanosPerHostTick),
+                    records[i].sampleTime);
+        }
+    }
+    return fclose(file) == 0;
+}
+
+UInt32 EngramLatency_MakeMLS(Float32* out, UInt32 order) {
+    // Galois LFSR feedback masks for primitive polynomials of degree 2..12
+    static const UInt32 kTaps[13] = {
+        0, 0, 0x3, 0x6, 0xC, 0x14, 0x30, 0x60, 0xB8, 0x110, 0x240, 0x500, 0xE08
+    };
+    if (order < 2 || order > 12) {
+        return 0;
+    }
+
+    UInt32 length = (1u << order) - 1;
+    UInt32 state = 1;
+    for (UInt32 i = 0; i < length; i++) {
+        UInt32 bit = state & 1;
+        out[i] = bit ? 1.0f : -1.0f;
+        state >>= 1;
+        if (bit) {
+            state ^= kTaps[order];
+        }
+    }
+    return length;
+}
+
+// MARK: - Producer-side Generator
+
+void EngramLatencyGenerator_Init(EngramLatencyGenerator* generator, EngramLatencyProbeKind kind,
+                                 UInt32 channels, UInt32 intervalFrames) {
+    generator->kind = kind;
+    generator->channels = channels;
+    generator->intervalFrames = intervalFrames;
+    generator->probeLength = (kind == kEngramLatencyProbeMLS)
+        ? EngramLatency_MakeMLS(generator->mls, kEngramLatencyMLSOrder) : 1;
+    generator->streamFrame = 0;
+    generator->nextProbeFrame = intervalFrames;
+    generator->sequence = 0;
+}
+
+void EngramLatencyGenerator_Render(EngramLatencyGenerator* generator, Float32* samples, UInt32 frames,
+                                   UInt64 hostTime, EngramLatencyLog* probes) {
+    memset(samples, 0, sizeof(Float32) * frames * generator->channels);
+
+    UInt64 blockStart = generator->streamFrame;
+    UInt64 blockEnd = blockStart + frames;
+
+    for (;;) {
+        UInt64 probeStart = generator->nextProbeFrame;
+        UInt64 probeEnd = probeStart + generator->probeLength;
+        if (probeStart >= blockEnd) {
+            break;
+        }
+
+        if (probeStart >= blockStart && probes != NULL) {
+            EngramLatencyRecord record;
+            record.sequence = ++generator->sequence;
+            record.hostTime = hostTime;
+            record.sampleTime = (Float64)probeStart;
+            EngramLatencyLog_Push(probes, &record);
+        }
+
+        UInt64 from = (probeStart > blockStart) ? probeStart : blockStart;
+        UInt64 to = (probeEnd < blockEnd) ? probeEnd : blockEnd;
+        for (UInt64 frame = from; frame < to; frame++) {
+            Float32 chip = (generator->kind == kEngramLatencyProbeMLS)
+                ? generator->mls[frame - probeStart] * kEngramLatencyAmplitude : 1.0f;
+            Float32* out = samples + (frame - blockStart) * generator->channels;
+            for (UInt32 channel = 0; channel < generator->channels; channel++) {
+                out[channel] = chip;
+            }
+        }
+
+        if (probeEnd > blockEnd) {
+            // Probe continues into the next block
+            break;
+        }
+        generator->nextProbeFrame += generator->intervalFrames;
+    }
+
+    generator->streamFrame = blockEnd;
+}
+
+// MARK: - Device-side Detector
+
+void EngramLatencyDetector_Init(EngramLatencyDetector* detector, UInt32 channels, UInt32 holdoffFrames) {
+    detector->channels = channels;
+    detector->holdoffFrames = holdoffFrames;
+    detector->holdoffRemaining = 0;
+    detector->sequence = 0;
+}
+
+SInt32 EngramLatencyDetector_Scan(EngramLatencyDetector* detector, const Float32* samples, UInt32 frames) {
+    SInt32 onset = -1;
+
+    for (UInt32 frame = 0; frame < frames; frame++) {
+        if (detector->holdoffRemaining > 0) {
+            detector->holdoffRemaining--;
+            continue;
+        }
+        // Probes are written identically to every channel; the first is enough
+        Float32 sample = samples[frame * detector->channels];
+        if (sample > kEngramLatencyThreshold || sample < -kEngramLatencyThreshold) {
+            if (onset < 0) {
+                onset = (SInt32)frame;
+            }
+            detector->holdoffRemaining = detector->holdoffFrames;
+        }
+    }
+    return onset;
+}
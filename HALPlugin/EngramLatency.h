@@ -0,0 +1,95 @@
+//
+//  EngramLatency.h
+//  Engram Virtual Audio Device
+//
+//  Calibration probes for measuring producer-to-client latency
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#ifndef EngramLatency_h
+#define EngramLatency_h
+
+#include "EngramTypes.h"
+#include <atomic>
+
+// Probes are spaced far enough apart that one always arrives before the next
+// is sent, which is what lets the analysis pair them up by order.
+#define kEngramLatencyDefaultIntervalFrames 12000   // 250 ms at 48 kHz
+#define kEngramLatencyMLSOrder 10                   // 1023-chip sequence
+#define kEngramLatencyMaxMLSLength ((1u << 12) - 1)
+#define kEngramLatencyAmplitude 0.5f
+// Onset detector: anything above this after a quiet stretch is a probe
+#define kEngramLatencyThreshold 0.25f
+#define kEngramLatencyRecordCapacity 256
+// Arrivals are appended here, in the diagnostics directory, when calibration stops
+#define kEngramLatencyArrivalsFileName "engram-hal-latency.csv"
+
+typedef enum {
+    kEngramLatencyProbeImpulse = 0,   // single full-scale sample
+    kEngramLatencyProbeMLS            // maximum-length sequence, robust to processing
+} EngramLatencyProbeKind;
+
+// MARK: - Records
+
+// One probe leaving the producer, or arriving at the end of DoIOOperation.
+typedef struct {
+    UInt64 sequence;
+    UInt64 hostTime;        // producer write time, or DoIOOperation exit time
+    Float64 sampleTime;     // producer stream frame, or device sample time of the onset
+} EngramLatencyRecord;
+
+// Single-producer / single-consumer record queue; full queues drop records.
+typedef struct {
+    std::atomic<UInt32> writeIndex;
+    std::atomic<UInt32> readIndex;
+    std::atomic<UInt64> dropped;
+    EngramLatencyRecord records[kEngramLatencyRecordCapacity];
+} EngramLatencyLog;
+
+void EngramLatencyLog_Init(EngramLatencyLog* log);
+Boolean EngramLatencyLog_Push(EngramLatencyLog* log, const EngramLatencyRecord* record);
+UInt32 EngramLatencyLog_Pop(EngramLatencyLog* log, EngramLatencyRecord* outRecords, UInt32 maxRecords);
+// Appends "sequence,hostTimeNanos,sampleTime" lines for everything queued to
+// a private file (see EngramFiles_AppendPrivate). Not real-time safe.
+Boolean EngramLatencyLog_AppendCSV(EngramLatencyLog* log, const char* path, Float64 nanosPerHostTick);
+
+// Fills `out` with a +/-1 maximum-length sequence of 2^order - 1 chips.
+UInt32 EngramLatency_MakeMLS(Float32* out, UInt32 order);
+
+// MARK: - Producer-side Generator
+
+typedef struct {
+    EngramLatencyProbeKind kind;
+    UInt32 channels;
+    UInt32 intervalFrames;
+    UInt32 probeLength;     // frames per probe
+    UInt64 streamFrame;     // frames rendered so far
+    UInt64 nextProbeFrame;
+    UInt64 sequence;
+    Float32 mls[kEngramLatencyMaxMLSLength];
+} EngramLatencyGenerator;
+
+void EngramLatencyGenerator_Init(EngramLatencyGenerator* generator, EngramLatencyProbeKind kind,
+                                 UInt32 channels, UInt32 intervalFrames);
+// Renders `frames` interleaved frames of silence with probes. `hostTime` is
+// when the block will be handed to the ring; each probe that starts in the
+// block is logged with it.
+void EngramLatencyGenerator_Render(EngramLatencyGenerator* generator, Float32* samples, UInt32 frames,
+                                   UInt64 hostTime, EngramLatencyLog* probes);
+
+// MARK: - Device-side Detector
+
+typedef struct {
+    UInt32 channels;
+    UInt32 holdoffFrames;   // frames to ignore after an onset (the rest of the probe)
+    UInt32 holdoffRemaining;
+    UInt64 sequence;
+} EngramLatencyDetector;
+
+void EngramLatencyDetector_Init(EngramLatencyDetector* detector, UInt32 channels, UInt32 holdoffFrames);
+// Real-time safe. Returns the frame offset of a probe onset in the block, or
+// -1 when there is none.
+SInt32 EngramLatencyDetector_Scan(EngramLatencyDetector* detector, const Float32* samples, UInt32 frames);
+
+#endif /* EngramLatency_h */
@@ -0,0 +1,319 @@
+//
+//  EngramLog.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramLog.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__APPLE__)
+#include <mach/mach_time.h>
+#include <os/log.h>
+#else
+#include <time.h>
+#endif
+
+// MARK: - Queue Storage
+//
+// Bounded multi-producer / single-consumer queue. Each slot carries a turn
+// counter: 2*lap means free for that lap, 2*lap+1 means it holds the record
+// written during that lap. Zeroed storage is therefore a valid empty queue,
+// so pushing never depends on an initialiser having run.
+
+typedef struct {
+    std::atomic<UInt64> turn;
+    EngramLogRecord record;
+} EngramLogSlot;
+
+static EngramLogSlot gLogSlots[kEngramLogCapacity];
+static std::atomic<UInt64> gLogEnqueuePos;
+static UInt64 gLogDequeuePos = 0;
+static std::atomic<UInt64> gLogDropped;
+static std::atomic<UInt32> gLogMinLevel(kEngramLogLevelInfo);
+
+static pthread_t gLogThread;
+static pthread_mutex_t gLogThreadLock = PTHREAD_MUTEX_INITIALIZER;
+static std::atomic<Boolean> gLogThreadRunning;
+static std::atomic<Boolean> gLogStopRequested;
+
+static_assert((kEngramLogCapacity & (kEngramLogCapacity - 1)) == 0, "kEngramLogCapacity must be a power of two");
+
+// MARK: - Clock
+
+UInt64 EngramLog_NowNanos(void) {
+#if defined(__APPLE__)
+    static mach_timebase_info_data_t sTimebase;
+    if (sTimebase.denom == 0) {
+        mach_timebase_info(&sTimebase);
+    }
+    return mach_absolute_time() * sTimebase.numer / sTimebase.denom;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (UInt64)ts.tv_sec * 1000000000ull + (UInt64)ts.tv_nsec;
+#endif
+}
+
+// MARK: - Producer API
+
+static Boolean EngramLog_Enqueue(EngramLogLevel level, const char* format, UInt32 suppressed,
+                                 UInt64 a0, UInt64 a1, UInt64 a2, UInt64 a3) {
+    UInt64 pos = gLogEnqueuePos.load(std::memory_order_relaxed);
+    EngramLogSlot* slot;
+
+    for (;;) {
+        slot = &gLogSlots[pos & (kEngramLogCapacity - 1)];
+        UInt64 turn = slot->turn.load(std::memory_order_acquire);
+        UInt64 expected = 2 * (pos / kEngramLogCapacity);
+
+        if (turn == expected) {
+            if (gLogEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (turn < expected) {
+            // The drain thread has not caught up with this slot yet: drop.
+            gLogDropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = gLogEnqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    EngramLogRecord* record = &slot->record;
+    record->hostNanos = EngramLog_NowNanos();
+    record->format = format;
+    record->args[0] = a0;
+    record->args[1] = a1;
+    record->args[2] = a2;
+    record->args[3] = a3;
+    record->suppressed = suppressed;
+    record->level = (UInt8)level;
+
+    slot->turn.store(2 * (pos / kEngramLogCapacity) + 1, std::memory_order_release);
+    return true;
+}
+
+Boolean EngramLog_Push(EngramLogLevel level, const char* format, UInt64 a0, UInt64 a1, UInt64 a2, UInt64 a3) {
+    if ((UInt32)level < gLogMinLevel.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    return EngramLog_Enqueue(level, format, 0, a0, a1, a2, a3);
+}
+
+Boolean EngramLog_PushRateLimited(EngramLogRateLimiter* limiter, UInt64 intervalNanos,
+                                  EngramLogLevel level, const char* format,
+                                  UInt64 a0, UInt64 a1, UInt64 a2, UInt64 a3) {
+    if ((UInt32)level < gLogMinLevel.load(std::memory_order_relaxed)) {
+        return false;
+    }
+
+    UInt64 now = EngramLog_NowNanos();
+    UInt64 nextAllowed = limiter->nextAllowedNanos.load(std::memory_order_relaxed);
+
+    if (now < nextAllowed ||
+        !limiter->nextAllowedNanos.compare_exchange_strong(nextAllowed, now + intervalNanos, std::memory_order_relaxed)) {
+        limiter->suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    UInt32 suppressed = limiter->suppressed.exchange(0, std::memory_order_relaxed);
+    return EngramLog_Enqueue(level, format, suppressed, a0, a1, a2, a3);
+}
+
+void EngramLog_SetMinLevel(EngramLogLevel level) {
+    gLogMinLevel.store((UInt32)level, std::memory_order_relaxed);
+}
+
+UInt64 EngramLog_GetDroppedCount(void) {
+    return gLogDropped.load(std::memory_order_relaxed);
+}
+
+// MARK: - Consumer
+
+static Boolean EngramLog_PopOne(EngramLogRecord* outRecord) {
+    EngramLogSlot* slot = &gLogSlots[gLogDequeuePos & (kEngramLogCapacity - 1)];
+    UInt64 lap = gLogDequeuePos / kEngramLogCapacity;
+
+    if (slot->turn.load(std::memory_order_acquire) != 2 * lap + 1) {
+        return false;
+    }
+
+    *outRecord = slot->record;
+    slot->turn.store(2 * (lap + 1), std::memory_order_release);
+    gLogDequeuePos++;
+    return true;
+}
+
+UInt32 EngramLog_PopRecords(EngramLogRecord* outRecords, UInt32 maxRecords) {
+    UInt32 count = 0;
+    while (count < maxRecords && EngramLog_PopOne(&outRecords[count])) {
+        count++;
+    }
+    return count;
+}
+
+static const char* EngramLog_LevelName(UInt8 level) {
+    switch (level) {
+        case kEngramLogLevelDebug:   return "debug";
+        case kEngramLogLevelInfo:    return "info";
+        case kEngramLogLevelNotice:  return "notice";
+        case kEngramLogLevelWarning: return "warning";
+        default:                     return "error";
+    }
+}
+
+void EngramLog_FormatRecord(const EngramLogRecord* record, char* buffer, UInt32 bufferSize) {
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+    int length = snprintf(buffer, bufferSize, record->format,
+                          (unsigned long long)record->args[0], (unsigned long long)record->args[1],
+                          (unsigned long long)record->args[2], (unsigned long long)record->args[3]);
+#pragma GCC diagnostic pop
+
+    if (record->suppressed > 0 && length >= 0 && (UInt32)length < bufferSize) {
+        snprintf(buffer + length, bufferSize - (UInt32)length, " (+%u suppressed)", record->suppressed);
+    }
+}
+
+// MARK: - Sinks
+
+#if defined(__APPLE__)
+
+static os_log_t gLogHandle = NULL;
+
+static void EngramLog_OpenSink(void) {
+    if (gLogHandle == NULL) {
+        gLogHandle = os_log_create("dev.balakumar.engram.hal", "plugin");
+    }
+}
+
+static void EngramLog_Emit(const EngramLogRecord* record, const char* line) {
+    os_log_type_t type;
+    switch (record->level) {
+        case kEngramLogLevelDebug: type = OS_LOG_TYPE_DEBUG; break;
+        case kEngramLogLevelInfo:  type = OS_LOG_TYPE_INFO; break;
+        case kEngramLogLevelError: type = OS_LOG_TYPE_ERROR; break;
+        default:                   type = OS_LOG_TYPE_DEFAULT; break;
+    }
+    os_log_with_type(gLogHandle, type, "%{public}s: %{public}s", EngramLog_LevelName(record->level), line);
+}
+
+static void EngramLog_CloseSink(void) {
+}
+
+#else
+
+static FILE* gLogFile = NULL;
+
+// Linux builds write to $ENGRAM_HAL_LOG_FILE when set, otherwise stderr.
+static void EngramLog_OpenSink(void) {
+    if (gLogFile != NULL) {
+        return;
+    }
+    const char* path = getenv("ENGRAM_HAL_LOG_FILE");
+    if (path != NULL && path[0] != '\0') {
+        gLogFile = fopen(path, "a");
+    }
+    if (gLogFile == NULL) {
+        gLogFile = stderr;
+    }
+}
+
+static void EngramLog_Emit(const EngramLogRecord* record, const char* line) {
+    fprintf(gLogFile, "[%llu.%09llu] engram-hal %s: %s\n",
+            (unsigned long long)(record->hostNanos / 1000000000ull),
+            (unsigned long long)(record->hostNanos % 1000000000ull),
+            EngramLog_LevelName(record->level), line);
+}
+
+static void EngramLog_CloseSink(void) {
+    if (gLogFile != NULL) {
+        fflush(gLogFile);
+        if (gLogFile != stderr) {
+            fclose(gLogFile);
+        }
+        gLogFile = NULL;
+    }
+}
+
+#endif
+
+// MARK: - Drain Thread
+
+static void EngramLog_DrainPending(void) {
+    EngramLogRecord record;
+    char line[512];
+    Boolean emitted = false;
+
+    while (EngramLog_PopOne(&record)) {
+        EngramLog_FormatRecord(&record, line, sizeof(line));
+        EngramLog_Emit(&record, line);
+        emitted = true;
+    }
+
+#if !defined(__APPLE__)
+    if (emitted) {
+        fflush(gLogFile);
+    }
+#else
+    (void)emitted;
+#endif
+}
+
+static void* EngramLog_DrainThread(void* context) {
+#if defined(__APPLE__)
+    pthread_set_qos_class_self_np(QOS_CLASS_UTILITY, 0);
+#endif
+
+    while (!gLogStopRequested.load(std::memory_order_acquire)) {
+        EngramLog_DrainPending();
+        usleep(kEngramLogDrainIntervalUs);
+    }
+
+    EngramLog_DrainPending();
+    return NULL;
+}
+
+void EngramLog_Start(void) {
+    pthread_mutex_lock(&gLogThreadLock);
+
+    if (!gLogThreadRunning.load(std::memory_order_relaxed)) {
+        EngramLog_OpenSink();
+        gLogStopRequested.store(false, std::memory_order_release);
+
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+#if !defined(__APPLE__)
+        // Leave the default SCHED_OTHER policy but make sure we never inherit
+        // a real-time policy from the thread that happened to call Start.
+        pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+        pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+#endif
+        if (pthread_create(&gLogThread, &attr, EngramLog_DrainThread, NULL) == 0) {
+            gLogThreadRunning.store(true, std::memory_order_relaxed);
+        }
+        pthread_attr_destroy(&attr);
+    }
+
+    pthread_mutex_unlock(&gLogThreadLock);
+}
+
+void EngramLog_Stop(void) {
+    pthread_mutex_lock(&gLogThreadLock);
+
+    if (gLogThreadRunning.load(std::memory_order_relaxed)) {
+        gLogStopRequested.store(true, std::memory_order_release);
+        pthread_join(gLogThread, NULL);
+        gLogThreadRunning.store(false, std::memory_order_relaxed);
+        EngramLog_CloseSink();
+    }
+
+    pthread_mutex_unlock(&gLogThreadLock);
+}
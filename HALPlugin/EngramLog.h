@@ -0,0 +1,87 @@
+//
+//  EngramLog.h
+//  Engram Virtual Audio Device
+//
+//  Lock-free deferred logging for real-time code paths
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#ifndef EngramLog_h
+#define EngramLog_h
+
+#include "EngramTypes.h"
+#include <atomic>
+
+// Number of in-flight records (power of two). Pushes beyond this are dropped
+// and counted rather than blocking the caller.
+#define kEngramLogCapacity 1024
+#define kEngramLogMaxArgs 4
+#define kEngramLogDrainIntervalUs 10000
+
+// MARK: - Records
+
+typedef enum {
+    kEngramLogLevelDebug = 0,
+    kEngramLogLevelInfo,
+    kEngramLogLevelNotice,
+    kEngramLogLevelWarning,
+    kEngramLogLevelError
+} EngramLogLevel;
+
+// A fixed-size record. `format` must be a string literal whose conversions all
+// consume 64-bit integers (%llu, %lld, %llx); it is formatted on the drain
+// thread, never on the caller's thread.
+typedef struct {
+    UInt64 hostNanos;
+    const char* format;
+    UInt64 args[kEngramLogMaxArgs];
+    UInt32 suppressed;
+    UInt8 level;
+} EngramLogRecord;
+
+// Per-call-site state for rate-limited events such as underruns. Declare as a
+// function-level static; zero-initialised storage is a valid initial state.
+typedef struct {
+    std::atomic<UInt64> nextAllowedNanos;
+    std::atomic<UInt32> suppressed;
+} EngramLogRateLimiter;
+
+// MARK: - Producer API (real-time safe)
+
+Boolean EngramLog_Push(EngramLogLevel level, const char* format,
+                       UInt64 a0 = 0, UInt64 a1 = 0, UInt64 a2 = 0, UInt64 a3 = 0);
+Boolean EngramLog_PushRateLimited(EngramLogRateLimiter* limiter, UInt64 intervalNanos,
+                                  EngramLogLevel level, const char* format,
+                                  UInt64 a0 = 0, UInt64 a1 = 0, UInt64 a2 = 0, UInt64 a3 = 0);
+void EngramLog_SetMinLevel(EngramLogLevel level);
+UInt64 EngramLog_GetDroppedCount(void);
+UInt64 EngramLog_NowNanos(void);
+
+// MARK: - Drain
+
+// Starts the low-priority drain thread. Safe to call more than once.
+void EngramLog_Start(void);
+// Stops the drain thread after emitting everything still queued.
+void EngramLog_Stop(void);
+// Pops up to `maxRecords` records without emitting them. Intended for tests and
+// tools; must not be called while the drain thread is running.
+UInt32 EngramLog_PopRecords(EngramLogRecord* outRecords, UInt32 maxRecords);
+// Formats a record into `buffer` as a single line without a trailing newline.
+void EngramLog_FormatRecord(const EngramLogRecord* record, char* buffer, UInt32 bufferSize);
+
+#define ENGRAM_LOG_DEBUG(...)   EngramLog_Push(kEngramLogLevelDebug, __VA_ARGS__)
+#define ENGRAM_LOG_INFO(...)    EngramLog_Push(kEngramLogLevelInfo, __VA_ARGS__)
+#define ENGRAM_LOG_NOTICE(...)  EngramLog_Push(kEngramLogLevelNotice, __VA_ARGS__)
+#define ENGRAM_LOG_WARNING(...) EngramLog_Push(kEngramLogLevelWarning, __VA_ARGS__)
+#define ENGRAM_LOG_ERROR(...)   EngramLog_Push(kEngramLogLevelError, __VA_ARGS__)
+
+// Emits at most one record per `intervalNanos` from this call site; the next
+// emitted record carries the number of suppressed repeats.
+#define ENGRAM_LOG_RATE_LIMITED(intervalNanos, level, ...)                            \
+    do {                                                                              \
+        static EngramLogRateLimiter sEngramLogLimiter;                                \
+        EngramLog_PushRateLimited(&sEngramLogLimiter, (intervalNanos), (level), __VA_ARGS__); \
+    } while (0)
+
+#endif /* EngramLog_h */
@@ -0,0 +1,134 @@
+//
+//  EngramMixMinus.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramMixMinus.h"
+#include "EngramSIMD.h"
+#include <string.h>
+
+static inline size_t EngramMixMinus_BufferBytes(UInt32 channels) {
+    return sizeof(Float32) * (size_t)kEngramMixMinusMaxFrames * channels;
+}
+
+size_t EngramMixMinus_RequiredBytes(UInt32 channels) {
+    return (kEngramMixMinusMaxClients + 1) * EngramArena_AlignedSize(EngramMixMinus_BufferBytes(channels));
+}
+
+void EngramMixMinus_Init(EngramMixMinus* mixMinus, EngramArena* arena, UInt32 channels) {
+    mixMinus->enabled.store(false, std::memory_order_relaxed);
+    mixMinus->channels = channels;
+
+    mixMinus->mixCycle = 0;
+    mixMinus->mixFrames = 0;
+    mixMinus->mixValid = false;
+    mixMinus->mix = ENGRAM_ARENA_NEW_ARRAY(arena, Float32, (size_t)kEngramMixMinusMaxFrames * channels);
+
+    for (UInt32 i = 0; i < kEngramMixMinusMaxClients; i++) {
+        EngramMixMinusSlot* slot = &mixMinus->slots[i];
+        slot->clientID.store(kEngramMixMinusNoClient, std::memory_order_relaxed);
+        slot->cycle.store(kEngramMixMinusNoCycle, std::memory_order_relaxed);
+        slot->frames = 0;
+        slot->contribution = ENGRAM_ARENA_NEW_ARRAY(arena, Float32, (size_t)kEngramMixMinusMaxFrames * channels);
+    }
+}
+
+// MARK: - Clients
+
+static EngramMixMinusSlot* EngramMixMinus_FindSlot(EngramMixMinus* mixMinus, UInt32 clientID) {
+    for (UInt32 i = 0; i < kEngramMixMinusMaxClients; i++) {
+        if (mixMinus->slots[i].clientID.load(std::memory_order_acquire) == clientID) {
+            return &mixMinus->slots[i];
+        }
+    }
+    return NULL;
+}
+
+Boolean EngramMixMinus_Attach(EngramMixMinus* mixMinus, UInt32 clientID) {
+    if (clientID == kEngramMixMinusNoClient || clientID == kEngramMixMinusClaiming) {
+        return false;
+    }
+    if (EngramMixMinus_FindSlot(mixMinus, clientID) != NULL) {
+        return true;
+    }
+
+    for (UInt32 i = 0; i < kEngramMixMinusMaxClients; i++) {
+        EngramMixMinusSlot* slot = &mixMinus->slots[i];
+        if (slot->contribution == NULL) {
+            continue;
+        }
+        // Won first, then cleared of whatever the last client left in it,
+        // and only then found under the new client's ID
+        UInt32 expected = kEngramMixMinusNoClient;
+        if (slot->clientID.compare_exchange_strong(expected, kEngramMixMinusClaiming, std::memory_order_seq_cst)) {
+            slot->cycle.store(kEngramMixMinusNoCycle, std::memory_order_seq_cst);
+            slot->clientID.store(clientID, std::memory_order_seq_cst);
+            return true;
+        }
+    }
+    return false;
+}
+
+void EngramMixMinus_Detach(EngramMixMinus* mixMinus, UInt32 clientID) {
+    EngramMixMinusSlot* slot = EngramMixMinus_FindSlot(mixMinus, clientID);
+    if (slot != NULL) {
+        slot->cycle.store(kEngramMixMinusNoCycle, std::memory_order_seq_cst);
+        slot->clientID.store(kEngramMixMinusNoClient, std::memory_order_seq_cst);
+    }
+}
+
+// MARK: - IO Thread
+
+void EngramMixMinus_Contribute(EngramMixMinus* mixMinus, UInt32 clientID, UInt64 cycle,
+                               const Float32* samples, UInt32 frames) {
+    if (!mixMinus->enabled.load(std::memory_order_relaxed) || frames > kEngramMixMinusMaxFrames) {
+        return;
+    }
+    EngramMixMinusSlot* slot = EngramMixMinus_FindSlot(mixMinus, clientID);
+    if (slot == NULL) {
+        return;
+    }
+
+    memcpy(slot->contribution, samples, sizeof(Float32) * (size_t)frames * mixMinus->channels);
+    slot->frames = frames;
+    slot->cycle.store(cycle, std::memory_order_seq_cst);
+    // The client left while this was being written: whoever claims the slot
+    // next must not find it
+    if (slot->clientID.load(std::memory_order_seq_cst) != clientID) {
+        slot->cycle.store(kEngramMixMinusNoCycle, std::memory_order_seq_cst);
+    }
+}
+
+void EngramMixMinus_CaptureMix(EngramMixMinus* mixMinus, UInt64 cycle, const Float32* mix, UInt32 frames) {
+    mixMinus->mixValid = false;
+    if (!mixMinus->enabled.load(std::memory_order_relaxed) || frames > kEngramMixMinusMaxFrames ||
+        mixMinus->mix == NULL) {
+        return;
+    }
+
+    memcpy(mixMinus->mix, mix, sizeof(Float32) * (size_t)frames * mixMinus->channels);
+    mixMinus->mixCycle = cycle;
+    mixMinus->mixFrames = frames;
+    mixMinus->mixValid = true;
+}
+
+Boolean EngramMixMinus_Apply(EngramMixMinus* mixMinus, UInt32 clientID, UInt64 cycle, Float32* samples, UInt32 frames) {
+    if (!mixMinus->enabled.load(std::memory_order_relaxed) || !mixMinus->mixValid ||
+        mixMinus->mixFrames != frames || mixMinus->mixCycle > cycle || mixMinus->mixCycle + 1 < cycle) {
+        return false;
+    }
+
+    const EngramSIMDKernels* simd = EngramSIMD_Kernels();
+    UInt32 count = frames * mixMinus->channels;
+    simd->mix(samples, mixMinus->mix, 1.0f, count);
+
+    // A client that played nothing into this mix hears all of it
+    EngramMixMinusSlot* slot = EngramMixMinus_FindSlot(mixMinus, clientID);
+    if (slot != NULL && slot->cycle.load(std::memory_order_seq_cst) == mixMinus->mixCycle && slot->frames == frames) {
+        simd->mix(samples, slot->contribution, -1.0f, count);
+    }
+    return true;
+}
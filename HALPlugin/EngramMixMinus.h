@@ -0,0 +1,84 @@
+//
+//  EngramMixMinus.h
+//  Engram Virtual Audio Device
+//
+//  Loopback with mix-minus: every client's input also carries what the other
+//  clients played to the device in the previous cycle, never its own output.
+//  ProcessOutput keeps a copy of each client's contribution, WriteMix keeps
+//  the mix, and ProcessInput adds the mix less that client's own copy on top
+//  of the input ReadInput shared out. The loopback stays out of the input
+//  chain, which runs once per cycle for every client alike.
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#ifndef EngramMixMinus_h
+#define EngramMixMinus_h
+
+#include "EngramArena.h"
+#include "EngramTypes.h"
+#include <atomic>
+#include <stdint.h>
+
+// Clients that can take part at once; later ones hear the whole mix, their
+// own output included
+#define kEngramMixMinusMaxClients 8
+// Largest IO buffer that is looped back; bigger cycles carry no loopback
+#define kEngramMixMinusMaxFrames 4096
+
+#define kEngramMixMinusNoClient 0xFFFFFFFFu
+// Held by a slot while Attach readies it for its new client
+#define kEngramMixMinusClaiming 0xFFFFFFFEu
+// The cycle of a slot holding no contribution
+#define kEngramMixMinusNoCycle UINT64_MAX
+
+typedef struct {
+    // Claimed by StartIO and freed by StopIO, on whatever thread they run
+    std::atomic<UInt32> clientID;
+
+    // The cycle `contribution` holds. Written by the IO thread, and reset to
+    // kEngramMixMinusNoCycle whenever the slot changes hands.
+    std::atomic<UInt64> cycle;
+    // Owned by the IO thread: the size `contribution` holds
+    UInt32 frames;
+    Float32* contribution;
+} EngramMixMinusSlot;
+
+typedef struct {
+    std::atomic<Boolean> enabled;
+    UInt32 channels;
+
+    // Owned by the IO thread: the most recent mix, before the output chain
+    UInt64 mixCycle;
+    UInt32 mixFrames;
+    Boolean mixValid;
+    Float32* mix;
+
+    EngramMixMinusSlot slots[kEngramMixMinusMaxClients];
+} EngramMixMinus;
+
+size_t EngramMixMinus_RequiredBytes(UInt32 channels);
+// Loopback starts off. Storage comes from the arena.
+void EngramMixMinus_Init(EngramMixMinus* mixMinus, EngramArena* arena, UInt32 channels);
+
+// MARK: - Clients
+
+// Gives a client starting IO a contribution slot; false when all are taken.
+// A slot never carries a contribution from one client over to the next.
+Boolean EngramMixMinus_Attach(EngramMixMinus* mixMinus, UInt32 clientID);
+void EngramMixMinus_Detach(EngramMixMinus* mixMinus, UInt32 clientID);
+
+// MARK: - IO Thread
+
+// ProcessOutput: keeps the client's share of this cycle's mix.
+void EngramMixMinus_Contribute(EngramMixMinus* mixMinus, UInt32 clientID, UInt64 cycle,
+                               const Float32* samples, UInt32 frames);
+// WriteMix: keeps the cycle's mix, as the HAL summed it from the contributions.
+void EngramMixMinus_CaptureMix(EngramMixMinus* mixMinus, UInt64 cycle, const Float32* mix, UInt32 frames);
+// ProcessInput: adds the latest mix, less this client's contribution to it,
+// to the client's input in place. Only a mix from this cycle or the one before
+// is used, so loopback stops with the output rather than repeating its last
+// buffer. Returns true if anything was added.
+Boolean EngramMixMinus_Apply(EngramMixMinus* mixMinus, UInt32 clientID, UInt64 cycle, Float32* samples, UInt32 frames);
+
+#endif /* EngramMixMinus_h */
@@ -0,0 +1,192 @@
+//
+//  EngramNotify.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramNotify.h"
+#include "EngramLog.h"
+#include "EngramWait.h"
+#include <pthread.h>
+
+#define kEngramNotifyStopBit 0x80000000u
+
+typedef struct {
+    AudioObjectID objectID;
+    AudioObjectPropertyAddress address;
+} EngramNotifyTarget;
+
+// Targets are written before gTargetCount publishes them and only cleared
+// once the delivery thread has stopped and no callbacks can be posting.
+static EngramNotifyTarget gTargets[kEngramNotifyMaxTargets];
+static std::atomic<UInt32> gTargetCount(0);
+
+// One bit per target, plus kEngramNotifyStopBit; the word the thread sleeps on
+static std::atomic<UInt32> gPending(0);
+
+static std::atomic<UInt64> gPosted(0);
+static std::atomic<UInt64> gCoalesced(0);
+static std::atomic<UInt64> gBatches(0);
+static std::atomic<UInt64> gDelivered(0);
+
+static pthread_t gNotifyThread;
+static pthread_mutex_t gNotifyThreadLock = PTHREAD_MUTEX_INITIALIZER;
+static std::atomic<Boolean> gNotifyRunning(false);
+static AudioServerPlugInHostRef gNotifyHost = NULL;
+
+// MARK: - Targets
+
+Boolean EngramNotify_Register(AudioObjectID objectID, AudioObjectPropertySelector selector,
+                              AudioObjectPropertyScope scope, AudioObjectPropertyElement element) {
+    UInt32 count = gTargetCount.load(std::memory_order_relaxed);
+    for (UInt32 i = 0; i < count; i++) {
+        if (gTargets[i].objectID == objectID && gTargets[i].address.mSelector == selector) {
+            return true;
+        }
+    }
+    if (count >= kEngramNotifyMaxTargets) {
+        return false;
+    }
+
+    gTargets[count].objectID = objectID;
+    gTargets[count].address.mSelector = selector;
+    gTargets[count].address.mScope = scope;
+    gTargets[count].address.mElement = element;
+    gTargetCount.store(count + 1, std::memory_order_release);
+    return true;
+}
+
+void EngramNotify_Post(AudioObjectID objectID, AudioObjectPropertySelector selector) {
+    if (!gNotifyRunning.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    UInt32 count = gTargetCount.load(std::memory_order_acquire);
+    for (UInt32 i = 0; i < count; i++) {
+        if (gTargets[i].objectID != objectID || gTargets[i].address.mSelector != selector) {
+            continue;
+        }
+        UInt32 bit = 1u << i;
+        UInt32 previous = gPending.fetch_or(bit, std::memory_order_release);
+        gPosted.fetch_add(1, std::memory_order_relaxed);
+        if (previous & bit) {
+            gCoalesced.fetch_add(1, std::memory_order_relaxed);
+        } else if (previous == 0) {
+            // The thread sleeps only while nothing is pending
+            EngramWait_WakeAll(&gPending);
+        }
+        return;
+    }
+}
+
+// MARK: - Delivery Thread
+
+// One PropertiesChanged call per object, addresses in registration order.
+static void EngramNotify_Deliver(UInt32 bits) {
+    UInt32 count = gTargetCount.load(std::memory_order_acquire);
+    UInt32 remaining = bits & ((1u << count) - 1);
+
+    while (remaining != 0) {
+        AudioObjectID objectID = gTargets[__builtin_ctz(remaining)].objectID;
+        AudioObjectPropertyAddress addresses[kEngramNotifyMaxTargets];
+        UInt32 addressCount = 0;
+        for (UInt32 i = 0; i < count; i++) {
+            UInt32 bit = 1u << i;
+            if ((remaining & bit) != 0 && gTargets[i].objectID == objectID) {
+                addresses[addressCount++] = gTargets[i].address;
+                remaining &= ~bit;
+            }
+        }
+
+        if (addressCount > 0) {
+            OSStatus status = (*gNotifyHost).PropertiesChanged(gNotifyHost, objectID, addressCount, addresses);
+            if (status != kAudioHardwareNoError) {
+                ENGRAM_LOG_WARNING("PropertiesChanged failed (object %llu, status %lld)", objectID, (SInt64)status);
+            }
+            gBatches.fetch_add(1, std::memory_order_relaxed);
+            gDelivered.fetch_add(addressCount, std::memory_order_relaxed);
+        }
+    }
+}
+
+static void* EngramNotify_Thread(void* context) {
+#if defined(__APPLE__)
+    pthread_set_qos_class_self_np(QOS_CLASS_UTILITY, 0);
+#endif
+
+    for (;;) {
+        UInt32 pending = gPending.load(std::memory_order_acquire);
+        if (pending == 0) {
+            EngramWait_WhileEqual(&gPending, 0, 0);
+            continue;
+        }
+
+        // Let the burst that woke us finish before announcing it
+        UInt64 deadline = EngramWait_Now() + kEngramNotifyCoalesceNs;
+        for (UInt64 now = EngramWait_Now(); now < deadline && (pending & kEngramNotifyStopBit) == 0;
+             now = EngramWait_Now()) {
+            EngramWait_WhileEqual(&gPending, pending, deadline - now);
+            pending = gPending.load(std::memory_order_acquire);
+        }
+
+        UInt32 bits = gPending.exchange(0, std::memory_order_acq_rel);
+        EngramNotify_Deliver(bits & ~kEngramNotifyStopBit);
+        if (bits & kEngramNotifyStopBit) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+// MARK: - Lifecycle
+
+void EngramNotify_Start(AudioServerPlugInHostRef host) {
+    if (host == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&gNotifyThreadLock);
+
+    if (!gNotifyRunning.load(std::memory_order_relaxed)) {
+        gNotifyHost = host;
+        gPending.store(0, std::memory_order_relaxed);
+
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+#if !defined(__APPLE__)
+        pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+        pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+#endif
+        if (pthread_create(&gNotifyThread, &attr, EngramNotify_Thread, NULL) == 0) {
+            gNotifyRunning.store(true, std::memory_order_release);
+        }
+        pthread_attr_destroy(&attr);
+    }
+
+    pthread_mutex_unlock(&gNotifyThreadLock);
+}
+
+void EngramNotify_Stop(void) {
+    pthread_mutex_lock(&gNotifyThreadLock);
+
+    if (gNotifyRunning.load(std::memory_order_relaxed)) {
+        gNotifyRunning.store(false, std::memory_order_release);
+        gPending.fetch_or(kEngramNotifyStopBit, std::memory_order_release);
+        EngramWait_WakeAll(&gPending);
+        pthread_join(gNotifyThread, NULL);
+        gNotifyHost = NULL;
+    }
+    gPending.store(0, std::memory_order_relaxed);
+    gTargetCount.store(0, std::memory_order_relaxed);
+
+    pthread_mutex_unlock(&gNotifyThreadLock);
+}
+
+void EngramNotify_GetCounters(EngramNotifyCounters* outCounters) {
+    outCounters->posted = gPosted.load(std::memory_order_relaxed);
+    outCounters->coalesced = gCoalesced.load(std::memory_order_relaxed);
+    outCounters->batches = gBatches.load(std::memory_order_relaxed);
+    outCounters->delivered = gDelivered.load(std::memory_order_relaxed);
+}
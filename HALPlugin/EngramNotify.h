@@ -0,0 +1,57 @@
+//
+//  EngramNotify.h
+//  Engram Virtual Audio Device
+//
+//  Coalesced property-change notifications. Any thread, the IO thread
+//  included, marks a registered property as changed; a low-priority thread
+//  collects everything marked within a short window and announces it to the
+//  host in one PropertiesChanged call per object.
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#ifndef EngramNotify_h
+#define EngramNotify_h
+
+#include <CoreAudio/AudioServerPlugIn.h>
+#include "EngramTypes.h"
+#include <atomic>
+
+// One pending bit per target; the top bit asks the delivery thread to stop
+#define kEngramNotifyMaxTargets 31
+// Changes posted this soon after the first one go out in the same batch
+#define kEngramNotifyCoalesceNs 5000000ull
+
+typedef struct {
+    UInt64 posted;       // Post calls for registered targets
+    UInt64 coalesced;    // posts folded into a notification already pending
+    UInt64 batches;      // PropertiesChanged calls made
+    UInt64 delivered;    // property addresses announced across all batches
+} EngramNotifyCounters;
+
+// MARK: - Targets
+
+// Adds a property that may be posted. Call before Start, with nothing posting
+// yet. Returns false once kEngramNotifyMaxTargets are registered. Registering
+// an address twice is harmless.
+Boolean EngramNotify_Register(AudioObjectID objectID, AudioObjectPropertySelector selector,
+                              AudioObjectPropertyScope scope, AudioObjectPropertyElement element);
+
+// Marks a property changed. Real-time safe: one atomic OR, plus a single
+// non-blocking wake call when nothing was pending before. Unregistered
+// properties, and posts while the delivery thread is not running, are ignored.
+void EngramNotify_Post(AudioObjectID objectID, AudioObjectPropertySelector selector);
+
+// MARK: - Delivery
+
+// Starts the delivery thread, which calls host->PropertiesChanged. A NULL
+// host starts nothing. Safe to call more than once.
+void EngramNotify_Start(AudioServerPlugInHostRef host);
+// Announces anything still pending without waiting out the window, stops
+// the delivery thread and forgets every target. The host is not called again
+// once this returns.
+void EngramNotify_Stop(void);
+
+void EngramNotify_GetCounters(EngramNotifyCounters* outCounters);
+
+#endif /* EngramNotify_h */
@@ -0,0 +1,480 @@
+//
+//  EngramProperties.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramProperties.h"
+#include "EngramHalPlugin.h"
+#include "EngramLog.h"
+#include "EngramNotify.h"
+#include <errno.h>
+#include <string.h>
+
+// MARK: - Custom Properties
+
+#define kEngramCustomPropertyCount 7
+
+static const AudioServerPlugInCustomPropertyInfo gCustomProperties[kEngramCustomPropertyCount] = {
+    { kEngramPropertyStats, kAudioServerPlugInCustomPropertyDataTypeCFPropertyList, kAudioServerPlugInCustomPropertyDataTypeNone },
+    { kEngramPropertyTrace, kAudioServerPlugInCustomPropertyDataTypeCFPropertyList, kAudioServerPlugInCustomPropertyDataTypeNone },
+    { kEngramPropertyLatency, kAudioServerPlugInCustomPropertyDataTypeCFPropertyList, kAudioServerPlugInCustomPropertyDataTypeNone },
+    { kEngramPropertyLoopback, kAudioServerPlugInCustomPropertyDataTypeCFPropertyList, kAudioServerPlugInCustomPropertyDataTypeNone },
+    { kEngramPropertyFeedback, kAudioServerPlugInCustomPropertyDataTypeCFPropertyList, kAudioServerPlugInCustomPropertyDataTypeNone },
+    { kEngramPropertyAGC, kAudioServerPlugInCustomPropertyDataTypeCFPropertyList, kAudioServerPlugInCustomPropertyDataTypeNone },
+    { kEngramPropertyLowWater, kAudioServerPlugInCustomPropertyDataTypeCFPropertyList, kAudioServerPlugInCustomPropertyDataTypeNone }
+};
+
+// MARK: - Validation
+
+// Clients reach these callbacks with whatever object IDs, addresses and
+// buffer sizes they like, and a bad write here corrupts coreaudiod for every
+// app on the machine. Nothing below trusts its arguments.
+
+static Boolean EngramProperties_IsDevice(AudioObjectID objectID) {
+    return objectID != kAudioObjectUnknown && objectID == gDevice.objectID;
+}
+
+// The plug-in object only describes itself; everything else is the device's.
+static Boolean EngramProperties_Answers(AudioObjectID objectID, const AudioObjectPropertyAddress* address) {
+    if (address == NULL) {
+        return false;
+    }
+
+    switch (address->mSelector) {
+        case kAudioObjectPropertyName:
+        case kAudioObjectPropertyManufacturer:
+            return objectID == kAudioObjectPlugInObject || EngramProperties_IsDevice(objectID);
+        case kAudioDevicePropertyNominalSampleRate:
+        case kAudioDevicePropertyBufferFrameSizeRange:
+        case kAudioDevicePropertyStreams:
+        case kAudioDevicePropertyDeviceIsRunning:
+        case kAudioObjectPropertyCustomPropertyInfoList:
+        case kEngramPropertyStats:
+        case kEngramPropertyTrace:
+        case kEngramPropertyLatency:
+        case kEngramPropertyLoopback:
+        case kEngramPropertyFeedback:
+        case kEngramPropertyAGC:
+        case kEngramPropertyLowWater:
+            return EngramProperties_IsDevice(objectID);
+        default:
+            return false;
+    }
+}
+
+static OSStatus EngramProperties_Validate(AudioObjectID objectID, const AudioObjectPropertyAddress* address) {
+    if (address == NULL) {
+        return kAudioHardwareIllegalOperationError;
+    }
+    if (objectID != kAudioObjectPlugInObject && !EngramProperties_IsDevice(objectID)) {
+        return kAudioHardwareBadObjectError;
+    }
+    if (!EngramProperties_Answers(objectID, address)) {
+        return kAudioHardwareUnknownPropertyError;
+    }
+    return kAudioHardwareNoError;
+}
+
+// Streams the device has published; none until stream objects exist.
+static UInt32 EngramProperties_StreamIDs(AudioObjectID* outStreamIDs) {
+    UInt32 count = 0;
+    if (gDevice.inputStreamID != kAudioObjectUnknown) {
+        outStreamIDs[count++] = gDevice.inputStreamID;
+    }
+    if (gDevice.outputStreamID != kAudioObjectUnknown) {
+        outStreamIDs[count++] = gDevice.outputStreamID;
+    }
+    return count;
+}
+
+// The settable properties take a CFBoolean, apart from the low-water mark.
+static OSStatus EngramProperties_ReadBoolean(UInt32 inDataSize, const void* inData, Boolean* outValue) {
+    if (inDataSize < sizeof(CFPropertyListRef) || inData == NULL) {
+        return kAudioHardwareBadPropertySizeError;
+    }
+    CFPropertyListRef value = *((const CFPropertyListRef*)inData);
+    if (value != NULL && CFGetTypeID(value) != CFBooleanGetTypeID()) {
+        return kAudioHardwareIllegalOperationError;
+    }
+    *outValue = (value != NULL && CFBooleanGetValue((CFBooleanRef)value));
+    return kAudioHardwareNoError;
+}
+
+// The low-water mark: a CFData holding one UInt32 frame count.
+static OSStatus EngramProperties_ReadFrames(UInt32 inDataSize, const void* inData, UInt32* outFrames) {
+    if (inDataSize < sizeof(CFPropertyListRef) || inData == NULL) {
+        return kAudioHardwareBadPropertySizeError;
+    }
+    CFPropertyListRef value = *((const CFPropertyListRef*)inData);
+    if (value == NULL || CFGetTypeID(value) != CFDataGetTypeID() || CFDataGetLength((CFDataRef)value) != sizeof(UInt32)) {
+        return kAudioHardwareIllegalOperationError;
+    }
+    memcpy(outFrames, CFDataGetBytePtr((CFDataRef)value), sizeof(UInt32));
+    return kAudioHardwareNoError;
+}
+
+// MARK: - Property Management (Simplified - Full implementation would be extensive)
+
+Boolean EngramDevice_HasProperty(AudioServerPlugInDriverRef driver, AudioObjectID objectID, pid_t clientPID, const AudioObjectPropertyAddress* address) {
+    ENGRAM_ALLOC_GUARD();
+    ENGRAM_CALLBACK_GUARD(false);
+
+    return EngramProperties_Answers(objectID, address);
+}
+
+OSStatus EngramDevice_IsPropertySettable(AudioServerPlugInDriverRef driver, AudioObjectID objectID, pid_t clientPID, const AudioObjectPropertyAddress* address, Boolean* outIsSettable) {
+    ENGRAM_ALLOC_GUARD();
+    ENGRAM_CALLBACK_GUARD(kAudioHardwareNotRunningError);
+
+    OSStatus status = EngramProperties_Validate(objectID, address);
+    if (status != kAudioHardwareNoError) {
+        return status;
+    }
+    if (outIsSettable == NULL) {
+        return kAudioHardwareIllegalOperationError;
+    }
+
+    *outIsSettable = (address->mSelector == kEngramPropertyTrace || address->mSelector == kEngramPropertyLatency ||
+                      address->mSelector == kEngramPropertyLoopback || address->mSelector == kEngramPropertyFeedback ||
+                      address->mSelector == kEngramPropertyAGC || address->mSelector == kEngramPropertyLowWater);
+    return kAudioHardwareNoError;
+}
+
+OSStatus EngramDevice_GetPropertyDataSize(AudioServerPlugInDriverRef driver, AudioObjectID objectID, pid_t clientPID, const AudioObjectPropertyAddress* address, UInt32 qualifierDataSize, const void* qualifierData, UInt32* outDataSize) {
+    ENGRAM_ALLOC_GUARD();
+    ENGRAM_CALLBACK_GUARD(kAudioHardwareNotRunningError);
+
+    OSStatus status = EngramProperties_Validate(objectID, address);
+    if (status != kAudioHardwareNoError) {
+        return status;
+    }
+    if (outDataSize == NULL) {
+        return kAudioHardwareIllegalOperationError;
+    }
+
+    switch (address->mSelector) {
+        case kAudioObjectPropertyName:
+        case kAudioObjectPropertyManufacturer:
+            *outDataSize = sizeof(CFStringRef);
+            break;
+        case kAudioDevicePropertyNominalSampleRate:
+            *outDataSize = sizeof(Float64);
+            break;
+        case kAudioDevicePropertyBufferFrameSizeRange:
+            *outDataSize = sizeof(AudioValueRange);
+            break;
+        case kAudioDevicePropertyDeviceIsRunning:
+            *outDataSize = sizeof(UInt32);
+            break;
+        case kAudioDevicePropertyStreams: {
+            AudioObjectID streamIDs[2];
+            *outDataSize = EngramProperties_StreamIDs(streamIDs) * sizeof(AudioObjectID);
+            break;
+        }
+        case kAudioObjectPropertyCustomPropertyInfoList:
+            *outDataSize = sizeof(gCustomProperties);
+            break;
+        case kEngramPropertyStats:
+        case kEngramPropertyTrace:
+        case kEngramPropertyLatency:
+        case kEngramPropertyLoopback:
+        case kEngramPropertyFeedback:
+        case kEngramPropertyAGC:
+        case kEngramPropertyLowWater:
+            *outDataSize = sizeof(CFPropertyListRef);
+            break;
+        default:
+            return kAudioHardwareUnknownPropertyError;
+    }
+
+    return kAudioHardwareNoError;
+}
+
+OSStatus EngramDevice_GetPropertyData(AudioServerPlugInDriverRef driver, AudioObjectID objectID, pid_t clientPID, const AudioObjectPropertyAddress* address, UInt32 qualifierDataSize, const void* qualifierData, UInt32 inDataSize, UInt32* outDataSize, void* outData) {
+    ENGRAM_ALLOC_GUARD();
+    ENGRAM_CALLBACK_GUARD(kAudioHardwareNotRunningError);
+
+    OSStatus status = EngramProperties_Validate(objectID, address);
+    if (status != kAudioHardwareNoError) {
+        return status;
+    }
+    if (outDataSize == NULL || (outData == NULL && inDataSize > 0)) {
+        return kAudioHardwareIllegalOperationError;
+    }
+
+    switch (address->mSelector) {
+        case kAudioObjectPropertyName:
+            if (inDataSize < sizeof(CFStringRef)) {
+                return kAudioHardwareBadPropertySizeError;
+            }
+            *((CFStringRef*)outData) = CFSTR(kEngramDeviceName);
+            *outDataSize = sizeof(CFStringRef);
+            break;
+        case kAudioObjectPropertyManufacturer:
+            if (inDataSize < sizeof(CFStringRef)) {
+                return kAudioHardwareBadPropertySizeError;
+            }
+            *((CFStringRef*)outData) = CFSTR(kEngramDeviceManufacturer);
+            *outDataSize = sizeof(CFStringRef);
+            break;
+        case kAudioDevicePropertyNominalSampleRate:
+            if (inDataSize < sizeof(Float64)) {
+                return kAudioHardwareBadPropertySizeError;
+            }
+            *((Float64*)outData) = EngramSeqlock_Read(&gDevice.clock).sampleRate;
+            *outDataSize = sizeof(Float64);
+            break;
+        case kAudioDevicePropertyBufferFrameSizeRange: {
+            if (inDataSize < sizeof(AudioValueRange)) {
+                return kAudioHardwareBadPropertySizeError;
+            }
+            // Keeps the HAL within what the shared input copy holds
+            AudioValueRange range = { kEngramMinIOBufferFrames, kEngramMaxIOBufferFrames };
+            memcpy(outData, &range, sizeof(range));
+            *outDataSize = sizeof(AudioValueRange);
+            break;
+        }
+        case kAudioDevicePropertyDeviceIsRunning:
+            if (inDataSize < sizeof(UInt32)) {
+                return kAudioHardwareBadPropertySizeError;
+            }
+            *((UInt32*)outData) = (gDevice.ioClientCount.load(std::memory_order_acquire) != 0) ? 1 : 0;
+            *outDataSize = sizeof(UInt32);
+            break;
+        case kAudioDevicePropertyStreams: {
+            AudioObjectID streamIDs[2];
+            UInt32 count = EngramProperties_StreamIDs(streamIDs);
+            if (count > inDataSize / sizeof(AudioObjectID)) {
+                count = inDataSize / sizeof(AudioObjectID);
+            }
+            if (count > 0) {
+                memcpy(outData, streamIDs, count * sizeof(AudioObjectID));
+            }
+            *outDataSize = count * sizeof(AudioObjectID);
+            break;
+        }
+        case kAudioObjectPropertyCustomPropertyInfoList: {
+            UInt32 count = inDataSize / sizeof(AudioServerPlugInCustomPropertyInfo);
+            if (count > kEngramCustomPropertyCount) {
+                count = kEngramCustomPropertyCount;
+            }
+            if (count > 0) {
+                memcpy(outData, gCustomProperties, count * sizeof(AudioServerPlugInCustomPropertyInfo));
+            }
+            *outDataSize = count * sizeof(AudioServerPlugInCustomPropertyInfo);
+            break;
+        }
+        case kEngramPropertyStats: {
+            if (inDataSize < sizeof(CFPropertyListRef)) {
+                return kAudioHardwareBadPropertySizeError;
+            }
+            if (gDevice.stats == NULL) {
+                return kAudioHardwareUnspecifiedError;
+            }
+            // The host takes ownership of the returned CFData. This is a
+            // property-thread allocation made by CoreFoundation, never the IO path.
+            EngramStatsSnapshot snapshot;
+            EngramStats_Snapshot(gDevice.stats, &snapshot);
+            ENGRAM_ALLOC_PERMIT();
+            *((CFPropertyListRef*)outData) = CFDataCreate(NULL, (const UInt8*)&snapshot, sizeof(snapshot));
+            *outDataSize = sizeof(CFPropertyListRef);
+            break;
+        }
+        case kEngramPropertyTrace: {
+            if (inDataSize < sizeof(CFPropertyListRef)) {
+                return kAudioHardwareBadPropertySizeError;
+            }
+            EngramClockConfig clock = EngramSeqlock_Read(&gDevice.clock);
+            CFIndex size = (CFIndex)EngramTrace_SerializedSize();
+            ENGRAM_ALLOC_PERMIT();
+            CFMutableDataRef data = CFDataCreateMutable(NULL, size);
+            CFDataSetLength(data, size);
+            size = (CFIndex)EngramTrace_Serialize(CFDataGetMutableBytePtr(data), (size_t)size,
+                                                  clock.nanosPerHostTick, clock.sampleRate);
+            CFDataSetLength(data, size);
+            *((CFPropertyListRef*)outData) = data;
+            *outDataSize = sizeof(CFPropertyListRef);
+            break;
+        }
+        case kEngramPropertyLatency: {
+            if (inDataSize < sizeof(CFPropertyListRef)) {
+                return kAudioHardwareBadPropertySizeError;
+            }
+            EngramLatencyRecord records[kEngramLatencyRecordCapacity];
+            UInt32 count = (gDevice.latencyArrivals != NULL)
+                ? EngramLatencyLog_Pop(gDevice.latencyArrivals, records, kEngramLatencyRecordCapacity) : 0;
+            ENGRAM_ALLOC_PERMIT();
+            *((CFPropertyListRef*)outData) = CFDataCreate(NULL, (const UInt8*)records, (CFIndex)(count * sizeof(EngramLatencyRecord)));
+            *outDataSize = sizeof(CFPropertyListRef);
+            break;
+        }
+        case kEngramPropertyLoopback:
+            if (inDataSize < sizeof(CFPropertyListRef)) {
+                return kAudioHardwareBadPropertySizeError;
+            }
+            *((CFPropertyListRef*)outData) = gDevice.mixMinus.enabled.load(std::memory_order_relaxed) ? kCFBooleanTrue : kCFBooleanFalse;
+            *outDataSize = sizeof(CFPropertyListRef);
+            break;
+        case kEngramPropertyFeedback:
+            if (inDataSize < sizeof(CFPropertyListRef)) {
+                return kAudioHardwareBadPropertySizeError;
+            }
+            *((CFPropertyListRef*)outData) = (gDevice.feedback != NULL && gDevice.feedback->enabled.load(std::memory_order_relaxed))
+                ? kCFBooleanTrue : kCFBooleanFalse;
+            *outDataSize = sizeof(CFPropertyListRef);
+            break;
+        case kEngramPropertyAGC:
+            if (inDataSize < sizeof(CFPropertyListRef)) {
+                return kAudioHardwareBadPropertySizeError;
+            }
+            *((CFPropertyListRef*)outData) = (gDevice.dspStages.load(std::memory_order_relaxed) & kEngramDSPStageAGC)
+                ? kCFBooleanTrue : kCFBooleanFalse;
+            *outDataSize = sizeof(CFPropertyListRef);
+            break;
+        case kEngramPropertyLowWater: {
+            if (inDataSize < sizeof(CFPropertyListRef)) {
+                return kAudioHardwareBadPropertySizeError;
+            }
+            UInt32 frames = (gDevice.lowWater.armed.load(std::memory_order_acquire) != kEngramLowWaterDisarmed)
+                ? gDevice.lowWater.frames.load(std::memory_order_relaxed) : 0;
+            ENGRAM_ALLOC_PERMIT();
+            *((CFPropertyListRef*)outData) = CFDataCreate(NULL, (const UInt8*)&frames, sizeof(frames));
+            *outDataSize = sizeof(CFPropertyListRef);
+            break;
+        }
+        default:
+            return kAudioHardwareUnknownPropertyError;
+    }
+
+    return kAudioHardwareNoError;
+}
+
+OSStatus EngramDevice_SetPropertyData(AudioServerPlugInDriverRef driver, AudioObjectID objectID, pid_t clientPID, const AudioObjectPropertyAddress* address, UInt32 qualifierDataSize, const void* qualifierData, UInt32 inDataSize, const void* inData) {
+    ENGRAM_ALLOC_GUARD();
+    ENGRAM_CALLBACK_GUARD(kAudioHardwareNotRunningError);
+
+    OSStatus status = EngramProperties_Validate(objectID, address);
+    if (status != kAudioHardwareNoError) {
+        return status;
+    }
+
+    Boolean enable = false;
+    switch (address->mSelector) {
+        case kEngramPropertyTrace: {
+            status = EngramProperties_ReadBoolean(inDataSize, inData, &enable);
+            if (status != kAudioHardwareNoError) {
+                return status;
+            }
+            // Only a real stop dumps the trace; repeated "off" is a no-op
+            Boolean wasEnabled = EngramTrace_IsEnabled();
+            EngramTrace_SetEnabled(enable);
+            if (enable != wasEnabled) {
+                EngramNotify_Post(gDevice.objectID, kEngramPropertyTrace);
+            }
+            if (!enable && wasEnabled) {
+                // A one-off dump on the property thread; stdio buffers the file
+                ENGRAM_ALLOC_PERMIT();
+                EngramClockConfig clock = EngramSeqlock_Read(&gDevice.clock);
+                char path[kEngramMaxPathLength];
+                if (!EngramFiles_MakePrivateDirectory(gDevice.diagnosticsDirectory) ||
+                    !EngramFiles_Join(path, sizeof(path), gDevice.diagnosticsDirectory, kEngramTraceFileName) ||
+                    !EngramTrace_WriteFile(path, clock.nanosPerHostTick, clock.sampleRate)) {
+                    ENGRAM_LOG_WARNING("Could not write IO trace (errno %llu)", (UInt64)errno);
+                }
+            }
+            ENGRAM_LOG_NOTICE("IO tracing %llu", enable);
+            return kAudioHardwareNoError;
+        }
+        case kEngramPropertyLatency: {
+            status = EngramProperties_ReadBoolean(inDataSize, inData, &enable);
+            if (status != kAudioHardwareNoError) {
+                return status;
+            }
+            Boolean wasEnabled = gDevice.latencyEnabled.exchange(enable, std::memory_order_relaxed);
+            if (enable != wasEnabled) {
+                EngramNotify_Post(gDevice.objectID, kEngramPropertyLatency);
+            }
+            if (!enable && wasEnabled && gDevice.latencyArrivals != NULL) {
+                ENGRAM_ALLOC_PERMIT();
+                EngramClockConfig clock = EngramSeqlock_Read(&gDevice.clock);
+                char path[kEngramMaxPathLength];
+                if (!EngramFiles_MakePrivateDirectory(gDevice.diagnosticsDirectory) ||
+                    !EngramFiles_Join(path, sizeof(path), gDevice.diagnosticsDirectory, kEngramLatencyArrivalsFileName) ||
+                    !EngramLatencyLog_AppendCSV(gDevice.latencyArrivals, path, clock.nanosPerHostTick)) {
+                    ENGRAM_LOG_WARNING("Could not write latency arrivals (errno %llu)", (UInt64)errno);
+                }
+            }
+            ENGRAM_LOG_NOTICE("Latency calibration %llu", enable);
+            return kAudioHardwareNoError;
+        }
+        case kEngramPropertyLoopback: {
+            status = EngramProperties_ReadBoolean(inDataSize, inData, &enable);
+            if (status != kAudioHardwareNoError) {
+                return status;
+            }
+            // ProcessInput ignores a mix older than the previous cycle, so turning
+            // this back on never replays audio from before it was turned off
+            if (gDevice.mixMinus.enabled.exchange(enable, std::memory_order_relaxed) != enable) {
+                EngramNotify_Post(gDevice.objectID, kEngramPropertyLoopback);
+            }
+            ENGRAM_LOG_NOTICE("Loopback %llu", enable);
+            return kAudioHardwareNoError;
+        }
+        case kEngramPropertyFeedback: {
+            status = EngramProperties_ReadBoolean(inDataSize, inData, &enable);
+            if (status != kAudioHardwareNoError) {
+                return status;
+            }
+            if (gDevice.feedback == NULL) {
+                return kAudioHardwareUnsupportedOperationError;
+            }
+            // Notches already engaged stay put, and apply again once re-enabled
+            if (gDevice.feedback->enabled.exchange(enable, std::memory_order_relaxed) != enable) {
+                EngramNotify_Post(gDevice.objectID, kEngramPropertyFeedback);
+            }
+            ENGRAM_LOG_NOTICE("Feedback suppression %llu", enable);
+            return kAudioHardwareNoError;
+        }
+        case kEngramPropertyAGC: {
+            status = EngramProperties_ReadBoolean(inDataSize, inData, &enable);
+            if (status != kAudioHardwareNoError) {
+                return status;
+            }
+            UInt32 previous = enable ? gDevice.dspStages.fetch_or(kEngramDSPStageAGC, std::memory_order_relaxed)
+                                     : gDevice.dspStages.fetch_and(~(UInt32)kEngramDSPStageAGC, std::memory_order_relaxed);
+            if (((previous & kEngramDSPStageAGC) != 0) != enable) {
+                EngramNotify_Post(gDevice.objectID, kEngramPropertyAGC);
+            }
+            ENGRAM_LOG_NOTICE("Input AGC %llu", enable);
+            return kAudioHardwareNoError;
+        }
+        case kEngramPropertyLowWater: {
+            // The channel for producers in other processes, which can only
+            // read the stats page: read lowWaterSequence, arm here, then sleep
+            // on lowWaterSequence while it holds the value read
+            UInt32 frames = 0;
+            status = EngramProperties_ReadFrames(inDataSize, inData, &frames);
+            if (status != kAudioHardwareNoError) {
+                return status;
+            }
+            if (frames == 0) {
+                EngramLowWater_Disarm(&gDevice.lowWater);
+                return kAudioHardwareNoError;
+            }
+            // Nothing reads the ring while IO is stopped; wait on the gate instead
+            if (!EngramGate_IsRunning(gDevice.ioGate.clients.load(std::memory_order_acquire))) {
+                return kAudioHardwareNotRunningError;
+            }
+            EngramLowWater_Arm(&gDevice.lowWater, kEngramLowWaterArmedShared, frames);
+            // Already below the mark: wake the producer now rather than after
+            // the next read. Not counted; lowWaterSignals is the IO thread's.
+            EngramLowWater_Check(&gDevice.lowWater, EngramRingBuffer_GetAvailableRead(&gDevice.ringBuffer) / gDevice.channels);
+            return kAudioHardwareNoError;
+        }
+        default:
+            return kAudioHardwareUnsupportedOperationError;
+    }
+}
@@ -0,0 +1,152 @@
+//
+//  EngramRender.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramRender.h"
+#include "EngramWait.h"
+#include <string.h>
+
+static inline size_t EngramRender_SlotBytes(UInt32 channels) {
+    return sizeof(Float32) * (size_t)kEngramRenderMaxFrames * channels;
+}
+
+size_t EngramRender_RequiredBytes(UInt32 channels) {
+    return kEngramRenderSlots * EngramArena_AlignedSize(EngramRender_SlotBytes(channels));
+}
+
+void EngramRender_Init(EngramRender* render, EngramArena* arena, UInt32 channels) {
+    render->enabled.store(false, std::memory_order_relaxed);
+    render->requested.store(0, std::memory_order_relaxed);
+    render->completed.store(0, std::memory_order_relaxed);
+    render->producerWaiting.store(0, std::memory_order_relaxed);
+
+    EngramRenderRequest none;
+    memset(&none, 0, sizeof(none));
+    EngramSeqlock_Write(&render->request, none);
+
+    render->issuedSequence = 0;
+    render->issuedFrames = 0;
+    render->issued = false;
+
+    render->channels = channels;
+    for (UInt32 i = 0; i < kEngramRenderSlots; i++) {
+        render->slots[i] = ENGRAM_ARENA_NEW_ARRAY(arena, Float32, (size_t)kEngramRenderMaxFrames * channels);
+        if (render->slots[i] != NULL) {
+            memset(render->slots[i], 0, EngramRender_SlotBytes(channels));
+        }
+    }
+}
+
+// MARK: - IO Thread
+
+Boolean EngramRender_Request(EngramRender* render, UInt64 cycle, Float64 sampleTime, UInt64 hostTime, UInt32 frames) {
+    render->issued = false;
+    if (!render->enabled.load(std::memory_order_relaxed) || frames == 0 || frames > kEngramRenderMaxFrames ||
+        render->slots[0] == NULL || render->slots[1] == NULL) {
+        return false;
+    }
+
+    EngramRenderRequest request;
+    request.frames = frames;
+    request.channels = render->channels;
+    request.reserved = 0;
+    request.cycle = cycle;
+    request.hostTime = hostTime;
+    request.sampleTime = sampleTime;
+
+    // The payload goes out before the word the producer sleeps on. A nudge
+    // landing in between costs the producer one render of a request that is
+    // then reissued under the next sequence; it never sees a torn one.
+    UInt32 current = render->requested.load(std::memory_order_relaxed);
+    for (;;) {
+        request.sequence = current + 1;
+        request.buffer = render->slots[request.sequence % kEngramRenderSlots];
+        EngramSeqlock_Write(&render->request, request);
+        if (render->requested.compare_exchange_strong(current, request.sequence, std::memory_order_seq_cst,
+                                                      std::memory_order_relaxed)) {
+            break;
+        }
+    }
+
+    render->issuedSequence = request.sequence;
+    render->issuedFrames = frames;
+    render->issued = true;
+
+    // Pairs with the seq_cst store in Arm: either the producer sees the new
+    // sequence before sleeping, or this sees it waiting
+    if (render->producerWaiting.load(std::memory_order_seq_cst) != 0 &&
+        render->producerWaiting.exchange(0, std::memory_order_acq_rel) != 0) {
+        EngramWait_WakeAll(&render->requested);
+    }
+    return true;
+}
+
+Boolean EngramRender_Collect(EngramRender* render, Float32* out, UInt32 frames, UInt64 budgetNanos, UInt64* outWaitNanos) {
+    *outWaitNanos = 0;
+    if (!render->issued || render->issuedFrames != frames) {
+        render->issued = false;
+        return false;
+    }
+    render->issued = false;
+
+    UInt32 sequence = render->issuedSequence;
+    UInt64 start = EngramWait_Now();
+    UInt64 deadline = start + budgetNanos;
+    for (;;) {
+        // A late completion of an earlier request changes the word too
+        UInt32 completed = render->completed.load(std::memory_order_acquire);
+        if (completed == sequence) {
+            break;
+        }
+        UInt64 now = EngramWait_Now();
+        if (now >= deadline) {
+            *outWaitNanos = now - start;
+            return false;
+        }
+        EngramWait_WhileEqual(&render->completed, completed, deadline - now);
+    }
+
+    memcpy(out, render->slots[sequence % kEngramRenderSlots], sizeof(Float32) * (size_t)frames * render->channels);
+    *outWaitNanos = EngramWait_Now() - start;
+    return true;
+}
+
+// MARK: - Producer
+
+Boolean EngramRender_Pending(EngramRender* render, EngramRenderRequest* outRequest) {
+    UInt32 requested = render->requested.load(std::memory_order_seq_cst);
+    if (requested == render->completed.load(std::memory_order_acquire)) {
+        return false;
+    }
+    // A nudge moves the word past the last payload, so nothing is pending
+    EngramRenderRequest request = EngramSeqlock_Read(&render->request);
+    if (request.sequence != requested) {
+        return false;
+    }
+    *outRequest = request;
+    return true;
+}
+
+UInt32 EngramRender_Arm(EngramRender* render) {
+    render->producerWaiting.store(1, std::memory_order_seq_cst);
+    return render->requested.load(std::memory_order_seq_cst);
+}
+
+void EngramRender_Disarm(EngramRender* render) {
+    render->producerWaiting.store(0, std::memory_order_relaxed);
+}
+
+void EngramRender_Complete(EngramRender* render, const EngramRenderRequest* request) {
+    render->completed.store(request->sequence, std::memory_order_release);
+    EngramWait_WakeAll(&render->completed);
+}
+
+void EngramRender_Nudge(EngramRender* render) {
+    render->requested.fetch_add(1, std::memory_order_seq_cst);
+    render->producerWaiting.store(0, std::memory_order_relaxed);
+    EngramWait_WakeAll(&render->requested);
+}
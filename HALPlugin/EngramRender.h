@@ -0,0 +1,98 @@
+//
+//  EngramRender.h
+//  Engram Virtual Audio Device
+//
+//  Pull-mode input: instead of pushing into the ring ahead of time, a
+//  producer that can render on demand is asked for each cycle as it starts
+//  (BeginIOOperation) and renders exactly the frames that cycle needs
+//  straight into plugin memory. DoIOOperation waits a bounded time for the
+//  render and falls back to the ring if it misses, so no safety margin of
+//  queued audio is needed.
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#ifndef EngramRender_h
+#define EngramRender_h
+
+#include "EngramArena.h"
+#include "EngramSeqlock.h"
+#include "EngramTypes.h"
+#include <atomic>
+
+// Largest IO buffer that can be pulled; bigger cycles read the ring
+#define kEngramRenderMaxFrames 4096
+// Two slots, so a render that arrives after its cycle gave up can never
+// overwrite the slot the next cycle is copying out of
+#define kEngramRenderSlots 2
+// ReadInput waits at most 1/kEngramRenderBudgetDivisor of a cycle for the render
+#define kEngramRenderBudgetDivisor 2
+
+// MARK: - Requests
+
+// One cycle's worth of input, as the producer sees it.
+typedef struct {
+    UInt32 sequence;        // pass back unchanged to complete the request
+    UInt32 frames;
+    UInt32 channels;
+    UInt32 reserved;
+    UInt64 cycle;           // mIOCycleCounter
+    UInt64 hostTime;        // mInputTime.mHostTime of the first frame
+    Float64 sampleTime;     // mInputTime.mSampleTime of the first frame
+    Float32* buffer;        // frames * channels interleaved samples to render into
+} EngramRenderRequest;
+
+typedef struct {
+    std::atomic<Boolean> enabled;
+
+    // requested: what the producer sleeps on; bumped by every request and by
+    // nudges (IO stopping, teardown, mode changes) that carry no request.
+    // completed: what the IO thread sleeps on; the last sequence rendered.
+    std::atomic<UInt32> requested;
+    std::atomic<UInt32> completed;
+    std::atomic<UInt32> producerWaiting;
+    EngramSeqlock<EngramRenderRequest> request;
+
+    // Owned by the IO thread: the request Collect is to wait for
+    UInt32 issuedSequence;
+    UInt32 issuedFrames;
+    Boolean issued;
+
+    UInt32 channels;
+    Float32* slots[kEngramRenderSlots];
+} EngramRender;
+
+// Arena bytes for the render slots.
+size_t EngramRender_RequiredBytes(UInt32 channels);
+// Pull mode starts disabled.
+void EngramRender_Init(EngramRender* render, EngramArena* arena, UInt32 channels);
+
+// MARK: - IO Thread
+
+// Publishes a request for the cycle about to run. Returns false, and asks for
+// nothing, when pull mode is off or the cycle is too large. The wake call is
+// only made when the producer is asleep.
+Boolean EngramRender_Request(EngramRender* render, UInt64 cycle, Float64 sampleTime, UInt64 hostTime, UInt32 frames);
+
+// Waits up to `budgetNanos` for the current request, then copies the render
+// into `out`. Returns false on a miss, or if no request was issued for a cycle
+// of `frames`; the caller reads the ring instead. `outWaitNanos` gets the time
+// spent waiting either way.
+Boolean EngramRender_Collect(EngramRender* render, Float32* out, UInt32 frames, UInt64 budgetNanos, UInt64* outWaitNanos);
+
+// MARK: - Producer
+
+// The request waiting to be rendered, if any. A request stays pending until
+// completed, so asking again returns the same one.
+Boolean EngramRender_Pending(EngramRender* render, EngramRenderRequest* outRequest);
+// Announces a sleeping producer and returns the word value to sleep on. Check
+// Pending once more after arming, before sleeping.
+UInt32 EngramRender_Arm(EngramRender* render);
+void EngramRender_Disarm(EngramRender* render);
+// Marks `request` rendered and wakes the IO thread.
+void EngramRender_Complete(EngramRender* render, const EngramRenderRequest* request);
+
+// Wakes a sleeping producer without a request so it re-checks its conditions.
+void EngramRender_Nudge(EngramRender* render);
+
+#endif /* EngramRender_h */
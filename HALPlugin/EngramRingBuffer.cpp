@@ -0,0 +1,155 @@
+//
+//  EngramRingBuffer.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramRingBuffer.h"
+#include "EngramStats.h"
+#include <string.h>
+
+void EngramRingBuffer_Init(EngramRingBuffer* rb, Float32* storage, UInt32 size) {
+    rb->size = (storage != NULL) ? size : 0;
+    rb->buffer = storage;
+    rb->writeIndex.store(0, std::memory_order_relaxed);
+    rb->readIndex.store(0, std::memory_order_relaxed);
+    rb->overrunSamples.store(0, std::memory_order_relaxed);
+
+    rb->stamps = NULL;
+    rb->stampMask = 0;
+    rb->stampHead.store(0, std::memory_order_relaxed);
+    rb->stampTail.store(0, std::memory_order_relaxed);
+    rb->writtenSamples = 0;
+    rb->readSamples = 0;
+    rb->droppedStamps.store(0, std::memory_order_relaxed);
+}
+
+void EngramRingBuffer_AttachStamps(EngramRingBuffer* rb, EngramRingStamp* storage, UInt32 capacity) {
+    Boolean usable = (storage != NULL && capacity >= 2 && (capacity & (capacity - 1)) == 0);
+    rb->stamps = usable ? storage : NULL;
+    rb->stampMask = usable ? capacity - 1 : 0;
+}
+
+void EngramRingBuffer_Destroy(EngramRingBuffer* rb) {
+    rb->buffer = NULL;
+    rb->size = 0;
+    rb->stamps = NULL;
+    rb->stampMask = 0;
+}
+
+// MARK: - Stamps
+
+// Producer, before the samples are published. `hostTime` 0 stamps nothing.
+static inline void EngramRingBuffer_PushStamp(EngramRingBuffer* rb, UInt32 accepted, UInt64 hostTime) {
+    rb->writtenSamples += accepted;
+    if (rb->stamps == NULL || accepted == 0 || hostTime == 0) {
+        return;
+    }
+
+    UInt32 head = rb->stampHead.load(std::memory_order_relaxed);
+    if (head - rb->stampTail.load(std::memory_order_acquire) > rb->stampMask) {
+        EngramStats_Add(&rb->droppedStamps, 1);
+        return;
+    }
+    rb->stamps[head & rb->stampMask].endSample = rb->writtenSamples;
+    rb->stamps[head & rb->stampMask].hostTime = hostTime;
+    rb->stampHead.store(head + 1, std::memory_order_release);
+}
+
+// Reader, after taking `taken` samples. Returns the host time of the stamp
+// covering the first of them, or 0.
+static inline UInt64 EngramRingBuffer_RetireStamps(EngramRingBuffer* rb, UInt32 taken) {
+    UInt64 first = rb->readSamples;
+    rb->readSamples += taken;
+    if (rb->stamps == NULL || taken == 0) {
+        return 0;
+    }
+
+    UInt32 tail = rb->stampTail.load(std::memory_order_relaxed);
+    UInt32 head = rb->stampHead.load(std::memory_order_acquire);
+    while (tail != head && rb->stamps[tail & rb->stampMask].endSample <= first) {
+        tail++;
+    }
+    UInt64 hostTime = (tail != head) ? rb->stamps[tail & rb->stampMask].hostTime : 0;
+    while (tail != head && rb->stamps[tail & rb->stampMask].endSample <= rb->readSamples) {
+        tail++;
+    }
+    rb->stampTail.store(tail, std::memory_order_release);
+    return hostTime;
+}
+
+UInt32 EngramRingBuffer_Write(EngramRingBuffer* rb, const Float32* data, UInt32 frames) {
+    return EngramRingBuffer_WriteStamped(rb, data, frames, 0);
+}
+
+UInt32 EngramRingBuffer_WriteStamped(EngramRingBuffer* rb, const Float32* data, UInt32 frames, UInt64 hostTime) {
+    if (rb->size == 0) {
+        return 0;
+    }
+
+    UInt32 w = rb->writeIndex.load(std::memory_order_relaxed);
+    UInt32 r = rb->readIndex.load(std::memory_order_acquire);
+
+    UInt32 used = (w >= r) ? (w - r) : (rb->size - r + w);
+    UInt32 available = rb->size - used - 1;
+    UInt32 toWrite = (frames < available) ? frames : available;
+
+    if (toWrite < frames) {
+        EngramStats_Add(&rb->overrunSamples, frames - toWrite);
+    }
+
+    UInt32 firstPart = (toWrite < rb->size - w) ? toWrite : (rb->size - w);
+    memcpy(rb->buffer + w, data, firstPart * sizeof(Float32));
+    memcpy(rb->buffer, data + firstPart, (toWrite - firstPart) * sizeof(Float32));
+
+    EngramRingBuffer_PushStamp(rb, toWrite, hostTime);
+    rb->writeIndex.store((w + toWrite) % rb->size, std::memory_order_release);
+    return toWrite;
+}
+
+UInt32 EngramRingBuffer_Read(EngramRingBuffer* rb, Float32* data, UInt32 frames) {
+    UInt64 hostTime;
+    return EngramRingBuffer_ReadStamped(rb, data, frames, &hostTime);
+}
+
+UInt32 EngramRingBuffer_ReadStamped(EngramRingBuffer* rb, Float32* data, UInt32 frames, UInt64* outHostTime) {
+    *outHostTime = 0;
+    if (rb->size == 0) {
+        memset(data, 0, frames * sizeof(Float32));
+        return 0;
+    }
+
+    UInt32 r = rb->readIndex.load(std::memory_order_relaxed);
+    UInt32 w = rb->writeIndex.load(std::memory_order_acquire);
+
+    UInt32 available = (w >= r) ? (w - r) : (rb->size - r + w);
+    UInt32 toRead = (frames < available) ? frames : available;
+
+    UInt32 firstPart = (toRead < rb->size - r) ? toRead : (rb->size - r);
+    memcpy(data, rb->buffer + r, firstPart * sizeof(Float32));
+    memcpy(data + firstPart, rb->buffer, (toRead - firstPart) * sizeof(Float32));
+
+    // Zero-fill if not enough data
+    if (toRead < frames) {
+        memset(data + toRead, 0, (frames - toRead) * sizeof(Float32));
+    }
+
+    *outHostTime = EngramRingBuffer_RetireStamps(rb, toRead);
+    rb->readIndex.store((r + toRead) % rb->size, std::memory_order_release);
+    return toRead;
+}
+
+UInt32 EngramRingBuffer_GetAvailableRead(EngramRingBuffer* rb) {
+    UInt32 w = rb->writeIndex.load(std::memory_order_acquire);
+    UInt32 r = rb->readIndex.load(std::memory_order_acquire);
+    return (w >= r) ? (w - r) : (rb->size - r + w);
+}
+
+UInt32 EngramRingBuffer_GetAvailableWrite(EngramRingBuffer* rb) {
+    if (rb->size == 0) {
+        return 0;
+    }
+    return rb->size - EngramRingBuffer_GetAvailableRead(rb) - 1;
+}
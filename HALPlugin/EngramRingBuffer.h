@@ -0,0 +1,67 @@
+//
+//  EngramRingBuffer.h
+//  Engram Virtual Audio Device
+//
+//  Lock-free single-producer / single-consumer sample ring
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#ifndef EngramRingBuffer_h
+#define EngramRingBuffer_h
+
+#include "EngramTypes.h"
+#include <atomic>
+
+// A write's host time and the running sample count just past its last sample
+typedef struct {
+    UInt64 endSample;
+    UInt64 hostTime;
+} EngramRingStamp;
+
+// MARK: - Ring Buffer
+
+// Single-producer / single-consumer. The producer owns writeIndex and the IO
+// thread owns readIndex; each publishes its index with release semantics, so
+// neither side ever waits on the other.
+//
+// An optional side ring carries one timestamp per stamped write, published
+// before the samples it covers, so the reader can tell how long the oldest
+// sample it takes has been queued. Every read retires stamps, stamped or not,
+// so the two rings never drift apart.
+typedef struct {
+    Float32* buffer;
+    UInt32 size;
+    std::atomic<UInt32> writeIndex;
+    std::atomic<UInt32> readIndex;
+    std::atomic<UInt64> overrunSamples;   // producer samples dropped because the ring was full
+
+    EngramRingStamp* stamps;
+    UInt32 stampMask;                     // capacity - 1; capacity is a power of two
+    std::atomic<UInt32> stampHead;        // producer
+    std::atomic<UInt32> stampTail;        // reader
+    UInt64 writtenSamples;                // producer's running total of accepted samples
+    UInt64 readSamples;                   // reader's running total
+    std::atomic<UInt64> droppedStamps;    // stamps that found the side ring full; their samples
+                                          // are attributed to the next stamp
+} EngramRingBuffer;
+
+// Ring buffer operations. Storage is owned by the caller (the plugin arena).
+void EngramRingBuffer_Init(EngramRingBuffer* rb, Float32* storage, UInt32 size);
+void EngramRingBuffer_Destroy(EngramRingBuffer* rb);
+UInt32 EngramRingBuffer_Write(EngramRingBuffer* rb, const Float32* data, UInt32 frames);
+UInt32 EngramRingBuffer_Read(EngramRingBuffer* rb, Float32* data, UInt32 frames);
+
+// Gives the ring `capacity` stamps of side storage (a power of two; anything
+// else, or NULL, leaves stamping off). Call before either side runs.
+void EngramRingBuffer_AttachStamps(EngramRingBuffer* rb, EngramRingStamp* storage, UInt32 capacity);
+// Write tagged with the host time the samples were produced.
+UInt32 EngramRingBuffer_WriteStamped(EngramRingBuffer* rb, const Float32* data, UInt32 frames, UInt64 hostTime);
+// Read that also reports the stamp covering the first sample taken. Unstamped
+// samples count toward the next stamped write; *outHostTime is 0 when nothing
+// was read or no stamp covers the sample yet.
+UInt32 EngramRingBuffer_ReadStamped(EngramRingBuffer* rb, Float32* data, UInt32 frames, UInt64* outHostTime);
+UInt32 EngramRingBuffer_GetAvailableRead(EngramRingBuffer* rb);
+UInt32 EngramRingBuffer_GetAvailableWrite(EngramRingBuffer* rb);
+
+#endif /* EngramRingBuffer_h */
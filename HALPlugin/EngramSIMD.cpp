@@ -0,0 +1,86 @@
+//
+//  EngramSIMD.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramSIMDKernels.h"
+
+// MARK: - Scalar Reference
+
+static const EngramSIMDKernels kEngramSIMDScalarKernels = {
+    kEngramSIMDLevelScalar,
+    "scalar",
+    EngramSIMDScalar_Mix,
+    EngramSIMDScalar_GainRamp,
+    EngramSIMDScalar_Int16ToFloat,
+    EngramSIMDScalar_FloatToInt16,
+    EngramSIMDScalar_Interleave2,
+    EngramSIMDScalar_Deinterleave2,
+    EngramSIMDScalar_Biquad,
+    EngramSIMDScalar_FFTButterflies
+};
+
+// MARK: - CPU Features
+
+static Boolean EngramSIMD_CPUSupports(EngramSIMDLevel level) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    switch (level) {
+        case kEngramSIMDLevelSSE41: return __builtin_cpu_supports("sse4.1") != 0;
+        // Also confirms the OS saves the upper halves of the YMM registers
+        case kEngramSIMDLevelAVX2: return __builtin_cpu_supports("avx2") != 0;
+        default: return level == kEngramSIMDLevelScalar;
+    }
+#elif defined(__aarch64__)
+    // Advanced SIMD is part of the arm64 baseline
+    return level == kEngramSIMDLevelScalar || level == kEngramSIMDLevelNEON;
+#else
+    return level == kEngramSIMDLevelScalar;
+#endif
+}
+
+// MARK: - Dispatch
+
+const EngramSIMDKernels* EngramSIMD_KernelsForLevel(EngramSIMDLevel level) {
+    if (!EngramSIMD_CPUSupports(level)) {
+        return NULL;
+    }
+    switch (level) {
+        case kEngramSIMDLevelScalar: return &kEngramSIMDScalarKernels;
+        case kEngramSIMDLevelSSE41: return EngramSIMD_SSE41Kernels();
+        case kEngramSIMDLevelAVX2: return EngramSIMD_AVX2Kernels();
+        case kEngramSIMDLevelNEON: return EngramSIMD_NEONKernels();
+        default: return NULL;
+    }
+}
+
+static const EngramSIMDKernels* EngramSIMD_Select(void) {
+    static const EngramSIMDLevel kPreference[] = {
+        kEngramSIMDLevelAVX2, kEngramSIMDLevelNEON, kEngramSIMDLevelSSE41
+    };
+    for (EngramSIMDLevel level : kPreference) {
+        const EngramSIMDKernels* kernels = EngramSIMD_KernelsForLevel(level);
+        if (kernels != NULL) {
+            return kernels;
+        }
+    }
+    return &kEngramSIMDScalarKernels;
+}
+
+const EngramSIMDKernels* EngramSIMD_Kernels(void) {
+    static const EngramSIMDKernels* const kernels = EngramSIMD_Select();
+    return kernels;
+}
+
+const char* EngramSIMD_LevelName(EngramSIMDLevel level) {
+    switch (level) {
+        case kEngramSIMDLevelScalar: return "scalar";
+        case kEngramSIMDLevelSSE41: return "sse4.1";
+        case kEngramSIMDLevelAVX2: return "avx2";
+        case kEngramSIMDLevelNEON: return "neon";
+        default: return "unknown";
+    }
+}
@@ -0,0 +1,79 @@
+//
+//  EngramSIMD.h
+//  Engram Virtual Audio Device
+//
+//  Vectorized building blocks for the IO path: mixing, gain ramps, Int16
+//  conversion, stereo interleave, biquads and FFT butterflies. Each is written once against a
+//  small vector type (EngramSIMDVector.h), instantiated for NEON, SSE4.1 and
+//  AVX2, and checked against a plain scalar reference. The implementation
+//  for the running CPU is picked once, on first use.
+//
+//  Every implementation matches the scalar reference bit for bit (NaN
+//  payloads aside), so switching ISA never changes the audio. That is why the
+//  SIMD sources are built without floating-point contraction.
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#ifndef EngramSIMD_h
+#define EngramSIMD_h
+
+#include "EngramDSP.h"
+
+typedef enum {
+    kEngramSIMDLevelScalar = 0,
+    kEngramSIMDLevelSSE41,
+    kEngramSIMDLevelAVX2,
+    kEngramSIMDLevelNEON,
+    kEngramSIMDLevelCount
+} EngramSIMDLevel;
+
+// MARK: - Kernels
+
+typedef struct {
+    EngramSIMDLevel level;
+    const char* name;
+
+    // dst[i] += src[i] * gain
+    void (*mix)(Float32* dst, const Float32* src, Float32 gain, UInt32 count);
+
+    // Scales interleaved frames by a gain moving linearly from startGain
+    // (frame 0) towards endGain (reached at frame `frames`, i.e. the first
+    // frame of the next block).
+    void (*gainRamp)(Float32* samples, UInt32 frames, UInt32 channels, Float32 startGain, Float32 endGain);
+
+    // x / 32768
+    void (*int16ToFloat)(Float32* dst, const SInt16* src, UInt32 count);
+    // x * 32768, rounded to nearest even and clamped to [-32768, 32767]; NaN becomes -32768
+    void (*floatToInt16)(SInt16* dst, const Float32* src, UInt32 count);
+
+    // Two planes to one interleaved stereo buffer and back
+    void (*interleave2)(Float32* dst, const Float32* left, const Float32* right, UInt32 frames);
+    void (*deinterleave2)(Float32* left, Float32* right, const Float32* src, UInt32 frames);
+
+    // The same filter over every channel of an interleaved buffer in place,
+    // one state per channel, flushed like EngramBiquad_Process.
+    void (*biquad)(const EngramBiquadCoefficients* coefficients, EngramBiquadState* states,
+                   Float32* samples, UInt32 frames, UInt32 channels);
+
+    // One radix-2 decimation-in-time pass over `count` complex points in
+    // place. In every block of 2 * half points, x[k + half] is multiplied by
+    // twiddle k, then added to and subtracted from x[k]. The pass's `half`
+    // twiddles are contiguous.
+    void (*fftButterflies)(Float32* re, Float32* im, const Float32* twiddleRe, const Float32* twiddleIm,
+                           UInt32 count, UInt32 half);
+} EngramSIMDKernels;
+
+// MARK: - Dispatch
+
+// The best implementation this CPU supports. Selected on the first call and
+// cached; later calls are a single load, so this is real-time safe once
+// EngramPlugIn_Initialize has made the first.
+const EngramSIMDKernels* EngramSIMD_Kernels(void);
+
+// A specific implementation, or NULL if this build or CPU can't run it.
+const EngramSIMDKernels* EngramSIMD_KernelsForLevel(EngramSIMDLevel level);
+
+const char* EngramSIMD_LevelName(EngramSIMDLevel level);
+
+#endif /* EngramSIMD_h */
@@ -0,0 +1,335 @@
+//
+//  EngramSIMDKernels.h
+//  Engram Virtual Audio Device
+//
+//  The scalar reference for every EngramSIMD kernel, and the same kernels
+//  written once against the vector types in EngramSIMDVector.h. Included by
+//  EngramSIMD.cpp and by one translation unit per ISA, each compiled with
+//  that ISA's flags and reporting its table through the functions below.
+//
+//  The vector loops do each sample's arithmetic in the reference's order
+//  and leave remainders to the reference, which is what keeps them bit-exact.
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#ifndef EngramSIMDKernels_h
+#define EngramSIMDKernels_h
+
+#include "EngramSIMD.h"
+#include "EngramSIMDVector.h"
+#include <math.h>
+
+#define kEngramSIMDInt16Scale 32768.0f
+
+// Each returns NULL when its unit wasn't built for the ISA. They don't check
+// the CPU; EngramSIMD_KernelsForLevel does.
+const EngramSIMDKernels* EngramSIMD_SSE41Kernels(void);
+const EngramSIMDKernels* EngramSIMD_AVX2Kernels(void);
+const EngramSIMDKernels* EngramSIMD_NEONKernels(void);
+
+// MARK: - Scalar Reference
+
+static inline Float32 EngramSIMDScalar_Min(Float32 a, Float32 b) {
+    return (a < b) ? a : b;
+}
+
+static inline Float32 EngramSIMDScalar_Max(Float32 a, Float32 b) {
+    return (a > b) ? a : b;
+}
+
+static inline void EngramSIMDScalar_Mix(Float32* dst, const Float32* src, Float32 gain, UInt32 count) {
+    for (UInt32 i = 0; i < count; i++) {
+        dst[i] = dst[i] + src[i] * gain;
+    }
+}
+
+// Frames [firstFrame, endFrame) of a ramp that started at frame 0
+static inline void EngramSIMDScalar_GainRampFrames(Float32* samples, UInt32 firstFrame, UInt32 endFrame,
+                                                   UInt32 channels, Float32 startGain, Float32 step) {
+    for (UInt32 frame = firstFrame; frame < endFrame; frame++) {
+        Float32 gain = startGain + (Float32)frame * step;
+        for (UInt32 ch = 0; ch < channels; ch++) {
+            samples[frame * channels + ch] = samples[frame * channels + ch] * gain;
+        }
+    }
+}
+
+static inline Float32 EngramSIMDScalar_RampStep(UInt32 frames, Float32 startGain, Float32 endGain) {
+    return (endGain - startGain) / (Float32)frames;
+}
+
+static inline void EngramSIMDScalar_GainRamp(Float32* samples, UInt32 frames, UInt32 channels,
+                                             Float32 startGain, Float32 endGain) {
+    if (frames == 0) {
+        return;
+    }
+    EngramSIMDScalar_GainRampFrames(samples, 0, frames, channels, startGain,
+                                    EngramSIMDScalar_RampStep(frames, startGain, endGain));
+}
+
+static inline void EngramSIMDScalar_Int16ToFloat(Float32* dst, const SInt16* src, UInt32 count) {
+    for (UInt32 i = 0; i < count; i++) {
+        dst[i] = (Float32)src[i] * (1.0f / kEngramSIMDInt16Scale);
+    }
+}
+
+static inline void EngramSIMDScalar_FloatToInt16(SInt16* dst, const Float32* src, UInt32 count) {
+    for (UInt32 i = 0; i < count; i++) {
+        Float32 x = src[i] * kEngramSIMDInt16Scale;
+        x = EngramSIMDScalar_Max(x, -32768.0f);
+        x = EngramSIMDScalar_Min(x, 32767.0f);
+        dst[i] = (SInt16)lrintf(x);
+    }
+}
+
+static inline void EngramSIMDScalar_Interleave2(Float32* dst, const Float32* left, const Float32* right, UInt32 frames) {
+    for (UInt32 i = 0; i < frames; i++) {
+        dst[2 * i] = left[i];
+        dst[2 * i + 1] = right[i];
+    }
+}
+
+static inline void EngramSIMDScalar_Deinterleave2(Float32* left, Float32* right, const Float32* src, UInt32 frames) {
+    for (UInt32 i = 0; i < frames; i++) {
+        left[i] = src[2 * i];
+        right[i] = src[2 * i + 1];
+    }
+}
+
+static inline void EngramSIMDScalar_Biquad(const EngramBiquadCoefficients* coefficients, EngramBiquadState* states,
+                                           Float32* samples, UInt32 frames, UInt32 channels) {
+    for (UInt32 ch = 0; ch < channels; ch++) {
+        EngramBiquad_Process(coefficients, &states[ch], samples + ch, frames, channels);
+    }
+}
+
+// Butterflies [first, half) of the block starting at re/im
+static inline void EngramSIMDScalar_FFTBlock(Float32* re, Float32* im, const Float32* twiddleRe, const Float32* twiddleIm,
+                                             UInt32 first, UInt32 half) {
+    for (UInt32 k = first; k < half; k++) {
+        Float32 wr = twiddleRe[k];
+        Float32 wi = twiddleIm[k];
+        Float32 xr = re[k + half] * wr - im[k + half] * wi;
+        Float32 xi = re[k + half] * wi + im[k + half] * wr;
+        re[k + half] = re[k] - xr;
+        im[k + half] = im[k] - xi;
+        re[k] = re[k] + xr;
+        im[k] = im[k] + xi;
+    }
+}
+
+static inline void EngramSIMDScalar_FFTButterflies(Float32* re, Float32* im, const Float32* twiddleRe,
+                                                   const Float32* twiddleIm, UInt32 count, UInt32 half) {
+    for (UInt32 start = 0; start + 2 * half <= count; start += 2 * half) {
+        EngramSIMDScalar_FFTBlock(re + start, im + start, twiddleRe, twiddleIm, 0, half);
+    }
+}
+
+// MARK: - Vector Kernels
+
+template <class V>
+static void EngramSIMDKernel_Mix(Float32* dst, const Float32* src, Float32 gain, UInt32 count) {
+    typename V::Type g = V::Set1(gain);
+    UInt32 i = 0;
+    for (; i + V::kWidth <= count; i += V::kWidth) {
+        V::Store(dst + i, V::Add(V::Load(dst + i), V::Mul(V::Load(src + i), g)));
+    }
+    EngramSIMDScalar_Mix(dst + i, src + i, gain, count - i);
+}
+
+// A vector either holds whole frames or lies within one, as long as one of
+// the width and the channel count divides the other; anything else
+// (3, 5, 6 or 7 channels) is left to the reference.
+template <class V>
+static void EngramSIMDKernel_GainRamp(Float32* samples, UInt32 frames, UInt32 channels,
+                                      Float32 startGain, Float32 endGain) {
+    if (frames == 0) {
+        return;
+    }
+    Float32 step = EngramSIMDScalar_RampStep(frames, startGain, endGain);
+    if (channels == 0 || (V::kWidth % channels != 0 && channels % V::kWidth != 0)) {
+        EngramSIMDScalar_GainRampFrames(samples, 0, frames, channels, startGain, step);
+        return;
+    }
+
+    // Frame of each lane relative to the vector's first sample
+    Float32 laneFrames[V::kWidth];
+    for (UInt32 lane = 0; lane < V::kWidth; lane++) {
+        laneFrames[lane] = (channels <= V::kWidth) ? (Float32)(lane / channels) : 0.0f;
+    }
+    typename V::Type laneFrame = V::Load(laneFrames);
+    typename V::Type start = V::Set1(startGain);
+    typename V::Type stepVector = V::Set1(step);
+
+    UInt32 count = frames * channels;
+    UInt32 i = 0;
+    for (; i + V::kWidth <= count; i += V::kWidth) {
+        typename V::Type frame = V::Add(V::Set1((Float32)(i / channels)), laneFrame);
+        typename V::Type gain = V::Add(start, V::Mul(frame, stepVector));
+        V::Store(samples + i, V::Mul(V::Load(samples + i), gain));
+    }
+    // Only a whole number of frames can be left over
+    EngramSIMDScalar_GainRampFrames(samples, i / channels, frames, channels, startGain, step);
+}
+
+template <class V>
+static void EngramSIMDKernel_Int16ToFloat(Float32* dst, const SInt16* src, UInt32 count) {
+    typename V::Type scale = V::Set1(1.0f / kEngramSIMDInt16Scale);
+    UInt32 i = 0;
+    for (; i + V::kWidth <= count; i += V::kWidth) {
+        V::Store(dst + i, V::Mul(V::LoadInt16(src + i), scale));
+    }
+    EngramSIMDScalar_Int16ToFloat(dst + i, src + i, count - i);
+}
+
+template <class V>
+static void EngramSIMDKernel_FloatToInt16(SInt16* dst, const Float32* src, UInt32 count) {
+    typename V::Type scale = V::Set1(kEngramSIMDInt16Scale);
+    typename V::Type low = V::Set1(-32768.0f);
+    typename V::Type high = V::Set1(32767.0f);
+    UInt32 i = 0;
+    for (; i + V::kWidth <= count; i += V::kWidth) {
+        typename V::Type x = V::Mul(V::Load(src + i), scale);
+        V::StoreInt16(dst + i, V::Min(V::Max(x, low), high));
+    }
+    EngramSIMDScalar_FloatToInt16(dst + i, src + i, count - i);
+}
+
+template <class V>
+static void EngramSIMDKernel_Interleave2(Float32* dst, const Float32* left, const Float32* right, UInt32 frames) {
+    UInt32 i = 0;
+    for (; i + V::kWidth <= frames; i += V::kWidth) {
+        typename V::Type lo;
+        typename V::Type hi;
+        V::Interleave2(V::Load(left + i), V::Load(right + i), &lo, &hi);
+        V::Store(dst + 2 * i, lo);
+        V::Store(dst + 2 * i + V::kWidth, hi);
+    }
+    EngramSIMDScalar_Interleave2(dst + 2 * i, left + i, right + i, frames - i);
+}
+
+template <class V>
+static void EngramSIMDKernel_Deinterleave2(Float32* left, Float32* right, const Float32* src, UInt32 frames) {
+    UInt32 i = 0;
+    for (; i + V::kWidth <= frames; i += V::kWidth) {
+        typename V::Type a;
+        typename V::Type b;
+        V::Deinterleave2(V::Load(src + 2 * i), V::Load(src + 2 * i + V::kWidth), &a, &b);
+        V::Store(left + i, a);
+        V::Store(right + i, b);
+    }
+    EngramSIMDScalar_Deinterleave2(left + i, right + i, src + 2 * i, frames - i);
+}
+
+// The recursion runs along frames, so the lanes are channels: one vector per
+// kWidth channels, kGroups vectors per frame.
+template <class V, UInt32 kGroups>
+static void EngramSIMDKernel_BiquadGroups(const EngramBiquadCoefficients* c, EngramBiquadState* states,
+                                          Float32* samples, UInt32 frames) {
+    const UInt32 channels = kGroups * V::kWidth;
+    Float32 lanes[2][kGroups * V::kWidth];
+    for (UInt32 ch = 0; ch < channels; ch++) {
+        lanes[0][ch] = states[ch].z1;
+        lanes[1][ch] = states[ch].z2;
+    }
+
+    typename V::Type b0 = V::Set1(c->b0);
+    typename V::Type b1 = V::Set1(c->b1);
+    typename V::Type b2 = V::Set1(c->b2);
+    typename V::Type a1 = V::Set1(c->a1);
+    typename V::Type a2 = V::Set1(c->a2);
+    typename V::Type z1[kGroups];
+    typename V::Type z2[kGroups];
+    for (UInt32 g = 0; g < kGroups; g++) {
+        z1[g] = V::Load(&lanes[0][g * V::kWidth]);
+        z2[g] = V::Load(&lanes[1][g * V::kWidth]);
+    }
+
+    for (UInt32 i = 0; i < frames; i++) {
+        Float32* frame = samples + i * channels;
+        for (UInt32 g = 0; g < kGroups; g++) {
+            typename V::Type x = V::Load(frame + g * V::kWidth);
+            typename V::Type y = V::Add(V::Mul(b0, x), z1[g]);
+            z1[g] = V::Add(V::Sub(V::Mul(b1, x), V::Mul(a1, y)), z2[g]);
+            z2[g] = V::Sub(V::Mul(b2, x), V::Mul(a2, y));
+            V::Store(frame + g * V::kWidth, y);
+        }
+    }
+
+    for (UInt32 g = 0; g < kGroups; g++) {
+        V::Store(&lanes[0][g * V::kWidth], z1[g]);
+        V::Store(&lanes[1][g * V::kWidth], z2[g]);
+    }
+    for (UInt32 ch = 0; ch < channels; ch++) {
+        states[ch].z1 = EngramDSP_FlushDenormal(lanes[0][ch]);
+        states[ch].z2 = EngramDSP_FlushDenormal(lanes[1][ch]);
+    }
+}
+
+// `VNarrow` covers channel counts too small for V (4 channels under AVX2).
+// Fewer channels than that have nothing to put in the lanes.
+template <class V, class VNarrow>
+static void EngramSIMDKernel_Biquad(const EngramBiquadCoefficients* c, EngramBiquadState* states,
+                                    Float32* samples, UInt32 frames, UInt32 channels) {
+    if (channels == V::kWidth) {
+        EngramSIMDKernel_BiquadGroups<V, 1>(c, states, samples, frames);
+    } else if (channels == 2 * V::kWidth) {
+        EngramSIMDKernel_BiquadGroups<V, 2>(c, states, samples, frames);
+    } else if (channels == VNarrow::kWidth) {
+        EngramSIMDKernel_BiquadGroups<VNarrow, 1>(c, states, samples, frames);
+    } else {
+        EngramSIMDScalar_Biquad(c, states, samples, frames, channels);
+    }
+}
+
+// The lanes run along k within a block, so passes narrower than a vector
+// (the first two or three of a transform) are left to the reference.
+template <class V>
+static void EngramSIMDKernel_FFTButterflies(Float32* re, Float32* im, const Float32* twiddleRe,
+                                            const Float32* twiddleIm, UInt32 count, UInt32 half) {
+    if (half < V::kWidth) {
+        EngramSIMDScalar_FFTButterflies(re, im, twiddleRe, twiddleIm, count, half);
+        return;
+    }
+    for (UInt32 start = 0; start + 2 * half <= count; start += 2 * half) {
+        Float32* aRe = re + start;
+        Float32* aIm = im + start;
+        Float32* bRe = aRe + half;
+        Float32* bIm = aIm + half;
+        UInt32 k = 0;
+        for (; k + V::kWidth <= half; k += V::kWidth) {
+            typename V::Type wr = V::Load(twiddleRe + k);
+            typename V::Type wi = V::Load(twiddleIm + k);
+            typename V::Type br = V::Load(bRe + k);
+            typename V::Type bi = V::Load(bIm + k);
+            typename V::Type xr = V::Sub(V::Mul(br, wr), V::Mul(bi, wi));
+            typename V::Type xi = V::Add(V::Mul(br, wi), V::Mul(bi, wr));
+            typename V::Type ar = V::Load(aRe + k);
+            typename V::Type ai = V::Load(aIm + k);
+            V::Store(bRe + k, V::Sub(ar, xr));
+            V::Store(bIm + k, V::Sub(ai, xi));
+            V::Store(aRe + k, V::Add(ar, xr));
+            V::Store(aIm + k, V::Add(ai, xi));
+        }
+        EngramSIMDScalar_FFTBlock(aRe, aIm, twiddleRe, twiddleIm, k, half);
+    }
+}
+
+template <class V, class VNarrow>
+static EngramSIMDKernels EngramSIMDKernels_Make(EngramSIMDLevel level, const char* name) {
+    EngramSIMDKernels kernels;
+    kernels.level = level;
+    kernels.name = name;
+    kernels.mix = EngramSIMDKernel_Mix<V>;
+    kernels.gainRamp = EngramSIMDKernel_GainRamp<V>;
+    kernels.int16ToFloat = EngramSIMDKernel_Int16ToFloat<V>;
+    kernels.floatToInt16 = EngramSIMDKernel_FloatToInt16<V>;
+    kernels.interleave2 = EngramSIMDKernel_Interleave2<V>;
+    kernels.deinterleave2 = EngramSIMDKernel_Deinterleave2<V>;
+    kernels.biquad = EngramSIMDKernel_Biquad<V, VNarrow>;
+    kernels.fftButterflies = EngramSIMDKernel_FFTButterflies<V>;
+    return kernels;
+}
+
+#endif /* EngramSIMDKernels_h */
@@ -0,0 +1,148 @@
+//
+//  EngramSIMDVector.h
+//  Engram Virtual Audio Device
+//
+//  The vector types EngramSIMDKernels.h is written against. Each one wraps a
+//  native register of Float32 lanes behind the same static functions, and is
+//  only defined where the translation unit is compiled for its ISA.
+//
+//  Everything here has internal linkage on purpose: the AVX2 unit also sees
+//  the SSE4.1 type, and an out-of-line copy built with VEX encoding must
+//  never be what the SSE4.1 kernels on an older CPU link against.
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#ifndef EngramSIMDVector_h
+#define EngramSIMDVector_h
+
+#include "EngramTypes.h"
+
+#if defined(__SSE4_1__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+// Min and Max follow the x86 rule (the second operand when either is NaN) on
+// every ISA, so clamping NaN gives the same answer everywhere.
+
+namespace {
+
+// MARK: - SSE4.1
+
+#if defined(__SSE4_1__)
+struct EngramVecSSE41 {
+    typedef __m128 Type;
+    static const UInt32 kWidth = 4;
+
+    static inline Type Load(const Float32* p) { return _mm_loadu_ps(p); }
+    static inline void Store(Float32* p, Type v) { _mm_storeu_ps(p, v); }
+    static inline Type Set1(Float32 x) { return _mm_set1_ps(x); }
+
+    static inline Type Add(Type a, Type b) { return _mm_add_ps(a, b); }
+    static inline Type Sub(Type a, Type b) { return _mm_sub_ps(a, b); }
+    static inline Type Mul(Type a, Type b) { return _mm_mul_ps(a, b); }
+    static inline Type Min(Type a, Type b) { return _mm_min_ps(a, b); }
+    static inline Type Max(Type a, Type b) { return _mm_max_ps(a, b); }
+
+    static inline Type LoadInt16(const SInt16* p) {
+        __m128i x = _mm_loadl_epi64((const __m128i*)p);
+        return _mm_cvtepi32_ps(_mm_cvtepi16_epi32(x));
+    }
+    // `v` must already be within Int16 range
+    static inline void StoreInt16(SInt16* p, Type v) {
+        __m128i x = _mm_cvtps_epi32(v);
+        _mm_storel_epi64((__m128i*)p, _mm_packs_epi32(x, x));
+    }
+
+    static inline void Interleave2(Type a, Type b, Type* lo, Type* hi) {
+        *lo = _mm_unpacklo_ps(a, b);
+        *hi = _mm_unpackhi_ps(a, b);
+    }
+    static inline void Deinterleave2(Type lo, Type hi, Type* a, Type* b) {
+        *a = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+        *b = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));
+    }
+};
+#endif
+
+// MARK: - AVX2
+
+#if defined(__AVX2__)
+struct EngramVecAVX2 {
+    typedef __m256 Type;
+    static const UInt32 kWidth = 8;
+
+    static inline Type Load(const Float32* p) { return _mm256_loadu_ps(p); }
+    static inline void Store(Float32* p, Type v) { _mm256_storeu_ps(p, v); }
+    static inline Type Set1(Float32 x) { return _mm256_set1_ps(x); }
+
+    static inline Type Add(Type a, Type b) { return _mm256_add_ps(a, b); }
+    static inline Type Sub(Type a, Type b) { return _mm256_sub_ps(a, b); }
+    static inline Type Mul(Type a, Type b) { return _mm256_mul_ps(a, b); }
+    static inline Type Min(Type a, Type b) { return _mm256_min_ps(a, b); }
+    static inline Type Max(Type a, Type b) { return _mm256_max_ps(a, b); }
+
+    static inline Type LoadInt16(const SInt16* p) {
+        __m128i x = _mm_loadu_si128((const __m128i*)p);
+        return _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(x));
+    }
+    static inline void StoreInt16(SInt16* p, Type v) {
+        __m256i x = _mm256_cvtps_epi32(v);
+        __m128i packed = _mm_packs_epi32(_mm256_castsi256_si128(x), _mm256_extracti128_si256(x, 1));
+        _mm_storeu_si128((__m128i*)p, packed);
+    }
+
+    // The unpacks work within 128-bit halves, so the halves are swapped into place after
+    static inline void Interleave2(Type a, Type b, Type* lo, Type* hi) {
+        Type low = _mm256_unpacklo_ps(a, b);
+        Type high = _mm256_unpackhi_ps(a, b);
+        *lo = _mm256_permute2f128_ps(low, high, 0x20);
+        *hi = _mm256_permute2f128_ps(low, high, 0x31);
+    }
+    static inline void Deinterleave2(Type lo, Type hi, Type* a, Type* b) {
+        Type evens = _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+        Type odds = _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));
+        *a = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(evens), _MM_SHUFFLE(3, 1, 2, 0)));
+        *b = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(odds), _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+};
+#endif
+
+// MARK: - NEON
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+struct EngramVecNEON {
+    typedef float32x4_t Type;
+    static const UInt32 kWidth = 4;
+
+    static inline Type Load(const Float32* p) { return vld1q_f32(p); }
+    static inline void Store(Float32* p, Type v) { vst1q_f32(p, v); }
+    static inline Type Set1(Float32 x) { return vdupq_n_f32(x); }
+
+    static inline Type Add(Type a, Type b) { return vaddq_f32(a, b); }
+    static inline Type Sub(Type a, Type b) { return vsubq_f32(a, b); }
+    static inline Type Mul(Type a, Type b) { return vmulq_f32(a, b); }
+    // vminq/vmaxq propagate NaN; select instead to keep the x86 rule
+    static inline Type Min(Type a, Type b) { return vbslq_f32(vcltq_f32(a, b), a, b); }
+    static inline Type Max(Type a, Type b) { return vbslq_f32(vcgtq_f32(a, b), a, b); }
+
+    static inline Type LoadInt16(const SInt16* p) { return vcvtq_f32_s32(vmovl_s16(vld1_s16(p))); }
+    static inline void StoreInt16(SInt16* p, Type v) { vst1_s16(p, vqmovn_s32(vcvtnq_s32_f32(v))); }
+
+    static inline void Interleave2(Type a, Type b, Type* lo, Type* hi) {
+        *lo = vzip1q_f32(a, b);
+        *hi = vzip2q_f32(a, b);
+    }
+    static inline void Deinterleave2(Type lo, Type hi, Type* a, Type* b) {
+        *a = vuzp1q_f32(lo, hi);
+        *b = vuzp2q_f32(lo, hi);
+    }
+};
+#endif
+
+} // namespace
+
+#endif /* EngramSIMDVector_h */
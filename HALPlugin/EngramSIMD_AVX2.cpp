@@ -0,0 +1,22 @@
+//
+//  EngramSIMD_AVX2.cpp
+//  Engram Virtual Audio Device
+//
+//  Built with -mavx2 on x86_64 and empty everywhere else. Only reached
+//  after EngramSIMD_KernelsForLevel has checked the CPU. FMA is left off:
+//  fusing would round differently from the scalar reference.
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramSIMDKernels.h"
+
+const EngramSIMDKernels* EngramSIMD_AVX2Kernels(void) {
+#if defined(__AVX2__)
+    static const EngramSIMDKernels kernels =
+        EngramSIMDKernels_Make<EngramVecAVX2, EngramVecSSE41>(kEngramSIMDLevelAVX2, "avx2");
+    return &kernels;
+#else
+    return NULL;
+#endif
+}
@@ -0,0 +1,21 @@
+//
+//  EngramSIMD_NEON.cpp
+//  Engram Virtual Audio Device
+//
+//  NEON is baseline on arm64, so this needs no extra flags; it is empty on
+//  every other architecture (including the x86_64 half of a fat build).
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramSIMDKernels.h"
+
+const EngramSIMDKernels* EngramSIMD_NEONKernels(void) {
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    static const EngramSIMDKernels kernels =
+        EngramSIMDKernels_Make<EngramVecNEON, EngramVecNEON>(kEngramSIMDLevelNEON, "neon");
+    return &kernels;
+#else
+    return NULL;
+#endif
+}
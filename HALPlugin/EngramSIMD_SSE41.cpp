@@ -0,0 +1,21 @@
+//
+//  EngramSIMD_SSE41.cpp
+//  Engram Virtual Audio Device
+//
+//  Built with -msse4.1 on x86_64 and empty everywhere else. Only reached
+//  after EngramSIMD_KernelsForLevel has checked the CPU.
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramSIMDKernels.h"
+
+const EngramSIMDKernels* EngramSIMD_SSE41Kernels(void) {
+#if defined(__SSE4_1__)
+    static const EngramSIMDKernels kernels =
+        EngramSIMDKernels_Make<EngramVecSSE41, EngramVecSSE41>(kEngramSIMDLevelSSE41, "sse4.1");
+    return &kernels;
+#else
+    return NULL;
+#endif
+}
@@ -0,0 +1,83 @@
+//
+//  EngramSeqlock.h
+//  Engram Virtual Audio Device
+//
+//  Sequence-locked publication of small multi-field snapshots
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#ifndef EngramSeqlock_h
+#define EngramSeqlock_h
+
+#include "EngramTypes.h"
+#include <atomic>
+#include <string.h>
+#include <type_traits>
+
+// MARK: - Seqlock
+//
+// Readers never block and never write shared state: they copy the payload and
+// retry if a writer was active. Writers claim the sequence with a CAS, so any
+// number of non-real-time threads may publish without an external mutex.
+//
+// The payload is stored as atomic words rather than a plain struct so that the
+// (discarded) copies taken during a concurrent write are not data races under
+// the C++ memory model. Word stores are release and word loads acquire instead
+// of using standalone fences, which ThreadSanitizer cannot model; on x86 this
+// costs nothing and on ARM it is one ldar/stlr per word.
+
+template <typename T>
+struct EngramSeqlock {
+    static_assert(std::is_trivially_copyable<T>::value, "seqlock payloads must be trivially copyable");
+    static constexpr UInt32 kWords = (UInt32)((sizeof(T) + sizeof(UInt64) - 1) / sizeof(UInt64));
+
+    std::atomic<UInt32> sequence;
+    std::atomic<UInt64> words[kWords];
+};
+
+template <typename T>
+inline void EngramSeqlock_Write(EngramSeqlock<T>* lock, const T& value) {
+    UInt64 staged[EngramSeqlock<T>::kWords] = {};
+    memcpy(staged, &value, sizeof(T));
+
+    UInt32 sequence = lock->sequence.load(std::memory_order_relaxed);
+    for (;;) {
+        if ((sequence & 1) == 0 &&
+            lock->sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+            break;
+        }
+        sequence = lock->sequence.load(std::memory_order_relaxed);
+    }
+
+    for (UInt32 i = 0; i < EngramSeqlock<T>::kWords; i++) {
+        lock->words[i].store(staged[i], std::memory_order_release);
+    }
+
+    lock->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+template <typename T>
+inline T EngramSeqlock_Read(const EngramSeqlock<T>* lock, UInt32* outSequence = NULL) {
+    UInt64 staged[EngramSeqlock<T>::kWords];
+    UInt32 before;
+    UInt32 after;
+
+    do {
+        before = lock->sequence.load(std::memory_order_acquire);
+        for (UInt32 i = 0; i < EngramSeqlock<T>::kWords; i++) {
+            staged[i] = lock->words[i].load(std::memory_order_acquire);
+        }
+        after = lock->sequence.load(std::memory_order_relaxed);
+    } while ((before & 1) != 0 || before != after);
+
+    if (outSequence != NULL) {
+        *outSequence = before;
+    }
+
+    T value;
+    memcpy(&value, staged, sizeof(T));
+    return value;
+}
+
+#endif /* EngramSeqlock_h */
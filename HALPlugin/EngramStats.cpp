@@ -0,0 +1,241 @@
+//
+//  EngramStats.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramStats.h"
+#include "EngramWait.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// MARK: - Histogram
+
+void EngramHistogram_Snapshot(const EngramHistogram* histogram, EngramHistogramSnapshot* outSnapshot) {
+    outSnapshot->count = histogram->count.load(std::memory_order_acquire);
+    outSnapshot->sum = histogram->sum.load(std::memory_order_relaxed);
+    outSnapshot->min = histogram->min.load(std::memory_order_relaxed);
+    outSnapshot->max = histogram->max.load(std::memory_order_relaxed);
+    for (UInt32 i = 0; i < kEngramHistogramBuckets; i++) {
+        outSnapshot->buckets[i] = histogram->buckets[i].load(std::memory_order_relaxed);
+    }
+}
+
+UInt64 EngramHistogram_ValueAtPercentile(const EngramHistogramSnapshot* snapshot, Float64 percentile) {
+    // Buckets are read without stopping the writer, so use their own total
+    // rather than `count`, which may be a few records behind or ahead.
+    UInt64 total = 0;
+    for (UInt32 i = 0; i < kEngramHistogramBuckets; i++) {
+        total += snapshot->buckets[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    Float64 clamped = (percentile < 0.0) ? 0.0 : (percentile > 100.0 ? 100.0 : percentile);
+    UInt64 target = (UInt64)ceil(clamped / 100.0 * (Float64)total);
+    if (target == 0) {
+        target = 1;
+    }
+
+    UInt64 seen = 0;
+    for (UInt32 i = 0; i < kEngramHistogramBuckets; i++) {
+        seen += snapshot->buckets[i];
+        if (seen >= target) {
+            UInt64 upper = (i + 1 < kEngramHistogramBuckets) ? EngramHistogram_BucketLowerBound(i + 1) - 1 : snapshot->max;
+            return (upper < snapshot->max) ? upper : snapshot->max;
+        }
+    }
+    return snapshot->max;
+}
+
+// MARK: - Stats Page
+
+void EngramStats_InitPage(EngramStatsPage* page) {
+    memset((void*)page, 0, sizeof(EngramStatsPage));
+    page->magic = kEngramStatsMagic;
+    page->version = kEngramStatsVersion;
+    page->size = (UInt32)sizeof(EngramStatsPage);
+}
+
+const char* EngramStats_SharedPageName(void) {
+    const char* name = getenv(kEngramStatsNameEnvironment);
+    return (name != NULL && name[0] == '/') ? name : kEngramStatsSharedMemoryName;
+}
+
+// Distinguishes the pages one process creates over its lifetime
+static std::atomic<UInt32> gStatsPageSerial{0};
+
+// Unlinks `name` only while it still refers to the page stamped with this
+// owner, so a page some other instance has since created there survives.
+static void EngramStats_UnlinkIfOwnedBy(const char* name, UInt32 ownerPid, UInt32 ownerSerial) {
+    const EngramStatsPage* page = EngramStats_MapSharedPageReadOnly(name);
+    if (page == NULL) {
+        return;
+    }
+    Boolean owned = (page->ownerPid == ownerPid && page->ownerSerial == ownerSerial);
+    munmap((void*)page, sizeof(EngramStatsPage));
+    if (owned) {
+        shm_unlink(name);
+    }
+}
+
+// Removes a page whose owner has exited without unlinking it. A page that
+// isn't stamped yet, or whose owner can't be probed, is treated as live.
+static void EngramStats_ReclaimAbandonedPage(const char* name) {
+    const EngramStatsPage* page = EngramStats_MapSharedPageReadOnly(name);
+    if (page == NULL) {
+        return;
+    }
+    UInt32 ownerPid = page->ownerPid;
+    UInt32 ownerSerial = page->ownerSerial;
+    munmap((void*)page, sizeof(EngramStatsPage));
+    if (ownerPid != 0 && kill((pid_t)ownerPid, 0) != 0 && errno == ESRCH) {
+        EngramStats_UnlinkIfOwnedBy(name, ownerPid, ownerSerial);
+    }
+}
+
+Boolean EngramStats_OpenSharedPage(const char* name, EngramStatsSharedPage* outShared) {
+    memset(outShared, 0, sizeof(EngramStatsSharedPage));
+    if (strlen(name) >= sizeof(outShared->name)) {
+        return false;
+    }
+
+    // Only a page this process created is initialised and, later, unlinked
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0 && errno == EEXIST) {
+        EngramStats_ReclaimAbandonedPage(name);
+        fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    }
+    if (fd < 0) {
+        return false;
+    }
+
+    // Clients may be running as another user; they only ever map it read-only
+    fchmod(fd, 0644);
+
+    if (ftruncate(fd, sizeof(EngramStatsPage)) != 0) {
+        close(fd);
+        shm_unlink(name);
+        return false;
+    }
+
+    void* mapping = mmap(NULL, sizeof(EngramStatsPage), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        shm_unlink(name);
+        return false;
+    }
+
+    EngramStatsPage* page = (EngramStatsPage*)mapping;
+    EngramStats_InitPage(page);
+    page->ownerPid = (UInt32)getpid();
+    page->ownerSerial = gStatsPageSerial.fetch_add(1, std::memory_order_relaxed) + 1;
+
+    outShared->page = page;
+    outShared->ownerSerial = page->ownerSerial;
+    strcpy(outShared->name, name);
+    return true;
+}
+
+void EngramStats_CloseSharedPage(EngramStatsSharedPage* shared) {
+    if (shared->page == NULL) {
+        return;
+    }
+    munmap((void*)shared->page, sizeof(EngramStatsPage));
+    EngramStats_UnlinkIfOwnedBy(shared->name, (UInt32)getpid(), shared->ownerSerial);
+    memset(shared, 0, sizeof(EngramStatsSharedPage));
+}
+
+const EngramStatsPage* EngramStats_MapSharedPageReadOnly(const char* name) {
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(EngramStatsPage)) {
+        close(fd);
+        return NULL;
+    }
+
+    void* mapping = mmap(NULL, sizeof(EngramStatsPage), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return NULL;
+    }
+
+    const EngramStatsPage* page = (const EngramStatsPage*)mapping;
+    if (page->magic != kEngramStatsMagic || page->version != kEngramStatsVersion) {
+        munmap(mapping, sizeof(EngramStatsPage));
+        return NULL;
+    }
+    return page;
+}
+
+void EngramStats_Snapshot(const EngramStatsPage* page, EngramStatsSnapshot* outSnapshot) {
+    outSnapshot->magic = page->magic;
+    outSnapshot->version = page->version;
+    outSnapshot->size = (UInt32)sizeof(EngramStatsSnapshot);
+    outSnapshot->reserved = 0;
+
+    outSnapshot->ioClients = page->ioClients.load(std::memory_order_relaxed);
+    outSnapshot->lowWaterFrames = page->lowWaterFrames.load(std::memory_order_relaxed);
+    outSnapshot->ioActivations = page->ioActivations.load(std::memory_order_relaxed);
+    outSnapshot->lowWaterSignals = page->lowWaterSignals.load(std::memory_order_relaxed);
+
+    outSnapshot->ioCycles = page->ioCycles.load(std::memory_order_relaxed);
+    outSnapshot->underruns = page->underruns.load(std::memory_order_relaxed);
+    outSnapshot->underrunSamples = page->underrunSamples.load(std::memory_order_relaxed);
+    outSnapshot->overrunSamples = page->overrunSamples.load(std::memory_order_relaxed);
+    outSnapshot->glitches = page->glitches.load(std::memory_order_relaxed);
+    outSnapshot->discontinuities = page->discontinuities.load(std::memory_order_relaxed);
+    outSnapshot->clicks = page->clicks.load(std::memory_order_relaxed);
+    outSnapshot->glitchSnapshotsDropped = page->glitchSnapshotsDropped.load(std::memory_order_relaxed);
+    outSnapshot->renderCycles = page->renderCycles.load(std::memory_order_relaxed);
+    outSnapshot->renderMisses = page->renderMisses.load(std::memory_order_relaxed);
+    outSnapshot->residencyStampsDropped = page->residencyStampsDropped.load(std::memory_order_relaxed);
+    outSnapshot->mixCycles = page->mixCycles.load(std::memory_order_relaxed);
+    outSnapshot->mixOverrunSamples = page->mixOverrunSamples.load(std::memory_order_relaxed);
+    outSnapshot->outputSamplesScrubbed = page->outputSamplesScrubbed.load(std::memory_order_relaxed);
+    outSnapshot->loopbackCycles = page->loopbackCycles.load(std::memory_order_relaxed);
+    outSnapshot->feedbackEvents = page->feedbackEvents.load(std::memory_order_relaxed);
+    outSnapshot->feedbackNotches = page->feedbackNotches.load(std::memory_order_relaxed);
+    outSnapshot->feedbackGainCut = page->feedbackGainCut.load(std::memory_order_relaxed);
+
+    EngramHistogram_Snapshot(&page->ioDurationNs, &outSnapshot->ioDurationNs);
+    EngramHistogram_Snapshot(&page->ringFillFrames, &outSnapshot->ringFillFrames);
+    EngramHistogram_Snapshot(&page->cycleJitterNs, &outSnapshot->cycleJitterNs);
+    EngramHistogram_Snapshot(&page->renderWaitNs, &outSnapshot->renderWaitNs);
+    EngramHistogram_Snapshot(&page->queueResidencyNs, &outSnapshot->queueResidencyNs);
+}
+
+// MARK: - IO Gate Mirror
+
+void EngramStats_PublishIO(EngramStatsPage* page, const EngramGate* gate) {
+    // A publisher whose copy the gate has since moved past goes round again,
+    // so the last store to land always holds the current state
+    UInt32 clients;
+    UInt64 activations;
+    do {
+        clients = gate->clients.load(std::memory_order_seq_cst);
+        activations = gate->activations.load(std::memory_order_seq_cst);
+        page->ioActivations.store(activations, std::memory_order_seq_cst);
+        page->ioClients.store(clients, std::memory_order_seq_cst);
+    } while (gate->clients.load(std::memory_order_seq_cst) != clients ||
+             gate->activations.load(std::memory_order_seq_cst) != activations);
+    EngramWait_WakeAll(&page->ioClients);
+}
+
+Boolean EngramStats_WaitForIO(const EngramStatsPage* page, UInt64 timeoutNanos) {
+    return EngramGate_WaitForIO(&page->ioClients, timeoutNanos);
+}
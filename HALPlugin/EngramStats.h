@@ -0,0 +1,229 @@
+//
+//  EngramStats.h
+//  Engram Virtual Audio Device
+//
+//  Lock-free IO-path histograms and counters, published in shared memory
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#ifndef EngramStats_h
+#define EngramStats_h
+
+#include "EngramGate.h"
+#include "EngramTypes.h"
+#include <atomic>
+
+#define kEngramStatsSharedMemoryName "/engram.hal.stats"
+// Names a different page, so several plugin instances (parallel test runs)
+// each publish their own
+#define kEngramStatsNameEnvironment "ENGRAM_HAL_STATS_NAME"
+// Longest name macOS accepts for a POSIX shared-memory object, plus the NUL
+#define kEngramStatsMaxNameLength 32
+#define kEngramStatsMagic 0x454E5354u   // 'ENST'
+#define kEngramStatsVersion 11
+
+// MARK: - Histogram
+//
+// Log-linear buckets in the style of HdrHistogram: values below 16 get exact
+// buckets, above that every power of two is split into 8 linear sub-buckets
+// (12.5% worst-case relative error). Values at or above 2^40 land in the last
+// bucket, which is far beyond anything the IO path measures.
+
+#define kEngramHistogramSubBucketBits 3
+#define kEngramHistogramSubBuckets (1u << kEngramHistogramSubBucketBits)
+#define kEngramHistogramLinearLimit (2u * kEngramHistogramSubBuckets)
+#define kEngramHistogramMaxExponent 40
+#define kEngramHistogramBuckets \
+    (kEngramHistogramLinearLimit + (kEngramHistogramMaxExponent - kEngramHistogramSubBucketBits - 1) * kEngramHistogramSubBuckets)
+
+// Live histogram. Recorded by a single thread (the IO thread) with relaxed
+// load/store pairs; read concurrently by anyone, including other processes.
+typedef struct {
+    std::atomic<UInt64> count;
+    std::atomic<UInt64> sum;
+    std::atomic<UInt64> min;
+    std::atomic<UInt64> max;
+    std::atomic<UInt64> buckets[kEngramHistogramBuckets];
+} EngramHistogram;
+
+typedef struct {
+    UInt64 count;
+    UInt64 sum;
+    UInt64 min;
+    UInt64 max;
+    UInt64 buckets[kEngramHistogramBuckets];
+} EngramHistogramSnapshot;
+
+static inline UInt32 EngramHistogram_BucketForValue(UInt64 value) {
+    if (value < kEngramHistogramLinearLimit) {
+        return (UInt32)value;
+    }
+    UInt32 exponent = 63 - (UInt32)__builtin_clzll(value);
+    if (exponent >= kEngramHistogramMaxExponent) {
+        return kEngramHistogramBuckets - 1;
+    }
+    UInt32 sub = (UInt32)(value >> (exponent - kEngramHistogramSubBucketBits)) & (kEngramHistogramSubBuckets - 1);
+    return kEngramHistogramLinearLimit + (exponent - kEngramHistogramSubBucketBits - 1) * kEngramHistogramSubBuckets + sub;
+}
+
+// Smallest value that maps to `bucket`.
+static inline UInt64 EngramHistogram_BucketLowerBound(UInt32 bucket) {
+    if (bucket < kEngramHistogramLinearLimit) {
+        return bucket;
+    }
+    UInt32 offset = bucket - kEngramHistogramLinearLimit;
+    UInt32 exponent = offset / kEngramHistogramSubBuckets + kEngramHistogramSubBucketBits + 1;
+    UInt64 sub = offset % kEngramHistogramSubBuckets;
+    return (kEngramHistogramSubBuckets + sub) << (exponent - kEngramHistogramSubBucketBits);
+}
+
+// Single-writer counter update: a relaxed load/store pair, no locked RMW.
+static inline void EngramStats_Add(std::atomic<UInt64>* counter, UInt64 delta) {
+    counter->store(counter->load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+// Real-time safe; single writer per histogram.
+static inline void EngramHistogram_Record(EngramHistogram* histogram, UInt64 value) {
+    UInt64 count = histogram->count.load(std::memory_order_relaxed);
+    if (count == 0 || value < histogram->min.load(std::memory_order_relaxed)) {
+        histogram->min.store(value, std::memory_order_relaxed);
+    }
+    if (value > histogram->max.load(std::memory_order_relaxed)) {
+        histogram->max.store(value, std::memory_order_relaxed);
+    }
+    EngramStats_Add(&histogram->buckets[EngramHistogram_BucketForValue(value)], 1);
+    EngramStats_Add(&histogram->sum, value);
+    histogram->count.store(count + 1, std::memory_order_release);
+}
+
+void EngramHistogram_Snapshot(const EngramHistogram* histogram, EngramHistogramSnapshot* outSnapshot);
+// Value at `percentile` (0-100), reported as the upper edge of its bucket
+// clamped to the recorded maximum. Returns 0 for an empty histogram.
+UInt64 EngramHistogram_ValueAtPercentile(const EngramHistogramSnapshot* snapshot, Float64 percentile);
+
+// MARK: - Stats Page
+
+typedef struct {
+    UInt32 magic;
+    UInt32 version;
+    UInt32 size;
+    UInt32 ownerPid;        // process that created the shared page and will unlink it
+    UInt32 ownerSerial;     // which of that process's pages this is
+    UInt32 reserved;
+
+    // Control block: read-only mirrors of the plugin's producer pacing (see
+    // EngramGate.h) for producers in other processes. They sleep on ioClients
+    // while it reads 0, and on lowWaterSequence after arming a low-water
+    // wake through kEngramPropertyLowWater.
+    std::atomic<UInt32> ioClients;          // EngramGate clients, plus kEngramGateClosed
+    std::atomic<UInt32> lowWaterSequence;   // EngramLowWater sequence
+    std::atomic<UInt64> ioActivations;      // EngramGate activations
+    std::atomic<UInt32> lowWaterFrames;     // last threshold armed
+    std::atomic<UInt64> lowWaterSignals;    // wakes the IO thread has issued
+
+    std::atomic<UInt64> ioCycles;
+    std::atomic<UInt64> underruns;          // cycles where the ring could not fill the buffer
+    std::atomic<UInt64> underrunSamples;
+    std::atomic<UInt64> overrunSamples;     // producer samples dropped because the ring was full
+    std::atomic<UInt64> glitches;           // cycles with any EngramGlitchKind
+    std::atomic<UInt64> discontinuities;    // cycles whose sample time skipped or repeated
+    std::atomic<UInt64> clicks;             // cycles with a high-pass energy spike
+    std::atomic<UInt64> glitchSnapshotsDropped;
+    std::atomic<UInt64> renderCycles;       // pull-mode cycles a producer rendered on demand
+    std::atomic<UInt64> renderMisses;       // pull-mode cycles that gave up waiting and read the ring
+    std::atomic<UInt64> residencyStampsDropped; // producer writes whose timestamp found the side ring full
+    std::atomic<UInt64> mixCycles;          // WriteMix cycles, each one mixed output buffer
+    std::atomic<UInt64> mixOverrunSamples;  // mixed samples dropped because nobody drained the output ring
+    std::atomic<UInt64> outputSamplesScrubbed; // non-finite client output samples ProcessOutput zeroed
+    std::atomic<UInt64> loopbackCycles;     // ProcessInput calls that carried other clients' output
+    std::atomic<UInt64> feedbackEvents;     // howls found on the input: notches engaged plus gain cuts
+    std::atomic<UInt32> feedbackNotches;    // notch filters currently suppressing a howl
+    std::atomic<UInt32> feedbackGainCut;    // non-zero while the input is turned down to stop a howl
+
+    EngramHistogram ioDurationNs;           // DoIOOperation wall time
+    EngramHistogram ringFillFrames;         // frames queued when the IO thread reads
+    EngramHistogram cycleJitterNs;          // |actual - nominal| spacing between consecutive cycles
+    EngramHistogram renderWaitNs;           // time ReadInput spent waiting for a pull-mode render
+    EngramHistogram queueResidencyNs;       // producer write to ReadInput for the oldest sample delivered
+} EngramStatsPage;
+
+// Plain copy of the page; this is the payload of kEngramPropertyStats.
+typedef struct {
+    UInt32 magic;
+    UInt32 version;
+    UInt32 size;
+    UInt32 reserved;
+
+    UInt32 ioClients;
+    UInt32 lowWaterFrames;
+    UInt64 ioActivations;
+    UInt64 lowWaterSignals;
+
+    UInt64 ioCycles;
+    UInt64 underruns;
+    UInt64 underrunSamples;
+    UInt64 overrunSamples;
+    UInt64 glitches;
+    UInt64 discontinuities;
+    UInt64 clicks;
+    UInt64 glitchSnapshotsDropped;
+    UInt64 renderCycles;
+    UInt64 renderMisses;
+    UInt64 residencyStampsDropped;
+    UInt64 mixCycles;
+    UInt64 mixOverrunSamples;
+    UInt64 outputSamplesScrubbed;
+    UInt64 loopbackCycles;
+    UInt64 feedbackEvents;
+    UInt32 feedbackNotches;
+    UInt32 feedbackGainCut;
+
+    EngramHistogramSnapshot ioDurationNs;
+    EngramHistogramSnapshot ringFillFrames;
+    EngramHistogramSnapshot cycleJitterNs;
+    EngramHistogramSnapshot renderWaitNs;
+    EngramHistogramSnapshot queueResidencyNs;
+} EngramStatsSnapshot;
+
+// A shared page this process created, and so the only one it may unlink
+typedef struct {
+    EngramStatsPage* page;
+    UInt32 ownerSerial;
+    char name[kEngramStatsMaxNameLength];
+} EngramStatsSharedPage;
+
+// The page name this process publishes under: kEngramStatsSharedMemoryName
+// unless kEngramStatsNameEnvironment says otherwise.
+const char* EngramStats_SharedPageName(void);
+
+// Creates the POSIX shared-memory stats page `name`, zeroed and stamped with
+// this process as its owner. A page left behind by a process that has exited
+// is replaced; one whose owner is still running is left alone and the call
+// fails, as it does if the process is not allowed to create the page.
+Boolean EngramStats_OpenSharedPage(const char* name, EngramStatsSharedPage* outShared);
+// Unmaps the page, and unlinks its name only while the name still refers to it.
+void EngramStats_CloseSharedPage(EngramStatsSharedPage* shared);
+// Maps an existing page read-only for monitoring tools.
+const EngramStatsPage* EngramStats_MapSharedPageReadOnly(const char* name);
+void EngramStats_InitPage(EngramStatsPage* page);
+void EngramStats_Snapshot(const EngramStatsPage* page, EngramStatsSnapshot* outSnapshot);
+
+// MARK: - IO Gate Mirror
+//
+// The plugin keeps the IO gate (EngramGate) in its own memory and republishes
+// it here, so producers in other processes can follow it through a read-only
+// mapping. Nothing in the plugin reads the mirror back.
+
+// Copies the gate into the page and wakes anyone sleeping on the mirror.
+// Concurrent publishers settle on the gate's latest value.
+void EngramStats_PublishIO(EngramStatsPage* page, const EngramGate* gate);
+
+static inline Boolean EngramStats_IOActive(const EngramStatsPage* page) {
+    return EngramGate_IsRunning(page->ioClients.load(std::memory_order_acquire));
+}
+
+// EngramGate_WaitForIO on the mirror. Not real-time safe.
+Boolean EngramStats_WaitForIO(const EngramStatsPage* page, UInt64 timeoutNanos);
+
+#endif /* EngramStats_h */
@@ -0,0 +1,175 @@
+//
+//  EngramTrace.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramTrace.h"
+#include "EngramFiles.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+static_assert((kEngramTraceCapacity & (kEngramTraceCapacity - 1)) == 0, "kEngramTraceCapacity must be a power of two");
+
+std::atomic<Boolean> gEngramTraceEnabled;
+
+static std::atomic<EngramTraceSlot*> gTraceSlots;
+static std::atomic<UInt64> gTraceHead;
+
+// MARK: - Recording
+//
+// Writers claim an index with one fetch_add and publish the record through
+// the slot's seqlock; when the ring wraps the oldest records are overwritten.
+// The exporter keeps only records whose index matches the slot it expected.
+
+void EngramTrace_RecordEvent(EngramTraceEvent event, UInt64 hostTime, UInt64 cycle, UInt64 deadlineHostTime,
+                             Float64 sampleTime, UInt32 operation, UInt32 frames, UInt32 ringFill) {
+    EngramTraceSlot* slots = gTraceSlots.load(std::memory_order_acquire);
+    if (slots == NULL) {
+        return;
+    }
+
+    EngramTraceRecord record;
+    record.index = gTraceHead.fetch_add(1, std::memory_order_relaxed);
+    record.hostTime = hostTime;
+    record.cycle = cycle;
+    record.deadlineHostTime = deadlineHostTime;
+    record.sampleTime = sampleTime;
+    record.event = (UInt32)event;
+    record.operation = operation;
+    record.frames = frames;
+    record.ringFill = ringFill;
+
+    EngramSeqlock_Write(&slots[record.index & (kEngramTraceCapacity - 1)], record);
+}
+
+// MARK: - Control
+
+void EngramTrace_Attach(EngramTraceSlot* slots) {
+    if (slots == NULL) {
+        gEngramTraceEnabled.store(false, std::memory_order_relaxed);
+    } else {
+        // Index 0 must not look like a valid record in an unwritten slot
+        EngramTraceRecord empty;
+        memset(&empty, 0, sizeof(empty));
+        empty.index = ~0ull;
+        for (UInt32 i = 0; i < kEngramTraceCapacity; i++) {
+            EngramSeqlock_Write(&slots[i], empty);
+        }
+        gTraceHead.store(0, std::memory_order_relaxed);
+    }
+    gTraceSlots.store(slots, std::memory_order_release);
+}
+
+void EngramTrace_SetEnabled(Boolean enabled) {
+    gEngramTraceEnabled.store(enabled && gTraceSlots.load(std::memory_order_acquire) != NULL, std::memory_order_relaxed);
+}
+
+Boolean EngramTrace_IsEnabled(void) {
+    return gEngramTraceEnabled.load(std::memory_order_relaxed);
+}
+
+// MARK: - Export
+
+size_t EngramTrace_SerializedSize(void) {
+    UInt64 head = gTraceHead.load(std::memory_order_acquire);
+    UInt64 count = (head < kEngramTraceCapacity) ? head : kEngramTraceCapacity;
+    return sizeof(EngramTraceHeader) + (size_t)count * sizeof(EngramTraceRecord);
+}
+
+size_t EngramTrace_Serialize(void* buffer, size_t bufferSize, Float64 nanosPerHostTick, Float64 sampleRate) {
+    if (bufferSize < sizeof(EngramTraceHeader)) {
+        return 0;
+    }
+
+    EngramTraceHeader* header = (EngramTraceHeader*)buffer;
+    EngramTraceRecord* records = (EngramTraceRecord*)(header + 1);
+    UInt32 maxRecords = (UInt32)((bufferSize - sizeof(EngramTraceHeader)) / sizeof(EngramTraceRecord));
+    UInt32 count = 0;
+
+    EngramTraceSlot* slots = gTraceSlots.load(std::memory_order_acquire);
+    if (slots != NULL) {
+        UInt64 head = gTraceHead.load(std::memory_order_acquire);
+        UInt64 first = (head > kEngramTraceCapacity) ? head - kEngramTraceCapacity : 0;
+
+        for (UInt64 index = first; index < head && count < maxRecords; index++) {
+            EngramTraceRecord record = EngramSeqlock_Read(&slots[index & (kEngramTraceCapacity - 1)]);
+            // Skip slots that were overwritten by a newer lap, or claimed but
+            // not yet published
+            if (record.index == index) {
+                records[count++] = record;
+            }
+        }
+    }
+
+    header->magic = kEngramTraceMagic;
+    header->version = kEngramTraceVersion;
+    header->recordCount = count;
+    header->recordSize = (UInt32)sizeof(EngramTraceRecord);
+    header->nanosPerHostTick = nanosPerHostTick;
+    header->sampleRate = sampleRate;
+    return sizeof(EngramTraceHeader) + (size_t)count * sizeof(EngramTraceRecord);
+}
+
+Boolean EngramTrace_WriteFile(const char* path, Float64 nanosPerHostTick, Float64 sampleRate) {
+    // Written to a new private file, then renamed over the previous dump;
+    // rename replaces a symlink at `path` rather than following it
+    char temporaryPath[kEngramMaxPathLength];
+    if (snprintf(temporaryPath, sizeof(temporaryPath), "%s.%d.tmp", path, (int)getpid()) >= (int)sizeof(temporaryPath)) {
+        return false;
+    }
+    unlink(temporaryPath);
+    FILE* file = EngramFiles_CreatePrivate(temporaryPath);
+    if (file == NULL) {
+        return false;
+    }
+
+    // Copy out in chunks through a stack buffer so this can run on any
+    // thread without a large allocation.
+    static const UInt32 kChunkRecords = 256;
+    EngramTraceRecord pending[kChunkRecords];
+
+    EngramTraceHeader header;
+    header.magic = kEngramTraceMagic;
+    header.version = kEngramTraceVersion;
+    header.recordCount = 0;
+    header.recordSize = (UInt32)sizeof(EngramTraceRecord);
+    header.nanosPerHostTick = nanosPerHostTick;
+    header.sampleRate = sampleRate;
+    fwrite(&header, sizeof(header), 1, file);
+
+    EngramTraceSlot* slots = gTraceSlots.load(std::memory_order_acquire);
+    UInt32 count = 0;
+    if (slots != NULL) {
+        UInt64 head = gTraceHead.load(std::memory_order_acquire);
+        UInt64 first = (head > kEngramTraceCapacity) ? head - kEngramTraceCapacity : 0;
+        UInt32 pendingCount = 0;
+
+        for (UInt64 index = first; index < head; index++) {
+            EngramTraceRecord record = EngramSeqlock_Read(&slots[index & (kEngramTraceCapacity - 1)]);
+            if (record.index != index) {
+                continue;
+            }
+            pending[pendingCount++] = record;
+            if (pendingCount == kChunkRecords) {
+                fwrite(pending, sizeof(EngramTraceRecord), pendingCount, file);
+                count += pendingCount;
+                pendingCount = 0;
+            }
+        }
+        fwrite(pending, sizeof(EngramTraceRecord), pendingCount, file);
+        count += pendingCount;
+    }
+
+    header.recordCount = count;
+    fseek(file, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, file);
+    if (fclose(file) != 0 || rename(temporaryPath, path) != 0) {
+        unlink(temporaryPath);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,101 @@
+//
+//  EngramTrace.h
+//  Engram Virtual Audio Device
+//
+//  Optional flight-recorder tracing of IO cycles and producer writes
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#ifndef EngramTrace_h
+#define EngramTrace_h
+
+#include "EngramSeqlock.h"
+#include "EngramTypes.h"
+#include <atomic>
+#include <stddef.h>
+
+// Power of two. At ~5 events per 512-frame cycle this holds ~17 s at 48 kHz.
+#define kEngramTraceCapacity 8192
+#define kEngramTraceMagic 0x454E5452u   // 'ENTR'
+#define kEngramTraceVersion 1
+// Where, in the diagnostics directory, the plugin dumps the trace when
+// tracing is switched off
+#define kEngramTraceFileName "engram-hal-trace.bin"
+
+// MARK: - Records
+
+typedef enum {
+    kEngramTraceEventStartIO = 1,
+    kEngramTraceEventStopIO,
+    kEngramTraceEventBeginIO,         // BeginIOOperation
+    kEngramTraceEventDoIOBegin,       // DoIOOperation entry
+    kEngramTraceEventDoIOEnd,         // DoIOOperation exit
+    kEngramTraceEventEndIO,           // EndIOOperation
+    kEngramTraceEventProducerWrite,   // samples pushed into the ring
+    kEngramTraceEventUnderrun         // ring could not fill a read
+} EngramTraceEvent;
+
+typedef struct {
+    UInt64 index;          // global sequence number, used to detect overwritten slots
+    UInt64 hostTime;       // when the event happened
+    UInt64 cycle;          // ioCycleInfo->mIOCycleCounter, 0 outside IO
+    UInt64 deadlineHostTime; // ioCycleInfo host time the operation is due for, 0 if none
+    Float64 sampleTime;    // ioCycleInfo sample time for the operation
+    UInt32 event;          // EngramTraceEvent
+    UInt32 operation;      // IO operation ID, client ID for Start/StopIO, or
+                           // frames requested for ProducerWrite
+    UInt32 frames;         // frames the operation covers; for ProducerWrite, frames written
+    UInt32 ringFill;       // frames queued in the ring after the event
+} EngramTraceRecord;
+
+typedef EngramSeqlock<EngramTraceRecord> EngramTraceSlot;
+
+// Header of a serialized trace (file or kEngramPropertyTrace payload),
+// followed by `recordCount` records, oldest first.
+typedef struct {
+    UInt32 magic;
+    UInt32 version;
+    UInt32 recordCount;
+    UInt32 recordSize;
+    Float64 nanosPerHostTick;
+    Float64 sampleRate;
+} EngramTraceHeader;
+
+// MARK: - Recording (real-time safe)
+
+extern std::atomic<Boolean> gEngramTraceEnabled;
+
+void EngramTrace_RecordEvent(EngramTraceEvent event, UInt64 hostTime, UInt64 cycle, UInt64 deadlineHostTime,
+                             Float64 sampleTime, UInt32 operation, UInt32 frames, UInt32 ringFill);
+
+// Costs a single relaxed load when tracing is off.
+#define ENGRAM_TRACE(...)                                                   \
+    do {                                                                    \
+        if (gEngramTraceEnabled.load(std::memory_order_relaxed)) {          \
+            EngramTrace_RecordEvent(__VA_ARGS__);                           \
+        }                                                                   \
+    } while (0)
+
+// MARK: - Control
+
+static inline size_t EngramTrace_RequiredBytes(void) {
+    return sizeof(EngramTraceSlot) * kEngramTraceCapacity;
+}
+
+// Attaches preallocated slot storage (kEngramTraceCapacity slots) or detaches with NULL.
+void EngramTrace_Attach(EngramTraceSlot* slots);
+void EngramTrace_SetEnabled(Boolean enabled);
+Boolean EngramTrace_IsEnabled(void);
+
+// MARK: - Export
+
+// Bytes needed to serialize everything currently held.
+size_t EngramTrace_SerializedSize(void);
+// Writes a header plus the retained records (oldest first) into `buffer`.
+// Returns the number of bytes written.
+size_t EngramTrace_Serialize(void* buffer, size_t bufferSize, Float64 nanosPerHostTick, Float64 sampleRate);
+// Replaces `path` with the serialized trace, as a file only this user can read.
+Boolean EngramTrace_WriteFile(const char* path, Float64 nanosPerHostTick, Float64 sampleRate);
+
+#endif /* EngramTrace_h */
@@ -0,0 +1,33 @@
+//
+//  EngramTypes.h
+//  Engram Virtual Audio Device
+//
+//  Scalar type vocabulary shared by the plugin's portable modules
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#ifndef EngramTypes_h
+#define EngramTypes_h
+
+// Linux builds that put Platform/Linux on the include path get the shim
+// MacTypes.h, so CoreAudio-facing and standalone code agree on every type.
+#if defined(__APPLE__) || __has_include(<MacTypes.h>)
+#include <MacTypes.h>
+#else
+#include <stdint.h>
+
+typedef uint8_t  UInt8;
+typedef int8_t   SInt8;
+typedef uint16_t UInt16;
+typedef int16_t  SInt16;
+typedef uint32_t UInt32;
+typedef int32_t  SInt32;
+typedef uint64_t UInt64;
+typedef int64_t  SInt64;
+typedef float    Float32;
+typedef double   Float64;
+typedef unsigned char Boolean;
+#endif
+
+#endif /* EngramTypes_h */
@@ -0,0 +1,114 @@
+//
+//  EngramWait.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramWait.h"
+#include <time.h>
+
+#if defined(__linux__)
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define ENGRAM_WAIT_FUTEX 1
+#elif defined(__APPLE__)
+#include <stdint.h>
+#if __has_include(<os/os_sync_wait_on_address.h>)
+#include <os/os_sync_wait_on_address.h>
+#define ENGRAM_WAIT_OS_SYNC 1
+#endif
+// Before macOS 14.4 the same kernel primitive is only reachable through
+// these. Private, but stable since macOS 10.12; libc++ builds
+// std::atomic::wait on them.
+extern "C" int __ulock_wait(uint32_t operation, void* address, uint64_t value, uint32_t timeoutMicros);
+extern "C" int __ulock_wake(uint32_t operation, void* address, uint64_t wakeValue);
+#define kEngramULockCompareAndWaitShared 3
+#define kEngramULockWakeAll 0x00000100u
+#define ENGRAM_WAIT_ULOCK 1
+#endif
+
+#define kEngramWaitNanosPerSecond 1000000000ull
+
+// The kernel compares and sleeps on the raw 32-bit word
+static_assert(sizeof(std::atomic<UInt32>) == sizeof(UInt32) && std::atomic<UInt32>::is_always_lock_free,
+              "wait words must be plain lock-free 32-bit integers");
+
+UInt64 EngramWait_Now(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (UInt64)now.tv_sec * kEngramWaitNanosPerSecond + (UInt64)now.tv_nsec;
+}
+
+// MARK: - Polling Fallback
+
+#if !ENGRAM_WAIT_FUTEX && !ENGRAM_WAIT_ULOCK
+static void EngramWait_Poll(const std::atomic<UInt32>* word, UInt32 expected, UInt64 timeoutNanos) {
+    UInt64 deadline = (timeoutNanos != 0) ? EngramWait_Now() + timeoutNanos : 0;
+    while (word->load(std::memory_order_acquire) == expected) {
+        UInt64 slice = kEngramWaitPollNs;
+        if (deadline != 0) {
+            UInt64 now = EngramWait_Now();
+            if (now >= deadline) {
+                return;
+            }
+            slice = (deadline - now < slice) ? deadline - now : slice;
+        }
+        struct timespec pause = { 0, (long)slice };
+        nanosleep(&pause, NULL);
+    }
+}
+#endif
+
+// MARK: - Wait
+
+void EngramWait_WhileEqual(const std::atomic<UInt32>* word, UInt32 expected, UInt64 timeoutNanos) {
+    if (word->load(std::memory_order_acquire) != expected) {
+        return;
+    }
+
+#if ENGRAM_WAIT_FUTEX
+    // Not FUTEX_PRIVATE_FLAG: the word may be in a page another process maps
+    struct timespec timeout = { (time_t)(timeoutNanos / kEngramWaitNanosPerSecond),
+                                (long)(timeoutNanos % kEngramWaitNanosPerSecond) };
+    syscall(SYS_futex, (void*)word, FUTEX_WAIT, expected, (timeoutNanos != 0) ? &timeout : NULL, NULL, 0);
+#elif ENGRAM_WAIT_ULOCK
+#if ENGRAM_WAIT_OS_SYNC
+    if (__builtin_available(macOS 14.4, *)) {
+        if (timeoutNanos == 0) {
+            os_sync_wait_on_address((void*)word, expected, sizeof(UInt32), OS_SYNC_WAIT_ON_ADDRESS_SHARED);
+        } else {
+            os_sync_wait_on_address_with_timeout((void*)word, expected, sizeof(UInt32), OS_SYNC_WAIT_ON_ADDRESS_SHARED,
+                                                 OS_CLOCK_MACH_ABSOLUTE_TIME, timeoutNanos);
+        }
+        return;
+    }
+#endif
+    // Microseconds, rounded up so a short timeout never becomes "forever"
+    UInt64 micros = (timeoutNanos + 999) / 1000;
+    __ulock_wait(kEngramULockCompareAndWaitShared, (void*)word, expected,
+                 (micros > UINT32_MAX) ? UINT32_MAX : (uint32_t)micros);
+#else
+    EngramWait_Poll(word, expected, timeoutNanos);
+#endif
+}
+
+void EngramWait_WakeAll(std::atomic<UInt32>* word) {
+#if ENGRAM_WAIT_FUTEX
+    syscall(SYS_futex, (void*)word, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+#elif ENGRAM_WAIT_ULOCK
+#if ENGRAM_WAIT_OS_SYNC
+    if (__builtin_available(macOS 14.4, *)) {
+        os_sync_wake_by_address_all((void*)word, sizeof(UInt32), OS_SYNC_WAKE_BY_ADDRESS_SHARED);
+        return;
+    }
+#endif
+    __ulock_wake(kEngramULockCompareAndWaitShared | kEngramULockWakeAll, (void*)word, 0);
+#else
+    // Pollers notice the store on their own
+    (void)word;
+#endif
+}
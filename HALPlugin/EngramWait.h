@@ -0,0 +1,41 @@
+//
+//  EngramWait.h
+//  Engram Virtual Audio Device
+//
+//  Sleeping on a 32-bit word until someone changes it: a futex on Linux,
+//  os_sync_wait_on_address on macOS 14.4 and later, __ulock_wait on earlier
+//  macOS, and a short polling sleep anywhere else. Words may live in memory
+//  shared between processes.
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#ifndef EngramWait_h
+#define EngramWait_h
+
+#include "EngramTypes.h"
+#include <atomic>
+
+// The polling fallback checks the word this often, well inside one IO cycle
+#define kEngramWaitPollNs 250000ull
+
+// MARK: - Wait
+
+// Returns once *word no longer holds `expected`, after a wake, or after
+// `timeoutNanos` (0 waits without limit). Wakeups may be spurious, so callers
+// re-check their condition in a loop. The IO thread only ever waits with a
+// timeout inside its cycle budget (the pull-mode render).
+void EngramWait_WhileEqual(const std::atomic<UInt32>* word, UInt32 expected, UInt64 timeoutNanos);
+
+// Wakes every thread, in any process, sleeping on `word`. Store the new value
+// first; a waiter that has not gone to sleep yet then sees it and never does.
+// Never blocks: one system call that takes no lock and does not wait for the
+// woken threads to run, so the IO thread may make it. It is still a kernel
+// entry, so the IO thread only makes it when a waiter is known to be asleep.
+void EngramWait_WakeAll(std::atomic<UInt32>* word);
+
+// CLOCK_MONOTONIC in nanoseconds, for deadlines around the waits above.
+// Independent of mach_absolute_time, so a virtual host clock can't stall it.
+UInt64 EngramWait_Now(void);
+
+#endif /* EngramWait_h */
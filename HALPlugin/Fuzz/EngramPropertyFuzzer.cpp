@@ -0,0 +1,344 @@
+//
+//  EngramPropertyFuzzer.cpp
+//  Engram Virtual Audio Device
+//
+//  libFuzzer target for the property callbacks. Each input is decoded into a
+//  sequence of HasProperty / IsPropertySettable / GetPropertyDataSize /
+//  GetPropertyData / SetPropertyData calls with arbitrary object IDs,
+//  addresses, qualifiers and buffer sizes. Output buffers are allocated at
+//  exactly the size the caller claims and followed by canary bytes, so
+//  overflows trip ASan or, without it, the canary check.
+//
+//  Invariants (violations abort):
+//    - a property HasProperty denies is never answered;
+//    - successful gets report no more than the buffer they were given;
+//    - nothing is written past the buffer;
+//    - every CF object the plugin hands out is released (Linux shim count).
+//
+//  Built with -fsanitize=fuzzer this is a plain libFuzzer target. Otherwise
+//  ENGRAM_FUZZ_STANDALONE adds a main() that replays files given on the
+//  command line, or generates inputs: engram-property-fuzz [--runs N] [--seed S]
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramHalPlugin.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define kEngramFuzzMaxCalls 16
+#define kEngramFuzzMaxDataSize 4096
+#define kEngramFuzzCanaryBytes 64
+#define kEngramFuzzCanary 0xA5
+
+static AudioServerPlugInDriverInterface* gInterface = NULL;
+static AudioServerPlugInDriverRef gDriver = NULL;
+static AudioObjectID gDeviceID = kAudioObjectUnknown;
+
+// MARK: - Input Decoding
+
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+    size_t offset;
+} EngramFuzzInput;
+
+static uint8_t EngramFuzz_Byte(EngramFuzzInput* input) {
+    return (input->offset < input->size) ? input->data[input->offset++] : 0;
+}
+
+static UInt32 EngramFuzz_UInt32(EngramFuzzInput* input) {
+    UInt32 value = 0;
+    for (int i = 0; i < 4; i++) {
+        value = (value << 8) | EngramFuzz_Byte(input);
+    }
+    return value;
+}
+
+// Mostly values the plugin knows, so the fuzzer gets past the front door
+static AudioObjectID EngramFuzz_ObjectID(EngramFuzzInput* input) {
+    switch (EngramFuzz_Byte(input) % 6) {
+        case 0: return kAudioObjectUnknown;
+        case 1: return kAudioObjectPlugInObject;
+        case 2:
+        case 3: return gDeviceID;
+        case 4: return gDeviceID + 1;
+        default: return EngramFuzz_UInt32(input);
+    }
+}
+
+static AudioObjectPropertySelector EngramFuzz_Selector(EngramFuzzInput* input) {
+    static const AudioObjectPropertySelector kSelectors[] = {
+        kAudioObjectPropertyName, kAudioObjectPropertyManufacturer, kAudioObjectPropertyOwnedObjects,
+        kAudioObjectPropertyCustomPropertyInfoList, kAudioDevicePropertyDeviceUID,
+        kAudioDevicePropertyNominalSampleRate, kAudioDevicePropertyStreams, kAudioDevicePropertyDeviceIsRunning,
+        kAudioDevicePropertyLatency, kAudioDevicePropertySafetyOffset, kAudioDevicePropertyBufferFrameSize,
+        kAudioDevicePropertyBufferFrameSizeRange,
+        kAudioDevicePropertyZeroTimeStampPeriod, kEngramPropertyStats, kEngramPropertyTrace, kEngramPropertyLatency,
+        kEngramPropertyLoopback, kEngramPropertyFeedback, kEngramPropertyAGC, kEngramPropertyLowWater
+    };
+    static const UInt32 kCount = sizeof(kSelectors) / sizeof(kSelectors[0]);
+    uint8_t choice = EngramFuzz_Byte(input);
+    return (choice < 4 * kCount) ? kSelectors[choice % kCount] : EngramFuzz_UInt32(input);
+}
+
+static void EngramFuzz_Address(EngramFuzzInput* input, AudioObjectPropertyAddress* address) {
+    static const AudioObjectPropertyScope kScopes[] = {
+        kAudioObjectPropertyScopeGlobal, kAudioObjectPropertyScopeInput, kAudioObjectPropertyScopeOutput
+    };
+    address->mSelector = EngramFuzz_Selector(input);
+    uint8_t scope = EngramFuzz_Byte(input);
+    address->mScope = (scope < 192) ? kScopes[scope % 3] : EngramFuzz_UInt32(input);
+    uint8_t element = EngramFuzz_Byte(input);
+    address->mElement = (element < 192) ? element % 4 : EngramFuzz_UInt32(input);
+}
+
+// Sizes cluster around the real ones (pointers, Float64s, short lists)
+static UInt32 EngramFuzz_DataSize(EngramFuzzInput* input) {
+    uint8_t choice = EngramFuzz_Byte(input);
+    if (choice < 224) {
+        return choice % 48;
+    }
+    return EngramFuzz_UInt32(input) % (kEngramFuzzMaxDataSize + 1);
+}
+
+// MARK: - Checked Buffers
+
+typedef struct {
+    uint8_t* bytes;
+    UInt32 size;
+} EngramFuzzBuffer;
+
+static void EngramFuzz_Fail(const char* what, const AudioObjectPropertyAddress* address, AudioObjectID objectID) {
+    fprintf(stderr, "engram-property-fuzz: %s (object %u, selector 0x%08x, scope 0x%08x, element %u)\n",
+            what, objectID, address->mSelector, address->mScope, address->mElement);
+    abort();
+}
+
+static EngramFuzzBuffer EngramFuzz_NewBuffer(UInt32 size, uint8_t fill) {
+    EngramFuzzBuffer buffer;
+    buffer.size = size;
+    buffer.bytes = (uint8_t*)malloc((size_t)size + kEngramFuzzCanaryBytes);
+    memset(buffer.bytes, fill, size);
+    memset(buffer.bytes + size, kEngramFuzzCanary, kEngramFuzzCanaryBytes);
+    return buffer;
+}
+
+static Boolean EngramFuzz_CanaryIntact(const EngramFuzzBuffer* buffer) {
+    for (UInt32 i = 0; i < kEngramFuzzCanaryBytes; i++) {
+        if (buffer->bytes[buffer->size + i] != kEngramFuzzCanary) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// MARK: - Calls
+
+static Boolean EngramFuzz_ReturnsCFObject(AudioObjectPropertySelector selector) {
+    return selector == kEngramPropertyStats || selector == kEngramPropertyTrace || selector == kEngramPropertyLatency ||
+           selector == kEngramPropertyLoopback || selector == kEngramPropertyFeedback || selector == kEngramPropertyAGC ||
+           selector == kEngramPropertyLowWater;
+}
+
+static void EngramFuzz_Get(EngramFuzzInput* input, AudioObjectID objectID, const AudioObjectPropertyAddress* address,
+                           Boolean has) {
+    UInt32 qualifierSize = EngramFuzz_DataSize(input);
+    EngramFuzzBuffer qualifier = EngramFuzz_NewBuffer(qualifierSize, EngramFuzz_Byte(input));
+    EngramFuzzBuffer out = EngramFuzz_NewBuffer(EngramFuzz_DataSize(input), EngramFuzz_Byte(input));
+    Boolean nullOut = (EngramFuzz_Byte(input) % 16) == 0;
+
+    UInt32 outSize = 0xFFFFFFFF;
+    OSStatus status = gInterface->GetPropertyData(gDriver, objectID, 0, address, qualifierSize,
+                                                  (qualifierSize > 0) ? qualifier.bytes : NULL, out.size, &outSize,
+                                                  nullOut ? NULL : out.bytes);
+    if (status == kAudioHardwareNoError) {
+        if (!has) {
+            EngramFuzz_Fail("GetPropertyData answered a property HasProperty denies", address, objectID);
+        }
+        if (outSize > out.size) {
+            EngramFuzz_Fail("GetPropertyData reported more than the buffer holds", address, objectID);
+        }
+        if (EngramFuzz_ReturnsCFObject(address->mSelector) && outSize == sizeof(CFPropertyListRef)) {
+            CFPropertyListRef value = NULL;
+            memcpy(&value, out.bytes, sizeof(value));
+            if (value != NULL) {
+                CFRelease(value);
+            }
+        }
+    }
+    if (!EngramFuzz_CanaryIntact(&out)) {
+        EngramFuzz_Fail("GetPropertyData wrote past the buffer", address, objectID);
+    }
+
+    free(qualifier.bytes);
+    free(out.bytes);
+}
+
+static void EngramFuzz_Set(EngramFuzzInput* input, AudioObjectID objectID, const AudioObjectPropertyAddress* address,
+                           Boolean has) {
+    // The HAL marshals CF-typed data, so the pointer inside is always a real
+    // CF object (or NULL); its type and the buffer size are what vary
+    static const UInt8 kPayload[] = { 1, 2, 3, 4 };
+    CFDataRef data = CFDataCreate(NULL, kPayload, sizeof(kPayload));
+    CFPropertyListRef values[] = { kCFBooleanTrue, kCFBooleanFalse, NULL, data, CFSTR("engram") };
+    CFPropertyListRef value = values[EngramFuzz_Byte(input) % (sizeof(values) / sizeof(values[0]))];
+
+    UInt32 inSize = EngramFuzz_DataSize(input);
+    EngramFuzzBuffer in = EngramFuzz_NewBuffer(inSize, EngramFuzz_Byte(input));
+    if (inSize >= sizeof(value)) {
+        memcpy(in.bytes, &value, sizeof(value));
+    }
+    Boolean nullIn = (EngramFuzz_Byte(input) % 16) == 0;
+
+    OSStatus status = gInterface->SetPropertyData(gDriver, objectID, 0, address, 0, NULL, inSize,
+                                                  nullIn ? NULL : in.bytes);
+    if (status == kAudioHardwareNoError && !has) {
+        EngramFuzz_Fail("SetPropertyData accepted a property HasProperty denies", address, objectID);
+    }
+
+    free(in.bytes);
+    CFRelease(data);
+}
+
+static void EngramFuzz_Call(EngramFuzzInput* input) {
+    uint8_t operation = EngramFuzz_Byte(input) % 5;
+    AudioObjectID objectID = EngramFuzz_ObjectID(input);
+    AudioObjectPropertyAddress address;
+    EngramFuzz_Address(input, &address);
+    Boolean has = gInterface->HasProperty(gDriver, objectID, 0, &address);
+
+    switch (operation) {
+        case 0:
+            break;
+        case 1: {
+            Boolean settable = false;
+            OSStatus status = gInterface->IsPropertySettable(gDriver, objectID, 0, &address, &settable);
+            if (status == kAudioHardwareNoError && !has) {
+                EngramFuzz_Fail("IsPropertySettable answered a property HasProperty denies", &address, objectID);
+            }
+            break;
+        }
+        case 2: {
+            UInt32 size = 0;
+            OSStatus status = gInterface->GetPropertyDataSize(gDriver, objectID, 0, &address, 0, NULL, &size);
+            if (status == kAudioHardwareNoError && !has) {
+                EngramFuzz_Fail("GetPropertyDataSize answered a property HasProperty denies", &address, objectID);
+            }
+            break;
+        }
+        case 3:
+            EngramFuzz_Get(input, objectID, &address, has);
+            break;
+        default:
+            EngramFuzz_Set(input, objectID, &address, has);
+            break;
+    }
+}
+
+// MARK: - libFuzzer Entry Points
+
+extern "C" int LLVMFuzzerInitialize(int* argc, char*** argv) {
+    gDriver = (AudioServerPlugInDriverRef)EngramPlugIn_Create(NULL, kAudioServerPlugInTypeUUID);
+    gInterface = *gDriver;
+    gInterface->Initialize(gDriver, NULL);
+    gInterface->CreateDevice(gDriver, NULL, NULL, &gDeviceID);
+    return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    EngramFuzzInput input = { data, size, 0 };
+
+#if !defined(__APPLE__)
+    CFIndex liveObjects = EngramShim_LiveObjectCount();
+#endif
+
+    for (int call = 0; call < kEngramFuzzMaxCalls && input.offset < input.size; call++) {
+        EngramFuzz_Call(&input);
+    }
+
+#if !defined(__APPLE__)
+    if (EngramShim_LiveObjectCount() != liveObjects) {
+        fprintf(stderr, "engram-property-fuzz: CF objects leaked (%ld live, %ld before)\n",
+                EngramShim_LiveObjectCount(), liveObjects);
+        abort();
+    }
+#endif
+    return 0;
+}
+
+// MARK: - Standalone Driver
+
+#if defined(ENGRAM_FUZZ_STANDALONE)
+
+#define kEngramFuzzMaxInputBytes 256
+
+static int EngramFuzz_Replay(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        fprintf(stderr, "engram-property-fuzz: cannot open %s\n", path);
+        return 1;
+    }
+    uint8_t bytes[1 << 16];
+    size_t size = fread(bytes, 1, sizeof(bytes), file);
+    fclose(file);
+    LLVMFuzzerTestOneInput(bytes, size);
+    return 0;
+}
+
+// Releasing the driver tears the plugin down, so the run leaves no stats page behind
+static int EngramFuzz_Finish(int status) {
+    gInterface->Release(gDriver);
+    return status;
+}
+
+int main(int argc, char** argv) {
+    LLVMFuzzerInitialize(&argc, &argv);
+
+    UInt64 runs = 100000;
+    UInt64 seed = 0x46555A5A454E4752ull;
+    int replayed = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+            runs = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 0);
+        } else {
+            if (EngramFuzz_Replay(argv[i]) != 0) {
+                return EngramFuzz_Finish(1);
+            }
+            replayed++;
+        }
+    }
+    if (replayed > 0) {
+        printf("engram-property-fuzz: replayed %d inputs\n", replayed);
+        return EngramFuzz_Finish(0);
+    }
+
+    // xorshift64*: random lengths and bytes, reproducible from the seed
+    UInt64 state = (seed != 0) ? seed : 1;
+    uint8_t bytes[kEngramFuzzMaxInputBytes];
+    for (UInt64 run = 0; run < runs; run++) {
+        size_t size = 0;
+        for (size_t i = 0; i <= kEngramFuzzMaxInputBytes; i++) {
+            state ^= state >> 12;
+            state ^= state << 25;
+            state ^= state >> 27;
+            UInt64 value = state * 0x2545F4914F6CDD1Dull;
+            if (i == 0) {
+                size = (size_t)(value % (kEngramFuzzMaxInputBytes + 1));
+            } else if (i <= size) {
+                bytes[i - 1] = (uint8_t)(value >> 56);
+            } else {
+                break;
+            }
+        }
+        LLVMFuzzerTestOneInput(bytes, size);
+    }
+    printf("engram-property-fuzz: %llu runs clean\n", (unsigned long long)runs);
+    return EngramFuzz_Finish(0);
+}
+
+#endif
@@ -0,0 +1,234 @@
+//
+//  AudioServerPlugIn.h
+//  Engram Virtual Audio Device
+//
+//  Linux stand-in for the AudioServerPlugIn driver interface: the types,
+//  constants and vtable layout the plugin core compiles against, with the
+//  same values as the macOS SDK
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#ifndef EngramShim_AudioServerPlugIn_h
+#define EngramShim_AudioServerPlugIn_h
+
+#include <CoreFoundation/CoreFoundation.h>
+#include <MacTypes.h>
+#include <sys/types.h>
+
+// MARK: - Audio Objects
+
+typedef UInt32 AudioObjectID;
+typedef UInt32 AudioClassID;
+typedef UInt32 AudioObjectPropertySelector;
+typedef UInt32 AudioObjectPropertyScope;
+typedef UInt32 AudioObjectPropertyElement;
+
+typedef struct AudioObjectPropertyAddress {
+    AudioObjectPropertySelector mSelector;
+    AudioObjectPropertyScope mScope;
+    AudioObjectPropertyElement mElement;
+} AudioObjectPropertyAddress;
+
+enum {
+    kAudioObjectUnknown = 0,
+    kAudioObjectPlugInObject = 1
+};
+
+enum {
+    kAudioObjectPropertyScopeGlobal = 'glob',
+    kAudioObjectPropertyScopeInput = 'inpt',
+    kAudioObjectPropertyScopeOutput = 'outp',
+    kAudioObjectPropertyElementMain = 0
+};
+
+// MARK: - Errors
+
+enum {
+    kAudioHardwareNoError = 0,
+    kAudioHardwareNotRunningError = 'stop',
+    kAudioHardwareUnspecifiedError = 'what',
+    kAudioHardwareUnknownPropertyError = 'who?',
+    kAudioHardwareBadPropertySizeError = '!siz',
+    kAudioHardwareIllegalOperationError = 'nope',
+    kAudioHardwareBadObjectError = '!obj',
+    kAudioHardwareBadDeviceError = '!dev',
+    kAudioHardwareBadStreamError = '!str',
+    kAudioHardwareUnsupportedOperationError = 'unop'
+};
+
+// MARK: - Properties
+
+enum {
+    kAudioObjectPropertyName = 'lnam',
+    kAudioObjectPropertyManufacturer = 'lmak',
+    kAudioObjectPropertyOwnedObjects = 'ownd',
+    kAudioObjectPropertyCustomPropertyInfoList = 'cust',
+    kAudioDevicePropertyDeviceUID = 'uid ',
+    kAudioDevicePropertyNominalSampleRate = 'nsrt',
+    kAudioDevicePropertyStreams = 'stm#',
+    kAudioDevicePropertyDeviceIsRunning = 'goin',
+    kAudioDevicePropertyLatency = 'ltnc',
+    kAudioDevicePropertySafetyOffset = 'saft',
+    kAudioDevicePropertyBufferFrameSize = 'fsiz',
+    kAudioDevicePropertyBufferFrameSizeRange = 'fsz#',
+    kAudioDevicePropertyZeroTimeStampPeriod = 'ring'
+};
+
+typedef struct AudioValueRange {
+    Float64 mMinimum;
+    Float64 mMaximum;
+} AudioValueRange;
+
+// MARK: - Time Stamps
+
+typedef struct SMPTETime {
+    SInt16 mSubframes;
+    SInt16 mSubframeDivisor;
+    UInt32 mCounter;
+    UInt32 mType;
+    UInt32 mFlags;
+    SInt16 mHours;
+    SInt16 mMinutes;
+    SInt16 mSeconds;
+    SInt16 mFrames;
+} SMPTETime;
+
+typedef struct AudioTimeStamp {
+    Float64 mSampleTime;
+    UInt64 mHostTime;
+    Float64 mRateScalar;
+    UInt64 mWordClockTime;
+    SMPTETime mSMPTETime;
+    UInt32 mFlags;
+    UInt32 mReserved;
+} AudioTimeStamp;
+
+enum {
+    kAudioTimeStampSampleTimeValid = (1u << 0),
+    kAudioTimeStampHostTimeValid = (1u << 1),
+    kAudioTimeStampRateScalarValid = (1u << 2)
+};
+
+// MARK: - Plug-in Types
+
+#define kAudioServerPlugInTypeUUID \
+    CFUUIDGetConstantUUIDWithBytes(NULL, 0x44, 0x3A, 0xBA, 0xB8, 0xE7, 0xB3, 0x49, 0x1A, \
+                                   0xB9, 0x85, 0xBE, 0xB9, 0x18, 0x70, 0x30, 0xDB)
+#define kAudioServerPlugInDriverInterfaceUUID \
+    CFUUIDGetConstantUUIDWithBytes(NULL, 0xEE, 0xA5, 0x77, 0x3D, 0xCC, 0x43, 0x49, 0xF1, \
+                                   0x8E, 0x00, 0x8F, 0x96, 0xE7, 0xD2, 0x3B, 0x17)
+
+enum {
+    kAudioServerPlugInIOOperationThread = 'thrd',
+    kAudioServerPlugInIOOperationCycle = 'cycl',
+    kAudioServerPlugInIOOperationReadInput = 'read',
+    kAudioServerPlugInIOOperationConvertInput = 'cinp',
+    kAudioServerPlugInIOOperationProcessInput = 'pinp',
+    kAudioServerPlugInIOOperationProcessOutput = 'pout',
+    kAudioServerPlugInIOOperationMixOutput = 'mixo',
+    kAudioServerPlugInIOOperationProcessMix = 'pmix',
+    kAudioServerPlugInIOOperationConvertMix = 'cmix',
+    kAudioServerPlugInIOOperationWriteMix = 'rite'
+};
+
+enum {
+    kAudioServerPlugInCustomPropertyDataTypeNone = 0,
+    kAudioServerPlugInCustomPropertyDataTypeCFString = 'cfst',
+    kAudioServerPlugInCustomPropertyDataTypeCFPropertyList = 'plst'
+};
+
+typedef struct AudioServerPlugInCustomPropertyInfo {
+    AudioObjectPropertySelector mSelector;
+    UInt32 mPropertyDataType;
+    UInt32 mQualifierDataType;
+} AudioServerPlugInCustomPropertyInfo;
+
+typedef struct AudioServerPlugInClientInfo {
+    UInt32 mClientID;
+    pid_t mProcessID;
+    Boolean mIsNativeEndian;
+    CFStringRef mBundleID;
+} AudioServerPlugInClientInfo;
+
+typedef struct AudioServerPlugInIOCycleInfo {
+    UInt64 mIOCycleCounter;
+    UInt32 mNominalIOBufferFrameSize;
+    AudioTimeStamp mCurrentTime;
+    AudioTimeStamp mInputTime;
+    AudioTimeStamp mOutputTime;
+    Float64 mMainHostTicksPerFrame;
+    Float64 mDeviceHostTicksPerFrame;
+} AudioServerPlugInIOCycleInfo;
+
+// MARK: - Host Interface
+
+typedef struct AudioServerPlugInHostInterface AudioServerPlugInHostInterface;
+typedef const AudioServerPlugInHostInterface* AudioServerPlugInHostRef;
+
+struct AudioServerPlugInHostInterface {
+    OSStatus (*PropertiesChanged)(AudioServerPlugInHostRef inHost, AudioObjectID inObjectID,
+                                  UInt32 inNumberAddresses, const AudioObjectPropertyAddress* inAddresses);
+    OSStatus (*CopyFromStorage)(AudioServerPlugInHostRef inHost, CFStringRef inKey, CFPropertyListRef* outData);
+    OSStatus (*WriteToStorage)(AudioServerPlugInHostRef inHost, CFStringRef inKey, CFPropertyListRef inData);
+    OSStatus (*DeleteFromStorage)(AudioServerPlugInHostRef inHost, CFStringRef inKey);
+    OSStatus (*RequestDeviceConfigurationChange)(AudioServerPlugInHostRef inHost, AudioObjectID inDeviceObjectID,
+                                                 UInt64 inChangeAction, void* inChangeInfo);
+};
+
+// MARK: - Driver Interface
+
+typedef struct AudioServerPlugInDriverInterface AudioServerPlugInDriverInterface;
+typedef AudioServerPlugInDriverInterface** AudioServerPlugInDriverRef;
+
+struct AudioServerPlugInDriverInterface {
+    void* _reserved;
+    HRESULT (*QueryInterface)(void* inDriver, REFIID inUUID, LPVOID* outInterface);
+    ULONG (*AddRef)(void* inDriver);
+    ULONG (*Release)(void* inDriver);
+
+    OSStatus (*Initialize)(AudioServerPlugInDriverRef inDriver, AudioServerPlugInHostRef inHost);
+    OSStatus (*CreateDevice)(AudioServerPlugInDriverRef inDriver, CFDictionaryRef inDescription,
+                             const AudioServerPlugInClientInfo* inClientInfo, AudioObjectID* outDeviceObjectID);
+    OSStatus (*DestroyDevice)(AudioServerPlugInDriverRef inDriver, AudioObjectID inDeviceObjectID);
+    OSStatus (*AddDeviceClient)(AudioServerPlugInDriverRef inDriver, AudioObjectID inDeviceObjectID,
+                                const AudioServerPlugInClientInfo* inClientInfo);
+    OSStatus (*RemoveDeviceClient)(AudioServerPlugInDriverRef inDriver, AudioObjectID inDeviceObjectID,
+                                   const AudioServerPlugInClientInfo* inClientInfo);
+    OSStatus (*PerformDeviceConfigurationChange)(AudioServerPlugInDriverRef inDriver, AudioObjectID inDeviceObjectID,
+                                                 UInt64 inChangeAction, void* inChangeInfo);
+    OSStatus (*AbortDeviceConfigurationChange)(AudioServerPlugInDriverRef inDriver, AudioObjectID inDeviceObjectID,
+                                               UInt64 inChangeAction, void* inChangeInfo);
+
+    Boolean (*HasProperty)(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID,
+                           const AudioObjectPropertyAddress* inAddress);
+    OSStatus (*IsPropertySettable)(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID,
+                                   const AudioObjectPropertyAddress* inAddress, Boolean* outIsSettable);
+    OSStatus (*GetPropertyDataSize)(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID,
+                                    const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize,
+                                    const void* inQualifierData, UInt32* outDataSize);
+    OSStatus (*GetPropertyData)(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID,
+                                const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize,
+                                const void* inQualifierData, UInt32 inDataSize, UInt32* outDataSize, void* outData);
+    OSStatus (*SetPropertyData)(AudioServerPlugInDriverRef inDriver, AudioObjectID inObjectID, pid_t inClientProcessID,
+                                const AudioObjectPropertyAddress* inAddress, UInt32 inQualifierDataSize,
+                                const void* inQualifierData, UInt32 inDataSize, const void* inData);
+
+    OSStatus (*StartIO)(AudioServerPlugInDriverRef inDriver, AudioObjectID inDeviceObjectID, UInt32 inClientID);
+    OSStatus (*StopIO)(AudioServerPlugInDriverRef inDriver, AudioObjectID inDeviceObjectID, UInt32 inClientID);
+    OSStatus (*GetZeroTimeStamp)(AudioServerPlugInDriverRef inDriver, AudioObjectID inDeviceObjectID, UInt32 inClientID,
+                                 Float64* outSampleTime, UInt64* outHostTime, UInt64* outSeed);
+    OSStatus (*WillDoIOOperation)(AudioServerPlugInDriverRef inDriver, AudioObjectID inDeviceObjectID, UInt32 inClientID,
+                                  UInt32 inOperationID, Boolean* outWillDo, Boolean* outWillDoInPlace);
+    OSStatus (*BeginIOOperation)(AudioServerPlugInDriverRef inDriver, AudioObjectID inDeviceObjectID, UInt32 inClientID,
+                                 UInt32 inOperationID, UInt32 inIOBufferFrameSize,
+                                 const AudioServerPlugInIOCycleInfo* inIOCycleInfo);
+    OSStatus (*DoIOOperation)(AudioServerPlugInDriverRef inDriver, AudioObjectID inDeviceObjectID, AudioObjectID inStreamObjectID,
+                              UInt32 inClientID, UInt32 inOperationID, UInt32 inIOBufferFrameSize,
+                              const AudioServerPlugInIOCycleInfo* inIOCycleInfo, void* ioMainBuffer, void* ioSecondaryBuffer);
+    OSStatus (*EndIOOperation)(AudioServerPlugInDriverRef inDriver, AudioObjectID inDeviceObjectID, UInt32 inClientID,
+                               UInt32 inOperationID, UInt32 inIOBufferFrameSize,
+                               const AudioServerPlugInIOCycleInfo* inIOCycleInfo);
+};
+
+#endif /* EngramShim_AudioServerPlugIn_h */
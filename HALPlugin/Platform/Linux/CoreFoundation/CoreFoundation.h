@@ -0,0 +1,129 @@
+//
+//  CoreFoundation.h
+//  Engram Virtual Audio Device
+//
+//  Minimal Linux stand-in for the CoreFoundation subset the plugin uses:
+//  reference counting, CFUUID, CFString constants, CFData, CFBoolean and the
+//  COM plug-in types. Implemented in EngramCoreFoundationShim.cpp.
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#ifndef EngramShim_CoreFoundation_h
+#define EngramShim_CoreFoundation_h
+
+#include <MacTypes.h>
+#include <atomic>
+#include <stddef.h>
+
+typedef long CFIndex;
+typedef unsigned long CFTypeID;
+
+// MARK: - Runtime
+
+typedef struct __CFRuntimeBase {
+    CFTypeID typeID;
+    std::atomic<SInt32> retainCount;   // < 0 for constants, which are never freed
+} __CFRuntimeBase;
+
+enum {
+    kEngramShimTypeString = 1,
+    kEngramShimTypeUUID,
+    kEngramShimTypeData,
+    kEngramShimTypeBoolean,
+    kEngramShimTypeDictionary
+};
+
+typedef const void* CFTypeRef;
+typedef const void* CFPropertyListRef;
+typedef const struct __CFAllocator* CFAllocatorRef;
+typedef const struct __CFDictionary* CFDictionaryRef;
+
+#define kCFAllocatorDefault ((CFAllocatorRef)NULL)
+#define kCFAllocatorSystemDefault ((CFAllocatorRef)NULL)
+
+CFTypeRef CFRetain(CFTypeRef value);
+void CFRelease(CFTypeRef value);
+Boolean CFEqual(CFTypeRef a, CFTypeRef b);
+CFTypeID CFGetTypeID(CFTypeRef value);
+CFIndex CFGetRetainCount(CFTypeRef value);
+
+// Shim only: objects allocated and not yet freed, constants excluded. Soak
+// runs compare it across hours to catch leaked property data.
+CFIndex EngramShim_LiveObjectCount(void);
+
+// MARK: - Strings
+
+typedef struct __CFString {
+    __CFRuntimeBase base;
+    const char* cString;
+} __CFString;
+
+typedef const struct __CFString* CFStringRef;
+
+// Constant strings are immortal statics, so CFSTR never allocates.
+#define CFSTR(literal)                                                                          \
+    ([]() -> CFStringRef {                                                                      \
+        static const __CFString engramShimString = { { kEngramShimTypeString, {-1} }, literal }; \
+        return &engramShimString;                                                               \
+    }())
+
+const char* CFStringGetCStringPtr(CFStringRef string, UInt32 encoding);
+
+#define kCFStringEncodingUTF8 0x08000100
+
+// MARK: - UUIDs
+
+typedef struct {
+    UInt8 byte0, byte1, byte2, byte3, byte4, byte5, byte6, byte7;
+    UInt8 byte8, byte9, byte10, byte11, byte12, byte13, byte14, byte15;
+} CFUUIDBytes;
+
+typedef const struct __CFUUID* CFUUIDRef;
+
+CFUUIDRef CFUUIDCreateFromUUIDBytes(CFAllocatorRef allocator, CFUUIDBytes bytes);
+CFUUIDRef CFUUIDGetConstantUUIDWithBytes(CFAllocatorRef allocator,
+                                         UInt8 byte0, UInt8 byte1, UInt8 byte2, UInt8 byte3,
+                                         UInt8 byte4, UInt8 byte5, UInt8 byte6, UInt8 byte7,
+                                         UInt8 byte8, UInt8 byte9, UInt8 byte10, UInt8 byte11,
+                                         UInt8 byte12, UInt8 byte13, UInt8 byte14, UInt8 byte15);
+CFUUIDBytes CFUUIDGetUUIDBytes(CFUUIDRef uuid);
+
+// MARK: - Data
+
+typedef const struct __CFData* CFDataRef;
+typedef struct __CFData* CFMutableDataRef;
+
+CFTypeID CFDataGetTypeID(void);
+CFDataRef CFDataCreate(CFAllocatorRef allocator, const UInt8* bytes, CFIndex length);
+CFMutableDataRef CFDataCreateMutable(CFAllocatorRef allocator, CFIndex capacity);
+void CFDataSetLength(CFMutableDataRef data, CFIndex length);
+UInt8* CFDataGetMutableBytePtr(CFMutableDataRef data);
+const UInt8* CFDataGetBytePtr(CFDataRef data);
+CFIndex CFDataGetLength(CFDataRef data);
+
+// MARK: - Booleans
+
+typedef const struct __CFBoolean* CFBooleanRef;
+
+extern const CFBooleanRef kCFBooleanTrue;
+extern const CFBooleanRef kCFBooleanFalse;
+
+CFTypeID CFBooleanGetTypeID(void);
+Boolean CFBooleanGetValue(CFBooleanRef boolean);
+
+// MARK: - COM Plug-in Types
+
+typedef SInt32 HRESULT;
+typedef UInt32 ULONG;
+typedef void* LPVOID;
+typedef CFUUIDBytes REFIID;
+
+#define S_OK ((HRESULT)0x00000000L)
+#define E_NOINTERFACE ((HRESULT)0x80000004L)
+
+#define IUnknownUUID \
+    CFUUIDGetConstantUUIDWithBytes(kCFAllocatorSystemDefault, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+                                   0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x46)
+
+#endif /* EngramShim_CoreFoundation_h */
@@ -0,0 +1,212 @@
+//
+//  EngramCoreFoundationShim.cpp
+//  Engram Virtual Audio Device
+//
+//  Just enough CoreFoundation for the plugin core to run on Linux. Objects
+//  are malloc-backed and reference counted like the real thing, so leaks and
+//  over-releases show up under the sanitizers.
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include <CoreFoundation/CoreFoundation.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct __CFUUID {
+    __CFRuntimeBase base;
+    CFUUIDBytes bytes;
+};
+
+struct __CFData {
+    __CFRuntimeBase base;
+    UInt8* bytes;
+    CFIndex length;
+};
+
+struct __CFBoolean {
+    __CFRuntimeBase base;
+    Boolean value;
+};
+
+// MARK: - Runtime
+
+static std::atomic<CFIndex> gLiveObjects;
+
+static void EngramShim_InitBase(__CFRuntimeBase* base, CFTypeID typeID) {
+    base->typeID = typeID;
+    base->retainCount.store(1, std::memory_order_relaxed);
+    gLiveObjects.fetch_add(1, std::memory_order_relaxed);
+}
+
+CFIndex EngramShim_LiveObjectCount(void) {
+    return gLiveObjects.load(std::memory_order_relaxed);
+}
+
+CFTypeRef CFRetain(CFTypeRef value) {
+    __CFRuntimeBase* base = (__CFRuntimeBase*)value;
+    if (base->retainCount.load(std::memory_order_relaxed) >= 0) {
+        base->retainCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    return value;
+}
+
+void CFRelease(CFTypeRef value) {
+    __CFRuntimeBase* base = (__CFRuntimeBase*)value;
+    if (base == NULL || base->retainCount.load(std::memory_order_relaxed) < 0) {
+        return;
+    }
+    if (base->retainCount.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+
+    if (base->typeID == kEngramShimTypeData) {
+        free(((__CFData*)value)->bytes);
+    }
+    free((void*)value);
+    gLiveObjects.fetch_sub(1, std::memory_order_relaxed);
+}
+
+CFTypeID CFGetTypeID(CFTypeRef value) {
+    return ((const __CFRuntimeBase*)value)->typeID;
+}
+
+CFIndex CFGetRetainCount(CFTypeRef value) {
+    return ((const __CFRuntimeBase*)value)->retainCount.load(std::memory_order_relaxed);
+}
+
+Boolean CFEqual(CFTypeRef a, CFTypeRef b) {
+    if (a == b) {
+        return true;
+    }
+    if (a == NULL || b == NULL || CFGetTypeID(a) != CFGetTypeID(b)) {
+        return false;
+    }
+
+    switch (CFGetTypeID(a)) {
+        case kEngramShimTypeString:
+            return strcmp(((const __CFString*)a)->cString, ((const __CFString*)b)->cString) == 0;
+        case kEngramShimTypeUUID:
+            return memcmp(&((const __CFUUID*)a)->bytes, &((const __CFUUID*)b)->bytes, sizeof(CFUUIDBytes)) == 0;
+        case kEngramShimTypeData: {
+            const __CFData* x = (const __CFData*)a;
+            const __CFData* y = (const __CFData*)b;
+            return x->length == y->length && memcmp(x->bytes, y->bytes, (size_t)x->length) == 0;
+        }
+        case kEngramShimTypeBoolean:
+            return ((const __CFBoolean*)a)->value == ((const __CFBoolean*)b)->value;
+        default:
+            return false;
+    }
+}
+
+// MARK: - Strings
+
+const char* CFStringGetCStringPtr(CFStringRef string, UInt32 encoding) {
+    return string->cString;
+}
+
+// MARK: - UUIDs
+
+CFUUIDRef CFUUIDCreateFromUUIDBytes(CFAllocatorRef allocator, CFUUIDBytes bytes) {
+    __CFUUID* uuid = (__CFUUID*)calloc(1, sizeof(__CFUUID));
+    EngramShim_InitBase(&uuid->base, kEngramShimTypeUUID);
+    uuid->bytes = bytes;
+    return uuid;
+}
+
+#define kEngramShimConstantUUIDCapacity 32
+
+static __CFUUID gConstantUUIDs[kEngramShimConstantUUIDCapacity];
+static UInt32 gConstantUUIDCount = 0;
+static pthread_mutex_t gConstantUUIDLock = PTHREAD_MUTEX_INITIALIZER;
+
+CFUUIDRef CFUUIDGetConstantUUIDWithBytes(CFAllocatorRef allocator,
+                                         UInt8 byte0, UInt8 byte1, UInt8 byte2, UInt8 byte3,
+                                         UInt8 byte4, UInt8 byte5, UInt8 byte6, UInt8 byte7,
+                                         UInt8 byte8, UInt8 byte9, UInt8 byte10, UInt8 byte11,
+                                         UInt8 byte12, UInt8 byte13, UInt8 byte14, UInt8 byte15) {
+    CFUUIDBytes bytes = { byte0, byte1, byte2, byte3, byte4, byte5, byte6, byte7,
+                          byte8, byte9, byte10, byte11, byte12, byte13, byte14, byte15 };
+    CFUUIDRef result = NULL;
+
+    pthread_mutex_lock(&gConstantUUIDLock);
+    for (UInt32 i = 0; i < gConstantUUIDCount && result == NULL; i++) {
+        if (memcmp(&gConstantUUIDs[i].bytes, &bytes, sizeof(bytes)) == 0) {
+            result = &gConstantUUIDs[i];
+        }
+    }
+    if (result == NULL && gConstantUUIDCount < kEngramShimConstantUUIDCapacity) {
+        __CFUUID* uuid = &gConstantUUIDs[gConstantUUIDCount++];
+        uuid->base.typeID = kEngramShimTypeUUID;
+        uuid->base.retainCount.store(-1, std::memory_order_relaxed);
+        uuid->bytes = bytes;
+        result = uuid;
+    }
+    pthread_mutex_unlock(&gConstantUUIDLock);
+
+    return result;
+}
+
+CFUUIDBytes CFUUIDGetUUIDBytes(CFUUIDRef uuid) {
+    return uuid->bytes;
+}
+
+// MARK: - Data
+
+CFTypeID CFDataGetTypeID(void) {
+    return kEngramShimTypeData;
+}
+
+CFDataRef CFDataCreate(CFAllocatorRef allocator, const UInt8* bytes, CFIndex length) {
+    CFMutableDataRef data = CFDataCreateMutable(allocator, length);
+    CFDataSetLength(data, length);
+    if (length > 0) {
+        memcpy(data->bytes, bytes, (size_t)length);
+    }
+    return data;
+}
+
+CFMutableDataRef CFDataCreateMutable(CFAllocatorRef allocator, CFIndex capacity) {
+    __CFData* data = (__CFData*)calloc(1, sizeof(__CFData));
+    EngramShim_InitBase(&data->base, kEngramShimTypeData);
+    return data;
+}
+
+void CFDataSetLength(CFMutableDataRef data, CFIndex length) {
+    UInt8* bytes = (UInt8*)realloc(data->bytes, (size_t)(length > 0 ? length : 1));
+    if (length > data->length) {
+        memset(bytes + data->length, 0, (size_t)(length - data->length));
+    }
+    data->bytes = bytes;
+    data->length = length;
+}
+
+UInt8* CFDataGetMutableBytePtr(CFMutableDataRef data) {
+    return data->bytes;
+}
+
+const UInt8* CFDataGetBytePtr(CFDataRef data) {
+    return data->bytes;
+}
+
+CFIndex CFDataGetLength(CFDataRef data) {
+    return data->length;
+}
+
+// MARK: - Booleans
+
+static const __CFBoolean gBooleanTrue = { { kEngramShimTypeBoolean, {-1} }, true };
+static const __CFBoolean gBooleanFalse = { { kEngramShimTypeBoolean, {-1} }, false };
+
+const CFBooleanRef kCFBooleanTrue = &gBooleanTrue;
+const CFBooleanRef kCFBooleanFalse = &gBooleanFalse;
+
+CFTypeID CFBooleanGetTypeID(void) {
+    return kEngramShimTypeBoolean;
+}
+
+Boolean CFBooleanGetValue(CFBooleanRef boolean) {
+    return boolean->value;
+}
@@ -0,0 +1,11 @@
+//
+//  EngramMachTimeShim.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include <mach/mach_time.h>
+
+std::atomic<EngramShimHostTimeSource> gEngramShimHostTimeSource(NULL);
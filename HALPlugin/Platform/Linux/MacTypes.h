@@ -0,0 +1,35 @@
+//
+//  MacTypes.h
+//  Engram Virtual Audio Device
+//
+//  Linux stand-in for the Carbon scalar types used by CoreAudio headers
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#ifndef EngramShim_MacTypes_h
+#define EngramShim_MacTypes_h
+
+#include <stdint.h>
+
+typedef uint8_t  UInt8;
+typedef int8_t   SInt8;
+typedef uint16_t UInt16;
+typedef int16_t  SInt16;
+typedef uint32_t UInt32;
+typedef int32_t  SInt32;
+typedef uint64_t UInt64;
+typedef int64_t  SInt64;
+typedef float    Float32;
+typedef double   Float64;
+typedef unsigned char Boolean;
+
+typedef SInt32 OSStatus;
+typedef UInt32 FourCharCode;
+typedef FourCharCode OSType;
+
+enum {
+    noErr = 0
+};
+
+#endif /* EngramShim_MacTypes_h */
@@ -0,0 +1,51 @@
+//
+//  mach_time.h
+//  Engram Virtual Audio Device
+//
+//  Linux stand-in for mach_absolute_time: CLOCK_MONOTONIC nanoseconds, so
+//  the timebase is 1/1. A host simulator may substitute a virtual clock.
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#ifndef EngramShim_mach_time_h
+#define EngramShim_mach_time_h
+
+#include <atomic>
+#include <stdint.h>
+#include <time.h>
+
+typedef int kern_return_t;
+
+struct mach_timebase_info {
+    uint32_t numer;
+    uint32_t denom;
+};
+
+typedef struct mach_timebase_info* mach_timebase_info_t;
+typedef struct mach_timebase_info mach_timebase_info_data_t;
+
+static inline kern_return_t mach_timebase_info(mach_timebase_info_t info) {
+    info->numer = 1;
+    info->denom = 1;
+    return 0;
+}
+
+// When set, mach_absolute_time returns this instead of the monotonic clock so
+// simulated sessions can run faster than real time. Defined in
+// EngramMachTimeShim.cpp; install it before EngramPlugIn_Create.
+typedef uint64_t (*EngramShimHostTimeSource)(void);
+extern std::atomic<EngramShimHostTimeSource> gEngramShimHostTimeSource;
+
+static inline uint64_t mach_absolute_time(void) {
+    EngramShimHostTimeSource source = gEngramShimHostTimeSource.load(std::memory_order_relaxed);
+    if (source != NULL) {
+        return source();
+    }
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+#endif /* EngramShim_mach_time_h */
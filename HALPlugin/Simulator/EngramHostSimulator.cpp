@@ -0,0 +1,632 @@
+//
+//  EngramHostSimulator.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramHostSimulator.h"
+#include "EngramDenormal.h"
+#include "EngramIO.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Arbitrary non-zero start so nothing mistakes the first cycle for "never"
+#define kEngramSimStartHostTime 1000000000000ull
+#define kEngramSimClientID 1
+
+static std::atomic<UInt64> gSimHostTime;
+
+// MARK: - Virtual Clock
+
+UInt64 EngramSim_HostTime(void) {
+    return gSimHostTime.load(std::memory_order_relaxed);
+}
+
+static void EngramSim_AdvanceTo(UInt64 hostTime) {
+    if (hostTime > gSimHostTime.load(std::memory_order_relaxed)) {
+        gSimHostTime.store(hostTime, std::memory_order_relaxed);
+    }
+}
+
+// xorshift64*; jitter only needs to be cheap and reproducible
+static UInt64 EngramSim_Random(EngramSimulator* sim, UInt64 bound) {
+    if (bound == 0) {
+        return 0;
+    }
+    sim->rng ^= sim->rng >> 12;
+    sim->rng ^= sim->rng << 25;
+    sim->rng ^= sim->rng >> 27;
+    return (sim->rng * 0x2545F4914F6CDD1Dull) % (bound + 1);
+}
+
+// MARK: - Host Interface
+
+// Arrives on the plugin's notification thread, not the simulation thread
+static std::atomic<UInt64> gSimPropertyNotifications;
+
+static OSStatus EngramSim_PropertiesChanged(AudioServerPlugInHostRef host, AudioObjectID objectID,
+                                            UInt32 addressCount, const AudioObjectPropertyAddress* addresses) {
+    gSimPropertyNotifications.fetch_add(1, std::memory_order_relaxed);
+    return kAudioHardwareNoError;
+}
+
+static OSStatus EngramSim_CopyFromStorage(AudioServerPlugInHostRef host, CFStringRef key, CFPropertyListRef* outData) {
+    *outData = NULL;
+    return kAudioHardwareUnknownPropertyError;
+}
+
+static OSStatus EngramSim_WriteToStorage(AudioServerPlugInHostRef host, CFStringRef key, CFPropertyListRef data) {
+    return kAudioHardwareNoError;
+}
+
+static OSStatus EngramSim_DeleteFromStorage(AudioServerPlugInHostRef host, CFStringRef key) {
+    return kAudioHardwareNoError;
+}
+
+static OSStatus EngramSim_RequestConfigurationChange(AudioServerPlugInHostRef host, AudioObjectID deviceObjectID,
+                                                     UInt64 changeAction, void* changeInfo) {
+    return kAudioHardwareNoError;
+}
+
+// MARK: - Setup
+
+void EngramSim_DefaultConfig(EngramSimConfig* config) {
+    config->bufferFrames = 512;
+    config->producerFrames = 480;
+    config->producerLeadFrames = 2048;
+    config->ioJitterNanos = 500000;
+    config->producerJitterNanos = 2000000;
+    config->producerSkewPpm = 0.0;
+    config->producerSkewPeriodNanos = 0;
+    config->seed = 0x454E4752414D5349ull;
+}
+
+static void EngramSim_Check(EngramSimulator* sim, OSStatus status) {
+    if (status != kAudioHardwareNoError) {
+        sim->report.failedCalls++;
+    }
+}
+
+static OSStatus EngramSim_GetProperty(EngramSimulator* sim, AudioObjectPropertySelector selector,
+                                      UInt32 dataSize, void* outData) {
+    AudioObjectPropertyAddress address = { selector, kAudioObjectPropertyScopeGlobal, kAudioObjectPropertyElementMain };
+    if (!sim->interface->HasProperty(sim->driver, sim->deviceID, 0, &address)) {
+        return kAudioHardwareUnknownPropertyError;
+    }
+
+    UInt32 size = 0;
+    OSStatus status = sim->interface->GetPropertyDataSize(sim->driver, sim->deviceID, 0, &address, 0, NULL, &size);
+    if (status != kAudioHardwareNoError || size > dataSize) {
+        return kAudioHardwareBadPropertySizeError;
+    }
+    return sim->interface->GetPropertyData(sim->driver, sim->deviceID, 0, &address, 0, NULL, dataSize, &size, outData);
+}
+
+static OSStatus EngramSim_SetBoolean(EngramSimulator* sim, AudioObjectPropertySelector selector, Boolean value) {
+    AudioObjectPropertyAddress address = { selector, kAudioObjectPropertyScopeGlobal, kAudioObjectPropertyElementMain };
+    CFPropertyListRef data = value ? kCFBooleanTrue : kCFBooleanFalse;
+    return sim->interface->SetPropertyData(sim->driver, sim->deviceID, 0, &address, 0, NULL, sizeof(data), &data);
+}
+
+static void EngramSim_ScheduleProducer(EngramSimulator* sim) {
+    // Block k becomes available once its last frame exists on the producer's
+    // timeline, which runs `producerLeadFrames` ahead of the device.
+    Float64 readyFrame = (Float64)(sim->producedFrames + sim->config.producerFrames - sim->streamBase) -
+                         (Float64)sim->config.producerLeadFrames;
+    Float64 nominal = (Float64)sim->anchorHostTime + readyFrame * sim->hostTicksPerFrame;
+
+    // A skewed producer clock wanders around the device's: its rate error is
+    // ppm * cos(2 pi t / T), so the accumulated offset stays within ppm * T / 2 pi
+    if (sim->config.producerSkewPeriodNanos != 0) {
+        Float64 period = (Float64)sim->config.producerSkewPeriodNanos;
+        Float64 phase = 2.0 * M_PI * fmod(nominal, period) / period;
+        nominal -= sim->config.producerSkewPpm * 1.0e-6 * period / (2.0 * M_PI) * sin(phase);
+    }
+    UInt64 ready = (nominal > 0.0) ? (UInt64)nominal : 0;
+    ready += EngramSim_Random(sim, sim->config.producerJitterNanos);
+    // Writes from one producer are ordered
+    sim->nextProducerHostTime = (ready > sim->nextProducerHostTime) ? ready : sim->nextProducerHostTime;
+}
+
+static void EngramSim_ProduceBlock(EngramSimulator* sim) {
+    UInt32 frames = sim->config.producerFrames;
+    UInt32 channels = sim->channels;
+    if (sim->probing) {
+        EngramLatencyGenerator_Render(&sim->probeGenerator, sim->producerBuffer, frames, EngramSim_HostTime(), &sim->probeLog);
+    } else {
+        for (UInt32 frame = 0; frame < frames; frame++) {
+            UInt32 index = (UInt32)((sim->producedFrames + frame) % kEngramSimSignalFrames);
+            memcpy(sim->producerBuffer + frame * channels, sim->signal + index * channels, sizeof(Float32) * channels);
+        }
+    }
+
+    // The producer follows the IO gate, so it should never find it closed
+    if (!EngramGate_IsRunning(gDevice.ioGate.clients.load(std::memory_order_acquire))) {
+        sim->report.idleWrites++;
+    }
+
+    UInt32 accepted = EngramDevice_WriteInput(sim->producerBuffer, frames * channels);
+    if (accepted < frames * channels) {
+        // The ring dropped data; from here the expected stream is unknown
+        sim->verifyAudio = false;
+    }
+    sim->producedFrames += frames;
+    sim->report.producerWrites++;
+    EngramSim_ScheduleProducer(sim);
+}
+
+static void EngramSim_Anchor(EngramSimulator* sim) {
+    // The first zero timestamp after StartIO is the anchor of the timeline
+    Float64 zeroSampleTime = 0.0;
+    EngramSim_Check(sim, sim->interface->GetZeroTimeStamp(sim->driver, sim->deviceID, sim->clientID,
+                                                          &zeroSampleTime, &sim->anchorHostTime, &sim->seed));
+    sim->lastZeroSampleTime = zeroSampleTime;
+    sim->cycle = 0;
+    sim->sampleTime = 0;
+
+    // Whatever the producer had ready before IO started is the prefill
+    sim->streamBase = sim->consumedFrames;
+    sim->nextProducerHostTime = 0;
+    EngramSim_ScheduleProducer(sim);
+    while (sim->nextProducerHostTime <= sim->anchorHostTime) {
+        EngramSim_ProduceBlock(sim);
+    }
+}
+
+Boolean EngramSim_Start(EngramSimulator* sim, const EngramSimConfig* config) {
+    memset(&sim->report, 0, sizeof(sim->report));
+    sim->config = *config;
+    sim->interface = NULL;
+    sim->producerBuffer = NULL;
+    sim->ioBuffer = NULL;
+    sim->mixBuffer = NULL;
+    sim->expected = NULL;
+    if (sim->config.bufferFrames == 0 || sim->config.bufferFrames > kEngramSimMaxBufferFrames ||
+        sim->config.producerFrames == 0 || sim->config.producerFrames > kEngramSimMaxBufferFrames) {
+        return false;
+    }
+
+    gSimPropertyNotifications.store(0, std::memory_order_relaxed);
+    gSimHostTime.store(kEngramSimStartHostTime, std::memory_order_relaxed);
+    gEngramShimHostTimeSource.store(EngramSim_HostTime, std::memory_order_relaxed);
+
+    sim->host.PropertiesChanged = EngramSim_PropertiesChanged;
+    sim->host.CopyFromStorage = EngramSim_CopyFromStorage;
+    sim->host.WriteToStorage = EngramSim_WriteToStorage;
+    sim->host.DeleteFromStorage = EngramSim_DeleteFromStorage;
+    sim->host.RequestDeviceConfigurationChange = EngramSim_RequestConfigurationChange;
+
+    // coreaudiod: create through the factory, then ask for the driver interface
+    sim->driver = (AudioServerPlugInDriverRef)EngramPlugIn_Create(NULL, kAudioServerPlugInTypeUUID);
+    if (sim->driver == NULL) {
+        return false;
+    }
+    sim->interface = *sim->driver;
+
+    void* queried = NULL;
+    CFUUIDBytes interfaceBytes = CFUUIDGetUUIDBytes(kAudioServerPlugInDriverInterfaceUUID);
+    if (sim->interface->QueryInterface(sim->driver, interfaceBytes, &queried) != S_OK || queried == NULL) {
+        return false;
+    }
+    sim->interface->Release(sim->driver);
+
+    EngramSim_Check(sim, sim->interface->Initialize(sim->driver, &sim->host));
+    AudioServerPlugInClientInfo clientInfo = { kEngramSimClientID, 0, true, NULL };
+    EngramSim_Check(sim, sim->interface->CreateDevice(sim->driver, NULL, &clientInfo, &sim->deviceID));
+    sim->clientID = kEngramSimClientID;
+
+    EngramSim_Check(sim, EngramSim_GetProperty(sim, kAudioDevicePropertyNominalSampleRate, sizeof(sim->sampleRate), &sim->sampleRate));
+    sim->channels = kEngramChannels;
+    sim->hostTicksPerFrame = 1.0e9 / sim->sampleRate;
+    if (sim->report.failedCalls > 0) {
+        return false;
+    }
+
+    static const UInt32 kOperations[] = {
+        kAudioServerPlugInIOOperationReadInput,
+        kAudioServerPlugInIOOperationConvertInput,
+        kAudioServerPlugInIOOperationProcessInput,
+        kAudioServerPlugInIOOperationProcessOutput,
+        kAudioServerPlugInIOOperationMixOutput,
+        kAudioServerPlugInIOOperationProcessMix,
+        kAudioServerPlugInIOOperationConvertMix,
+        kAudioServerPlugInIOOperationWriteMix
+    };
+    sim->operationCount = 0;
+    for (UInt32 i = 0; i < sizeof(kOperations) / sizeof(kOperations[0]); i++) {
+        Boolean willDo = false;
+        Boolean inPlace = true;
+        EngramSim_Check(sim, sim->interface->WillDoIOOperation(sim->driver, sim->deviceID, sim->clientID,
+                                                               kOperations[i], &willDo, &inPlace));
+        if (willDo) {
+            sim->operations[sim->operationCount++] = kOperations[i];
+        }
+    }
+
+    for (UInt32 frame = 0; frame < kEngramSimSignalFrames; frame++) {
+        for (UInt32 channel = 0; channel < sim->channels; channel++) {
+            Float64 hz = 440.0 + 110.0 * channel;
+            sim->signal[frame * sim->channels + channel] = (Float32)(0.25 * sin(2.0 * M_PI * hz * frame / sim->sampleRate));
+        }
+    }
+    size_t bufferBytes = sizeof(Float32) * kEngramSimMaxBufferFrames * sim->channels;
+    sim->producerBuffer = (Float32*)malloc(bufferBytes);
+    sim->ioBuffer = (Float32*)malloc(bufferBytes);
+    sim->mixBuffer = (Float32*)malloc(bufferBytes);
+    sim->expected = (Float32*)malloc(bufferBytes);
+    EngramDSPChain_Init(&sim->reference, sim->sampleRate, sim->channels, kEngramDefaultDSPStages);
+    sim->verifyAudio = true;
+    sim->probing = false;
+
+    sim->rng = (sim->config.seed != 0) ? sim->config.seed : 1;
+    sim->producedFrames = 0;
+    sim->consumedFrames = 0;
+
+    EngramSim_Check(sim, sim->interface->StartIO(sim->driver, sim->deviceID, sim->clientID));
+    EngramSim_Anchor(sim);
+
+    return sim->report.failedCalls == 0;
+}
+
+// MARK: - IO Cycles
+
+static void EngramSim_CheckZeroTimeStamp(EngramSimulator* sim, UInt64 now) {
+    Float64 sampleTime = 0.0;
+    UInt64 hostTime = 0;
+    UInt64 seed = 0;
+    EngramSim_Check(sim, sim->interface->GetZeroTimeStamp(sim->driver, sim->deviceID, sim->clientID,
+                                                          &sampleTime, &hostTime, &seed));
+
+    // Zero timestamps must sit on the device timeline, on a period boundary,
+    // never go backwards and never be in the future.
+    Float64 expectedHostTime = (Float64)sim->anchorHostTime + sampleTime * sim->hostTicksPerFrame;
+    if (fabs((Float64)hostTime - expectedHostTime) > 1.0 ||
+        fmod(sampleTime, (Float64)kEngramZeroTimeStampPeriod) != 0.0 ||
+        sampleTime < sim->lastZeroSampleTime || seed != sim->seed) {
+        sim->report.timestampErrors++;
+    }
+    if (hostTime > now) {
+        sim->report.lateZeroTimeStamps++;
+    }
+    sim->lastZeroSampleTime = sampleTime;
+}
+
+static void EngramSim_MakeTimeStamp(EngramSimulator* sim, AudioTimeStamp* timeStamp, Float64 sampleTime) {
+    memset(timeStamp, 0, sizeof(AudioTimeStamp));
+    timeStamp->mSampleTime = sampleTime;
+    timeStamp->mHostTime = sim->anchorHostTime + (UInt64)(sampleTime * sim->hostTicksPerFrame);
+    timeStamp->mRateScalar = 1.0;
+    timeStamp->mFlags = kAudioTimeStampSampleTimeValid | kAudioTimeStampHostTimeValid | kAudioTimeStampRateScalarValid;
+}
+
+// Whether the cycle's output is the reference with its channels rotated
+// by some non-zero shift, i.e. every channel carries another one's audio.
+static Boolean EngramSim_ChannelsRotated(EngramSimulator* sim, UInt32 frames) {
+    UInt32 channels = sim->channels;
+    for (UInt32 shift = 1; shift < channels; shift++) {
+        Boolean rotated = true;
+        for (UInt32 frame = 0; frame < frames && rotated; frame++) {
+            for (UInt32 channel = 0; channel < channels; channel++) {
+                Float32 actual = sim->ioBuffer[frame * channels + channel];
+                Float32 other = sim->expected[frame * channels + (channel + shift) % channels];
+                if (fabsf(actual - other) > kEngramSimTolerance) {
+                    rotated = false;
+                    break;
+                }
+            }
+        }
+        if (rotated) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void EngramSim_VerifyInput(EngramSimulator* sim) {
+    UInt32 frames = sim->config.bufferFrames;
+    UInt32 channels = sim->channels;
+
+    // The ring hands out what the producer delivered, in order, and pads
+    // with silence when it runs dry
+    UInt64 queued = sim->producedFrames - sim->consumedFrames;
+    UInt32 available = (queued < frames) ? (UInt32)queued : frames;
+    for (UInt32 frame = 0; frame < available; frame++) {
+        UInt32 index = (UInt32)((sim->consumedFrames + frame) % kEngramSimSignalFrames);
+        memcpy(sim->expected + frame * channels, sim->signal + index * channels, sizeof(Float32) * channels);
+    }
+    memset(sim->expected + available * channels, 0, sizeof(Float32) * (frames - available) * channels);
+    sim->consumedFrames += available;
+
+    // What is left in the ring is the input latency clients are about to hear
+    UInt64 remaining = sim->producedFrames - sim->consumedFrames;
+    if (remaining > sim->report.maxQueuedFrames) {
+        sim->report.maxQueuedFrames = remaining;
+    }
+
+    if (!sim->verifyAudio) {
+        return;
+    }
+
+    if (EngramRingBuffer_GetAvailableRead(&gDevice.ringBuffer) != remaining * channels) {
+        sim->report.accountingErrors++;
+    }
+
+    // The device runs its specialized kernel; the reference stays generic
+    {
+        ENGRAM_DENORMAL_GUARD();
+        EngramDSPChain_ProcessGeneric(&sim->reference, sim->expected, frames);
+    }
+
+    UInt64 mismatched = 0;
+    for (UInt32 i = 0; i < frames * channels; i++) {
+        Float32 error = fabsf(sim->ioBuffer[i] - sim->expected[i]);
+        if (error > kEngramSimTolerance) {
+            mismatched++;
+        }
+        if (error > sim->report.maxAbsError) {
+            sim->report.maxAbsError = error;
+        }
+    }
+    sim->report.mismatchedSamples += mismatched;
+
+    if (mismatched != 0 && EngramSim_ChannelsRotated(sim, frames)) {
+        sim->report.channelSwaps++;
+    }
+}
+
+static void EngramSim_RunCycle(EngramSimulator* sim) {
+    UInt32 frames = sim->config.bufferFrames;
+    Float64 inputSampleTime = (Float64)sim->sampleTime;
+
+    // The IO thread wakes once the cycle's input has been captured, plus
+    // whatever the scheduler adds
+    Float64 nominalWake = (Float64)sim->anchorHostTime + (inputSampleTime + frames) * sim->hostTicksPerFrame;
+    UInt64 wake = (UInt64)nominalWake + EngramSim_Random(sim, sim->config.ioJitterNanos);
+
+    while (sim->nextProducerHostTime <= wake) {
+        EngramSim_AdvanceTo(sim->nextProducerHostTime);
+        EngramSim_ProduceBlock(sim);
+    }
+    EngramSim_AdvanceTo(wake);
+    UInt64 now = EngramSim_HostTime();
+
+    EngramSim_CheckZeroTimeStamp(sim, now);
+
+    AudioServerPlugInIOCycleInfo cycleInfo;
+    memset(&cycleInfo, 0, sizeof(cycleInfo));
+    cycleInfo.mIOCycleCounter = sim->cycle + 1;
+    cycleInfo.mNominalIOBufferFrameSize = frames;
+    EngramSim_MakeTimeStamp(sim, &cycleInfo.mCurrentTime, ((Float64)(now - sim->anchorHostTime)) / sim->hostTicksPerFrame);
+    cycleInfo.mCurrentTime.mHostTime = now;
+    EngramSim_MakeTimeStamp(sim, &cycleInfo.mInputTime, inputSampleTime);
+    EngramSim_MakeTimeStamp(sim, &cycleInfo.mOutputTime, inputSampleTime + 2.0 * frames);
+    cycleInfo.mMainHostTicksPerFrame = sim->hostTicksPerFrame;
+    cycleInfo.mDeviceHostTicksPerFrame = sim->hostTicksPerFrame;
+
+    // Output-side operations work on a silent client mix of their own
+    memset(sim->mixBuffer, 0, sizeof(Float32) * frames * sim->channels);
+
+    Boolean readInput = false;
+    for (UInt32 i = 0; i < sim->operationCount; i++) {
+        UInt32 operation = sim->operations[i];
+        Boolean input = (operation == kAudioServerPlugInIOOperationReadInput ||
+                         operation == kAudioServerPlugInIOOperationConvertInput ||
+                         operation == kAudioServerPlugInIOOperationProcessInput);
+        void* buffer = input ? sim->ioBuffer : sim->mixBuffer;
+
+        EngramSim_Check(sim, sim->interface->BeginIOOperation(sim->driver, sim->deviceID, sim->clientID,
+                                                              operation, frames, &cycleInfo));
+        EngramSim_Check(sim, sim->interface->DoIOOperation(sim->driver, sim->deviceID, kAudioObjectUnknown, sim->clientID,
+                                                           operation, frames, &cycleInfo, buffer, NULL));
+        EngramSim_Check(sim, sim->interface->EndIOOperation(sim->driver, sim->deviceID, sim->clientID,
+                                                            operation, frames, &cycleInfo));
+        readInput |= (operation == kAudioServerPlugInIOOperationReadInput);
+    }
+
+    if (readInput) {
+        EngramSim_VerifyInput(sim);
+    }
+
+    sim->cycle++;
+    sim->sampleTime += frames;
+    sim->report.cycles++;
+    sim->report.simulatedNanos = now - kEngramSimStartHostTime;
+}
+
+void EngramSim_Run(EngramSimulator* sim, UInt64 cycles) {
+    for (UInt64 i = 0; i < cycles; i++) {
+        EngramSim_RunCycle(sim);
+    }
+}
+
+void EngramSim_RunFor(EngramSimulator* sim, UInt64 nanos) {
+    Float64 cycleNanos = sim->config.bufferFrames * sim->hostTicksPerFrame;
+    EngramSim_Run(sim, (UInt64)((Float64)nanos / cycleNanos));
+}
+
+// MARK: - Teardown
+
+void EngramSim_CollectStats(EngramSimulator* sim) {
+    CFPropertyListRef data = NULL;
+    if (EngramSim_GetProperty(sim, kEngramPropertyStats, sizeof(data), &data) != kAudioHardwareNoError || data == NULL) {
+        sim->report.failedCalls++;
+        return;
+    }
+
+    if (CFDataGetLength((CFDataRef)data) == (CFIndex)sizeof(EngramStatsSnapshot)) {
+        const EngramStatsSnapshot* stats = (const EngramStatsSnapshot*)CFDataGetBytePtr((CFDataRef)data);
+        sim->report.underrunCycles = stats->underruns;
+        sim->report.underrunSamples = stats->underrunSamples;
+        sim->report.overrunSamples = stats->overrunSamples;
+        sim->report.glitches = stats->glitches;
+        sim->report.discontinuities = stats->discontinuities;
+        sim->report.clicks = stats->clicks;
+        sim->report.ioDurationP99Ns = EngramHistogram_ValueAtPercentile(&stats->ioDurationNs, 99.0);
+        sim->report.cycleJitterP99Ns = EngramHistogram_ValueAtPercentile(&stats->cycleJitterNs, 99.0);
+        sim->report.queueResidencyP50Ns = EngramHistogram_ValueAtPercentile(&stats->queueResidencyNs, 50.0);
+        sim->report.queueResidencyP99Ns = EngramHistogram_ValueAtPercentile(&stats->queueResidencyNs, 99.0);
+    }
+    CFRelease(data);
+}
+
+void EngramSim_Stop(EngramSimulator* sim, EngramSimReport* outReport) {
+    if (sim->interface != NULL) {
+        if (sim->probing) {
+            EngramSim_StopLatencyProbes(sim);
+        }
+        EngramSim_CollectStats(sim);
+        EngramSim_Check(sim, sim->interface->StopIO(sim->driver, sim->deviceID, sim->clientID));
+        EngramSim_Check(sim, sim->interface->DestroyDevice(sim->driver, sim->deviceID));
+        sim->interface->Release(sim->driver);
+        sim->interface = NULL;
+    }
+    // Teardown has delivered everything still pending by now
+    sim->report.propertyNotifications = gSimPropertyNotifications.load(std::memory_order_relaxed);
+
+    free(sim->producerBuffer);
+    free(sim->ioBuffer);
+    free(sim->mixBuffer);
+    free(sim->expected);
+    sim->producerBuffer = NULL;
+    sim->ioBuffer = NULL;
+    sim->mixBuffer = NULL;
+    sim->expected = NULL;
+
+    gEngramShimHostTimeSource.store(NULL, std::memory_order_relaxed);
+
+    if (outReport != NULL) {
+        *outReport = sim->report;
+    }
+}
+
+// MARK: - Latency Calibration
+
+Boolean EngramSim_StartLatencyProbes(EngramSimulator* sim, EngramLatencyProbeKind kind, UInt32 intervalFrames) {
+    OSStatus status = EngramSim_SetBoolean(sim, kEngramPropertyLatency, true);
+    EngramSim_Check(sim, status);
+    if (status != kAudioHardwareNoError) {
+        return false;
+    }
+    EngramLatencyGenerator_Init(&sim->probeGenerator, kind, sim->channels, intervalFrames);
+    EngramLatencyLog_Init(&sim->probeLog);
+    sim->probing = true;
+    sim->verifyAudio = false;
+    return true;
+}
+
+void EngramSim_StopLatencyProbes(EngramSimulator* sim) {
+    static EngramLatencyRecord probes[kEngramLatencyRecordCapacity];
+    static EngramLatencyRecord arrivals[kEngramLatencyRecordCapacity];
+    UInt32 probeCount = EngramLatencyLog_Pop(&sim->probeLog, probes, kEngramLatencyRecordCapacity);
+    UInt32 arrivalCount = 0;
+
+    // Reading the property drains the plugin's queue
+    CFPropertyListRef data = NULL;
+    if (EngramSim_GetProperty(sim, kEngramPropertyLatency, sizeof(data), &data) != kAudioHardwareNoError || data == NULL) {
+        sim->report.failedCalls++;
+    } else {
+        arrivalCount = (UInt32)((size_t)CFDataGetLength((CFDataRef)data) / sizeof(EngramLatencyRecord));
+        if (arrivalCount > kEngramLatencyRecordCapacity) {
+            arrivalCount = kEngramLatencyRecordCapacity;
+        }
+        memcpy(arrivals, CFDataGetBytePtr((CFDataRef)data), arrivalCount * sizeof(EngramLatencyRecord));
+        CFRelease(data);
+    }
+    EngramSim_Check(sim, EngramSim_SetBoolean(sim, kEngramPropertyLatency, false));
+    sim->probing = false;
+
+    // Both queues are in time order; each arrival belongs to the latest probe
+    // sent before it (the virtual timebase is 1/1, so ticks are nanoseconds)
+    UInt32 probe = 0;
+    for (UInt32 i = 0; i < arrivalCount; i++) {
+        if (probe >= probeCount || probes[probe].hostTime > arrivals[i].hostTime) {
+            continue;
+        }
+        while (probe + 1 < probeCount && probes[probe + 1].hostTime <= arrivals[i].hostTime) {
+            probe++;
+        }
+        UInt64 latency = arrivals[i].hostTime - probes[probe].hostTime;
+        if (sim->report.latencyMatched == 0 || latency < sim->report.latencyMinNs) {
+            sim->report.latencyMinNs = latency;
+        }
+        if (latency > sim->report.latencyMaxNs) {
+            sim->report.latencyMaxNs = latency;
+        }
+        sim->report.latencyMatched++;
+        probe++;
+    }
+    sim->report.latencyProbes += probeCount;
+    sim->report.latencyArrivals += arrivalCount;
+}
+
+// MARK: - Pathologies
+
+Boolean EngramSim_SetBufferFrames(EngramSimulator* sim, UInt32 frames) {
+    if (frames == 0 || frames > kEngramSimMaxBufferFrames) {
+        return false;
+    }
+    sim->config.bufferFrames = frames;
+    return true;
+}
+
+Boolean EngramSim_SetProducerFrames(EngramSimulator* sim, UInt32 frames) {
+    if (frames == 0 || frames > kEngramSimMaxBufferFrames) {
+        return false;
+    }
+    sim->config.producerFrames = frames;
+    return true;
+}
+
+void EngramSim_StallProducer(EngramSimulator* sim, UInt64 nanos) {
+    // Writes are ordered, so every block that falls due during the stall
+    // lands together when it ends
+    UInt64 until = EngramSim_HostTime() + nanos;
+    if (until > sim->nextProducerHostTime) {
+        sim->nextProducerHostTime = until;
+    }
+}
+
+void EngramSim_ProducerBurst(EngramSimulator* sim, UInt32 frames) {
+    UInt64 target = sim->producedFrames + frames;
+    while (sim->producedFrames < target) {
+        EngramSim_ProduceBlock(sim);
+    }
+}
+
+OSStatus EngramSim_AttachClient(EngramSimulator* sim, UInt32 clientID) {
+    // The plugin doesn't track clients; the HAL only calls these when provided
+    AudioServerPlugInClientInfo clientInfo = { clientID, 0, true, NULL };
+    OSStatus status = kAudioHardwareNoError;
+    if (sim->interface->AddDeviceClient != NULL) {
+        status = sim->interface->AddDeviceClient(sim->driver, sim->deviceID, &clientInfo);
+    }
+    if (status == kAudioHardwareNoError) {
+        status = sim->interface->StartIO(sim->driver, sim->deviceID, clientID);
+    }
+    EngramSim_Check(sim, status);
+    return status;
+}
+
+OSStatus EngramSim_DetachClient(EngramSimulator* sim, UInt32 clientID) {
+    AudioServerPlugInClientInfo clientInfo = { clientID, 0, true, NULL };
+    OSStatus status = sim->interface->StopIO(sim->driver, sim->deviceID, clientID);
+    if (status == kAudioHardwareNoError && sim->interface->RemoveDeviceClient != NULL) {
+        status = sim->interface->RemoveDeviceClient(sim->driver, sim->deviceID, &clientInfo);
+    }
+    EngramSim_Check(sim, status);
+    return status;
+}
+
+void EngramSim_Restart(EngramSimulator* sim, UInt64 gapNanos) {
+    EngramSim_Check(sim, sim->interface->StopIO(sim->driver, sim->deviceID, sim->clientID));
+    EngramSim_AdvanceTo(EngramSim_HostTime() + gapNanos);
+    EngramSim_Check(sim, sim->interface->StartIO(sim->driver, sim->deviceID, sim->clientID));
+
+    // StartIO reset the plugin's chain; the reference follows it
+    EngramDSPChain_Reset(&sim->reference);
+    EngramSim_Anchor(sim);
+    sim->report.restarts++;
+}
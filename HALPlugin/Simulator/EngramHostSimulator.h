@@ -0,0 +1,167 @@
+//
+//  EngramHostSimulator.h
+//  Engram Virtual Audio Device
+//
+//  Stands in for coreaudiod: loads the driver interface from
+//  EngramPlugIn_Create, brings the device up and runs IO cycles against a
+//  virtual host clock, so hours of session time take seconds. A simulated
+//  producer feeds the ring on its own (jittered) schedule and every cycle's
+//  output is checked against a reference chain fed the expected signal.
+//  Linux only: the virtual clock is installed through the mach_time shim.
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#ifndef EngramHostSimulator_h
+#define EngramHostSimulator_h
+
+#include "EngramDSP.h"
+#include "EngramHalPlugin.h"
+
+// Test signal period: 440 Hz and 550 Hz both complete whole cycles in it
+#define kEngramSimSignalFrames 4800
+#define kEngramSimMaxBufferFrames 4096
+// Output within this of the reference counts as a match
+#define kEngramSimTolerance 1.0e-6f
+
+// MARK: - Configuration
+
+typedef struct {
+    UInt32 bufferFrames;        // IO buffer size the host asks for
+    UInt32 producerFrames;      // frames per producer write
+    UInt32 producerLeadFrames;  // how far ahead of the device timeline the producer delivers
+    UInt64 ioJitterNanos;       // IO thread wakes up to this late
+    UInt64 producerJitterNanos; // producer writes land up to this late
+    Float64 producerSkewPpm;    // peak rate error of the producer's clock against the device
+    UInt64 producerSkewPeriodNanos; // the error wanders sinusoidally over this period; 0 disables skew
+    UInt64 seed;                // jitter RNG seed; runs are reproducible
+} EngramSimConfig;
+
+// What a run observed. Counters from the plugin come from kEngramPropertyStats.
+typedef struct {
+    UInt64 cycles;
+    UInt64 simulatedNanos;
+    UInt64 producerWrites;
+    UInt64 idleWrites;          // producer writes while the IO gate said no client was running
+    UInt64 underrunCycles;
+    UInt64 underrunSamples;
+    UInt64 overrunSamples;
+    UInt64 glitches;
+    UInt64 discontinuities;
+    UInt64 clicks;
+    UInt64 mismatchedSamples;   // output that differs from the reference chain
+    Float64 maxAbsError;
+    UInt64 timestampErrors;     // zero timestamps off the device timeline
+    UInt64 lateZeroTimeStamps;  // zero timestamps ahead of the current time
+    UInt64 failedCalls;         // driver calls that returned an error
+    UInt64 propertyNotifications; // PropertiesChanged calls received from the plugin
+    UInt64 channelSwaps;        // cycles whose output matched the reference with channels rotated
+    UInt64 accountingErrors;    // cycles where the ring fill disagreed with produced - consumed
+    UInt64 maxQueuedFrames;     // deepest the ring got after a read: the input latency high-water mark
+    UInt64 restarts;            // IO stop/start round trips
+    UInt64 ioDurationP99Ns;
+    UInt64 cycleJitterP99Ns;
+    UInt64 queueResidencyP50Ns; // producer write to delivery, oldest sample of each cycle
+    UInt64 queueResidencyP99Ns;
+    // Latency calibration, filled in by EngramSim_StopLatencyProbes
+    UInt64 latencyProbes;       // probes the producer sent
+    UInt64 latencyArrivals;     // onsets the plugin stamped through kEngramPropertyLatency
+    UInt64 latencyMatched;      // arrivals paired with the probe sent before them
+    UInt64 latencyMinNs;
+    UInt64 latencyMaxNs;
+} EngramSimReport;
+
+// MARK: - Simulator
+
+typedef struct {
+    EngramSimConfig config;
+
+    AudioServerPlugInDriverInterface* interface;
+    AudioServerPlugInDriverRef driver;
+    AudioServerPlugInHostInterface host;
+    AudioObjectID deviceID;
+    UInt32 clientID;
+    UInt32 channels;
+    Float64 sampleRate;
+    Float64 hostTicksPerFrame;
+
+    // Operations the plugin asked for in WillDoIOOperation, in HAL order
+    UInt32 operations[10];
+    UInt32 operationCount;
+
+    // Device timeline
+    UInt64 anchorHostTime;
+    UInt64 cycle;
+    UInt64 sampleTime;          // device frame of the next cycle's input
+    UInt64 seed;
+    Float64 lastZeroSampleTime;
+
+    // Producer timeline; streamBase is the stream frame at device frame 0
+    UInt64 producedFrames;
+    UInt64 consumedFrames;
+    UInt64 streamBase;
+    UInt64 nextProducerHostTime;
+    UInt64 rng;
+
+    Float32 signal[kEngramSimSignalFrames * kEngramMaxChannels];
+    Float32* producerBuffer;
+    Float32* ioBuffer;
+    Float32* mixBuffer;
+    Float32* expected;
+    EngramDSPChain reference;
+    Boolean verifyAudio;
+
+    // Latency calibration: the producer sends probes instead of the signal
+    Boolean probing;
+    EngramLatencyGenerator probeGenerator;
+    EngramLatencyLog probeLog;
+
+    EngramSimReport report;
+} EngramSimulator;
+
+void EngramSim_DefaultConfig(EngramSimConfig* config);
+
+// Current virtual host time (nanoseconds; the shim timebase is 1/1).
+UInt64 EngramSim_HostTime(void);
+
+// Installs the virtual clock, creates and initializes the plugin, creates the
+// device, reads its format and starts IO for one client.
+Boolean EngramSim_Start(EngramSimulator* sim, const EngramSimConfig* config);
+// Runs `cycles` IO cycles, interleaving producer writes as their time comes.
+void EngramSim_Run(EngramSimulator* sim, UInt64 cycles);
+// Runs whole cycles until `nanos` of device time have passed.
+void EngramSim_RunFor(EngramSimulator* sim, UInt64 nanos);
+// Folds the plugin's stats into the report without stopping.
+void EngramSim_CollectStats(EngramSimulator* sim);
+// Stops IO, releases the plugin and removes the virtual clock.
+void EngramSim_Stop(EngramSimulator* sim, EngramSimReport* outReport);
+
+// MARK: - Latency Calibration
+
+// Switches kEngramPropertyLatency on and has the producer send probes of
+// `kind` every `intervalFrames` instead of the test signal, so output is no
+// longer checked against the reference. Both sides queue at most
+// kEngramLatencyRecordCapacity records, so stop before that many are sent.
+Boolean EngramSim_StartLatencyProbes(EngramSimulator* sim, EngramLatencyProbeKind kind, UInt32 intervalFrames);
+// Drains the plugin's arrivals, switches calibration off and pairs the
+// arrivals with the probes the way engram-hal-latency does, into the report.
+void EngramSim_StopLatencyProbes(EngramSimulator* sim);
+
+// MARK: - Pathologies
+
+// The host renegotiates the IO buffer size; takes effect from the next cycle.
+Boolean EngramSim_SetBufferFrames(EngramSimulator* sim, UInt32 frames);
+// The producer switches to a different write size from its next block.
+Boolean EngramSim_SetProducerFrames(EngramSimulator* sim, UInt32 frames);
+// The producer delivers nothing for `nanos`, then catches up in one burst.
+void EngramSim_StallProducer(EngramSimulator* sim, UInt64 nanos);
+// The producer delivers (at least) the next `frames` right now, ahead of schedule.
+void EngramSim_ProducerBurst(EngramSimulator* sim, UInt32 frames);
+// Additional clients joining and leaving the running device.
+OSStatus EngramSim_AttachClient(EngramSimulator* sim, UInt32 clientID);
+OSStatus EngramSim_DetachClient(EngramSimulator* sim, UInt32 clientID);
+// The last client stops IO, the producer pauses for `gapNanos`, then IO starts
+// again on a fresh anchor. Detach any extra clients first.
+void EngramSim_Restart(EngramSimulator* sim, UInt64 gapNanos);
+
+#endif /* EngramHostSimulator_h */
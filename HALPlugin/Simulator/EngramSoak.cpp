@@ -0,0 +1,260 @@
+//
+//  EngramSoak.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramSoak.h"
+#include <malloc.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define kEngramSoakNanosPerHour 3600000000000ull
+
+// What the host and producer switch between when a rate change comes up
+static const UInt32 kEngramSoakBufferFrames[] = { 128, 256, 512, 1024 };
+static const UInt32 kEngramSoakProducerFrames[] = { 240, 480, 960 };
+
+#define kEngramSoakCount(array) (sizeof(array) / sizeof((array)[0]))
+
+void EngramSoak_DefaultConfig(EngramSoakConfig* config) {
+    EngramSim_DefaultConfig(&config->sim);
+    config->sim.producerSkewPpm = 50.0;
+    config->sim.producerSkewPeriodNanos = 600000000000ull;
+    config->durationNanos = 8 * kEngramSoakNanosPerHour;
+    config->stepNanos = 1000000000ull;
+    config->warmupNanos = 600000000000ull;
+    config->stallsPerHour = 20.0;
+    config->maxStallNanos = 150000000ull;
+    config->burstsPerHour = 20.0;
+    config->maxBurstFrames = 4800;
+    config->clientChangesPerHour = 30.0;
+    config->restartsPerHour = 2.0;
+    config->maxRestartGapNanos = 5000000000ull;
+    config->rateChangesPerHour = 6.0;
+    config->maxHeapGrowthBytes = 64 * 1024;
+}
+
+static UInt32 EngramSoak_Max(const UInt32* values, size_t count, UInt32 floor) {
+    UInt32 result = floor;
+    for (size_t i = 0; i < count; i++) {
+        result = (values[i] > result) ? values[i] : result;
+    }
+    return result;
+}
+
+UInt64 EngramSoak_LatencyBoundFrames(const EngramSoakConfig* config) {
+    Float64 framesPerNano = (Float64)kEngramSampleRate * 1.0e-9;
+    UInt32 producerFrames = EngramSoak_Max(kEngramSoakProducerFrames, kEngramSoakCount(kEngramSoakProducerFrames),
+                                           config->sim.producerFrames);
+    UInt32 bufferFrames = EngramSoak_Max(kEngramSoakBufferFrames, kEngramSoakCount(kEngramSoakBufferFrames),
+                                         config->sim.bufferFrames);
+
+    // Late deliveries underrun and then arrive anyway, so the deepest stall
+    // (plus jitter and the slow half of the skew) stays queued for good. Early
+    // deliveries (bursts, the fast half of the skew) only borrow from later.
+    Float64 skewNanos = config->sim.producerSkewPpm * 1.0e-6 * (Float64)config->sim.producerSkewPeriodNanos / (2.0 * M_PI);
+    Float64 lateNanos = (Float64)(config->maxStallNanos + config->sim.producerJitterNanos + config->sim.ioJitterNanos) + skewNanos;
+    Float64 earlyNanos = skewNanos;
+
+    return config->sim.producerLeadFrames + producerFrames + bufferFrames + config->maxBurstFrames +
+           (UInt64)ceil((lateNanos + earlyNanos) * framesPerNano);
+}
+
+// MARK: - Memory
+
+static SInt64 EngramSoak_HeapInUse(void) {
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 33)
+    struct mallinfo2 info = mallinfo2();
+    return (SInt64)info.uordblks;
+#else
+    return 0;
+#endif
+}
+
+// MARK: - Pathologies
+
+typedef struct {
+    EngramSimulator* sim;
+    const EngramSoakConfig* config;
+    EngramSoakReport* report;
+    UInt64 rng;
+    Boolean clientAttached[kEngramSoakMaxExtraClients];
+} EngramSoakSession;
+
+// xorshift64*, seeded apart from the simulator's jitter stream
+static UInt64 EngramSoak_Random(EngramSoakSession* session, UInt64 bound) {
+    session->rng ^= session->rng >> 12;
+    session->rng ^= session->rng << 25;
+    session->rng ^= session->rng >> 27;
+    UInt64 value = session->rng * 0x2545F4914F6CDD1Dull;
+    return (bound == 0) ? 0 : value % (bound + 1);
+}
+
+// Whether an event at `perHour` happens in this step
+static Boolean EngramSoak_Roll(EngramSoakSession* session, Float64 perHour) {
+    Float64 probability = perHour * (Float64)session->config->stepNanos / (Float64)kEngramSoakNanosPerHour;
+    return (Float64)EngramSoak_Random(session, 1000000) < probability * 1.0e6;
+}
+
+static void EngramSoak_DetachClient(EngramSoakSession* session, UInt32 slot) {
+    EngramSim_DetachClient(session->sim, kEngramSoakFirstExtraClientID + slot);
+    session->clientAttached[slot] = false;
+    session->report->clientDetaches++;
+}
+
+static void EngramSoak_ChangeClients(EngramSoakSession* session) {
+    UInt32 slot = (UInt32)EngramSoak_Random(session, kEngramSoakMaxExtraClients - 1);
+    if (session->clientAttached[slot]) {
+        EngramSoak_DetachClient(session, slot);
+    } else {
+        EngramSim_AttachClient(session->sim, kEngramSoakFirstExtraClientID + slot);
+        session->clientAttached[slot] = true;
+        session->report->clientAttaches++;
+    }
+}
+
+static void EngramSoak_Restart(EngramSoakSession* session) {
+    // IO only stops once the last client has gone
+    for (UInt32 slot = 0; slot < kEngramSoakMaxExtraClients; slot++) {
+        if (session->clientAttached[slot]) {
+            EngramSoak_DetachClient(session, slot);
+        }
+    }
+    EngramSim_Restart(session->sim, EngramSoak_Random(session, session->config->maxRestartGapNanos));
+}
+
+static void EngramSoak_ChangeRate(EngramSoakSession* session) {
+    if (EngramSoak_Random(session, 1) == 0) {
+        UInt32 index = (UInt32)EngramSoak_Random(session, kEngramSoakCount(kEngramSoakBufferFrames) - 1);
+        EngramSim_SetBufferFrames(session->sim, kEngramSoakBufferFrames[index]);
+        session->report->bufferChanges++;
+    } else {
+        UInt32 index = (UInt32)EngramSoak_Random(session, kEngramSoakCount(kEngramSoakProducerFrames) - 1);
+        EngramSim_SetProducerFrames(session->sim, kEngramSoakProducerFrames[index]);
+        session->report->producerChanges++;
+    }
+}
+
+static void EngramSoak_InjectPathologies(EngramSoakSession* session) {
+    const EngramSoakConfig* config = session->config;
+
+    if (EngramSoak_Roll(session, config->stallsPerHour)) {
+        EngramSim_StallProducer(session->sim, EngramSoak_Random(session, config->maxStallNanos));
+        session->report->stalls++;
+    }
+    if (EngramSoak_Roll(session, config->burstsPerHour)) {
+        EngramSim_ProducerBurst(session->sim, (UInt32)EngramSoak_Random(session, config->maxBurstFrames));
+        session->report->bursts++;
+    }
+    if (EngramSoak_Roll(session, config->clientChangesPerHour)) {
+        EngramSoak_ChangeClients(session);
+    }
+    if (EngramSoak_Roll(session, config->rateChangesPerHour)) {
+        EngramSoak_ChangeRate(session);
+    }
+    if (EngramSoak_Roll(session, config->restartsPerHour)) {
+        EngramSoak_Restart(session);
+    }
+}
+
+// MARK: - Invariants
+
+static UInt64 EngramSoak_Failures(const EngramSoakReport* report) {
+    const EngramSimReport* sim = &report->sim;
+    return sim->mismatchedSamples + sim->channelSwaps + sim->accountingErrors + sim->overrunSamples +
+           sim->timestampErrors + sim->lateZeroTimeStamps + sim->failedCalls + sim->idleWrites +
+           report->latencyViolations;
+}
+
+static void EngramSoak_CheckStep(EngramSoakSession* session) {
+    EngramSoakReport* report = session->report;
+    UInt64 failuresBefore = EngramSoak_Failures(report);
+
+    // Polling the stats property is what monitoring clients do all session
+    EngramSim_CollectStats(session->sim);
+    report->sim = session->sim->report;
+    if (report->sim.maxQueuedFrames > report->latencyBoundFrames) {
+        report->latencyViolations++;
+    }
+
+    if (report->firstFailureNanos == 0 && EngramSoak_Failures(report) > failuresBefore) {
+        report->firstFailureNanos = report->sim.simulatedNanos;
+    }
+}
+
+// MARK: - Session
+
+Boolean EngramSoak_Run(const EngramSoakConfig* config, EngramSoakReport* outReport,
+                       EngramSoakProgress progress, void* context) {
+    EngramSoakReport report;
+    memset(&report, 0, sizeof(report));
+    report.latencyBoundFrames = EngramSoak_LatencyBoundFrames(config);
+
+    EngramSimulator* sim = (EngramSimulator*)calloc(1, sizeof(EngramSimulator));
+    EngramSoakSession session;
+    memset(&session, 0, sizeof(session));
+    session.sim = sim;
+    session.config = config;
+    session.report = &report;
+    session.rng = (config->sim.seed ^ 0x536F616B536F616Bull) | 1;
+
+    // A bound the ring can't hold would turn every pathology into an overrun
+    Boolean started = (config->stepNanos != 0) &&
+                      (report.latencyBoundFrames < kEngramRingBufferSize / kEngramChannels) &&
+                      EngramSim_Start(sim, &config->sim);
+    if (!started) {
+        EngramSim_Stop(sim, &report.sim);
+        free(sim);
+        report.passed = false;
+        if (outReport != NULL) {
+            *outReport = report;
+        }
+        return false;
+    }
+
+    Boolean baselined = false;
+    SInt64 heapBaseline = 0;
+    CFIndex objectBaseline = 0;
+    UInt64 nextProgressNanos = kEngramSoakNanosPerHour;
+
+    while (report.sim.simulatedNanos < config->durationNanos) {
+        EngramSim_RunFor(sim, config->stepNanos);
+        EngramSoak_InjectPathologies(&session);
+        EngramSoak_CheckStep(&session);
+        report.steps++;
+
+        if (!baselined && report.sim.simulatedNanos >= config->warmupNanos) {
+            heapBaseline = EngramSoak_HeapInUse();
+            objectBaseline = EngramShim_LiveObjectCount();
+            baselined = true;
+        }
+        if (progress != NULL && report.sim.simulatedNanos >= nextProgressNanos) {
+            progress(&report, context);
+            nextProgressNanos += kEngramSoakNanosPerHour;
+        }
+    }
+
+    if (baselined) {
+        report.heapGrowthBytes = EngramSoak_HeapInUse() - heapBaseline;
+        report.liveObjectGrowth = EngramShim_LiveObjectCount() - objectBaseline;
+    }
+
+    for (UInt32 slot = 0; slot < kEngramSoakMaxExtraClients; slot++) {
+        if (session.clientAttached[slot]) {
+            EngramSoak_DetachClient(&session, slot);
+        }
+    }
+    EngramSim_Stop(sim, &report.sim);
+    free(sim);
+
+    report.passed = EngramSoak_Failures(&report) == 0 && report.liveObjectGrowth == 0 &&
+                    report.heapGrowthBytes <= (SInt64)config->maxHeapGrowthBytes;
+    if (outReport != NULL) {
+        *outReport = report;
+    }
+    return report.passed;
+}
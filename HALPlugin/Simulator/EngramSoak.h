@@ -0,0 +1,74 @@
+//
+//  EngramSoak.h
+//  Engram Virtual Audio Device
+//
+//  Long-session soak harness on top of the host simulator. Runs a whole
+//  meeting's worth of device time while the producer misbehaves the way real
+//  ones do over hours (stalls, catch-up bursts, a wandering clock, changing
+//  write sizes) and the host reconfigures underneath it (buffer size changes,
+//  clients joining and leaving, IO restarts). Invariants are checked every
+//  cycle and every step: audio identical to the reference with no channel
+//  rotation, ring fill consistent with what was produced, input latency under
+//  a bound derived from the injected pathologies, zero timestamps on a
+//  monotonic timeline, and no heap or CF object growth after warmup.
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#ifndef EngramSoak_h
+#define EngramSoak_h
+
+#include "EngramHostSimulator.h"
+
+#define kEngramSoakMaxExtraClients 4
+#define kEngramSoakFirstExtraClientID 2
+
+// MARK: - Configuration
+
+typedef struct {
+    EngramSimConfig sim;
+    UInt64 durationNanos;
+    UInt64 stepNanos;            // pathologies are drawn and the plugin polled once per step
+    UInt64 warmupNanos;          // memory baselines are taken after this much device time
+    Float64 stallsPerHour;
+    UInt64 maxStallNanos;
+    Float64 burstsPerHour;
+    UInt32 maxBurstFrames;
+    Float64 clientChangesPerHour; // an extra client attaches or detaches
+    Float64 restartsPerHour;      // every client leaves, then IO starts over
+    UInt64 maxRestartGapNanos;
+    Float64 rateChangesPerHour;   // the host picks a new buffer size or the producer a new write size
+    UInt64 maxHeapGrowthBytes;
+} EngramSoakConfig;
+
+typedef struct {
+    EngramSimReport sim;
+    UInt64 steps;
+    UInt64 stalls;
+    UInt64 bursts;
+    UInt64 clientAttaches;
+    UInt64 clientDetaches;
+    UInt64 bufferChanges;
+    UInt64 producerChanges;
+    UInt64 latencyBoundFrames;
+    UInt64 latencyViolations;    // steps that ended with the latency high-water mark over the bound
+    UInt64 firstFailureNanos;    // device time of the first step that broke an invariant; 0 if none
+    SInt64 heapGrowthBytes;      // in-use heap at the end minus after warmup (glibc only)
+    SInt64 liveObjectGrowth;     // live CF objects at the end minus after warmup
+    Boolean passed;
+} EngramSoakReport;
+
+// Eight hours with a few of each pathology per hour.
+void EngramSoak_DefaultConfig(EngramSoakConfig* config);
+
+// The deepest the ring may legitimately get under `config`: the producer's
+// lead plus everything its pathologies can add on top.
+UInt64 EngramSoak_LatencyBoundFrames(const EngramSoakConfig* config);
+
+// Runs the session. `progress`, if given, is called after every simulated
+// hour. Returns whether every invariant held.
+typedef void (*EngramSoakProgress)(const EngramSoakReport* report, void* context);
+Boolean EngramSoak_Run(const EngramSoakConfig* config, EngramSoakReport* outReport,
+                       EngramSoakProgress progress, void* context);
+
+#endif /* EngramSoak_h */
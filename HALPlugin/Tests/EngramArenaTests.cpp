@@ -0,0 +1,158 @@
+//
+//  EngramArenaTests.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramArena.h"
+#include "EngramTestSupport.h"
+#include <CoreFoundation/CoreFoundation.h>
+#include <signal.h>
+#include <stdint.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static void TestAllocationsAreAlignedAndBounded(void) {
+    EngramArena arena;
+    ENGRAM_EXPECT(EngramArena_Reserve(&arena, 1000));
+    ENGRAM_EXPECT_EQ(arena.capacity, 1024u);
+
+    void* a = EngramArena_Alloc(&arena, 1);
+    void* b = EngramArena_Alloc(&arena, 100);
+    ENGRAM_EXPECT(a != NULL && b != NULL);
+    ENGRAM_EXPECT_EQ((uintptr_t)a % kEngramArenaAlignment, 0u);
+    ENGRAM_EXPECT_EQ((uintptr_t)b % kEngramArenaAlignment, 0u);
+    ENGRAM_EXPECT_EQ((UInt8*)b - (UInt8*)a, (long)kEngramArenaAlignment);
+
+    ENGRAM_EXPECT(EngramArena_Alloc(&arena, 4096) == NULL);
+    EngramArena_Release(&arena);
+    ENGRAM_EXPECT(arena.base == NULL);
+}
+
+#if !ENGRAM_DEBUG_ALLOC_GUARD
+static void TestSealedArenaRefuses(void) {
+    EngramArena arena;
+    EngramArena_Reserve(&arena, 1024);
+    EngramArena_Seal(&arena);
+    ENGRAM_EXPECT(EngramArena_Alloc(&arena, 16) == NULL);
+    EngramArena_Release(&arena);
+}
+#endif
+
+#if ENGRAM_DEBUG_ALLOC_GUARD
+// Keeps the compiler from folding a new/delete pair away
+static UInt64* volatile gAllocated;
+
+// Runs `body` in a child process; true when the child dies of SIGABRT
+static Boolean AbortsInChild(void (*body)(void)) {
+    pid_t child = fork();
+    if (child == 0) {
+        body();
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    return WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT;
+}
+
+static void AllocateAfterSeal(Boolean insideCallback) {
+    EngramArena arena;
+    EngramArena_Reserve(&arena, 1024);
+    EngramArena_Seal(&arena);
+    if (insideCallback) {
+        ENGRAM_ALLOC_GUARD();
+        gAllocated = new UInt64(1);
+    } else {
+        gAllocated = new UInt64(1);
+    }
+    delete gAllocated;
+    EngramArena_Release(&arena);
+}
+
+static void TestGuardAbortsOnCallbackAllocation(void) {
+    // Only callbacks are held to it; the host's own threads may still allocate
+    ENGRAM_EXPECT(AbortsInChild([]() { AllocateAfterSeal(true); }));
+    ENGRAM_EXPECT(!AbortsInChild([]() { AllocateAfterSeal(false); }));
+
+    // Nor does it fire before Initialize seals the arena
+    ENGRAM_EXPECT(!AbortsInChild([]() {
+        ENGRAM_ALLOC_GUARD();
+        gAllocated = new UInt64(1);
+        delete gAllocated;
+    }));
+}
+
+#if ENGRAM_ALLOC_GUARD_WATCHES_MALLOC
+// The C allocator, whichever entry point, and CoreFoundation through it
+static void CallocInCallback(void) {
+    EngramArena arena;
+    EngramArena_Reserve(&arena, 1024);
+    EngramArena_Seal(&arena);
+    ENGRAM_ALLOC_GUARD();
+    gAllocated = (UInt64*)calloc(4, sizeof(UInt64));
+    free(gAllocated);
+}
+
+static void TestGuardAbortsOnCallbackMalloc(void) {
+    ENGRAM_EXPECT(AbortsInChild(CallocInCallback));
+    ENGRAM_EXPECT(AbortsInChild([]() {
+        EngramArena arena;
+        EngramArena_Reserve(&arena, 1024);
+        EngramArena_Seal(&arena);
+        ENGRAM_ALLOC_GUARD();
+        void* block = NULL;
+        if (posix_memalign(&block, 64, 256) == 0) {
+            free(block);
+        }
+    }));
+    ENGRAM_EXPECT(AbortsInChild([]() {
+        EngramArena arena;
+        EngramArena_Reserve(&arena, 1024);
+        EngramArena_Seal(&arena);
+        ENGRAM_ALLOC_GUARD();
+        UInt8 bytes[4] = {};
+        CFRelease(CFDataCreate(NULL, bytes, sizeof(bytes)));
+    }));
+
+    // realloc of a block taken before the callback counts too
+    ENGRAM_EXPECT(AbortsInChild([]() {
+        EngramArena arena;
+        EngramArena_Reserve(&arena, 1024);
+        gAllocated = (UInt64*)malloc(sizeof(UInt64));
+        EngramArena_Seal(&arena);
+        ENGRAM_ALLOC_GUARD();
+        gAllocated = (UInt64*)realloc(gAllocated, 64 * sizeof(UInt64));
+        free(gAllocated);
+    }));
+
+    // A permitted allocation, like a CF object handed back to the host, goes through
+    ENGRAM_EXPECT(!AbortsInChild([]() {
+        EngramArena arena;
+        EngramArena_Reserve(&arena, 1024);
+        EngramArena_Seal(&arena);
+        ENGRAM_ALLOC_GUARD();
+        {
+            ENGRAM_ALLOC_PERMIT();
+            gAllocated = (UInt64*)calloc(4, sizeof(UInt64));
+        }
+        free(gAllocated);
+    }));
+}
+#endif
+#endif
+
+int main(void) {
+    ENGRAM_RUN_TEST(TestAllocationsAreAlignedAndBounded);
+#if !ENGRAM_DEBUG_ALLOC_GUARD
+    ENGRAM_RUN_TEST(TestSealedArenaRefuses);
+#endif
+#if ENGRAM_DEBUG_ALLOC_GUARD
+    ENGRAM_RUN_TEST(TestGuardAbortsOnCallbackAllocation);
+#if ENGRAM_ALLOC_GUARD_WATCHES_MALLOC
+    ENGRAM_RUN_TEST(TestGuardAbortsOnCallbackMalloc);
+#endif
+#endif
+    return ENGRAM_TEST_RESULT();
+}
@@ -0,0 +1,95 @@
+//
+//  EngramClockTests.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramClock.h"
+#include "EngramSeqlock.h"
+#include "EngramTestSupport.h"
+#include <atomic>
+#include <thread>
+
+static EngramClockConfig MakeClock(UInt64 anchor) {
+    EngramClockConfig clock = {};
+    clock.anchorHostTime = anchor;
+    clock.seed = 1;
+    clock.sampleRate = 48000.0;
+    clock.hostTicksPerFrame = EngramClock_HostTicksPerFrame(48000.0, 1, 1);
+    clock.nanosPerHostTick = EngramClock_NanosPerHostTick(1, 1);
+    clock.periodFrames = kEngramZeroTimeStampPeriod;
+    return clock;
+}
+
+static void TestHostTicksPerFrame(void) {
+    ENGRAM_EXPECT_NEAR(EngramClock_HostTicksPerFrame(48000.0, 1, 1), 20833.333, 0.001);
+    // Apple Silicon timebase: 125/3 ns per tick
+    ENGRAM_EXPECT_NEAR(EngramClock_HostTicksPerFrame(48000.0, 125, 3), 500.0, 1.0e-9);
+}
+
+static void TestZeroTimeStampBeforeAnchor(void) {
+    EngramClockConfig clock = MakeClock(1000000);
+    Float64 sampleTime = -1.0;
+    UInt64 hostTime = 0;
+    EngramClock_GetZeroTimeStamp(&clock, 10, &sampleTime, &hostTime);
+    ENGRAM_EXPECT_EQ(sampleTime, 0.0);
+    ENGRAM_EXPECT_EQ(hostTime, 1000000u);
+}
+
+static void TestZeroTimeStampSnapsToPeriod(void) {
+    EngramClockConfig clock = MakeClock(0);
+    Float64 periodTicks = clock.hostTicksPerFrame * kEngramZeroTimeStampPeriod;
+
+    Float64 sampleTime;
+    UInt64 hostTime;
+    EngramClock_GetZeroTimeStamp(&clock, (UInt64)(periodTicks * 2.5), &sampleTime, &hostTime);
+    ENGRAM_EXPECT_EQ(sampleTime, 2.0 * kEngramZeroTimeStampPeriod);
+    ENGRAM_EXPECT_EQ(hostTime, (UInt64)(periodTicks * 2.0));
+}
+
+static void TestSeqlockRoundTrip(void) {
+    static EngramSeqlock<EngramClockConfig> lock;
+    EngramClockConfig clock = MakeClock(42);
+    EngramSeqlock_Write(&lock, clock);
+
+    UInt32 sequence = 1;
+    EngramClockConfig read = EngramSeqlock_Read(&lock, &sequence);
+    ENGRAM_EXPECT_EQ(read.anchorHostTime, 42u);
+    ENGRAM_EXPECT_EQ(read.sampleRate, 48000.0);
+    ENGRAM_EXPECT_EQ(sequence % 2, 0u);
+}
+
+static void TestSeqlockReadersNeverSeeTornValues(void) {
+    static EngramSeqlock<EngramClockConfig> lock;
+    EngramSeqlock_Write(&lock, MakeClock(0));
+
+    std::atomic<Boolean> done(false);
+    std::thread writer([&done]() {
+        for (UInt64 i = 1; i <= 100000; i++) {
+            EngramClockConfig clock = MakeClock(i);
+            clock.seed = i;
+            EngramSeqlock_Write(&lock, clock);
+        }
+        done.store(true);
+    });
+
+    UInt32 torn = 0;
+    while (!done.load()) {
+        EngramClockConfig clock = EngramSeqlock_Read(&lock);
+        torn += (clock.seed != clock.anchorHostTime && clock.anchorHostTime != 0);
+    }
+    writer.join();
+
+    ENGRAM_EXPECT_EQ(torn, 0u);
+}
+
+int main(void) {
+    ENGRAM_RUN_TEST(TestHostTicksPerFrame);
+    ENGRAM_RUN_TEST(TestZeroTimeStampBeforeAnchor);
+    ENGRAM_RUN_TEST(TestZeroTimeStampSnapsToPeriod);
+    ENGRAM_RUN_TEST(TestSeqlockRoundTrip);
+    ENGRAM_RUN_TEST(TestSeqlockReadersNeverSeeTornValues);
+    return ENGRAM_TEST_RESULT();
+}
@@ -0,0 +1,292 @@
+//
+//  EngramDSPTests.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramDSP.h"
+#include "EngramDenormal.h"
+#include "EngramTestSupport.h"
+#include <math.h>
+#include <string.h>
+
+static void TestDCBlockRemovesOffset(void) {
+    EngramDSPChain chain;
+    EngramDSPChain_Init(&chain, 48000.0, 2, kEngramDSPStageDCBlock);
+
+    Float32 block[2 * 512];
+    Float32 last[2] = {};
+    for (UInt32 pass = 0; pass < 200; pass++) {
+        for (UInt32 i = 0; i < 2 * 512; i++) {
+            block[i] = 0.5f;
+        }
+        EngramDSPChain_Process(&chain, block, 512);
+        last[0] = block[2 * 511];
+        last[1] = block[2 * 511 + 1];
+    }
+    ENGRAM_EXPECT_NEAR(last[0], 0.0, 1.0e-3);
+    ENGRAM_EXPECT_NEAR(last[1], 0.0, 1.0e-3);
+}
+
+static void TestDisabledChainIsTransparent(void) {
+    EngramDSPChain chain;
+    EngramDSPChain_Init(&chain, 48000.0, 1, 0);
+
+    Float32 block[64];
+    for (UInt32 i = 0; i < 64; i++) {
+        block[i] = (Float32)i * 0.01f;
+    }
+    EngramDSPChain_Process(&chain, block, 64);
+    for (UInt32 i = 0; i < 64; i++) {
+        ENGRAM_EXPECT_EQ(block[i], (Float32)i * 0.01f);
+    }
+}
+
+static void TestSilenceFlushesState(void) {
+    EngramDSPChain chain;
+    EngramDSPChain_Init(&chain, 48000.0, 1, kEngramDSPStageDCBlock);
+
+    Float32 block[512];
+    block[0] = 1.0f;
+    for (UInt32 i = 1; i < 512; i++) {
+        block[i] = 0.0f;
+    }
+    EngramDSPChain_Process(&chain, block, 512);
+    for (UInt32 pass = 0; pass < 2000; pass++) {
+        for (UInt32 i = 0; i < 512; i++) {
+            block[i] = 0.0f;
+        }
+        EngramDSPChain_Process(&chain, block, 512);
+    }
+    ENGRAM_EXPECT_EQ(chain.dcBlockState[0].z1, 0.0f);
+    ENGRAM_EXPECT_EQ(chain.dcBlockState[0].z2, 0.0f);
+}
+
+static void TestDenormalGuardIsScoped(void) {
+    const UInt64 bits = kEngramDenormalControlBits;
+    if (bits == 0) {
+        return;   // no hardware flush on this target; the stages flush their own state
+    }
+    UInt64 original = EngramDenormal_GetControl();
+    EngramDenormal_SetControl(original & ~bits);
+
+    // 1e-40 is subnormal: kept without the guard, flushed with it
+    volatile Float32 tiny = 1.0e-30f;
+    volatile Float32 scale = 1.0e-10f;
+    ENGRAM_EXPECT(tiny * scale != 0.0f);
+    {
+        ENGRAM_DENORMAL_GUARD();
+        ENGRAM_EXPECT_EQ(EngramDenormal_GetControl() & bits, bits);
+        ENGRAM_EXPECT_EQ(tiny * scale, 0.0f);
+    }
+    // Compared on the flush bits alone; x86 also keeps sticky exception flags there
+    ENGRAM_EXPECT_EQ(EngramDenormal_GetControl() & bits, 0u);
+
+    // A thread that already flushes keeps doing so
+    EngramDenormal_SetControl(original | bits);
+    {
+        ENGRAM_DENORMAL_GUARD();
+    }
+    ENGRAM_EXPECT_EQ(EngramDenormal_GetControl() & bits, bits);
+    EngramDenormal_SetControl(original);
+}
+
+static void TestLowPassUnityAtDC(void) {
+    EngramBiquadCoefficients c;
+    EngramBiquad_MakeLowPass(&c, 48000.0, 1000.0, 0.7071);
+    ENGRAM_EXPECT_NEAR((c.b0 + c.b1 + c.b2) / (1.0f + c.a1 + c.a2), 1.0, 1.0e-4);
+
+    EngramBiquad_MakeHighPass(&c, 48000.0, 1000.0, 0.7071);
+    ENGRAM_EXPECT_NEAR(c.b0 + c.b1 + c.b2, 0.0, 1.0e-6);
+
+    // A notch passes DC and stops its centre frequency dead
+    EngramBiquad_MakeNotch(&c, 48000.0, 1000.0, 20.0);
+    ENGRAM_EXPECT_NEAR((c.b0 + c.b1 + c.b2) / (1.0f + c.a1 + c.a2), 1.0, 1.0e-4);
+    Float64 w = 2.0 * M_PI * 1000.0 / 48000.0;
+    ENGRAM_EXPECT_NEAR(2.0 * c.b0 * cos(w) + c.b1, 0.0, 1.0e-5);
+}
+
+static void TestSpecializedKernelsMatchGeneric(void) {
+    static Float32 specialized[1031 * kEngramMaxChannels];
+    static Float32 generic[1031 * kEngramMaxChannels];
+    static const UInt32 kFrames[] = { 0, 1, 7, 512, 1031 };
+    static const UInt32 kStages[] = { 0, kEngramDSPStageDCBlock, kEngramDSPStageAGC,
+                                      kEngramDSPStageDCBlock | kEngramDSPStageAGC };
+
+    for (UInt32 channels = 1; channels <= kEngramMaxChannels; channels++) {
+        for (UInt32 stages : kStages) {
+            EngramDSPChain a;
+            EngramDSPChain b;
+            EngramDSPChain_Init(&a, 48000.0, channels, stages);
+            EngramDSPChain_Init(&b, 48000.0, channels, stages);
+            Boolean isSpecialized = (channels == 1 || channels == 2 || channels == 4 || channels == 8);
+            ENGRAM_EXPECT_EQ(a.kernel != EngramDSPChain_ProcessGeneric, isSpecialized);
+
+            // Consecutive blocks of odd sizes carry state across calls; with a
+            // DC offset and a tone on every channel, distinct per channel
+            UInt32 offset = 0;
+            Boolean identical = true;
+            for (UInt32 frames : kFrames) {
+                for (UInt32 i = 0; i < frames * channels; i++) {
+                    UInt32 ch = i % channels;
+                    Float32 x = 0.1f * (Float32)(ch + 1) + 0.5f * sinf(0.01f * (Float32)((offset + i / channels) * (ch + 1)));
+                    specialized[i] = x;
+                    generic[i] = x;
+                }
+                {
+                    ENGRAM_DENORMAL_GUARD();
+                    EngramDSPChain_Process(&a, specialized, frames);
+                    EngramDSPChain_ProcessGeneric(&b, generic, frames);
+                }
+                identical &= (memcmp(specialized, generic, sizeof(Float32) * frames * channels) == 0);
+                offset += frames;
+            }
+            identical &= (memcmp(a.dcBlockState, b.dcBlockState, sizeof(a.dcBlockState)) == 0);
+            identical &= (memcmp(&a.agc, &b.agc, sizeof(a.agc)) == 0);
+            ENGRAM_EXPECT(identical);
+        }
+    }
+
+    // Stages the build doesn't know fall back to the generic path
+    ENGRAM_EXPECT(EngramDSPKernel_Select(2, 1u << 31) == EngramDSPChain_ProcessGeneric);
+}
+
+// MARK: - Automatic Gain Control
+
+#define kAGCChannels 2
+// Not a multiple of the AGC block, so gain blocks straddle cycles
+#define kAGCCycleFrames 480
+
+typedef struct {
+    Float32 rmsDb;      // over the last cycle
+    Float32 peak;
+    Float32 maxJump;    // largest relative change between successive measured gains
+} AGCResult;
+
+// Plays a sine at `amplitude` through the chain for `seconds`
+static AGCResult PlayTone(EngramDSPChain* chain, Float32 amplitude, Float64 seconds, Float64* phase) {
+    static Float32 block[kAGCCycleFrames * kAGCChannels];
+    static Float32 input[kAGCCycleFrames * kAGCChannels];
+    AGCResult result = { -200.0f, 0.0f, 0.0f };
+    UInt32 cycles = (UInt32)(seconds * 48000.0 / kAGCCycleFrames);
+    Float32 lastGain = -1.0f;
+    for (UInt32 c = 0; c < cycles; c++) {
+        for (UInt32 i = 0; i < kAGCCycleFrames; i++) {
+            Float32 x = amplitude * (Float32)sin(*phase);
+            *phase += 2.0 * M_PI * 440.0 / 48000.0;
+            input[i * kAGCChannels] = block[i * kAGCChannels] = x;
+            input[i * kAGCChannels + 1] = block[i * kAGCChannels + 1] = x;
+        }
+        EngramDSPChain_Process(chain, block, kAGCCycleFrames);
+
+        Float64 sumSquares = 0.0;
+        result.peak = 0.0f;
+        for (UInt32 i = 0; i < kAGCCycleFrames * kAGCChannels; i++) {
+            sumSquares += (Float64)block[i] * block[i];
+            result.peak = fmaxf(result.peak, fabsf(block[i]));
+            // The gain each frame got, wherever the input is large enough to tell
+            if (fabsf(input[i]) > 0.5f * amplitude) {
+                Float32 gain = block[i] / input[i];
+                if (lastGain >= 0.0f) {
+                    result.maxJump = fmaxf(result.maxJump, fabsf(gain - lastGain) / lastGain);
+                }
+                lastGain = gain;
+            }
+        }
+        result.rmsDb = (Float32)(10.0 * log10(sumSquares / (kAGCCycleFrames * kAGCChannels) + 1.0e-30));
+    }
+    return result;
+}
+
+// -3 dB from the RMS of a full-scale square, i.e. a sine's amplitude
+static Float32 AmplitudeForRmsDb(Float32 db) {
+    return (Float32)(M_SQRT2 * pow(10.0, db / 20.0));
+}
+
+static void TestAGCReachesTarget(void) {
+    EngramDSPChain chain;
+    EngramDSPChain_Init(&chain, 48000.0, kAGCChannels, kEngramDSPStageAGC);
+    Float64 phase = 0.0;
+
+    // A quiet talker comes up by 20 dB at the rise rate. Measured gains are
+    // a few dozen frames apart around zero crossings; stepping a whole
+    // block's rise at once would show as 0.37%.
+    AGCResult quiet = PlayTone(&chain, AmplitudeForRmsDb(-40.0f), 6.0, &phase);
+    ENGRAM_EXPECT_NEAR(quiet.rmsDb, kEngramAGCTargetDbfs, 0.5);
+    ENGRAM_EXPECT(quiet.maxJump < 1.5e-3f);
+
+    // A loud one is brought down, and faster
+    AGCResult loud = PlayTone(&chain, AmplitudeForRmsDb(-8.0f), 1.5, &phase);
+    ENGRAM_EXPECT_NEAR(loud.rmsDb, kEngramAGCTargetDbfs, 0.5);
+
+    // Never more than the maximum gain, however quiet the speech
+    EngramDSPChain_Reset(&chain);
+    AGCResult faint = PlayTone(&chain, AmplitudeForRmsDb(-47.0f), 8.0, &phase);
+    ENGRAM_EXPECT_NEAR(faint.rmsDb, -47.0f + kEngramAGCMaxGainDb, 0.5);
+}
+
+static void TestAGCFreezesInSilence(void) {
+    EngramDSPChain chain;
+    EngramDSPChain_Init(&chain, 48000.0, kAGCChannels, kEngramDSPStageAGC);
+    Float64 phase = 0.0;
+    PlayTone(&chain, AmplitudeForRmsDb(-36.0f), 6.0, &phase);
+    Float32 gainDb = chain.agc.gainDb;
+    ENGRAM_EXPECT_NEAR(gainDb, 16.0, 0.5);
+
+    // Room noise under the gate neither moves the gain nor the level
+    Float32 level = chain.agc.levelMeanSquare;
+    PlayTone(&chain, AmplitudeForRmsDb(-60.0f), 5.0, &phase);
+    ENGRAM_EXPECT_EQ(chain.agc.gainDb, gainDb);
+    ENGRAM_EXPECT_EQ(chain.agc.levelMeanSquare, level);
+
+    // and the talker comes back at the level they left
+    AGCResult back = PlayTone(&chain, AmplitudeForRmsDb(-36.0f), 0.1, &phase);
+    ENGRAM_EXPECT_NEAR(back.rmsDb, kEngramAGCTargetDbfs, 0.5);
+}
+
+static void TestAGCHoldsPeaksUnderCeiling(void) {
+    EngramDSPChain chain;
+    EngramDSPChain_Init(&chain, 48000.0, kAGCChannels, kEngramDSPStageAGC);
+    Float64 phase = 0.0;
+    PlayTone(&chain, AmplitudeForRmsDb(-40.0f), 6.0, &phase);
+
+    // A shout at +20 dB gain: one block gets through before the gain
+    // computer sees it, and from the next on peaks sit under the ceiling
+    PlayTone(&chain, 0.5f, 2.0 * kEngramAGCBlockFrames / 48000.0, &phase);
+    AGCResult shout = PlayTone(&chain, 0.5f, 0.05, &phase);
+    ENGRAM_EXPECT(shout.peak <= kEngramAGCPeakCeiling * 1.001f);
+}
+
+static void TestSetStagesKeepsState(void) {
+    EngramDSPChain chain;
+    EngramDSPChain_Init(&chain, 48000.0, kAGCChannels, kEngramDSPStageDCBlock);
+    Float64 phase = 0.0;
+    PlayTone(&chain, 0.1f, 0.1, &phase);
+    EngramBiquadState dcState = chain.dcBlockState[0];
+
+    // The DC block carries on; the AGC starts from unity
+    chain.agc.gain = 2.0f;
+    EngramDSPChain_SetStages(&chain, kEngramDSPStageDCBlock | kEngramDSPStageAGC);
+    ENGRAM_EXPECT_EQ(chain.dcBlockState[0].z1, dcState.z1);
+    ENGRAM_EXPECT_EQ(chain.agc.gain, 1.0f);
+    ENGRAM_EXPECT(chain.kernel == EngramDSPKernel_Select(kAGCChannels, kEngramDSPStageDCBlock | kEngramDSPStageAGC));
+
+    EngramDSPChain_SetStages(&chain, kEngramDSPStageDCBlock);
+    ENGRAM_EXPECT_EQ(chain.enabledStages, (UInt32)kEngramDSPStageDCBlock);
+}
+
+int main(void) {
+    ENGRAM_RUN_TEST(TestDCBlockRemovesOffset);
+    ENGRAM_RUN_TEST(TestDisabledChainIsTransparent);
+    ENGRAM_RUN_TEST(TestSilenceFlushesState);
+    ENGRAM_RUN_TEST(TestDenormalGuardIsScoped);
+    ENGRAM_RUN_TEST(TestLowPassUnityAtDC);
+    ENGRAM_RUN_TEST(TestSpecializedKernelsMatchGeneric);
+    ENGRAM_RUN_TEST(TestAGCReachesTarget);
+    ENGRAM_RUN_TEST(TestAGCFreezesInSilence);
+    ENGRAM_RUN_TEST(TestAGCHoldsPeaksUnderCeiling);
+    ENGRAM_RUN_TEST(TestSetStagesKeepsState);
+    return ENGRAM_TEST_RESULT();
+}
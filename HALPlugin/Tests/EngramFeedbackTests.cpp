@@ -0,0 +1,299 @@
+//
+//  EngramFeedbackTests.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramFeedback.h"
+#include "EngramTestSupport.h"
+#include <math.h>
+#include <string.h>
+
+#define kSampleRate 48000.0
+#define kChannels 2
+#define kBlockFrames 512
+#define kBlockSamples (kBlockFrames * kChannels)
+// 0.5 dB louder every block: a loop with a little too much gain
+#define kGrowthPerBlock 1.0593f
+
+static EngramArena gArena;
+static EngramFeedbackDetector* gDetector;
+
+static void Setup(void) {
+    EngramArena_Release(&gArena);
+    EngramArena_Reserve(&gArena, EngramFeedback_RequiredBytes());
+    gDetector = EngramFeedback_Create(&gArena, kSampleRate, kChannels);
+}
+
+typedef struct {
+    Float64 hz;
+    Float64 phase;
+    Float32 amplitude;
+} Tone;
+
+// One block of the given tones on both channels, each growing by `growth`
+// and held below `ceiling`
+static void RenderBlock(Float32* samples, Tone* tones, UInt32 count, Float32 growth, Float32 ceiling) {
+    memset(samples, 0, sizeof(Float32) * kBlockSamples);
+    for (UInt32 t = 0; t < count; t++) {
+        Tone* tone = &tones[t];
+        Float64 step = 2.0 * M_PI * tone->hz / kSampleRate;
+        for (UInt32 frame = 0; frame < kBlockFrames; frame++) {
+            Float32 x = tone->amplitude * (Float32)sin(tone->phase);
+            samples[frame * kChannels] += x;
+            samples[frame * kChannels + 1] += x;
+            tone->phase += step;
+        }
+        tone->amplitude = fminf(tone->amplitude * growth, ceiling);
+    }
+}
+
+static Float32 Peak(const Float32* samples) {
+    Float32 peak = 0.0f;
+    for (UInt32 i = 0; i < kBlockSamples; i++) {
+        peak = fmaxf(peak, fabsf(samples[i]));
+    }
+    return peak;
+}
+
+static void TestFindPeak(void) {
+    Setup();
+    ENGRAM_EXPECT(gDetector != NULL);
+    static Float32 mono[kEngramFeedbackFFTSize];
+
+    // 3 kHz is bin 64 exactly
+    for (UInt32 i = 0; i < kEngramFeedbackFFTSize; i++) {
+        mono[i] = 0.5f * sinf(2.0f * (Float32)M_PI * 64.0f * (Float32)i / kEngramFeedbackFFTSize);
+    }
+    UInt32 bin = 0;
+    Float32 db = 0.0f;
+    ENGRAM_EXPECT(EngramFeedback_FindPeak(gDetector, mono, &bin, &db));
+    ENGRAM_EXPECT_EQ(bin, 64u);
+    ENGRAM_EXPECT_NEAR(db, 20.0 * log10(0.5), 0.1);
+
+    // Nothing below the floor, and nothing in silence
+    for (UInt32 i = 0; i < kEngramFeedbackFFTSize; i++) {
+        mono[i] *= 0.0001f;
+    }
+    ENGRAM_EXPECT(!EngramFeedback_FindPeak(gDetector, mono, &bin, &db));
+    memset(mono, 0, sizeof(mono));
+    ENGRAM_EXPECT(!EngramFeedback_FindPeak(gDetector, mono, &bin, &db));
+}
+
+static void TestGrowingToneIsNotched(void) {
+    Setup();
+    static Float32 block[kBlockSamples];
+    // Between bins, so the notch has to land on the interpolated frequency
+    Tone tone = { 2520.0, 0.0, 0.003f };
+
+    UInt32 blocks = 0;
+    while (gDetector->activeNotches.load() == 0 && blocks < 200) {
+        RenderBlock(block, &tone, 1, kGrowthPerBlock, 1.0f);
+        EngramFeedback_Process(gDetector, block, kBlockFrames);
+        blocks++;
+    }
+    ENGRAM_EXPECT_EQ(gDetector->activeNotches.load(), 1u);
+    ENGRAM_EXPECT_EQ(gDetector->events.load(), 1ull);
+    ENGRAM_EXPECT(!gDetector->gainCut.load());
+    ENGRAM_EXPECT_NEAR(gDetector->notchHz[0], 2520.0, 10.0);
+    // Found within ~200 ms of growing, from a level nobody would notice
+    ENGRAM_EXPECT(blocks * kBlockFrames <= 0.2 * kSampleRate);
+
+    // The howl, held where it got to, comes out 20 dB down or more
+    for (UInt32 i = 0; i < 8; i++) {
+        RenderBlock(block, &tone, 1, 1.0f, 1.0f);
+        Float32 in = Peak(block);
+        EngramFeedback_Process(gDetector, block, kBlockFrames);
+        if (i == 7) {
+            ENGRAM_EXPECT(Peak(block) < 0.1f * in);
+        }
+    }
+}
+
+static void TestSteadyProgramIsLeftAlone(void) {
+    Setup();
+    static Float32 block[kBlockSamples];
+    static Float32 copy[kBlockSamples];
+    // The simulator's -12 dBFS tone, with noise on top, for five seconds
+    Tone tone = { 1000.0, 0.0, 0.25f };
+    UInt32 seed = 1;
+    Boolean identical = true;
+    for (UInt32 b = 0; b < 5 * (UInt32)kSampleRate / kBlockFrames; b++) {
+        RenderBlock(block, &tone, 1, 1.0f, 1.0f);
+        for (UInt32 i = 0; i < kBlockSamples; i++) {
+            seed = seed * 1664525u + 1013904223u;
+            block[i] += 0.05f * ((Float32)(seed >> 8) / (Float32)(1u << 24) - 0.5f);
+        }
+        memcpy(copy, block, sizeof(block));
+        ENGRAM_EXPECT_EQ(EngramFeedback_Process(gDetector, block, kBlockFrames), 0u);
+        identical &= (memcmp(copy, block, sizeof(block)) == 0);
+    }
+    ENGRAM_EXPECT(identical);
+    ENGRAM_EXPECT_EQ(gDetector->events.load(), 0ull);
+}
+
+static void TestGainCutOnceNotchesRunOut(void) {
+    Setup();
+    static Float32 block[kBlockSamples];
+    Tone tones[kEngramFeedbackMaxNotches + 1];
+    for (UInt32 t = 0; t <= kEngramFeedbackMaxNotches; t++) {
+        tones[t] = (Tone){ 700.0 + 900.0 * t, 0.0, 0.003f };
+    }
+
+    // Howls start one after another, a quarter of a second apart
+    for (UInt32 b = 0; b < 200 && !gDetector->gainCut.load(); b++) {
+        UInt32 howling = 1 + b / 24;
+        howling = (howling < kEngramFeedbackMaxNotches + 1) ? howling : kEngramFeedbackMaxNotches + 1;
+        RenderBlock(block, tones, howling, kGrowthPerBlock, 0.15f);
+        EngramFeedback_Process(gDetector, block, kBlockFrames);
+    }
+    ENGRAM_EXPECT_EQ(gDetector->activeNotches.load(), (UInt32)kEngramFeedbackMaxNotches);
+    ENGRAM_EXPECT(gDetector->gainCut.load());
+    ENGRAM_EXPECT(gDetector->events.load() >= kEngramFeedbackMaxNotches + 1ull);
+
+    // The cut ramps in over a block at least as long as the ramp
+    ENGRAM_EXPECT_EQ(gDetector->gain, 1.0f);
+    RenderBlock(block, tones, kEngramFeedbackMaxNotches + 1, 1.0f, 0.15f);
+    EngramFeedback_Process(gDetector, block, kBlockFrames);
+    ENGRAM_EXPECT_EQ(gDetector->gain, kEngramFeedbackCutGain);
+
+    // Released once the howl has been gone a while; the notches are held longer
+    memset(block, 0, sizeof(block));
+    for (UInt32 b = 0; b < 3 * (UInt32)kSampleRate / kBlockFrames; b++) {
+        EngramFeedback_Process(gDetector, block, kBlockFrames);
+    }
+    ENGRAM_EXPECT(!gDetector->gainCut.load());
+    ENGRAM_EXPECT_EQ(gDetector->gain, 1.0f);
+    ENGRAM_EXPECT_EQ(gDetector->activeNotches.load(), (UInt32)kEngramFeedbackMaxNotches);
+
+    // and then let go of too, all of them freed for the next howl
+    UInt64 events = gDetector->events.load();
+    for (UInt32 b = 0; b < 9 * (UInt32)kSampleRate / kBlockFrames; b++) {
+        EngramFeedback_Process(gDetector, block, kBlockFrames);
+    }
+    ENGRAM_EXPECT_EQ(gDetector->activeNotches.load(), 0u);
+    ENGRAM_EXPECT_EQ(gDetector->notchCount, 0u);
+    ENGRAM_EXPECT_EQ(gDetector->events.load(), events);
+}
+
+// Blocks of `tone` until the detector holds a notch, or 200 have gone by
+static UInt32 GrowUntilNotched(Float32* block, Tone* tone) {
+    UInt32 blocks = 0;
+    while (gDetector->activeNotches.load() == 0 && blocks < 200) {
+        RenderBlock(block, tone, 1, kGrowthPerBlock, 1.0f);
+        EngramFeedback_Process(gDetector, block, kBlockFrames);
+        blocks++;
+    }
+    return blocks;
+}
+
+static void TestNotchHeldWhileHowlRings(void) {
+    Setup();
+    static Float32 block[kBlockSamples];
+    Tone tone = { 2520.0, 0.0, 0.003f };
+    GrowUntilNotched(block, &tone);
+    ENGRAM_EXPECT_EQ(gDetector->activeNotches.load(), 1u);
+
+    // A loop driven harder than the notch can take all of still rings through
+    // it, which keeps it in well past the release time
+    UInt32 releaseBlocks = kEngramFeedbackNotchReleaseFrames * kEngramFeedbackFFTSize / kBlockFrames;
+    tone.amplitude = 0.5f;
+    for (UInt32 b = 0; b < 2 * releaseBlocks; b++) {
+        RenderBlock(block, &tone, 1, 1.0f, 1.0f);
+        EngramFeedback_Process(gDetector, block, kBlockFrames);
+    }
+    ENGRAM_EXPECT_EQ(gDetector->activeNotches.load(), 1u);
+    ENGRAM_EXPECT_EQ(gDetector->events.load(), 1ull);
+    ENGRAM_EXPECT(!gDetector->gainCut.load());
+
+    // Once the loop is broken it goes after the release time, not before
+    memset(block, 0, sizeof(block));
+    UInt32 quietBlocks = 0;
+    while (gDetector->activeNotches.load() != 0 && quietBlocks < 2 * releaseBlocks) {
+        EngramFeedback_Process(gDetector, block, kBlockFrames);
+        quietBlocks++;
+    }
+    ENGRAM_EXPECT_EQ(gDetector->activeNotches.load(), 0u);
+    ENGRAM_EXPECT(quietBlocks >= releaseBlocks);
+    ENGRAM_EXPECT(quietBlocks <= releaseBlocks + 2 * kEngramFeedbackFFTSize / kBlockFrames);
+
+    // A howl coming back is caught again from scratch
+    tone.amplitude = 0.003f;
+    GrowUntilNotched(block, &tone);
+    ENGRAM_EXPECT_EQ(gDetector->activeNotches.load(), 1u);
+    ENGRAM_EXPECT_EQ(gDetector->events.load(), 2ull);
+
+    EngramFeedback_Reset(gDetector);
+    ENGRAM_EXPECT_EQ(gDetector->activeNotches.load(), 0u);
+    ENGRAM_EXPECT_EQ(gDetector->notchCount, 0u);
+}
+
+// A talker at -30 dBFS RMS with a howl growing under them, through the
+// detector and then an AGC, coupled the way the IO path couples them when
+// `coupled`. Returns the highest AGC gain, in dB, while anything was suppressed.
+static Float32 HowlIntoAGC(Boolean coupled) {
+    Setup();
+    static EngramDSPChain chain;
+    EngramDSPChain_Init(&chain, kSampleRate, kChannels, kEngramDSPStageAGC);
+    static Float32 block[kBlockSamples];
+    static Float32 speech[kBlockSamples];
+    Tone howl = { 2520.0, 0.0, 0.003f };
+    Tone talker = { 440.0, 0.0, 0.0447f };
+    Float32 maxGainDb = -200.0f;
+    for (UInt32 b = 0; b < 3 * (UInt32)kSampleRate / kBlockFrames; b++) {
+        RenderBlock(block, &howl, 1, kGrowthPerBlock, 0.5f);
+        RenderBlock(speech, &talker, 1, 1.0f, 1.0f);
+        for (UInt32 i = 0; i < kBlockSamples; i++) {
+            block[i] += speech[i];
+        }
+        EngramFeedback_Process(gDetector, block, kBlockFrames);
+        Boolean suppressing = EngramFeedback_IsSuppressing(gDetector);
+        if (coupled) {
+            EngramDSPChain_SetAGCDecision(&chain, suppressing ? kEngramAGCDecisionHold : kEngramAGCDecisionGate);
+        }
+        EngramDSPChain_Process(&chain, block, kBlockFrames);
+        if (suppressing) {
+            maxGainDb = fmaxf(maxGainDb, chain.agc.gainDb);
+        }
+    }
+    ENGRAM_EXPECT_EQ(gDetector->activeNotches.load(), 1u);
+    return maxGainDb;
+}
+
+static void TestAGCHeldWhileSuppressing(void) {
+    // Left to its gate, the AGC turns the talker up, and the loop with them
+    ENGRAM_EXPECT(HowlIntoAGC(false) > 6.0f);
+    // Told about the notch, it stays at unity or below for as long as it is in
+    ENGRAM_EXPECT(HowlIntoAGC(true) <= 0.0f);
+}
+
+static void TestDisabledPassesThrough(void) {
+    Setup();
+    gDetector->enabled.store(false);
+    static Float32 block[kBlockSamples];
+    static Float32 copy[kBlockSamples];
+    Tone tone = { 2520.0, 0.0, 0.003f };
+    Boolean identical = true;
+    for (UInt32 b = 0; b < 200; b++) {
+        RenderBlock(block, &tone, 1, kGrowthPerBlock, 1.0f);
+        memcpy(copy, block, sizeof(block));
+        EngramFeedback_Process(gDetector, block, kBlockFrames);
+        identical &= (memcmp(copy, block, sizeof(block)) == 0);
+    }
+    ENGRAM_EXPECT(identical);
+    ENGRAM_EXPECT_EQ(gDetector->events.load(), 0ull);
+}
+
+int main(void) {
+    ENGRAM_RUN_TEST(TestFindPeak);
+    ENGRAM_RUN_TEST(TestGrowingToneIsNotched);
+    ENGRAM_RUN_TEST(TestSteadyProgramIsLeftAlone);
+    ENGRAM_RUN_TEST(TestGainCutOnceNotchesRunOut);
+    ENGRAM_RUN_TEST(TestNotchHeldWhileHowlRings);
+    ENGRAM_RUN_TEST(TestAGCHeldWhileSuppressing);
+    ENGRAM_RUN_TEST(TestDisabledPassesThrough);
+    EngramArena_Release(&gArena);
+    return ENGRAM_TEST_RESULT();
+}
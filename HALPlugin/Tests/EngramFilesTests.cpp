@@ -0,0 +1,90 @@
+//
+//  EngramFilesTests.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramFiles.h"
+#include "EngramTestSupport.h"
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static char gRoot[kEngramMaxPathLength];
+
+static void TestDiagnosticsDirectoryIsConfigurable(void) {
+    char path[kEngramMaxPathLength];
+    setenv(kEngramDiagnosticsDirectoryEnvironment, gRoot, 1);
+    ENGRAM_EXPECT(EngramFiles_DiagnosticsDirectory(path, sizeof(path)));
+    ENGRAM_EXPECT(strcmp(path, gRoot) == 0);
+
+    // Unset, it is per user, so nobody else's directory is ever picked up
+    unsetenv(kEngramDiagnosticsDirectoryEnvironment);
+    ENGRAM_EXPECT(EngramFiles_DiagnosticsDirectory(path, sizeof(path)));
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), "/%s.%u", kEngramDiagnosticsDirectoryPrefix, (unsigned)geteuid());
+    ENGRAM_EXPECT(strlen(path) > strlen(suffix) && strcmp(path + strlen(path) - strlen(suffix), suffix) == 0);
+
+    ENGRAM_EXPECT(!EngramFiles_Join(path, 8, gRoot, "name"));
+}
+
+static void TestPrivateDirectory(void) {
+    char path[kEngramMaxPathLength];
+    EngramFiles_Join(path, sizeof(path), gRoot, "private");
+    ENGRAM_EXPECT(EngramFiles_MakePrivateDirectory(path));
+    struct stat info;
+    ENGRAM_EXPECT(lstat(path, &info) == 0 && (info.st_mode & 0777) == 0700);
+    // Already there and still private: fine
+    ENGRAM_EXPECT(EngramFiles_MakePrivateDirectory(path));
+
+    // Someone else could have put files in it, so it is refused and left as is
+    char open[kEngramMaxPathLength];
+    EngramFiles_Join(open, sizeof(open), gRoot, "open");
+    mkdir(open, 0700);
+    chmod(open, 0777);
+    ENGRAM_EXPECT(!EngramFiles_MakePrivateDirectory(open));
+    ENGRAM_EXPECT(lstat(open, &info) == 0 && (info.st_mode & 0777) == 0777);
+
+    // A symlink to a private directory is still a symlink
+    char link[kEngramMaxPathLength];
+    EngramFiles_Join(link, sizeof(link), gRoot, "link");
+    ENGRAM_EXPECT(symlink(path, link) == 0);
+    ENGRAM_EXPECT(!EngramFiles_MakePrivateDirectory(link));
+}
+
+static void TestCreatePrivateNeverReuses(void) {
+    char path[kEngramMaxPathLength];
+    EngramFiles_Join(path, sizeof(path), gRoot, "snapshot.bin");
+    FILE* file = EngramFiles_CreatePrivate(path);
+    ENGRAM_EXPECT(file != NULL);
+    if (file != NULL) {
+        fputs("first", file);
+        fclose(file);
+    }
+    struct stat info;
+    ENGRAM_EXPECT(stat(path, &info) == 0 && (info.st_mode & 0777) == 0600 && info.st_size == 5);
+
+    // An existing file is not truncated or written through
+    ENGRAM_EXPECT(EngramFiles_CreatePrivate(path) == NULL);
+    ENGRAM_EXPECT(stat(path, &info) == 0 && info.st_size == 5);
+
+    // Nor is a planted symlink followed, dangling or not
+    char target[kEngramMaxPathLength];
+    char link[kEngramMaxPathLength];
+    EngramFiles_Join(target, sizeof(target), gRoot, "target");
+    EngramFiles_Join(link, sizeof(link), gRoot, "planted");
+    ENGRAM_EXPECT(symlink(target, link) == 0);
+    ENGRAM_EXPECT(EngramFiles_CreatePrivate(link) == NULL);
+    ENGRAM_EXPECT(access(target, F_OK) != 0);
+}
+
+int main(void) {
+    ENGRAM_EXPECT(EngramTest_MakeTempDirectory(gRoot, sizeof(gRoot)) != NULL);
+    ENGRAM_RUN_TEST(TestDiagnosticsDirectoryIsConfigurable);
+    ENGRAM_RUN_TEST(TestPrivateDirectory);
+    ENGRAM_RUN_TEST(TestCreatePrivateNeverReuses);
+    EngramTest_RemoveDirectory(gRoot);
+    return ENGRAM_TEST_RESULT();
+}
@@ -0,0 +1,126 @@
+//
+//  EngramGateTests.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramGate.h"
+#include "EngramTestSupport.h"
+#include "EngramWait.h"
+#include <thread>
+#include <unistd.h>
+
+#define kMillis 1000000ull
+
+static void TestClientsAndActivations(void) {
+    EngramGate gate;
+    EngramGate_Init(&gate);
+    ENGRAM_EXPECT(!EngramGate_IsRunning(gate.clients.load()));
+    ENGRAM_EXPECT(!EngramGate_WaitForIO(&gate.clients, 1 * kMillis));
+
+    // Only the first of overlapping clients is a new activation
+    EngramGate_Started(&gate);
+    EngramGate_Started(&gate);
+    ENGRAM_EXPECT(EngramGate_IsRunning(gate.clients.load()));
+    ENGRAM_EXPECT(EngramGate_WaitForIO(&gate.clients, 0));
+    EngramGate_Stopped(&gate);
+    ENGRAM_EXPECT(EngramGate_IsRunning(gate.clients.load()));
+    EngramGate_Stopped(&gate);
+    ENGRAM_EXPECT(!EngramGate_IsRunning(gate.clients.load()));
+    EngramGate_Started(&gate);
+    EngramGate_Stopped(&gate);
+    ENGRAM_EXPECT_EQ(gate.clients.load(), 0u);
+    ENGRAM_EXPECT_EQ(gate.activations.load(), 2u);
+
+    // A closed gate never reads as running, even with clients left over
+    EngramGate_Started(&gate);
+    EngramGate_Close(&gate);
+    ENGRAM_EXPECT(!EngramGate_IsRunning(gate.clients.load()));
+    ENGRAM_EXPECT(!EngramGate_WaitForIO(&gate.clients, 0));
+}
+
+static void TestWaitersWakeOnStartAndClose(void) {
+    EngramGate gate;
+    EngramGate_Init(&gate);
+    std::atomic<UInt32> results(0);
+
+    auto wait = [&gate, &results](UInt32 bit) {
+        if (EngramGate_WaitForIO(&gate.clients, 0)) {
+            results.fetch_or(bit);
+        }
+    };
+    std::thread started(wait, 1u);
+    usleep(5000);
+    ENGRAM_EXPECT_EQ(results.load(), 0u);
+    EngramGate_Started(&gate);
+    started.join();
+    ENGRAM_EXPECT_EQ(results.load(), 1u);
+
+    // Teardown sends a waiter home empty-handed
+    EngramGate_Stopped(&gate);
+    std::thread closed(wait, 2u);
+    usleep(5000);
+    UInt64 start = EngramWait_Now();
+    EngramGate_Close(&gate);
+    closed.join();
+    ENGRAM_EXPECT_EQ(results.load(), 1u);
+    ENGRAM_EXPECT(EngramWait_Now() - start < 1000 * kMillis);
+}
+
+static void TestLowWaterSignalsOncePerArm(void) {
+    std::atomic<UInt32> sequenceMirror(0);
+    std::atomic<UInt32> framesMirror(0);
+    EngramLowWater lowWater;
+    EngramLowWater_Init(&lowWater, &sequenceMirror, &framesMirror);
+
+    // Nobody armed: nothing to do however low the ring runs
+    ENGRAM_EXPECT(!EngramLowWater_Check(&lowWater, 0));
+
+    UInt32 sequence = EngramLowWater_Arm(&lowWater, kEngramLowWaterArmedShared, 512);
+    ENGRAM_EXPECT_EQ(framesMirror.load(), 512u);
+    ENGRAM_EXPECT(!EngramLowWater_Check(&lowWater, 512));
+    ENGRAM_EXPECT(EngramLowWater_Check(&lowWater, 511));
+    ENGRAM_EXPECT(sequenceMirror.load() != sequence);
+    ENGRAM_EXPECT_EQ(sequenceMirror.load(), lowWater.sequence.load());
+
+    // The signal claimed the arm, so later low reads make no more wakes
+    ENGRAM_EXPECT(!EngramLowWater_Check(&lowWater, 0));
+
+    // Release disarms and still moves the sequence on
+    sequence = EngramLowWater_Arm(&lowWater, kEngramLowWaterArmedLocal, 512);
+    EngramLowWater_Release(&lowWater);
+    ENGRAM_EXPECT(lowWater.sequence.load() != sequence);
+    ENGRAM_EXPECT(!EngramLowWater_Check(&lowWater, 0));
+}
+
+static void TestLowWaterWakesSleeperOnTheMirror(void) {
+    std::atomic<UInt32> sequenceMirror(0);
+    std::atomic<UInt32> framesMirror(0);
+    EngramLowWater lowWater;
+    EngramLowWater_Init(&lowWater, &sequenceMirror, &framesMirror);
+
+    std::atomic<Boolean> woke(false);
+    UInt32 sequence = EngramLowWater_Arm(&lowWater, kEngramLowWaterArmedShared, 512);
+    std::thread producer([&sequenceMirror, &woke, sequence]() {
+        UInt64 deadline = EngramWait_Now() + 1000 * kMillis;
+        while (sequenceMirror.load() == sequence && EngramWait_Now() < deadline) {
+            EngramWait_WhileEqual(&sequenceMirror, sequence, 100 * kMillis);
+        }
+        woke.store(sequenceMirror.load() != sequence);
+    });
+    usleep(5000);
+    ENGRAM_EXPECT(!woke.load());
+    ENGRAM_EXPECT(EngramLowWater_Check(&lowWater, 256));
+    producer.join();
+    ENGRAM_EXPECT(woke.load());
+}
+
+int main(void) {
+    ENGRAM_RUN_TEST(TestClientsAndActivations);
+    ENGRAM_RUN_TEST(TestWaitersWakeOnStartAndClose);
+    ENGRAM_RUN_TEST(TestLowWaterSignalsOncePerArm);
+    ENGRAM_RUN_TEST(TestLowWaterWakesSleeperOnTheMirror);
+    return ENGRAM_TEST_RESULT();
+}
@@ -0,0 +1,174 @@
+//
+//  EngramGlitchTests.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramGlitch.h"
+#include "EngramFiles.h"
+#include "EngramTestSupport.h"
+#include <dirent.h>
+#include <math.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define kTestFrames 256
+
+static EngramGlitchCycle MakeCycle(UInt64 index, UInt32 missingFrames) {
+    EngramGlitchCycle cycle = {};
+    cycle.cycle = index;
+    cycle.sampleTime = (Float64)(index * kTestFrames);
+    cycle.frames = kTestFrames;
+    cycle.missingFrames = missingFrames;
+    return cycle;
+}
+
+static void FillSine(Float32* samples, UInt64 startFrame) {
+    for (UInt32 frame = 0; frame < kTestFrames; frame++) {
+        Float32 value = 0.25f * sinf(2.0f * 3.14159265f * 440.0f * (Float32)(startFrame + frame) / 48000.0f);
+        samples[frame * 2] = value;
+        samples[frame * 2 + 1] = value;
+    }
+}
+
+static void TestCleanSignalPasses(void) {
+    EngramArena arena;
+    EngramArena_Reserve(&arena, EngramGlitch_RequiredBytes(2));
+    EngramGlitchDetector* detector = EngramGlitch_Create(&arena, 48000.0, 2);
+    ENGRAM_EXPECT(detector != NULL);
+
+    Float32 samples[kTestFrames * 2];
+    UInt32 kinds = 0;
+    for (UInt64 i = 0; i < 64; i++) {
+        FillSine(samples, i * kTestFrames);
+        EngramGlitchCycle cycle = MakeCycle(i, 0);
+        kinds |= EngramGlitch_Observe(detector, &cycle, samples);
+    }
+    ENGRAM_EXPECT_EQ(kinds, 0u);
+    EngramArena_Release(&arena);
+}
+
+static void TestDetectsEachKind(void) {
+    EngramArena arena;
+    EngramArena_Reserve(&arena, EngramGlitch_RequiredBytes(2));
+    EngramGlitchDetector* detector = EngramGlitch_Create(&arena, 48000.0, 2);
+
+    Float32 samples[kTestFrames * 2];
+    for (UInt64 i = 0; i < 16; i++) {
+        FillSine(samples, i * kTestFrames);
+        EngramGlitchCycle cycle = MakeCycle(i, 0);
+        EngramGlitch_Observe(detector, &cycle, samples);
+    }
+
+    FillSine(samples, 16 * kTestFrames);
+    EngramGlitchCycle underrun = MakeCycle(16, 10);
+    ENGRAM_EXPECT(EngramGlitch_Observe(detector, &underrun, samples) & kEngramGlitchUnderrun);
+
+    FillSine(samples, 18 * kTestFrames);
+    EngramGlitchCycle skipped = MakeCycle(18, 0);
+    ENGRAM_EXPECT(EngramGlitch_Observe(detector, &skipped, samples) & kEngramGlitchDiscontinuity);
+
+    FillSine(samples, 19 * kTestFrames);
+    samples[100 * 2] = 1.0f;
+    samples[100 * 2 + 1] = 1.0f;
+    EngramGlitchCycle click = MakeCycle(19, 0);
+    ENGRAM_EXPECT_EQ(EngramGlitch_Observe(detector, &click, samples), (UInt32)kEngramGlitchClick);
+
+    // Each glitch captured a snapshot
+    UInt32 ready = 0;
+    for (UInt32 slot = 0; slot < kEngramGlitchSlotCount; slot++) {
+        ready += (detector->slots[slot].state.load() == kEngramGlitchSlotReady);
+    }
+    ENGRAM_EXPECT_EQ(ready, 3u);
+
+    EngramGlitch_Reset(detector);
+    FillSine(samples, 40 * kTestFrames);
+    EngramGlitchCycle restarted = MakeCycle(40, 0);
+    ENGRAM_EXPECT_EQ(EngramGlitch_Observe(detector, &restarted, samples), 0u);
+
+    EngramArena_Release(&arena);
+}
+
+// Files directly in `directory`, each checked to be a private regular file
+static UInt32 CountPrivateFiles(const char* directory) {
+    UInt32 count = 0;
+    DIR* listing = opendir(directory);
+    if (listing == NULL) {
+        return 0;
+    }
+    while (struct dirent* entry = readdir(listing)) {
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        char path[kEngramMaxPathLength];
+        EngramFiles_Join(path, sizeof(path), directory, entry->d_name);
+        struct stat info;
+        ENGRAM_EXPECT(lstat(path, &info) == 0 && S_ISREG(info.st_mode) && (info.st_mode & 0777) == 0600);
+        count++;
+    }
+    closedir(listing);
+    return count;
+}
+
+// Restarts the detector, as StartIO does, and makes it capture one underrun
+// snapshot; sequence numbers carry on across the restart
+static void CaptureUnderrun(EngramGlitchDetector* detector, UInt64 firstCycle) {
+    EngramGlitch_Reset(detector);
+    Float32 samples[kTestFrames * 2];
+    for (UInt64 i = firstCycle; i < firstCycle + 16; i++) {
+        FillSine(samples, i * kTestFrames);
+        EngramGlitchCycle cycle = MakeCycle(i, (i == firstCycle + 15) ? 10 : 0);
+        EngramGlitch_Observe(detector, &cycle, samples);
+    }
+}
+
+static void TestSnapshotsArePrivate(void) {
+    EngramArena arena;
+    EngramArena_Reserve(&arena, EngramGlitch_RequiredBytes(2));
+    EngramGlitchDetector* detector = EngramGlitch_Create(&arena, 48000.0, 2);
+
+    char root[kEngramMaxPathLength];
+    char directory[kEngramMaxPathLength];
+    ENGRAM_EXPECT(EngramTest_MakeTempDirectory(root, sizeof(root)) != NULL);
+    EngramFiles_Join(directory, sizeof(directory), root, "snapshots");
+
+    // The directory is made on first use, closed to everyone else
+    CaptureUnderrun(detector, 0);
+    ENGRAM_EXPECT_EQ(EngramGlitch_PersistPending(detector, directory, "session", 1.0), 1u);
+    struct stat info;
+    ENGRAM_EXPECT(lstat(directory, &info) == 0 && (info.st_mode & 0777) == 0700);
+    ENGRAM_EXPECT_EQ(CountPrivateFiles(directory), 2u);
+
+    // A symlink planted under the next snapshot's name is not written through
+    char planted[kEngramMaxPathLength];
+    char target[kEngramMaxPathLength];
+    EngramFiles_Join(planted, sizeof(planted), directory, "glitch-session-000002.wav");
+    EngramFiles_Join(target, sizeof(target), root, "target");
+    ENGRAM_EXPECT(symlink(target, planted) == 0);
+    CaptureUnderrun(detector, 100);
+    ENGRAM_EXPECT_EQ(EngramGlitch_PersistPending(detector, directory, "session", 1.0), 0u);
+    ENGRAM_EXPECT(access(target, F_OK) != 0);
+    unlink(planted);
+
+    // Nor into a directory others could have put things in; the slot is freed either way
+    chmod(directory, 0777);
+    CaptureUnderrun(detector, 200);
+    ENGRAM_EXPECT_EQ(EngramGlitch_PersistPending(detector, directory, "session", 1.0), 0u);
+    chmod(directory, 0700);
+    ENGRAM_EXPECT_EQ(CountPrivateFiles(directory), 3u);   // the .json sidecar of the planted snapshot
+    for (UInt32 slot = 0; slot < kEngramGlitchSlotCount; slot++) {
+        ENGRAM_EXPECT_EQ(detector->slots[slot].state.load(), (UInt32)kEngramGlitchSlotFree);
+    }
+
+    EngramTest_RemoveDirectory(root);
+    EngramArena_Release(&arena);
+}
+
+int main(void) {
+    ENGRAM_RUN_TEST(TestCleanSignalPasses);
+    ENGRAM_RUN_TEST(TestDetectsEachKind);
+    ENGRAM_RUN_TEST(TestSnapshotsArePrivate);
+    return ENGRAM_TEST_RESULT();
+}
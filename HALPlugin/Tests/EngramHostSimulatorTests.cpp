@@ -0,0 +1,161 @@
+//
+//  EngramHostSimulatorTests.cpp
+//  Engram Virtual Audio Device
+//
+//  End-to-end sessions through the host simulator on a virtual clock.
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "Simulator/EngramHostSimulator.h"
+#include "EngramFiles.h"
+#include "EngramTestSupport.h"
+#include <stdlib.h>
+#include <time.h>
+
+#define kNanosPerSecond 1000000000ull
+
+static EngramSimulator* gSim = NULL;
+
+static Float64 WallSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (Float64)ts.tv_sec + (Float64)ts.tv_nsec * 1.0e-9;
+}
+
+static void ExpectCleanSession(const EngramSimReport* report) {
+    ENGRAM_EXPECT_EQ(report->failedCalls, 0u);
+    ENGRAM_EXPECT_EQ(report->underrunCycles, 0u);
+    ENGRAM_EXPECT_EQ(report->overrunSamples, 0u);
+    ENGRAM_EXPECT_EQ(report->glitches, 0u);
+    ENGRAM_EXPECT_EQ(report->mismatchedSamples, 0u);
+    ENGRAM_EXPECT_EQ(report->timestampErrors, 0u);
+    ENGRAM_EXPECT_EQ(report->lateZeroTimeStamps, 0u);
+}
+
+static void TestTenMinuteSessionIsClean(void) {
+    EngramSimConfig config;
+    EngramSim_DefaultConfig(&config);
+
+    Float64 wallStart = WallSeconds();
+    ENGRAM_EXPECT(EngramSim_Start(gSim, &config));
+    EngramSim_RunFor(gSim, 600 * kNanosPerSecond);
+    EngramSimReport report;
+    EngramSim_Stop(gSim, &report);
+    Float64 wall = WallSeconds() - wallStart;
+
+    ExpectCleanSession(&report);
+    ENGRAM_EXPECT_EQ(report.cycles, 600u * 48000u / 512u);
+    ENGRAM_EXPECT_NEAR((Float64)report.simulatedNanos / kNanosPerSecond, 600.0, 0.02);
+    ENGRAM_EXPECT(report.producerWrites >= 600u * 100u);
+    // Starting and stopping IO announce the running state, at most once each
+    ENGRAM_EXPECT(report.propertyNotifications >= 1);
+    ENGRAM_EXPECT(report.propertyNotifications <= 2);
+    // Virtual time: the session must not be paced by the wall clock
+    ENGRAM_EXPECT(wall < 60.0);
+    printf("  600 s simulated in %.2f s wall\n", wall);
+}
+
+static void TestBufferSizes(void) {
+    static const UInt32 kBufferSizes[] = { 32, 64, 256, 1024, 4096 };
+    for (UInt32 i = 0; i < sizeof(kBufferSizes) / sizeof(kBufferSizes[0]); i++) {
+        EngramSimConfig config;
+        EngramSim_DefaultConfig(&config);
+        config.bufferFrames = kBufferSizes[i];
+        config.producerLeadFrames = kBufferSizes[i] + 2048;
+
+        ENGRAM_EXPECT(EngramSim_Start(gSim, &config));
+        EngramSim_RunFor(gSim, 30 * kNanosPerSecond);
+        EngramSimReport report;
+        EngramSim_Stop(gSim, &report);
+
+        ExpectCleanSession(&report);
+        ENGRAM_EXPECT_EQ(report.cycles, 30u * 48000u / kBufferSizes[i]);
+    }
+}
+
+static void TestStarvedProducerUnderrunsAreReportedAndZeroFilled(void) {
+    EngramSimConfig config;
+    EngramSim_DefaultConfig(&config);
+    // Not enough lead to cover the producer's block size plus its jitter
+    config.producerLeadFrames = 256;
+
+    ENGRAM_EXPECT(EngramSim_Start(gSim, &config));
+    EngramSim_RunFor(gSim, 10 * kNanosPerSecond);
+    EngramSimReport report;
+    EngramSim_Stop(gSim, &report);
+
+    ENGRAM_EXPECT_EQ(report.failedCalls, 0u);
+    ENGRAM_EXPECT(report.underrunCycles > 0);
+    ENGRAM_EXPECT(report.glitches >= report.underrunCycles);
+    // Short reads are padded with silence and the stream resumes in order
+    ENGRAM_EXPECT_EQ(report.mismatchedSamples, 0u);
+    ENGRAM_EXPECT_EQ(report.timestampErrors, 0u);
+}
+
+static void TestRunsAreReproducible(void) {
+    EngramSimConfig config;
+    EngramSim_DefaultConfig(&config);
+    config.producerLeadFrames = 600;
+    config.producerJitterNanos = 5000000;
+
+    EngramSimReport first;
+    EngramSimReport second;
+    EngramSim_Start(gSim, &config);
+    EngramSim_RunFor(gSim, 20 * kNanosPerSecond);
+    EngramSim_Stop(gSim, &first);
+    EngramSim_Start(gSim, &config);
+    EngramSim_RunFor(gSim, 20 * kNanosPerSecond);
+    EngramSim_Stop(gSim, &second);
+
+    ENGRAM_EXPECT_EQ(first.underrunSamples, second.underrunSamples);
+    ENGRAM_EXPECT_EQ(first.producerWrites, second.producerWrites);
+    ENGRAM_EXPECT_EQ(first.mismatchedSamples, 0u);
+}
+
+static void TestLatencyProbesArriveWithinTheLead(void) {
+    EngramSimConfig config;
+    EngramSim_DefaultConfig(&config);
+
+    ENGRAM_EXPECT(EngramSim_Start(gSim, &config));
+    EngramSim_RunFor(gSim, 1 * kNanosPerSecond);
+    ENGRAM_EXPECT(EngramSim_StartLatencyProbes(gSim, kEngramLatencyProbeMLS, kEngramLatencyDefaultIntervalFrames));
+    EngramSim_RunFor(gSim, 30 * kNanosPerSecond);
+    EngramSim_StopLatencyProbes(gSim);
+    EngramSimReport report;
+    EngramSim_Stop(gSim, &report);
+
+    ENGRAM_EXPECT_EQ(report.failedCalls, 0u);
+    ENGRAM_EXPECT_EQ(report.underrunCycles, 0u);
+    // Every probe is found once, and nothing else is taken for one
+    ENGRAM_EXPECT(report.latencyProbes >= 30u * 48000u / kEngramLatencyDefaultIntervalFrames - 1);
+    ENGRAM_EXPECT_EQ(report.latencyArrivals, report.latencyProbes);
+    ENGRAM_EXPECT_EQ(report.latencyMatched, report.latencyProbes);
+
+    // A probe waits out the producer's lead less the rest of its block, and
+    // leaves with the cycle that reads it: up to a buffer later, plus jitter
+    Float64 nanosPerFrame = 1.0e9 / 48000.0;
+    Float64 lowest = (config.producerLeadFrames - config.producerFrames) * nanosPerFrame - (Float64)config.producerJitterNanos;
+    Float64 highest = (config.producerLeadFrames + config.bufferFrames) * nanosPerFrame + (Float64)config.ioJitterNanos;
+    ENGRAM_EXPECT((Float64)report.latencyMinNs >= lowest);
+    ENGRAM_EXPECT((Float64)report.latencyMaxNs <= highest);
+    printf("  %llu probes, latency %.2f..%.2f ms\n", (unsigned long long)report.latencyMatched,
+           report.latencyMinNs / 1.0e6, report.latencyMaxNs / 1.0e6);
+}
+
+int main(void) {
+    // Glitch snapshots go to a directory this run removes again
+    char diagnostics[kEngramMaxPathLength];
+    ENGRAM_EXPECT(EngramTest_MakeTempDirectory(diagnostics, sizeof(diagnostics)) != NULL);
+    setenv(kEngramDiagnosticsDirectoryEnvironment, diagnostics, 1);
+
+    gSim = (EngramSimulator*)calloc(1, sizeof(EngramSimulator));
+    ENGRAM_RUN_TEST(TestTenMinuteSessionIsClean);
+    ENGRAM_RUN_TEST(TestBufferSizes);
+    ENGRAM_RUN_TEST(TestStarvedProducerUnderrunsAreReportedAndZeroFilled);
+    ENGRAM_RUN_TEST(TestRunsAreReproducible);
+    ENGRAM_RUN_TEST(TestLatencyProbesArriveWithinTheLead);
+    free(gSim);
+    EngramTest_RemoveDirectory(diagnostics);
+    return ENGRAM_TEST_RESULT();
+}
@@ -0,0 +1,138 @@
+//
+//  EngramLatencyTests.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramLatency.h"
+#include "EngramFiles.h"
+#include "EngramTestSupport.h"
+#include <sys/stat.h>
+#include <unistd.h>
+
+static void TestMLSIsBalancedWithFlatAutocorrelation(void) {
+    static Float32 sequence[kEngramLatencyMaxMLSLength];
+    for (UInt32 order = 2; order <= 12; order++) {
+        UInt32 length = EngramLatency_MakeMLS(sequence, order);
+        ENGRAM_EXPECT_EQ(length, (1u << order) - 1);
+
+        Float64 sum = 0.0;
+        for (UInt32 i = 0; i < length; i++) {
+            sum += sequence[i];
+        }
+        ENGRAM_EXPECT_EQ(sum, 1.0);
+
+        // Circular autocorrelation of an m-sequence is -1 at every nonzero lag
+        for (UInt32 lag = 1; lag < length && lag < 64; lag++) {
+            Float64 correlation = 0.0;
+            for (UInt32 i = 0; i < length; i++) {
+                correlation += sequence[i] * sequence[(i + lag) % length];
+            }
+            ENGRAM_EXPECT_EQ(correlation, -1.0);
+        }
+    }
+    ENGRAM_EXPECT_EQ(EngramLatency_MakeMLS(sequence, 13), 0u);
+}
+
+static void TestLogDropsWhenFull(void) {
+    static EngramLatencyLog log;
+    EngramLatencyLog_Init(&log);
+
+    EngramLatencyRecord record = { 0, 0, 0.0 };
+    for (UInt32 i = 0; i < kEngramLatencyRecordCapacity + 3; i++) {
+        record.sequence = i;
+        EngramLatencyLog_Push(&log, &record);
+    }
+    ENGRAM_EXPECT_EQ(log.dropped.load(), 3u);
+
+    EngramLatencyRecord out[kEngramLatencyRecordCapacity];
+    ENGRAM_EXPECT_EQ(EngramLatencyLog_Pop(&log, out, kEngramLatencyRecordCapacity), (UInt32)kEngramLatencyRecordCapacity);
+    ENGRAM_EXPECT_EQ(out[5].sequence, 5u);
+}
+
+static void TestGeneratorProbesAreDetectedAtTheirOffset(void) {
+    static EngramLatencyGenerator generator;
+    static EngramLatencyLog probes;
+    EngramLatencyLog_Init(&probes);
+    EngramLatencyGenerator_Init(&generator, kEngramLatencyProbeMLS, 2, 4800);
+
+    EngramLatencyDetector detector;
+    EngramLatencyDetector_Init(&detector, 2, 2400);
+
+    static Float32 block[2 * 480];
+    UInt32 onsets = 0;
+    for (UInt32 i = 0; i < 100; i++) {
+        EngramLatencyGenerator_Render(&generator, block, 480, i, &probes);
+        SInt32 onset = EngramLatencyDetector_Scan(&detector, block, 480);
+        if (onset >= 0) {
+            // Probes start every 4800 frames: the 10th block of every 10
+            ENGRAM_EXPECT_EQ(onset, 0);
+            ENGRAM_EXPECT_EQ(i % 10, 0u);
+            onsets++;
+        }
+    }
+
+    EngramLatencyRecord records[16];
+    UInt32 count = EngramLatencyLog_Pop(&probes, records, 16);
+    ENGRAM_EXPECT_EQ(onsets, 9u);
+    ENGRAM_EXPECT_EQ(count, 9u);
+    ENGRAM_EXPECT_EQ(records[0].sampleTime, 4800.0);
+}
+
+static UInt32 CountLines(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        return 0;
+    }
+    UInt32 lines = 0;
+    for (int c; (c = fgetc(file)) != EOF;) {
+        lines += (c == '\n');
+    }
+    fclose(file);
+    return lines;
+}
+
+static void TestCSVIsAppendedPrivately(void) {
+    static EngramLatencyLog log;
+    EngramLatencyLog_Init(&log);
+    char directory[kEngramMaxPathLength];
+    char path[kEngramMaxPathLength];
+    char target[kEngramMaxPathLength];
+    ENGRAM_EXPECT(EngramTest_MakeTempDirectory(directory, sizeof(directory)) != NULL);
+    EngramFiles_Join(path, sizeof(path), directory, kEngramLatencyArrivalsFileName);
+    EngramFiles_Join(target, sizeof(target), directory, "elsewhere");
+
+    EngramLatencyRecord record = { 1, 1000, 48000.0 };
+    EngramLatencyLog_Push(&log, &record);
+    EngramLatencyLog_Push(&log, &record);
+    ENGRAM_EXPECT(EngramLatencyLog_AppendCSV(&log, path, 1.0));
+    EngramLatencyLog_Push(&log, &record);
+    ENGRAM_EXPECT(EngramLatencyLog_AppendCSV(&log, path, 1.0));
+    struct stat info;
+    ENGRAM_EXPECT(lstat(path, &info) == 0 && S_ISREG(info.st_mode) && (info.st_mode & 0777) == 0600);
+    ENGRAM_EXPECT_EQ(CountLines(path), 3u);
+
+    // A log others can read is not added to
+    chmod(path, 0644);
+    EngramLatencyLog_Push(&log, &record);
+    ENGRAM_EXPECT(!EngramLatencyLog_AppendCSV(&log, path, 1.0));
+    unlink(path);
+
+    // Nor is a symlink planted under its name followed
+    ENGRAM_EXPECT(symlink(target, path) == 0);
+    EngramLatencyLog_Push(&log, &record);
+    ENGRAM_EXPECT(!EngramLatencyLog_AppendCSV(&log, path, 1.0));
+    ENGRAM_EXPECT(access(target, F_OK) != 0);
+
+    EngramTest_RemoveDirectory(directory);
+}
+
+int main(void) {
+    ENGRAM_RUN_TEST(TestMLSIsBalancedWithFlatAutocorrelation);
+    ENGRAM_RUN_TEST(TestLogDropsWhenFull);
+    ENGRAM_RUN_TEST(TestGeneratorProbesAreDetectedAtTheirOffset);
+    ENGRAM_RUN_TEST(TestCSVIsAppendedPrivately);
+    return ENGRAM_TEST_RESULT();
+}
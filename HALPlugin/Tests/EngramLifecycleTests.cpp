@@ -0,0 +1,353 @@
+//
+//  EngramLifecycleTests.cpp
+//  Engram Virtual Audio Device
+//
+//  Factory and reference counting under contention: create/release storms
+//  from many threads, with IO and a producer racing teardown, and alongside
+//  a simulated session that must not notice any of it. Build with
+//  -DENGRAM_SANITIZE=ON to have ASan confirm nothing touches freed memory.
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "Simulator/EngramHostSimulator.h"
+#include "EngramIO.h"
+#include "EngramFiles.h"
+#include "EngramTestSupport.h"
+#include <stdlib.h>
+#include <atomic>
+#include <string.h>
+#include <thread>
+#include <unistd.h>
+
+#define kStormThreads 8
+#define kStormIterations 400
+#define kNanosPerSecond 1000000000ull
+
+static AudioServerPlugInDriverRef Create(void) {
+    return (AudioServerPlugInDriverRef)EngramPlugIn_Create(NULL, kAudioServerPlugInTypeUUID);
+}
+
+static OSStatus ReadInput(AudioServerPlugInDriverRef driver, AudioObjectID deviceID, Float32* buffer, UInt32 frames, UInt64 cycle) {
+    AudioServerPlugInIOCycleInfo info;
+    memset(&info, 0, sizeof(info));
+    info.mIOCycleCounter = cycle;
+    return (*driver)->DoIOOperation(driver, deviceID, kAudioObjectUnknown, 1,
+                                    kAudioServerPlugInIOOperationReadInput, frames, &info, buffer, NULL);
+}
+
+static OSStatus GetSampleRate(AudioServerPlugInDriverRef driver, Float64* outRate) {
+    AudioObjectPropertyAddress address = { kAudioDevicePropertyNominalSampleRate, kAudioObjectPropertyScopeGlobal,
+                                           kAudioObjectPropertyElementMain };
+    UInt32 size = 0;
+    return (*driver)->GetPropertyData(driver, gDevice.objectID, 0, &address, 0, NULL, sizeof(*outRate), &size, outRate);
+}
+
+// MARK: - Factory
+
+static void TestFactoryRejectsOtherTypes(void) {
+    ENGRAM_EXPECT(EngramPlugIn_Create(NULL, NULL) == NULL);
+    ENGRAM_EXPECT(EngramPlugIn_Create(NULL, IUnknownUUID) == NULL);
+    ENGRAM_EXPECT(!gDevice.live.load());
+
+    // An unbalanced Release finds nothing to release and must not wrap the count
+    AudioServerPlugInDriverRef driver = Create();
+    ENGRAM_EXPECT_EQ((*driver)->Release(driver), 0u);
+    ENGRAM_EXPECT_EQ((*driver)->Release(driver), 0u);
+    ENGRAM_EXPECT(!gDevice.live.load());
+}
+
+static void TestCreateIsIdempotent(void) {
+    AudioServerPlugInDriverRef first = Create();
+    ENGRAM_EXPECT(first != NULL && *first != NULL);
+    ENGRAM_EXPECT_EQ((*first)->Initialize(first, NULL), kAudioHardwareNoError);
+    AudioObjectID deviceID = kAudioObjectUnknown;
+    ENGRAM_EXPECT_EQ((*first)->CreateDevice(first, NULL, NULL, &deviceID), kAudioHardwareNoError);
+
+    Float32 frames[2 * 480] = {};
+    ENGRAM_EXPECT_EQ(EngramDevice_WriteInput(frames, 2 * 480), 2u * 480u);
+
+    // A second Create is another reference to the same live instance
+    AudioServerPlugInDriverRef second = Create();
+    ENGRAM_EXPECT(second == first);
+    ENGRAM_EXPECT_EQ(gDevice.objectID, deviceID);
+    ENGRAM_EXPECT_EQ(EngramRingBuffer_GetAvailableRead(&gDevice.ringBuffer), 2u * 480u);
+    ENGRAM_EXPECT_EQ((*first)->Initialize(first, NULL), kAudioHardwareIllegalOperationError);
+
+    ENGRAM_EXPECT_EQ((*second)->Release(second), 1u);
+    ENGRAM_EXPECT(gDevice.live.load());
+    ENGRAM_EXPECT_EQ((*first)->Release(first), 0u);
+    ENGRAM_EXPECT(!gDevice.live.load());
+
+    // Torn down: every entry point refuses instead of touching freed memory
+    Float64 rate = 0.0;
+    Float32 buffer[2 * 512];
+    ENGRAM_EXPECT_EQ(EngramDevice_WriteInput(frames, 2 * 480), 0u);
+    ENGRAM_EXPECT_EQ(GetSampleRate(first, &rate), kAudioHardwareNotRunningError);
+    ENGRAM_EXPECT_EQ(ReadInput(first, deviceID, buffer, 512, 1), kAudioHardwareNotRunningError);
+    ENGRAM_EXPECT_EQ((*first)->StartIO(first, deviceID, 1), kAudioHardwareNotRunningError);
+
+    // And a new instance starts clean
+    AudioServerPlugInDriverRef again = Create();
+    ENGRAM_EXPECT_EQ(EngramRingBuffer_GetAvailableRead(&gDevice.ringBuffer), 0u);
+    ENGRAM_EXPECT_EQ((*again)->Initialize(again, NULL), kAudioHardwareNoError);
+    ENGRAM_EXPECT_EQ((*again)->Release(again), 0u);
+}
+
+// MARK: - Teardown
+
+// Parks the IO thread inside DoIOOperation, at its first clock read
+static std::atomic<Boolean> gParkIO(false);
+static std::atomic<Boolean> gIOParked(false);
+static thread_local Boolean gIsIOThread = false;
+
+static uint64_t ParkingHostTime(void) {
+    if (gIsIOThread && gParkIO.load()) {
+        gIOParked.store(true);
+        while (gParkIO.load()) {
+            usleep(100);
+        }
+    }
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * kNanosPerSecond + (uint64_t)ts.tv_nsec;
+}
+
+static Boolean WaitFor(const std::atomic<Boolean>& flag, Boolean value) {
+    for (UInt32 i = 0; i < 20000 && flag.load() != value; i++) {
+        usleep(100);
+    }
+    return flag.load() == value;
+}
+
+static void TestTeardownWaitsForInFlightIO(void) {
+    AudioServerPlugInDriverRef driver = Create();
+    (*driver)->Initialize(driver, NULL);
+    AudioObjectID deviceID = kAudioObjectUnknown;
+    (*driver)->CreateDevice(driver, NULL, NULL, &deviceID);
+    ENGRAM_EXPECT_EQ((*driver)->StartIO(driver, deviceID, 1), kAudioHardwareNoError);
+    gEngramShimHostTimeSource.store(ParkingHostTime);
+
+    gParkIO.store(true);
+    OSStatus ioStatus = kAudioHardwareUnspecifiedError;
+    std::thread io([driver, deviceID, &ioStatus]() {
+        gIsIOThread = true;
+        static Float32 buffer[2 * 512];
+        ioStatus = ReadInput(driver, deviceID, buffer, 512, 1);
+    });
+    ENGRAM_EXPECT(WaitFor(gIOParked, true));
+
+    // The host releases without stopping IO, mid-cycle
+    std::atomic<Boolean> released(false);
+    std::thread releaser([driver, &released]() {
+        (*driver)->Release(driver);
+        released.store(true);
+    });
+    ENGRAM_EXPECT(WaitFor(gDevice.live, false));
+    usleep(20000);
+    ENGRAM_EXPECT(!released.load());
+    ENGRAM_EXPECT_EQ(gDevice.callbacksInFlight.load(), 1u);
+
+    gParkIO.store(false);
+    io.join();
+    releaser.join();
+    gEngramShimHostTimeSource.store(NULL);
+
+    // The cycle that was running finished against live memory
+    ENGRAM_EXPECT(released.load());
+    ENGRAM_EXPECT_EQ(ioStatus, kAudioHardwareNoError);
+    ENGRAM_EXPECT_EQ(gDevice.callbacksInFlight.load(), 0u);
+    ENGRAM_EXPECT_EQ(gDevice.ioClientCount.load(), 0u);
+    ENGRAM_EXPECT(gDevice.stats == NULL);
+}
+
+static void TestTeardownReleasesParkedProducer(void) {
+    AudioServerPlugInDriverRef driver = Create();
+    (*driver)->Initialize(driver, NULL);
+
+    // A producer asleep on the idle gate holds a callback scope, so teardown
+    // has to wake it before it can drain
+    std::atomic<Boolean> parked(false);
+    std::atomic<Boolean> running(true);
+    std::thread producer([&parked, &running]() {
+        parked.store(true);
+        running.store(EngramDevice_WaitForIO(0));
+    });
+    ENGRAM_EXPECT(WaitFor(parked, true));
+    usleep(2000);
+
+    ENGRAM_EXPECT_EQ((*driver)->Release(driver), 0u);
+    producer.join();
+    ENGRAM_EXPECT(!running.load());
+    ENGRAM_EXPECT(!EngramDevice_WaitForIO(0));
+    ENGRAM_EXPECT_EQ(gDevice.callbacksInFlight.load(), 0u);
+}
+
+static void TestTeardownReleasesWaitingRenderer(void) {
+    AudioServerPlugInDriverRef driver = Create();
+    (*driver)->Initialize(driver, NULL);
+    AudioObjectID deviceID = kAudioObjectUnknown;
+    (*driver)->CreateDevice(driver, NULL, NULL, &deviceID);
+
+    // Released with IO still running: only teardown's nudge ends the wait
+    ENGRAM_EXPECT_EQ((*driver)->StartIO(driver, deviceID, 1), kAudioHardwareNoError);
+    EngramDevice_SetPullMode(true);
+    std::atomic<Boolean> parked(false);
+    std::atomic<Boolean> requested(true);
+    std::thread renderer([&parked, &requested]() {
+        EngramRenderRequest request;
+        parked.store(true);
+        requested.store(EngramDevice_WaitForRenderRequest(&request, 0));
+    });
+    ENGRAM_EXPECT(WaitFor(parked, true));
+    usleep(2000);
+
+    ENGRAM_EXPECT_EQ((*driver)->Release(driver), 0u);
+    renderer.join();
+    ENGRAM_EXPECT(!requested.load());
+    ENGRAM_EXPECT_EQ(gDevice.callbacksInFlight.load(), 0u);
+}
+
+// MARK: - Storms
+
+static void StormReferences(AudioServerPlugInDriverRef* seen, std::atomic<UInt32>* failures, UInt32 seed) {
+    CFUUIDBytes interfaceBytes = CFUUIDGetUUIDBytes(kAudioServerPlugInDriverInterfaceUUID);
+    for (UInt32 i = 0; i < kStormIterations; i++) {
+        AudioServerPlugInDriverRef driver = Create();
+        if (driver == NULL) {
+            failures->fetch_add(1);
+            continue;
+        }
+        *seen = driver;
+
+        void* queried = NULL;
+        if ((*driver)->QueryInterface(driver, interfaceBytes, &queried) != S_OK || queried != driver) {
+            failures->fetch_add(1);
+        }
+        if (((i + seed) & 3) == 0) {
+            (*driver)->AddRef(driver);
+            (*driver)->Release(driver);
+        }
+        (*driver)->Release(driver);
+        (*driver)->Release(driver);
+    }
+}
+
+static void TestCreateReleaseStorm(void) {
+    CFIndex objectsBefore = EngramShim_LiveObjectCount();
+    std::atomic<UInt32> failures(0);
+    std::atomic<Boolean> stop(false);
+    std::atomic<UInt64> accepted(0);
+    std::atomic<UInt64> cycles(0);
+
+    // A producer and an IO thread that hold no reference of their own, so the
+    // instance is built and torn down under them over and over
+    std::thread producer([&stop, &accepted]() {
+        Float32 frames[2 * 480] = {};
+        while (!stop.load()) {
+            accepted += EngramDevice_WriteInput(frames, 2 * 480);
+        }
+    });
+    // The driver ref is a constant, so the IO thread can keep using it
+    // across instances the way a host's IO thread outlives a reference
+    AudioServerPlugInDriverRef driver = Create();
+    (*driver)->Release(driver);
+    std::thread io([driver, &stop, &cycles]() {
+        static Float32 buffer[2 * 512];
+        UInt64 cycle = 0;
+        while (!stop.load()) {
+            // Nothing initializes these instances, so there is no device ID to know
+            if (ReadInput(driver, kAudioObjectUnknown, buffer, 512, ++cycle) == kAudioHardwareNoError) {
+                cycles++;
+            }
+        }
+    });
+
+    AudioServerPlugInDriverRef seen[kStormThreads] = {};
+    std::thread storm[kStormThreads];
+    for (UInt32 t = 0; t < kStormThreads; t++) {
+        storm[t] = std::thread(StormReferences, &seen[t], &failures, t);
+    }
+    for (UInt32 t = 0; t < kStormThreads; t++) {
+        storm[t].join();
+    }
+    stop.store(true);
+    producer.join();
+    io.join();
+
+    ENGRAM_EXPECT_EQ(failures.load(), 0u);
+    for (UInt32 t = 0; t < kStormThreads; t++) {
+        ENGRAM_EXPECT(seen[t] == driver);
+    }
+
+    // Every reference was returned, so everything was torn down and nothing leaked
+    ENGRAM_EXPECT(!gDevice.live.load());
+    ENGRAM_EXPECT_EQ(gDevice.callbacksInFlight.load(), 0u);
+    ENGRAM_EXPECT(gDevice.stats == NULL);
+    ENGRAM_EXPECT_EQ(EngramShim_LiveObjectCount(), objectsBefore);
+    ENGRAM_EXPECT_EQ((*driver)->Release(driver), 0u);
+    printf("  %u threads x %u, producer accepted %llu samples, %llu IO cycles ran\n", kStormThreads, kStormIterations,
+           (unsigned long long)accepted.load(), (unsigned long long)cycles.load());
+}
+
+static void TestStormLeavesSessionUntouched(void) {
+    // The simulator holds its own reference throughout, so the storm only
+    // ever adds and drops extra ones around a live, running session
+    EngramSimulator* sim = (EngramSimulator*)calloc(1, sizeof(EngramSimulator));
+    EngramSimConfig config;
+    EngramSim_DefaultConfig(&config);
+    ENGRAM_EXPECT(EngramSim_Start(sim, &config));
+
+    std::atomic<UInt32> failures(0);
+    std::atomic<Boolean> stop(false);
+    std::thread storm[kStormThreads];
+    for (UInt32 t = 0; t < kStormThreads; t++) {
+        storm[t] = std::thread([&failures, &stop]() {
+            while (!stop.load()) {
+                AudioServerPlugInDriverRef driver = Create();
+                Float64 rate = 0.0;
+                if (driver == NULL || GetSampleRate(driver, &rate) != kAudioHardwareNoError || rate != kEngramSampleRate) {
+                    failures.fetch_add(1);
+                }
+                if (driver != NULL) {
+                    (*driver)->Release(driver);
+                }
+            }
+        });
+    }
+
+    EngramSim_RunFor(sim, 60 * kNanosPerSecond);
+    stop.store(true);
+    for (UInt32 t = 0; t < kStormThreads; t++) {
+        storm[t].join();
+    }
+    ENGRAM_EXPECT(gDevice.live.load());
+
+    EngramSimReport report;
+    EngramSim_Stop(sim, &report);
+    free(sim);
+
+    ENGRAM_EXPECT_EQ(failures.load(), 0u);
+    ENGRAM_EXPECT_EQ(report.failedCalls, 0u);
+    ENGRAM_EXPECT_EQ(report.underrunCycles, 0u);
+    ENGRAM_EXPECT_EQ(report.mismatchedSamples, 0u);
+    ENGRAM_EXPECT_EQ(report.timestampErrors, 0u);
+    ENGRAM_EXPECT(!gDevice.live.load());
+}
+
+int main(void) {
+    // Glitch snapshots go to a directory this run removes again
+    char diagnostics[kEngramMaxPathLength];
+    ENGRAM_EXPECT(EngramTest_MakeTempDirectory(diagnostics, sizeof(diagnostics)) != NULL);
+    setenv(kEngramDiagnosticsDirectoryEnvironment, diagnostics, 1);
+
+    ENGRAM_RUN_TEST(TestFactoryRejectsOtherTypes);
+    ENGRAM_RUN_TEST(TestCreateIsIdempotent);
+    ENGRAM_RUN_TEST(TestTeardownWaitsForInFlightIO);
+    ENGRAM_RUN_TEST(TestTeardownReleasesParkedProducer);
+    ENGRAM_RUN_TEST(TestTeardownReleasesWaitingRenderer);
+    ENGRAM_RUN_TEST(TestCreateReleaseStorm);
+    ENGRAM_RUN_TEST(TestStormLeavesSessionUntouched);
+    EngramTest_RemoveDirectory(diagnostics);
+    return ENGRAM_TEST_RESULT();
+}
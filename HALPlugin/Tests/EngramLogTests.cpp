@@ -0,0 +1,146 @@
+//
+//  EngramLogTests.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramLog.h"
+#include "EngramFiles.h"
+#include "EngramTestSupport.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <unistd.h>
+
+static void DrainAll(void) {
+    EngramLogRecord records[64];
+    while (EngramLog_PopRecords(records, 64) > 0) {
+    }
+}
+
+static void TestRecordsAreFormattedLater(void) {
+    DrainAll();
+    ENGRAM_EXPECT(ENGRAM_LOG_NOTICE("cycle %llu took %llu ns", 7, 1250));
+
+    EngramLogRecord record;
+    ENGRAM_EXPECT_EQ(EngramLog_PopRecords(&record, 1), 1u);
+    ENGRAM_EXPECT_EQ(record.level, (UInt8)kEngramLogLevelNotice);
+
+    char line[128];
+    EngramLog_FormatRecord(&record, line, sizeof(line));
+    ENGRAM_EXPECT(strcmp(line, "cycle 7 took 1250 ns") == 0);
+}
+
+static void TestMinimumLevelFilters(void) {
+    DrainAll();
+    EngramLog_SetMinLevel(kEngramLogLevelWarning);
+    ENGRAM_EXPECT(!ENGRAM_LOG_INFO("filtered"));
+    ENGRAM_EXPECT(ENGRAM_LOG_ERROR("kept"));
+    EngramLog_SetMinLevel(kEngramLogLevelInfo);
+
+    EngramLogRecord records[4];
+    ENGRAM_EXPECT_EQ(EngramLog_PopRecords(records, 4), 1u);
+}
+
+static void TestRateLimiterCountsSuppressed(void) {
+    DrainAll();
+    for (UInt32 i = 0; i < 5; i++) {
+        ENGRAM_LOG_RATE_LIMITED(1000000000ull * 3600, kEngramLogLevelWarning, "underrun %llu", i);
+    }
+
+    EngramLogRecord records[8];
+    ENGRAM_EXPECT_EQ(EngramLog_PopRecords(records, 8), 1u);
+    ENGRAM_EXPECT_EQ(records[0].suppressed, 0u);
+}
+
+static void TestRateLimiterReportsSuppressedOnNextRecord(void) {
+    DrainAll();
+    for (UInt32 i = 0; i < 6; i++) {
+        if (i == 5) {
+            usleep(30000);
+        }
+        ENGRAM_LOG_RATE_LIMITED(20000000ull, kEngramLogLevelWarning, "underrun %llu", i);
+    }
+
+    EngramLogRecord records[8];
+    ENGRAM_EXPECT_EQ(EngramLog_PopRecords(records, 8), 2u);
+    ENGRAM_EXPECT_EQ(records[1].suppressed, 4u);
+    char line[128];
+    EngramLog_FormatRecord(&records[1], line, sizeof(line));
+    ENGRAM_EXPECT(strcmp(line, "underrun 5 (+4 suppressed)") == 0);
+}
+
+static void TestFullQueueDropsInsteadOfBlocking(void) {
+    DrainAll();
+    UInt64 droppedBefore = EngramLog_GetDroppedCount();
+    for (UInt32 i = 0; i < kEngramLogCapacity + 10; i++) {
+        ENGRAM_LOG_INFO("record %llu", i);
+    }
+    ENGRAM_EXPECT_EQ(EngramLog_GetDroppedCount() - droppedBefore, 10u);
+    DrainAll();
+}
+
+static void TestConcurrentProducers(void) {
+    DrainAll();
+    std::thread producers[4];
+    for (UInt32 t = 0; t < 4; t++) {
+        producers[t] = std::thread([t]() {
+            for (UInt32 i = 0; i < 200; i++) {
+                ENGRAM_LOG_INFO("thread %llu record %llu", t, i);
+            }
+        });
+    }
+    for (UInt32 t = 0; t < 4; t++) {
+        producers[t].join();
+    }
+
+    EngramLogRecord records[64];
+    UInt32 total = 0;
+    UInt32 count;
+    while ((count = EngramLog_PopRecords(records, 64)) > 0) {
+        total += count;
+    }
+    ENGRAM_EXPECT_EQ(total, 800u);
+}
+
+static void TestDrainThreadWritesSink(void) {
+    DrainAll();
+    char root[kEngramMaxPathLength];
+    char path[kEngramMaxPathLength];
+    ENGRAM_EXPECT(EngramTest_MakeTempDirectory(root, sizeof(root)) != NULL);
+    EngramFiles_Join(path, sizeof(path), root, "engram-hal.log");
+    setenv("ENGRAM_HAL_LOG_FILE", path, 1);
+
+    // Producers only queue; the drain thread formats and writes, and Stop
+    // emits whatever is still queued before it returns
+    EngramLog_Start();
+    ENGRAM_EXPECT(ENGRAM_LOG_NOTICE("Engram device started (client %llu)", 3));
+    ENGRAM_EXPECT(ENGRAM_LOG_ERROR("ring %llu of %llu", 1, 2));
+    EngramLog_Stop();
+    unsetenv("ENGRAM_HAL_LOG_FILE");
+
+    char contents[512] = {};
+    FILE* file = fopen(path, "r");
+    ENGRAM_EXPECT(file != NULL);
+    if (file != NULL) {
+        fread(contents, 1, sizeof(contents) - 1, file);
+        fclose(file);
+    }
+    ENGRAM_EXPECT(strstr(contents, "engram-hal notice: Engram device started (client 3)\n") != NULL);
+    ENGRAM_EXPECT(strstr(contents, "engram-hal error: ring 1 of 2\n") != NULL);
+    EngramTest_RemoveDirectory(root);
+}
+
+int main(void) {
+    ENGRAM_RUN_TEST(TestRecordsAreFormattedLater);
+    ENGRAM_RUN_TEST(TestMinimumLevelFilters);
+    ENGRAM_RUN_TEST(TestRateLimiterCountsSuppressed);
+    ENGRAM_RUN_TEST(TestRateLimiterReportsSuppressedOnNextRecord);
+    ENGRAM_RUN_TEST(TestFullQueueDropsInsteadOfBlocking);
+    ENGRAM_RUN_TEST(TestConcurrentProducers);
+    ENGRAM_RUN_TEST(TestDrainThreadWritesSink);
+    return ENGRAM_TEST_RESULT();
+}
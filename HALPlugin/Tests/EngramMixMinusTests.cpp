@@ -0,0 +1,191 @@
+//
+//  EngramMixMinusTests.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramMixMinus.h"
+#include "EngramTestSupport.h"
+#include <string.h>
+
+#define kChannels 2
+#define kFrames 128
+#define kSamples (kFrames * kChannels)
+
+static EngramArena gArena;
+static EngramMixMinus gMixMinus;
+
+static void Setup(void) {
+    EngramArena_Release(&gArena);
+    EngramArena_Reserve(&gArena, EngramMixMinus_RequiredBytes(kChannels));
+    EngramMixMinus_Init(&gMixMinus, &gArena, kChannels);
+}
+
+static void Fill(Float32* samples, Float32 value) {
+    for (UInt32 i = 0; i < kSamples; i++) {
+        samples[i] = value;
+    }
+}
+
+// One output cycle as the HAL runs it: each client's ProcessOutput, then
+// WriteMix over their sum
+static void PlayCycle(UInt64 cycle, const UInt32* clients, const Float32* levels, UInt32 count) {
+    Float32 contribution[kSamples];
+    Float32 mix[kSamples];
+    Fill(mix, 0.0f);
+    for (UInt32 c = 0; c < count; c++) {
+        Fill(contribution, levels[c]);
+        EngramMixMinus_Contribute(&gMixMinus, clients[c], cycle, contribution, kFrames);
+        for (UInt32 i = 0; i < kSamples; i++) {
+            mix[i] += contribution[i];
+        }
+    }
+    EngramMixMinus_CaptureMix(&gMixMinus, cycle, mix, kFrames);
+}
+
+static void TestOffByDefault(void) {
+    Setup();
+    ENGRAM_EXPECT(EngramMixMinus_Attach(&gMixMinus, 1));
+    const UInt32 clients[] = { 1 };
+    const Float32 levels[] = { 0.5f };
+    PlayCycle(1, clients, levels, 1);
+
+    Float32 input[kSamples];
+    Fill(input, 0.25f);
+    ENGRAM_EXPECT(!EngramMixMinus_Apply(&gMixMinus, 1, 2, input, kFrames));
+    ENGRAM_EXPECT_EQ(input[0], 0.25f);
+}
+
+static void TestEachClientHearsTheOthers(void) {
+    Setup();
+    gMixMinus.enabled.store(true);
+    ENGRAM_EXPECT(EngramMixMinus_Attach(&gMixMinus, 10));
+    ENGRAM_EXPECT(EngramMixMinus_Attach(&gMixMinus, 20));
+    ENGRAM_EXPECT(EngramMixMinus_Attach(&gMixMinus, 30));
+    const UInt32 clients[] = { 10, 20, 30 };
+    const Float32 levels[] = { 0.125f, 0.25f, 0.5f };
+    PlayCycle(1, clients, levels, 3);
+
+    // Next cycle's input, on top of what the producer delivered
+    for (UInt32 c = 0; c < 3; c++) {
+        Float32 input[kSamples];
+        Fill(input, 0.0625f);
+        ENGRAM_EXPECT(EngramMixMinus_Apply(&gMixMinus, clients[c], 2, input, kFrames));
+        Float32 expected = 0.0625f + (0.875f - levels[c]);
+        ENGRAM_EXPECT_NEAR(input[0], expected, 1e-6);
+        ENGRAM_EXPECT_NEAR(input[kSamples - 1], expected, 1e-6);
+    }
+
+    // A client that only records hears everything
+    ENGRAM_EXPECT(EngramMixMinus_Attach(&gMixMinus, 40));
+    Float32 input[kSamples];
+    Fill(input, 0.0f);
+    ENGRAM_EXPECT(EngramMixMinus_Apply(&gMixMinus, 40, 2, input, kFrames));
+    ENGRAM_EXPECT_NEAR(input[0], 0.875f, 1e-6);
+}
+
+static void TestStaleContributionIsNotSubtracted(void) {
+    Setup();
+    gMixMinus.enabled.store(true);
+    ENGRAM_EXPECT(EngramMixMinus_Attach(&gMixMinus, 1));
+    ENGRAM_EXPECT(EngramMixMinus_Attach(&gMixMinus, 2));
+    const UInt32 both[] = { 1, 2 };
+    const Float32 bothLevels[] = { 0.5f, 0.25f };
+    PlayCycle(1, both, bothLevels, 2);
+
+    // Client 1 went quiet: its old buffer must not come out of the new mix
+    const UInt32 second[] = { 2 };
+    const Float32 secondLevels[] = { 0.25f };
+    PlayCycle(2, second, secondLevels, 1);
+
+    Float32 input[kSamples];
+    Fill(input, 0.0f);
+    ENGRAM_EXPECT(EngramMixMinus_Apply(&gMixMinus, 1, 3, input, kFrames));
+    ENGRAM_EXPECT_NEAR(input[0], 0.25f, 1e-6);
+}
+
+static void TestReusedSlotStartsEmpty(void) {
+    Setup();
+    gMixMinus.enabled.store(true);
+    ENGRAM_EXPECT(EngramMixMinus_Attach(&gMixMinus, 1));
+    ENGRAM_EXPECT(EngramMixMinus_Attach(&gMixMinus, 2));
+    const UInt32 both[] = { 1, 2 };
+    const Float32 bothLevels[] = { 0.5f, 0.25f };
+    PlayCycle(4, both, bothLevels, 2);
+
+    // Client 1 leaves and client 3 takes its slot before the cycle is over;
+    // 3 played nothing into this mix, so it hears all of it
+    EngramMixMinus_Detach(&gMixMinus, 1);
+    ENGRAM_EXPECT(EngramMixMinus_Attach(&gMixMinus, 3));
+    ENGRAM_EXPECT_EQ(gMixMinus.slots[0].clientID.load(), 3u);
+
+    Float32 input[kSamples];
+    Fill(input, 0.0f);
+    ENGRAM_EXPECT(EngramMixMinus_Apply(&gMixMinus, 3, 4, input, kFrames));
+    ENGRAM_EXPECT_NEAR(input[0], 0.75f, 1e-6);
+    Fill(input, 0.0f);
+    ENGRAM_EXPECT(EngramMixMinus_Apply(&gMixMinus, 3, 5, input, kFrames));
+    ENGRAM_EXPECT_NEAR(input[kSamples - 1], 0.75f, 1e-6);
+
+    // The client staying on still has its own share taken out
+    Fill(input, 0.0f);
+    ENGRAM_EXPECT(EngramMixMinus_Apply(&gMixMinus, 2, 5, input, kFrames));
+    ENGRAM_EXPECT_NEAR(input[0], 0.5f, 1e-6);
+}
+
+static void TestLoopbackStopsWithTheOutput(void) {
+    Setup();
+    gMixMinus.enabled.store(true);
+    ENGRAM_EXPECT(EngramMixMinus_Attach(&gMixMinus, 1));
+    const UInt32 clients[] = { 1 };
+    const Float32 levels[] = { 0.5f };
+    PlayCycle(5, clients, levels, 1);
+
+    Float32 input[kSamples];
+    Fill(input, 0.0f);
+    // The same cycle and the next one use it; later cycles do not repeat it
+    ENGRAM_EXPECT(EngramMixMinus_Apply(&gMixMinus, 2, 5, input, kFrames));
+    ENGRAM_EXPECT(EngramMixMinus_Apply(&gMixMinus, 2, 6, input, kFrames));
+    ENGRAM_EXPECT(!EngramMixMinus_Apply(&gMixMinus, 2, 7, input, kFrames));
+    ENGRAM_EXPECT(!EngramMixMinus_Apply(&gMixMinus, 2, 4, input, kFrames));
+
+    // Nor does a cycle of a different size
+    Float32 small[kSamples];
+    ENGRAM_EXPECT(!EngramMixMinus_Apply(&gMixMinus, 2, 6, small, kFrames / 2));
+
+    // A mix too big to keep leaves no loopback at all
+    static Float32 big[(kEngramMixMinusMaxFrames + 1) * kChannels];
+    EngramMixMinus_CaptureMix(&gMixMinus, 6, big, kEngramMixMinusMaxFrames + 1);
+    ENGRAM_EXPECT(!EngramMixMinus_Apply(&gMixMinus, 2, 7, input, kFrames));
+}
+
+static void TestSlots(void) {
+    Setup();
+    for (UInt32 i = 0; i < kEngramMixMinusMaxClients; i++) {
+        ENGRAM_EXPECT(EngramMixMinus_Attach(&gMixMinus, 100 + i));
+    }
+    // Attaching twice keeps the one slot
+    ENGRAM_EXPECT(EngramMixMinus_Attach(&gMixMinus, 100));
+    ENGRAM_EXPECT(!EngramMixMinus_Attach(&gMixMinus, 200));
+    ENGRAM_EXPECT(!EngramMixMinus_Attach(&gMixMinus, kEngramMixMinusNoClient));
+    ENGRAM_EXPECT(!EngramMixMinus_Attach(&gMixMinus, kEngramMixMinusClaiming));
+
+    EngramMixMinus_Detach(&gMixMinus, 103);
+    ENGRAM_EXPECT(EngramMixMinus_Attach(&gMixMinus, 200));
+    // Detaching a client that never attached is harmless
+    EngramMixMinus_Detach(&gMixMinus, 999);
+    ENGRAM_EXPECT(!EngramMixMinus_Attach(&gMixMinus, 201));
+}
+
+int main(void) {
+    ENGRAM_RUN_TEST(TestOffByDefault);
+    ENGRAM_RUN_TEST(TestEachClientHearsTheOthers);
+    ENGRAM_RUN_TEST(TestStaleContributionIsNotSubtracted);
+    ENGRAM_RUN_TEST(TestReusedSlotStartsEmpty);
+    ENGRAM_RUN_TEST(TestLoopbackStopsWithTheOutput);
+    ENGRAM_RUN_TEST(TestSlots);
+    EngramArena_Release(&gArena);
+    return ENGRAM_TEST_RESULT();
+}
@@ -0,0 +1,173 @@
+//
+//  EngramNotifyTests.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramNotify.h"
+#include "EngramTestSupport.h"
+#include "EngramWait.h"
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#define kDevice 1000
+#define kOtherObject 2000
+#define kMillis 1000000ull
+
+typedef struct {
+    AudioObjectID objectID;
+    std::vector<AudioObjectPropertySelector> selectors;
+    UInt64 receivedAt;
+} Batch;
+
+static std::mutex gBatchLock;
+static std::vector<Batch> gBatches;
+
+static OSStatus RecordPropertiesChanged(AudioServerPlugInHostRef host, AudioObjectID objectID,
+                                        UInt32 addressCount, const AudioObjectPropertyAddress* addresses) {
+    Batch batch;
+    batch.objectID = objectID;
+    for (UInt32 i = 0; i < addressCount; i++) {
+        batch.selectors.push_back(addresses[i].mSelector);
+    }
+    batch.receivedAt = EngramWait_Now();
+    std::lock_guard<std::mutex> lock(gBatchLock);
+    gBatches.push_back(batch);
+    return kAudioHardwareNoError;
+}
+
+static AudioServerPlugInHostInterface gHostInterface;
+
+static void StartWithTargets(void) {
+    {
+        std::lock_guard<std::mutex> lock(gBatchLock);
+        gBatches.clear();
+    }
+    memset(&gHostInterface, 0, sizeof(gHostInterface));
+    gHostInterface.PropertiesChanged = RecordPropertiesChanged;
+
+    ENGRAM_EXPECT(EngramNotify_Register(kDevice, kAudioDevicePropertyDeviceIsRunning,
+                                        kAudioObjectPropertyScopeGlobal, kAudioObjectPropertyElementMain));
+    ENGRAM_EXPECT(EngramNotify_Register(kDevice, kAudioDevicePropertyNominalSampleRate,
+                                        kAudioObjectPropertyScopeGlobal, kAudioObjectPropertyElementMain));
+    ENGRAM_EXPECT(EngramNotify_Register(kOtherObject, kAudioObjectPropertyName,
+                                        kAudioObjectPropertyScopeGlobal, kAudioObjectPropertyElementMain));
+    EngramNotify_Start(&gHostInterface);
+}
+
+static size_t BatchCount(void) {
+    std::lock_guard<std::mutex> lock(gBatchLock);
+    return gBatches.size();
+}
+
+static Boolean WaitForBatches(size_t count) {
+    for (UInt32 i = 0; i < 2000 && BatchCount() < count; i++) {
+        usleep(500);
+    }
+    return BatchCount() >= count;
+}
+
+static void TestBurstIsCoalesced(void) {
+    StartWithTargets();
+    EngramNotifyCounters before;
+    EngramNotify_GetCounters(&before);
+
+    UInt64 posted = EngramWait_Now();
+    for (UInt32 i = 0; i < 100; i++) {
+        EngramNotify_Post(kDevice, kAudioDevicePropertyDeviceIsRunning);
+        EngramNotify_Post(kDevice, kAudioDevicePropertyNominalSampleRate);
+    }
+    ENGRAM_EXPECT(WaitForBatches(1));
+    usleep(2 * kEngramNotifyCoalesceNs / 1000);
+
+    {
+        std::lock_guard<std::mutex> lock(gBatchLock);
+        ENGRAM_EXPECT_EQ(gBatches.size(), (size_t)1);
+        if (!gBatches.empty()) {
+            ENGRAM_EXPECT_EQ(gBatches[0].objectID, (AudioObjectID)kDevice);
+            ENGRAM_EXPECT_EQ(gBatches[0].selectors.size(), (size_t)2);
+            // Announced after the window, not after the first post
+            ENGRAM_EXPECT(gBatches[0].receivedAt - posted >= kEngramNotifyCoalesceNs);
+            ENGRAM_EXPECT(gBatches[0].receivedAt - posted < 500 * kMillis);
+        }
+    }
+
+    EngramNotifyCounters after;
+    EngramNotify_GetCounters(&after);
+    ENGRAM_EXPECT_EQ(after.posted - before.posted, 200u);
+    ENGRAM_EXPECT_EQ(after.coalesced - before.coalesced, 198u);
+    ENGRAM_EXPECT_EQ(after.batches - before.batches, 1u);
+    ENGRAM_EXPECT_EQ(after.delivered - before.delivered, 2u);
+    EngramNotify_Stop();
+}
+
+static void TestOneCallPerObject(void) {
+    StartWithTargets();
+    EngramNotify_Post(kDevice, kAudioDevicePropertyDeviceIsRunning);
+    EngramNotify_Post(kOtherObject, kAudioObjectPropertyName);
+    // Never registered: ignored
+    EngramNotify_Post(kDevice, kAudioObjectPropertyName);
+    ENGRAM_EXPECT(WaitForBatches(2));
+    usleep(2 * kEngramNotifyCoalesceNs / 1000);
+
+    {
+        std::lock_guard<std::mutex> lock(gBatchLock);
+        ENGRAM_EXPECT_EQ(gBatches.size(), (size_t)2);
+        if (gBatches.size() == 2) {
+            ENGRAM_EXPECT_EQ(gBatches[0].objectID, (AudioObjectID)kDevice);
+            ENGRAM_EXPECT_EQ(gBatches[0].selectors.size(), (size_t)1);
+            ENGRAM_EXPECT_EQ(gBatches[1].objectID, (AudioObjectID)kOtherObject);
+            ENGRAM_EXPECT_EQ(gBatches[1].selectors[0], (AudioObjectPropertySelector)kAudioObjectPropertyName);
+        }
+    }
+    EngramNotify_Stop();
+}
+
+static void TestStopFlushesPending(void) {
+    StartWithTargets();
+    EngramNotify_Post(kDevice, kAudioDevicePropertyDeviceIsRunning);
+    EngramNotify_Stop();
+    ENGRAM_EXPECT_EQ(BatchCount(), (size_t)1);
+
+    // Nothing is delivered, or even remembered, once stopped
+    EngramNotify_Post(kDevice, kAudioDevicePropertyDeviceIsRunning);
+    EngramNotify_Start(&gHostInterface);
+    usleep(2 * kEngramNotifyCoalesceNs / 1000);
+    EngramNotify_Stop();
+    ENGRAM_EXPECT_EQ(BatchCount(), (size_t)1);
+}
+
+static void TestPostsFromManyThreads(void) {
+    StartWithTargets();
+    std::thread posters[4];
+    for (UInt32 t = 0; t < 4; t++) {
+        posters[t] = std::thread([]() {
+            for (UInt32 i = 0; i < 10000; i++) {
+                EngramNotify_Post(kDevice, (i & 1) ? kAudioDevicePropertyDeviceIsRunning
+                                                   : kAudioDevicePropertyNominalSampleRate);
+            }
+        });
+    }
+    for (UInt32 t = 0; t < 4; t++) {
+        posters[t].join();
+    }
+    EngramNotify_Stop();
+
+    // However the posts interleaved with the window, far fewer calls than posts
+    size_t batches = BatchCount();
+    ENGRAM_EXPECT(batches >= 1);
+    ENGRAM_EXPECT(batches < 1000);
+}
+
+int main(void) {
+    ENGRAM_RUN_TEST(TestBurstIsCoalesced);
+    ENGRAM_RUN_TEST(TestOneCallPerObject);
+    ENGRAM_RUN_TEST(TestStopFlushesPending);
+    ENGRAM_RUN_TEST(TestPostsFromManyThreads);
+    return ENGRAM_TEST_RESULT();
+}
@@ -0,0 +1,941 @@
+//
+//  EngramPlugInTests.cpp
+//  Engram Virtual Audio Device
+//
+//  Drives the plugin through its driver interface the way coreaudiod does.
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramHalPlugin.h"
+#include "EngramDenormal.h"
+#include "EngramIO.h"
+#include "EngramTestSupport.h"
+#include "EngramWait.h"
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+static AudioServerPlugInDriverInterface* gInterface = NULL;
+static char gDiagnostics[kEngramMaxPathLength];
+
+static OSStatus GetProperty(AudioObjectPropertySelector selector, UInt32 inDataSize, UInt32* outDataSize, void* outData) {
+    AudioObjectPropertyAddress address = { selector, kAudioObjectPropertyScopeGlobal, kAudioObjectPropertyElementMain };
+    return gInterface->GetPropertyData(NULL, gDevice.objectID, 0, &address, 0, NULL, inDataSize, outDataSize, outData);
+}
+
+static void TestCreateAndInitialize(void) {
+    AudioServerPlugInDriverRef driver = (AudioServerPlugInDriverRef)EngramPlugIn_Create(NULL, kAudioServerPlugInTypeUUID);
+    ENGRAM_EXPECT(driver != NULL && *driver != NULL);
+    gInterface = *driver;
+    ENGRAM_EXPECT_EQ(gInterface->Initialize(NULL, NULL), kAudioHardwareNoError);
+
+    AudioObjectID deviceID = kAudioObjectUnknown;
+    ENGRAM_EXPECT_EQ(gInterface->CreateDevice(NULL, NULL, NULL, &deviceID), kAudioHardwareNoError);
+    ENGRAM_EXPECT(deviceID != kAudioObjectUnknown);
+}
+
+static void TestBasicProperties(void) {
+    UInt32 size = 0;
+    Float64 sampleRate = 0.0;
+    ENGRAM_EXPECT_EQ(GetProperty(kAudioDevicePropertyNominalSampleRate, sizeof(sampleRate), &size, &sampleRate), kAudioHardwareNoError);
+    ENGRAM_EXPECT_EQ(sampleRate, kEngramSampleRate);
+
+    AudioValueRange bufferSizes = { 0.0, 0.0 };
+    ENGRAM_EXPECT_EQ(GetProperty(kAudioDevicePropertyBufferFrameSizeRange, sizeof(bufferSizes), &size, &bufferSizes), kAudioHardwareNoError);
+    ENGRAM_EXPECT_EQ(bufferSizes.mMinimum, (Float64)kEngramMinIOBufferFrames);
+    ENGRAM_EXPECT_EQ(bufferSizes.mMaximum, (Float64)kEngramMaxIOBufferFrames);
+
+    CFStringRef name = NULL;
+    ENGRAM_EXPECT_EQ(GetProperty(kAudioObjectPropertyName, sizeof(name), &size, &name), kAudioHardwareNoError);
+    ENGRAM_EXPECT(CFEqual(name, CFSTR(kEngramDeviceName)));
+
+    AudioObjectPropertyAddress address = { 'zzzz', kAudioObjectPropertyScopeGlobal, kAudioObjectPropertyElementMain };
+    ENGRAM_EXPECT(!gInterface->HasProperty(NULL, gDevice.objectID, 0, &address));
+    ENGRAM_EXPECT_EQ(GetProperty('zzzz', 0, &size, NULL), kAudioHardwareUnknownPropertyError);
+}
+
+static void TestCustomPropertyList(void) {
+    AudioServerPlugInCustomPropertyInfo info[8];
+    UInt32 size = 0;
+    ENGRAM_EXPECT_EQ(GetProperty(kAudioObjectPropertyCustomPropertyInfoList, sizeof(info), &size, info), kAudioHardwareNoError);
+    ENGRAM_EXPECT_EQ(size, 7 * sizeof(AudioServerPlugInCustomPropertyInfo));
+    ENGRAM_EXPECT_EQ(info[0].mSelector, (AudioObjectPropertySelector)kEngramPropertyStats);
+
+    // A short buffer gets a truncated list, never an overflow
+    ENGRAM_EXPECT_EQ(GetProperty(kAudioObjectPropertyCustomPropertyInfoList, sizeof(info[0]), &size, info), kAudioHardwareNoError);
+    ENGRAM_EXPECT_EQ(size, sizeof(AudioServerPlugInCustomPropertyInfo));
+}
+
+static void TestMalformedPropertyQueries(void) {
+    // Short buffers are refused rather than written past
+    UInt32 size = 0;
+    Float64 sampleRate = 0.0;
+    ENGRAM_EXPECT_EQ(GetProperty(kAudioDevicePropertyNominalSampleRate, sizeof(Float32), &size, &sampleRate),
+                     kAudioHardwareBadPropertySizeError);
+    ENGRAM_EXPECT_EQ(GetProperty(kAudioObjectPropertyName, 0, &size, NULL), kAudioHardwareBadPropertySizeError);
+
+    // A missing stats page is not the caller's buffer's fault
+    CFPropertyListRef data = NULL;
+    EngramStatsPage* stats = gDevice.stats;
+    gDevice.stats = NULL;
+    ENGRAM_EXPECT_EQ(GetProperty(kEngramPropertyStats, sizeof(data), &size, &data), kAudioHardwareUnspecifiedError);
+    gDevice.stats = stats;
+    ENGRAM_EXPECT(data == NULL);
+    ENGRAM_EXPECT_EQ(GetProperty(kEngramPropertyStats, 0, &size, NULL), kAudioHardwareBadPropertySizeError);
+
+    // Objects the plugin doesn't own answer nothing
+    AudioObjectPropertyAddress address = { kAudioDevicePropertyNominalSampleRate, kAudioObjectPropertyScopeGlobal,
+                                           kAudioObjectPropertyElementMain };
+    ENGRAM_EXPECT(!gInterface->HasProperty(NULL, gDevice.objectID + 1, 0, &address));
+    ENGRAM_EXPECT_EQ(gInterface->GetPropertyData(NULL, gDevice.objectID + 1, 0, &address, 0, NULL,
+                                                 sizeof(sampleRate), &size, &sampleRate),
+                     kAudioHardwareBadObjectError);
+    ENGRAM_EXPECT_EQ(gInterface->GetPropertyDataSize(NULL, gDevice.objectID, 0, NULL, 0, NULL, &size),
+                     kAudioHardwareIllegalOperationError);
+
+    // The plug-in object names itself but has no device properties
+    ENGRAM_EXPECT(!gInterface->HasProperty(NULL, kAudioObjectPlugInObject, 0, &address));
+    address.mSelector = kAudioObjectPropertyManufacturer;
+    ENGRAM_EXPECT(gInterface->HasProperty(NULL, kAudioObjectPlugInObject, 0, &address));
+
+    // Settable properties take a CFBoolean and nothing else
+    address.mSelector = kEngramPropertyTrace;
+    CFPropertyListRef value = CFSTR("on");
+    ENGRAM_EXPECT_EQ(gInterface->SetPropertyData(NULL, gDevice.objectID, 0, &address, 0, NULL, sizeof(value), &value),
+                     kAudioHardwareIllegalOperationError);
+    ENGRAM_EXPECT(!EngramTrace_IsEnabled());
+}
+
+static void TestReadInputDrainsRing(void) {
+    ENGRAM_EXPECT_EQ(gInterface->StartIO(NULL, gDevice.objectID, 1), kAudioHardwareNoError);
+
+    const UInt32 frames = 256;
+    Float32 produced[frames * kEngramChannels];
+    for (UInt32 i = 0; i < frames * kEngramChannels; i++) {
+        produced[i] = 0.001f * (Float32)(i % 100);
+    }
+    ENGRAM_EXPECT_EQ(EngramDevice_WriteInput(produced, frames * kEngramChannels), frames * kEngramChannels);
+
+    AudioServerPlugInIOCycleInfo cycle;
+    memset(&cycle, 0, sizeof(cycle));
+    cycle.mIOCycleCounter = 1;
+    Float32 buffer[frames * kEngramChannels];
+    for (UInt32 pass = 0; pass < 2; pass++) {
+        ENGRAM_EXPECT_EQ(gInterface->DoIOOperation(NULL, gDevice.objectID, gDevice.inputStreamID, 1,
+                                                   kAudioServerPlugInIOOperationReadInput, frames, &cycle, buffer, NULL),
+                         kAudioHardwareNoError);
+        cycle.mIOCycleCounter++;
+        cycle.mInputTime.mSampleTime += frames;
+    }
+
+    CFPropertyListRef data = NULL;
+    UInt32 size = 0;
+    ENGRAM_EXPECT_EQ(GetProperty(kEngramPropertyStats, sizeof(data), &size, &data), kAudioHardwareNoError);
+    ENGRAM_EXPECT(data != NULL);
+    if (data != NULL) {
+        ENGRAM_EXPECT_EQ(CFDataGetLength((CFDataRef)data), (CFIndex)sizeof(EngramStatsSnapshot));
+        const EngramStatsSnapshot* snapshot = (const EngramStatsSnapshot*)CFDataGetBytePtr((CFDataRef)data);
+        ENGRAM_EXPECT_EQ(snapshot->ioCycles, 2u);
+        ENGRAM_EXPECT_EQ(snapshot->underruns, 1u);
+        ENGRAM_EXPECT_EQ(snapshot->underrunSamples, frames * kEngramChannels);
+        // Only the cycle that got samples has a residency to report
+        ENGRAM_EXPECT_EQ(snapshot->queueResidencyNs.count, 1u);
+        CFRelease(data);
+    }
+
+    ENGRAM_EXPECT_EQ(gInterface->StopIO(NULL, gDevice.objectID, 1), kAudioHardwareNoError);
+    ENGRAM_EXPECT_EQ(gInterface->StopIO(NULL, gDevice.objectID, 1), kAudioHardwareIllegalOperationError);
+}
+
+static void TestZeroTimeStampDuringRestarts(void) {
+    // Each first StartIO publishes a new anchor and seed while a reader keeps
+    // asking; every answer must be a whole number of periods after one of the
+    // anchors, and carry that anchor's seed
+    const UInt32 restarts = 200;
+    const UInt32 capacity = 1 << 16;
+    static UInt64 anchors[restarts + 1];
+    static UInt64 seeds[restarts + 1];
+    static UInt64 seen[capacity];
+    static UInt64 seenSeeds[capacity];
+    EngramClockConfig clock = EngramSeqlock_Read(&gDevice.clock);
+    Float64 periodTicks = clock.hostTicksPerFrame * (Float64)clock.periodFrames;
+    anchors[0] = clock.anchorHostTime;
+    seeds[0] = clock.seed;
+
+    std::atomic<Boolean> started(false);
+    std::atomic<Boolean> done(false);
+    UInt32 answers = 0;
+    UInt32 offPeriod = 0;
+    std::thread reader([&]() {
+        while (!done.load() && answers < capacity) {
+            Float64 sampleTime = -1.0;
+            UInt64 hostTime = 0;
+            UInt64 seed = 0;
+            gInterface->GetZeroTimeStamp(NULL, gDevice.objectID, 1, &sampleTime, &hostTime, &seed);
+            UInt64 periods = (UInt64)sampleTime / clock.periodFrames;
+            offPeriod += ((UInt64)sampleTime % clock.periodFrames != 0);
+            seenSeeds[answers] = seed;
+            seen[answers++] = hostTime - (UInt64)((Float64)periods * periodTicks);
+            started.store(true);
+        }
+    });
+    while (!started.load()) {
+        usleep(100);
+    }
+    for (UInt32 i = 1; i <= restarts; i++) {
+        ENGRAM_EXPECT_EQ(gInterface->StartIO(NULL, gDevice.objectID, 1), kAudioHardwareNoError);
+        EngramClockConfig restarted = EngramSeqlock_Read(&gDevice.clock);
+        anchors[i] = restarted.anchorHostTime;
+        seeds[i] = restarted.seed;
+        ENGRAM_EXPECT(seeds[i] != seeds[i - 1]);
+        ENGRAM_EXPECT_EQ(gInterface->StopIO(NULL, gDevice.objectID, 1), kAudioHardwareNoError);
+    }
+    done.store(true);
+    reader.join();
+
+    UInt32 unknown = 0;
+    for (UInt32 answer = 0; answer < answers; answer++) {
+        Boolean known = false;
+        for (UInt32 i = 0; i <= restarts && !known; i++) {
+            known = (anchors[i] == seen[answer] && seeds[i] == seenSeeds[answer]);
+        }
+        unknown += !known;
+    }
+    ENGRAM_EXPECT(answers > 0);
+    ENGRAM_EXPECT_EQ(offPeriod, 0u);
+    ENGRAM_EXPECT_EQ(unknown, 0u);
+}
+
+static void TestProducerSleepsUntilStartIO(void) {
+    // Nothing is running, so a producer has nothing to wait for
+    ENGRAM_EXPECT(!EngramDevice_WaitForIO(1000000));
+
+    // A parked producer must be running again well inside one IO cycle. The
+    // median is checked: on a loaded machine (parallel ctest) the scheduler
+    // can hold up any single wake-up, whatever the plugin does.
+    const UInt64 cycleNanos = (UInt64)(512 * 1.0e9 / kEngramSampleRate);
+    const UInt32 trials = 20;
+    UInt64 wakes[trials];
+    for (UInt32 trial = 0; trial < trials; trial++) {
+        std::atomic<Boolean> parked(false);
+        std::atomic<UInt64> wokeAt(0);
+        std::thread producer([&parked, &wokeAt]() {
+            parked.store(true);
+            if (EngramDevice_WaitForIO(0)) {
+                wokeAt.store(EngramWait_Now());
+            }
+        });
+        while (!parked.load()) {
+            usleep(100);
+        }
+        usleep(2000);
+        ENGRAM_EXPECT_EQ(wokeAt.load(), 0u);
+
+        UInt64 started = EngramWait_Now();
+        ENGRAM_EXPECT_EQ(gInterface->StartIO(NULL, gDevice.objectID, 1), kAudioHardwareNoError);
+        producer.join();
+        ENGRAM_EXPECT(wokeAt.load() >= started);
+        wakes[trial] = wokeAt.load() - started;
+        ENGRAM_EXPECT_EQ(gInterface->StopIO(NULL, gDevice.objectID, 1), kAudioHardwareNoError);
+    }
+    std::sort(wakes, wakes + trials);
+    ENGRAM_EXPECT(wakes[trials / 2] < cycleNanos);
+    printf("  median wake-up %llu ns, worst %llu ns (cycle %llu ns)\n", (unsigned long long)wakes[trials / 2],
+           (unsigned long long)wakes[trials - 1], (unsigned long long)cycleNanos);
+}
+
+static void TestStatsPageMirrorsTheGate(void) {
+    EngramStatsPage* page = gDevice.stats;
+    ENGRAM_EXPECT(page != NULL && !EngramStats_IOActive(page));
+
+    ENGRAM_EXPECT_EQ(gInterface->StartIO(NULL, gDevice.objectID, 1), kAudioHardwareNoError);
+    ENGRAM_EXPECT(EngramStats_IOActive(page));
+    ENGRAM_EXPECT_EQ(page->ioActivations.load(), gDevice.ioGate.activations.load());
+
+    // Whatever lands in the page, the plugin's own gate decides
+    page->ioClients.store(0);
+    ENGRAM_EXPECT(EngramDevice_WaitForIO(1000000));
+    ENGRAM_EXPECT_EQ(gInterface->StopIO(NULL, gDevice.objectID, 1), kAudioHardwareNoError);
+    ENGRAM_EXPECT(!EngramStats_IOActive(page));
+    ENGRAM_EXPECT(!EngramDevice_WaitForIO(1000000));
+}
+
+static OSStatus ReadCycle(UInt32 frames, UInt64 cycle) {
+    static Float32 buffer[1024 * kEngramChannels];
+    AudioServerPlugInIOCycleInfo cycleInfo;
+    memset(&cycleInfo, 0, sizeof(cycleInfo));
+    cycleInfo.mIOCycleCounter = cycle;
+    return gInterface->DoIOOperation(NULL, gDevice.objectID, gDevice.inputStreamID, 1,
+                                     kAudioServerPlugInIOOperationReadInput, frames, &cycleInfo, buffer, NULL);
+}
+
+static void TestIOLeavesFloatingPointControl(void) {
+    // The IO path flushes denormals while it runs and hands the host thread
+    // back its own setting
+    const UInt64 bits = kEngramDenormalControlBits;
+    UInt64 original = EngramDenormal_GetControl();
+    EngramDenormal_SetControl(original & ~bits);
+    static Float32 buffer[256 * kEngramChannels];
+    memset(buffer, 0, sizeof(buffer));
+
+    ENGRAM_EXPECT_EQ(gInterface->StartIO(NULL, gDevice.objectID, 1), kAudioHardwareNoError);
+    ENGRAM_EXPECT_EQ(ReadCycle(256, 1), kAudioHardwareNoError);
+    ENGRAM_EXPECT_EQ(EngramDenormal_GetControl() & bits, 0u);
+    AudioServerPlugInIOCycleInfo cycleInfo;
+    memset(&cycleInfo, 0, sizeof(cycleInfo));
+    cycleInfo.mIOCycleCounter = 1;
+    ENGRAM_EXPECT_EQ(gInterface->DoIOOperation(NULL, gDevice.objectID, gDevice.outputStreamID, 1,
+                                               kAudioServerPlugInIOOperationWriteMix, 256, &cycleInfo, buffer, NULL),
+                     kAudioHardwareNoError);
+    ENGRAM_EXPECT_EQ(EngramDenormal_GetControl() & bits, 0u);
+    ENGRAM_EXPECT_EQ(gInterface->StopIO(NULL, gDevice.objectID, 1), kAudioHardwareNoError);
+
+    EngramDenormal_SetControl(original);
+    static Float32 scratch[1024 * kEngramChannels];
+    while (EngramDevice_ReadOutput(scratch, 1024 * kEngramChannels) > 0) {
+    }
+}
+
+static void TestLowWaterWakesProducer(void) {
+    ENGRAM_EXPECT_EQ(gInterface->StartIO(NULL, gDevice.objectID, 1), kAudioHardwareNoError);
+    static Float32 block[1024 * kEngramChannels];
+    ENGRAM_EXPECT_EQ(EngramDevice_WriteInput(block, 1024 * kEngramChannels), 1024u * kEngramChannels);
+
+    // Already below the threshold: no sleep at all
+    ENGRAM_EXPECT(EngramDevice_WaitForLowWater(2048, 0));
+    ENGRAM_EXPECT(!EngramDevice_WaitForLowWater(512, 1000000));
+    UInt64 signalsBefore = gDevice.stats->lowWaterSignals.load();
+
+    std::atomic<Boolean> parked(false);
+    std::atomic<UInt64> wokeAt(0);
+    std::thread producer([&parked, &wokeAt]() {
+        parked.store(true);
+        if (EngramDevice_WaitForLowWater(512, 0)) {
+            wokeAt.store(EngramWait_Now());
+        }
+    });
+    while (!parked.load()) {
+        usleep(100);
+    }
+    usleep(2000);
+
+    // 768 frames left is still above the mark; 256 is below it
+    ENGRAM_EXPECT_EQ(ReadCycle(256, 1), kAudioHardwareNoError);
+    usleep(2000);
+    ENGRAM_EXPECT_EQ(wokeAt.load(), 0u);
+    UInt64 crossed = EngramWait_Now();
+    ENGRAM_EXPECT_EQ(ReadCycle(512, 2), kAudioHardwareNoError);
+    producer.join();
+    // Woken by that read, not by a timer; how soon is TestProducerSleepsUntilStartIO's business
+    ENGRAM_EXPECT(wokeAt.load() >= crossed);
+    ENGRAM_EXPECT_EQ(gDevice.stats->lowWaterSignals.load(), signalsBefore + 1);
+
+    // Nobody waits any more, so further low cycles make no wake calls
+    ENGRAM_EXPECT_EQ(ReadCycle(512, 3), kAudioHardwareNoError);
+    ENGRAM_EXPECT_EQ(gDevice.stats->lowWaterSignals.load(), signalsBefore + 1);
+
+    // The last StopIO sends a waiting producer back to the IO gate
+    ENGRAM_EXPECT_EQ(EngramDevice_WriteInput(block, 1024 * kEngramChannels), 1024u * kEngramChannels);
+    std::atomic<Boolean> result(true);
+    parked.store(false);
+    std::thread stopped([&parked, &result]() {
+        parked.store(true);
+        result.store(EngramDevice_WaitForLowWater(512, 0));
+    });
+    while (!parked.load()) {
+        usleep(100);
+    }
+    usleep(2000);
+    ENGRAM_EXPECT_EQ(gInterface->StopIO(NULL, gDevice.objectID, 1), kAudioHardwareNoError);
+    stopped.join();
+    ENGRAM_EXPECT(!result.load());
+    ENGRAM_EXPECT(!EngramDevice_WaitForLowWater(512, 0));
+}
+
+static void DrainRing(void) {
+    static Float32 scratch[1024 * kEngramChannels];
+    while (EngramRingBuffer_Read(&gDevice.ringBuffer, scratch, 1024 * kEngramChannels) > 0) {
+    }
+}
+
+static OSStatus SetLowWater(UInt32 frames) {
+    AudioObjectPropertyAddress address = { kEngramPropertyLowWater, kAudioObjectPropertyScopeGlobal, kAudioObjectPropertyElementMain };
+    CFDataRef data = CFDataCreate(NULL, (const UInt8*)&frames, sizeof(frames));
+    CFPropertyListRef value = data;
+    OSStatus status = gInterface->SetPropertyData(NULL, gDevice.objectID, 0, &address, 0, NULL, sizeof(value), &value);
+    CFRelease(data);
+    return status;
+}
+
+// Sleeps the way a producer in another process does; true once the sequence moves on
+static Boolean SleepOnSequence(const std::atomic<UInt32>* sequenceWord, UInt32 sequence) {
+    UInt64 deadline = EngramWait_Now() + 1000000000ull;
+    while (sequenceWord->load() == sequence && EngramWait_Now() < deadline) {
+        EngramWait_WhileEqual(sequenceWord, sequence, 100000000ull);
+    }
+    return sequenceWord->load() != sequence;
+}
+
+static void TestLowWaterPropertyWakesOtherProcesses(void) {
+    // Such a producer only has the page read-only, so it arms through the property
+    const EngramStatsPage* mapped = EngramStats_MapSharedPageReadOnly(gDevice.statsShared.name);
+    const EngramStatsPage* page = (mapped != NULL) ? mapped : gDevice.stats;
+    ENGRAM_EXPECT(page != NULL);
+
+    // Stopped: nothing reads the ring, so the producer belongs on the IO gate
+    ENGRAM_EXPECT_EQ(SetLowWater(512), kAudioHardwareNotRunningError);
+
+    ENGRAM_EXPECT_EQ(gInterface->StartIO(NULL, gDevice.objectID, 1), kAudioHardwareNoError);
+    DrainRing();
+    static Float32 block[1024 * kEngramChannels];
+    ENGRAM_EXPECT_EQ(EngramDevice_WriteInput(block, 1024 * kEngramChannels), 1024u * kEngramChannels);
+    UInt64 signalsBefore = page->lowWaterSignals.load();
+
+    std::atomic<Boolean> parked(false);
+    std::atomic<Boolean> woke(false);
+    std::atomic<OSStatus> armed(kAudioHardwareUnspecifiedError);
+    std::thread producer([page, &parked, &woke, &armed]() {
+        UInt32 sequence = page->lowWaterSequence.load();
+        armed.store(SetLowWater(512));
+        parked.store(true);
+        woke.store(SleepOnSequence(&page->lowWaterSequence, sequence));
+    });
+    while (!parked.load()) {
+        usleep(100);
+    }
+    ENGRAM_EXPECT_EQ(armed.load(), kAudioHardwareNoError);
+    ENGRAM_EXPECT_EQ(page->lowWaterFrames.load(), 512u);
+
+    // 768 frames left is still above the mark; 256 is below it
+    ENGRAM_EXPECT_EQ(ReadCycle(256, 1), kAudioHardwareNoError);
+    usleep(2000);
+    ENGRAM_EXPECT(!woke.load());
+    ENGRAM_EXPECT_EQ(ReadCycle(512, 2), kAudioHardwareNoError);
+    producer.join();
+    ENGRAM_EXPECT(woke.load());
+    ENGRAM_EXPECT_EQ(page->lowWaterSignals.load(), signalsBefore + 1);
+
+    // Arming below the mark wakes at once, without waiting for a read
+    UInt32 sequence = page->lowWaterSequence.load();
+    ENGRAM_EXPECT_EQ(SetLowWater(512), kAudioHardwareNoError);
+    ENGRAM_EXPECT(page->lowWaterSequence.load() != sequence);
+
+    // 0 disarms, and malformed marks are refused
+    sequence = page->lowWaterSequence.load();
+    ENGRAM_EXPECT_EQ(SetLowWater(0), kAudioHardwareNoError);
+    ENGRAM_EXPECT_EQ(ReadCycle(256, 3), kAudioHardwareNoError);
+    ENGRAM_EXPECT_EQ(page->lowWaterSequence.load(), sequence);
+    AudioObjectPropertyAddress address = { kEngramPropertyLowWater, kAudioObjectPropertyScopeGlobal, kAudioObjectPropertyElementMain };
+    CFPropertyListRef wrongType = kCFBooleanTrue;
+    ENGRAM_EXPECT_EQ(gInterface->SetPropertyData(NULL, gDevice.objectID, 0, &address, 0, NULL, sizeof(wrongType), &wrongType),
+                     kAudioHardwareIllegalOperationError);
+
+    ENGRAM_EXPECT_EQ(gInterface->StopIO(NULL, gDevice.objectID, 1), kAudioHardwareNoError);
+    if (mapped != NULL) {
+        munmap((void*)mapped, sizeof(EngramStatsPage));
+    }
+}
+
+static OSStatus PullCycle(UInt32 frames, UInt64 cycle, Float32* buffer) {
+    AudioServerPlugInIOCycleInfo cycleInfo;
+    memset(&cycleInfo, 0, sizeof(cycleInfo));
+    cycleInfo.mIOCycleCounter = cycle;
+    cycleInfo.mInputTime.mSampleTime = (Float64)((cycle - 1) * frames);
+    OSStatus status = gInterface->BeginIOOperation(NULL, gDevice.objectID, 1, kAudioServerPlugInIOOperationReadInput,
+                                                   frames, &cycleInfo);
+    if (status == kAudioHardwareNoError) {
+        status = gInterface->DoIOOperation(NULL, gDevice.objectID, gDevice.inputStreamID, 1,
+                                           kAudioServerPlugInIOOperationReadInput, frames, &cycleInfo, buffer, NULL);
+    }
+    return status;
+}
+
+static void TestPullModeRendersOnDemand(void) {
+    const UInt32 frames = 256;
+    static Float32 buffer[frames * kEngramChannels];
+    static Float32 expected[frames * kEngramChannels];
+    static EngramDSPChain reference;
+    EngramDSPChain_Init(&reference, kEngramSampleRate, kEngramChannels, kEngramDefaultDSPStages);
+
+    DrainRing();
+    ENGRAM_EXPECT_EQ(gInterface->StartIO(NULL, gDevice.objectID, 1), kAudioHardwareNoError);
+    EngramDevice_SetPullMode(true);
+    UInt64 renderedBefore = gDevice.stats->renderCycles.load();
+    UInt64 missesBefore = gDevice.stats->renderMisses.load();
+
+    // The producer renders each cycle's frames from its sample time, nothing ahead
+    std::atomic<UInt32> rendered(0);
+    std::thread producer([&rendered]() {
+        EngramRenderRequest request;
+        while (EngramDevice_WaitForRenderRequest(&request, 0)) {
+            for (UInt32 i = 0; i < request.frames * request.channels; i++) {
+                request.buffer[i] = 0.5f * sinf((Float32)(request.sampleTime + i / request.channels) * 0.01f);
+            }
+            EngramDevice_CompleteRender(&request);
+            rendered++;
+        }
+    });
+
+    const UInt64 cycles = 20;
+    Boolean inStep = true;
+    for (UInt64 cycle = 1; cycle <= cycles; cycle++) {
+        ENGRAM_EXPECT_EQ(PullCycle(frames, cycle, buffer), kAudioHardwareNoError);
+        Float64 sampleTime = (Float64)((cycle - 1) * frames);
+        for (UInt32 i = 0; i < frames * kEngramChannels; i++) {
+            expected[i] = 0.5f * sinf((Float32)(sampleTime + i / kEngramChannels) * 0.01f);
+        }
+        EngramDSPChain_ProcessGeneric(&reference, expected, frames);
+
+        // A loaded machine may deschedule the producer past the budget; the
+        // DSP state diverges from the reference after such a miss
+        inStep = inStep && gDevice.stats->renderCycles.load() - renderedBefore == cycle;
+        for (UInt32 i = 0; inStep && i < frames * kEngramChannels; i++) {
+            ENGRAM_EXPECT_NEAR(buffer[i], expected[i], 1e-6);
+        }
+    }
+    // Nothing went through the ring
+    ENGRAM_EXPECT_EQ(EngramRingBuffer_GetAvailableRead(&gDevice.ringBuffer), 0u);
+
+    // The last StopIO sends the producer home
+    ENGRAM_EXPECT_EQ(gInterface->StopIO(NULL, gDevice.objectID, 1), kAudioHardwareNoError);
+    producer.join();
+    UInt64 hits = gDevice.stats->renderCycles.load() - renderedBefore;
+    UInt64 misses = gDevice.stats->renderMisses.load() - missesBefore;
+    ENGRAM_EXPECT_EQ(hits + misses, cycles);
+    ENGRAM_EXPECT(hits > 0 && rendered.load() >= hits);
+    ENGRAM_EXPECT(gDevice.stats->renderWaitNs.count.load() >= cycles);
+    EngramDevice_SetPullMode(false);
+}
+
+static void TestPullModeMissFallsBackToRing(void) {
+    const UInt32 frames = 256;
+    static Float32 buffer[frames * kEngramChannels];
+    static Float32 produced[frames * kEngramChannels];
+    for (UInt32 i = 0; i < frames * kEngramChannels; i++) {
+        produced[i] = 0.25f;
+    }
+
+    DrainRing();
+    ENGRAM_EXPECT_EQ(gInterface->StartIO(NULL, gDevice.objectID, 1), kAudioHardwareNoError);
+    EngramDevice_SetPullMode(true);
+    ENGRAM_EXPECT_EQ(EngramDevice_WriteInput(produced, frames * kEngramChannels), frames * kEngramChannels);
+    UInt64 missesBefore = gDevice.stats->renderMisses.load();
+    UInt64 underrunsBefore = gDevice.stats->underruns.load();
+
+    // No producer answers: the cycle waits half a cycle at most, then reads the ring
+    UInt64 cycleNanos = (UInt64)((Float64)frames * 1.0e9 / kEngramSampleRate);
+    UInt64 start = EngramWait_Now();
+    ENGRAM_EXPECT_EQ(PullCycle(frames, 1, buffer), kAudioHardwareNoError);
+    UInt64 elapsed = EngramWait_Now() - start;
+    ENGRAM_EXPECT(elapsed >= cycleNanos / kEngramRenderBudgetDivisor);
+    ENGRAM_EXPECT(elapsed < 100 * cycleNanos);
+    ENGRAM_EXPECT_EQ(gDevice.stats->renderMisses.load(), missesBefore + 1);
+    ENGRAM_EXPECT_EQ(gDevice.stats->underruns.load(), underrunsBefore);
+    ENGRAM_EXPECT_EQ(EngramRingBuffer_GetAvailableRead(&gDevice.ringBuffer), 0u);
+
+    // Out of pull mode nothing is requested and nothing waits
+    EngramDevice_SetPullMode(false);
+    EngramRenderRequest request;
+    ENGRAM_EXPECT(!EngramDevice_WaitForRenderRequest(&request, 0));
+    ENGRAM_EXPECT_EQ(PullCycle(frames, 2, buffer), kAudioHardwareNoError);
+    ENGRAM_EXPECT_EQ(gDevice.stats->renderMisses.load(), missesBefore + 1);
+    ENGRAM_EXPECT_EQ(gInterface->StopIO(NULL, gDevice.objectID, 1), kAudioHardwareNoError);
+}
+
+static void TestQueueResidencyUsesProducerStamp(void) {
+    const UInt32 frames = 256;
+    static Float32 block[frames * kEngramChannels];
+    DrainRing();
+    ENGRAM_EXPECT_EQ(gInterface->StartIO(NULL, gDevice.objectID, 1), kAudioHardwareNoError);
+    UInt64 countBefore = gDevice.stats->queueResidencyNs.count.load();
+
+    // Captured 20 ms before it was handed over
+    struct mach_timebase_info timebase;
+    mach_timebase_info(&timebase);
+    UInt64 ticks = (UInt64)(20.0e6 * timebase.denom / timebase.numer);
+    ENGRAM_EXPECT_EQ(EngramDevice_WriteInputAt(block, frames * kEngramChannels, mach_absolute_time() - ticks),
+                     frames * kEngramChannels);
+    ENGRAM_EXPECT_EQ(ReadCycle(frames, 1), kAudioHardwareNoError);
+
+    ENGRAM_EXPECT_EQ(gDevice.stats->queueResidencyNs.count.load(), countBefore + 1);
+    ENGRAM_EXPECT(gDevice.stats->queueResidencyNs.max.load() >= 20000000u);
+    ENGRAM_EXPECT_EQ(gInterface->StopIO(NULL, gDevice.objectID, 1), kAudioHardwareNoError);
+}
+
+static void TestDeclaredOperations(void) {
+    static const struct {
+        UInt32 operation;
+        Boolean willDo;
+    } kExpected[] = {
+        { kAudioServerPlugInIOOperationReadInput, true },
+        { kAudioServerPlugInIOOperationConvertInput, false },
+        { kAudioServerPlugInIOOperationProcessInput, true },
+        { kAudioServerPlugInIOOperationProcessOutput, true },
+        { kAudioServerPlugInIOOperationMixOutput, false },
+        { kAudioServerPlugInIOOperationProcessMix, false },
+        { kAudioServerPlugInIOOperationConvertMix, false },
+        { kAudioServerPlugInIOOperationWriteMix, true }
+    };
+    for (UInt32 i = 0; i < sizeof(kExpected) / sizeof(kExpected[0]); i++) {
+        Boolean willDo = !kExpected[i].willDo;
+        Boolean inPlace = false;
+        ENGRAM_EXPECT_EQ(gInterface->WillDoIOOperation(NULL, gDevice.objectID, 1, kExpected[i].operation, &willDo, &inPlace),
+                         kAudioHardwareNoError);
+        ENGRAM_EXPECT_EQ(willDo, kExpected[i].willDo);
+        ENGRAM_EXPECT(inPlace);
+    }
+}
+
+static OSStatus OutputCycle(UInt32 operation, UInt32 frames, UInt64 cycle, Float32* buffer, Float32* secondary) {
+    AudioServerPlugInIOCycleInfo cycleInfo;
+    memset(&cycleInfo, 0, sizeof(cycleInfo));
+    cycleInfo.mIOCycleCounter = cycle;
+    return gInterface->DoIOOperation(NULL, gDevice.objectID, gDevice.outputStreamID, 1,
+                                     operation, frames, &cycleInfo, buffer, secondary);
+}
+
+static void DrainOutput(void) {
+    static Float32 scratch[1024 * kEngramChannels];
+    while (EngramDevice_ReadOutput(scratch, 1024 * kEngramChannels) > 0) {
+    }
+}
+
+static void TestWriteMixReachesSpeakerSide(void) {
+    const UInt32 frames = 256;
+    static Float32 mix[frames * kEngramChannels];
+    static Float32 expected[frames * kEngramChannels];
+    static Float32 heard[frames * kEngramChannels];
+    static EngramDSPChain reference;
+    EngramDSPChain_Init(&reference, kEngramSampleRate, kEngramChannels, kEngramDefaultDSPStages);
+    DrainOutput();
+    ENGRAM_EXPECT_EQ(gInterface->StartIO(NULL, gDevice.objectID, 1), kAudioHardwareNoError);
+    UInt64 cyclesBefore = gDevice.stats->mixCycles.load();
+
+    for (UInt64 cycle = 1; cycle <= 4; cycle++) {
+        for (UInt32 i = 0; i < frames * kEngramChannels; i++) {
+            mix[i] = 0.25f + 0.5f * sinf(0.01f * (Float32)(cycle * frames * kEngramChannels + i));
+        }
+        memcpy(expected, mix, sizeof(mix));
+        EngramDSPChain_Process(&reference, expected, frames);
+
+        // Processed in place: the mix buffer itself carries the result
+        ENGRAM_EXPECT_EQ(OutputCycle(kAudioServerPlugInIOOperationWriteMix, frames, cycle, mix, NULL), kAudioHardwareNoError);
+        ENGRAM_EXPECT_EQ(memcmp(mix, expected, sizeof(mix)), 0);
+        ENGRAM_EXPECT_EQ(EngramDevice_ReadOutput(heard, frames * kEngramChannels), frames * kEngramChannels);
+        ENGRAM_EXPECT_EQ(memcmp(heard, expected, sizeof(heard)), 0);
+    }
+    ENGRAM_EXPECT_EQ(gDevice.stats->mixCycles.load(), cyclesBefore + 4);
+    ENGRAM_EXPECT_EQ(EngramDevice_ReadOutput(heard, frames * kEngramChannels), 0u);
+
+    // A separate destination leaves the source alone
+    static Float32 source[frames * kEngramChannels];
+    static Float32 destination[frames * kEngramChannels];
+    for (UInt32 i = 0; i < frames * kEngramChannels; i++) {
+        source[i] = (i & 1) ? 0.5f : -0.5f;
+    }
+    memcpy(expected, source, sizeof(source));
+    EngramDSPChain_Process(&reference, expected, frames);
+    ENGRAM_EXPECT_EQ(OutputCycle(kAudioServerPlugInIOOperationWriteMix, frames, 5, source, destination), kAudioHardwareNoError);
+    ENGRAM_EXPECT_EQ(source[0], -0.5f);
+    ENGRAM_EXPECT_EQ(memcmp(destination, expected, sizeof(destination)), 0);
+    ENGRAM_EXPECT_EQ(EngramDevice_ReadOutput(heard, frames * kEngramChannels), frames * kEngramChannels);
+    ENGRAM_EXPECT_EQ(memcmp(heard, expected, sizeof(heard)), 0);
+
+    ENGRAM_EXPECT_EQ(gInterface->StopIO(NULL, gDevice.objectID, 1), kAudioHardwareNoError);
+}
+
+static void TestUndrainedMixIsDropped(void) {
+    const UInt32 frames = 512;
+    static Float32 mix[frames * kEngramChannels];
+    DrainOutput();
+    ENGRAM_EXPECT_EQ(gInterface->StartIO(NULL, gDevice.objectID, 1), kAudioHardwareNoError);
+    UInt64 droppedBefore = gDevice.stats->mixOverrunSamples.load();
+
+    // Nobody reads: the ring fills, then whole cycles are dropped, never waited on
+    UInt32 cycles = kEngramOutputRingSize / (frames * kEngramChannels) + 2;
+    for (UInt32 cycle = 1; cycle <= cycles; cycle++) {
+        memset(mix, 0, sizeof(mix));
+        ENGRAM_EXPECT_EQ(OutputCycle(kAudioServerPlugInIOOperationWriteMix, frames, cycle, mix, NULL), kAudioHardwareNoError);
+    }
+    ENGRAM_EXPECT(gDevice.stats->mixOverrunSamples.load() - droppedBefore >= frames * kEngramChannels);
+    DrainOutput();
+    ENGRAM_EXPECT_EQ(gInterface->StopIO(NULL, gDevice.objectID, 1), kAudioHardwareNoError);
+}
+
+static void TestProcessOutputScrubsNonFinite(void) {
+    const UInt32 frames = 64;
+    static Float32 client[frames * kEngramChannels];
+    for (UInt32 i = 0; i < frames * kEngramChannels; i++) {
+        client[i] = 0.125f;
+    }
+    client[3] = NAN;
+    client[10] = INFINITY;
+    client[11] = -INFINITY;
+    UInt64 scrubbedBefore = gDevice.stats->outputSamplesScrubbed.load();
+
+    ENGRAM_EXPECT_EQ(OutputCycle(kAudioServerPlugInIOOperationProcessOutput, frames, 1, client, NULL), kAudioHardwareNoError);
+    ENGRAM_EXPECT_EQ(client[3], 0.0f);
+    ENGRAM_EXPECT_EQ(client[10], 0.0f);
+    ENGRAM_EXPECT_EQ(client[11], 0.0f);
+    ENGRAM_EXPECT_EQ(client[4], 0.125f);
+    ENGRAM_EXPECT_EQ(gDevice.stats->outputSamplesScrubbed.load(), scrubbedBefore + 3);
+
+    // Per-client processing never reaches the speaker side; only WriteMix does
+    static Float32 heard[frames * kEngramChannels];
+    ENGRAM_EXPECT_EQ(EngramDevice_ReadOutput(heard, frames * kEngramChannels), 0u);
+}
+
+static OSStatus ClientCycle(UInt32 clientID, UInt32 operation, UInt32 frames, UInt64 cycle, Float32* buffer) {
+    AudioServerPlugInIOCycleInfo cycleInfo;
+    memset(&cycleInfo, 0, sizeof(cycleInfo));
+    cycleInfo.mIOCycleCounter = cycle;
+    return gInterface->DoIOOperation(NULL, gDevice.objectID, kAudioObjectUnknown, clientID,
+                                     operation, frames, &cycleInfo, buffer, NULL);
+}
+
+static void TestClientsShareOneInputCycle(void) {
+    const UInt32 frames = 128;
+    static Float32 produced[2 * frames * kEngramChannels];
+    static Float32 heard[2][frames * kEngramChannels];
+    for (UInt32 i = 0; i < 2 * frames * kEngramChannels; i++) {
+        produced[i] = 0.1f * sinf(0.01f * (Float32)i);
+    }
+    DrainRing();
+    ENGRAM_EXPECT_EQ(gInterface->StartIO(NULL, gDevice.objectID, 1), kAudioHardwareNoError);
+    ENGRAM_EXPECT_EQ(gInterface->StartIO(NULL, gDevice.objectID, 2), kAudioHardwareNoError);
+    ENGRAM_EXPECT_EQ(EngramDevice_WriteInput(produced, 2 * frames * kEngramChannels), 2u * frames * kEngramChannels);
+    UInt64 cyclesBefore = gDevice.stats->ioCycles.load();
+    UInt64 glitchesBefore = gDevice.stats->glitches.load();
+
+    // Both clients hear the same input; the ring, the detectors and the chain see each cycle once
+    AudioServerPlugInIOCycleInfo cycleInfo;
+    memset(&cycleInfo, 0, sizeof(cycleInfo));
+    for (UInt64 cycle = 1; cycle <= 2; cycle++) {
+        cycleInfo.mIOCycleCounter = cycle;
+        cycleInfo.mInputTime.mSampleTime = (Float64)((cycle - 1) * frames);
+        for (UInt32 c = 0; c < 2; c++) {
+            ENGRAM_EXPECT_EQ(gInterface->DoIOOperation(NULL, gDevice.objectID, gDevice.inputStreamID, c + 1,
+                                                       kAudioServerPlugInIOOperationReadInput, frames, &cycleInfo, heard[c], NULL),
+                             kAudioHardwareNoError);
+        }
+        ENGRAM_EXPECT_EQ(memcmp(heard[0], heard[1], sizeof(heard[0])), 0);
+        ENGRAM_EXPECT_EQ(EngramRingBuffer_GetAvailableRead(&gDevice.ringBuffer), (2 - (UInt32)cycle) * frames * kEngramChannels);
+    }
+    ENGRAM_EXPECT_EQ(gDevice.stats->ioCycles.load(), cyclesBefore + 2);
+    ENGRAM_EXPECT_EQ(gDevice.stats->glitches.load(), glitchesBefore);
+
+    ENGRAM_EXPECT_EQ(gInterface->StopIO(NULL, gDevice.objectID, 2), kAudioHardwareNoError);
+    ENGRAM_EXPECT_EQ(gInterface->StopIO(NULL, gDevice.objectID, 1), kAudioHardwareNoError);
+}
+
+static void TestOversizedCycleIsRefused(void) {
+    static Float32 heard[2][(kEngramMaxIOBufferFrames + 1) * kEngramChannels];
+    ENGRAM_EXPECT_EQ(gInterface->StartIO(NULL, gDevice.objectID, 1), kAudioHardwareNoError);
+    ENGRAM_EXPECT_EQ(gInterface->StartIO(NULL, gDevice.objectID, 2), kAudioHardwareNoError);
+    UInt64 cyclesBefore = gDevice.stats->ioCycles.load();
+
+    // The largest advertised size is still read once and shared
+    ENGRAM_EXPECT_EQ(ClientCycle(1, kAudioServerPlugInIOOperationReadInput, kEngramMaxIOBufferFrames, 1, heard[0]), kAudioHardwareNoError);
+    ENGRAM_EXPECT_EQ(ClientCycle(2, kAudioServerPlugInIOOperationReadInput, kEngramMaxIOBufferFrames, 1, heard[1]), kAudioHardwareNoError);
+    ENGRAM_EXPECT_EQ(gDevice.stats->ioCycles.load(), cyclesBefore + 1);
+
+    // One frame more is turned away with silence, not read once per client
+    for (UInt32 i = 0; i < (kEngramMaxIOBufferFrames + 1) * kEngramChannels; i++) {
+        heard[0][i] = 1.0f;
+    }
+    ENGRAM_EXPECT_EQ(ClientCycle(1, kAudioServerPlugInIOOperationReadInput, kEngramMaxIOBufferFrames + 1, 2, heard[0]),
+                     kAudioHardwareIllegalOperationError);
+    ENGRAM_EXPECT_EQ(gDevice.stats->ioCycles.load(), cyclesBefore + 1);
+    Float32 loudest = 0.0f;
+    for (UInt32 i = 0; i < (kEngramMaxIOBufferFrames + 1) * kEngramChannels; i++) {
+        loudest = fmaxf(loudest, fabsf(heard[0][i]));
+    }
+    ENGRAM_EXPECT_EQ(loudest, 0.0f);
+
+    ENGRAM_EXPECT_EQ(gInterface->StopIO(NULL, gDevice.objectID, 2), kAudioHardwareNoError);
+    ENGRAM_EXPECT_EQ(gInterface->StopIO(NULL, gDevice.objectID, 1), kAudioHardwareNoError);
+}
+
+static OSStatus SetLoopback(CFBooleanRef value) {
+    AudioObjectPropertyAddress address = { kEngramPropertyLoopback, kAudioObjectPropertyScopeGlobal, kAudioObjectPropertyElementMain };
+    return gInterface->SetPropertyData(NULL, gDevice.objectID, 0, &address, 0, NULL, sizeof(value), &value);
+}
+
+static void TestLoopbackIsMixMinus(void) {
+    const UInt32 frames = 128;
+    static Float32 played[2][frames * kEngramChannels];
+    static Float32 mix[frames * kEngramChannels];
+    static Float32 heard[2][frames * kEngramChannels];
+    static Float32 expected[2][frames * kEngramChannels];
+    static EngramDSPChain reference;
+    const Float32 levels[2] = { 0.25f, 0.5f };
+
+    CFPropertyListRef value = NULL;
+    UInt32 size = 0;
+    ENGRAM_EXPECT_EQ(GetProperty(kEngramPropertyLoopback, sizeof(value), &size, &value), kAudioHardwareNoError);
+    ENGRAM_EXPECT(value == kCFBooleanFalse);
+    ENGRAM_EXPECT_EQ(SetLoopback(kCFBooleanTrue), kAudioHardwareNoError);
+    ENGRAM_EXPECT_EQ(GetProperty(kEngramPropertyLoopback, sizeof(value), &size, &value), kAudioHardwareNoError);
+    ENGRAM_EXPECT(value == kCFBooleanTrue);
+
+    DrainRing();
+    DrainOutput();
+    ENGRAM_EXPECT_EQ(gInterface->StartIO(NULL, gDevice.objectID, 1), kAudioHardwareNoError);
+    ENGRAM_EXPECT_EQ(gInterface->StartIO(NULL, gDevice.objectID, 2), kAudioHardwareNoError);
+    EngramDSPChain_Init(&reference, kEngramSampleRate, kEngramChannels, kEngramDefaultDSPStages);
+    UInt64 loopbackBefore = gDevice.stats->loopbackCycles.load();
+    UInt64 underrunsBefore = gDevice.stats->underruns.load();
+
+    // Cycle 1: both clients play; the HAL sums them into the mix
+    memset(mix, 0, sizeof(mix));
+    for (UInt32 c = 0; c < 2; c++) {
+        for (UInt32 i = 0; i < frames * kEngramChannels; i++) {
+            played[c][i] = levels[c];
+        }
+        ENGRAM_EXPECT_EQ(ClientCycle(c + 1, kAudioServerPlugInIOOperationProcessOutput, frames, 1, played[c]), kAudioHardwareNoError);
+        for (UInt32 i = 0; i < frames * kEngramChannels; i++) {
+            mix[i] += played[c][i];
+        }
+    }
+    ENGRAM_EXPECT_EQ(ClientCycle(1, kAudioServerPlugInIOOperationWriteMix, frames, 1, mix), kAudioHardwareNoError);
+
+    // Cycle 2: with the ring empty, each client's input is the other's output,
+    // added on top of the one pass of the input chain over the shared input
+    static Float32 shared[frames * kEngramChannels];
+    memset(shared, 0, sizeof(shared));
+    EngramDSPChain_Process(&reference, shared, frames);
+    UInt64 cyclesBefore = gDevice.stats->ioCycles.load();
+    for (UInt32 c = 0; c < 2; c++) {
+        ENGRAM_EXPECT_EQ(ClientCycle(c + 1, kAudioServerPlugInIOOperationReadInput, frames, 2, heard[c]), kAudioHardwareNoError);
+        // The first client's loopback never leaks into what the second one reads
+        ENGRAM_EXPECT_EQ(memcmp(heard[c], shared, sizeof(shared)), 0);
+        ENGRAM_EXPECT_EQ(ClientCycle(c + 1, kAudioServerPlugInIOOperationProcessInput, frames, 2, heard[c]), kAudioHardwareNoError);
+        for (UInt32 i = 0; i < frames * kEngramChannels; i++) {
+            expected[c][i] = shared[i] + levels[1 - c];
+        }
+        ENGRAM_EXPECT_EQ(memcmp(heard[c], expected[c], sizeof(heard[c])), 0);
+    }
+    ENGRAM_EXPECT_EQ(gDevice.stats->loopbackCycles.load(), loopbackBefore + 2);
+    ENGRAM_EXPECT_EQ(gDevice.stats->ioCycles.load(), cyclesBefore + 1);
+
+    // No output in cycle 2, so cycle 3 carries no loopback
+    ENGRAM_EXPECT_EQ(ClientCycle(1, kAudioServerPlugInIOOperationReadInput, frames, 3, heard[0]), kAudioHardwareNoError);
+    ENGRAM_EXPECT_EQ(ClientCycle(1, kAudioServerPlugInIOOperationProcessInput, frames, 3, heard[0]), kAudioHardwareNoError);
+    ENGRAM_EXPECT_EQ(gDevice.stats->loopbackCycles.load(), loopbackBefore + 2);
+    // The empty ring underran once per cycle, not once per client reading it
+    ENGRAM_EXPECT_EQ(gDevice.stats->underruns.load(), underrunsBefore + 2);
+
+    ENGRAM_EXPECT_EQ(gInterface->StopIO(NULL, gDevice.objectID, 2), kAudioHardwareNoError);
+    ENGRAM_EXPECT_EQ(gInterface->StopIO(NULL, gDevice.objectID, 1), kAudioHardwareNoError);
+    ENGRAM_EXPECT_EQ(SetLoopback(kCFBooleanFalse), kAudioHardwareNoError);
+    DrainOutput();
+}
+
+static void TestFeedbackProperty(void) {
+    AudioObjectPropertyAddress address = { kEngramPropertyFeedback, kAudioObjectPropertyScopeGlobal, kAudioObjectPropertyElementMain };
+    Boolean settable = false;
+    ENGRAM_EXPECT_EQ(gInterface->IsPropertySettable(NULL, gDevice.objectID, 0, &address, &settable), kAudioHardwareNoError);
+    ENGRAM_EXPECT(settable);
+
+    // On from the start, with nothing found on the simulator's tone
+    CFPropertyListRef value = NULL;
+    UInt32 size = 0;
+    ENGRAM_EXPECT_EQ(GetProperty(kEngramPropertyFeedback, sizeof(value), &size, &value), kAudioHardwareNoError);
+    ENGRAM_EXPECT(value == kCFBooleanTrue);
+    ENGRAM_EXPECT_EQ(gDevice.stats->feedbackEvents.load(), 0ull);
+    ENGRAM_EXPECT_EQ(gDevice.stats->feedbackGainCut.load(), 0u);
+
+    value = kCFBooleanFalse;
+    ENGRAM_EXPECT_EQ(gInterface->SetPropertyData(NULL, gDevice.objectID, 0, &address, 0, NULL, sizeof(value), &value), kAudioHardwareNoError);
+    ENGRAM_EXPECT(!gDevice.feedback->enabled.load());
+    value = kCFBooleanTrue;
+    ENGRAM_EXPECT_EQ(gInterface->SetPropertyData(NULL, gDevice.objectID, 0, &address, 0, NULL, sizeof(value), &value), kAudioHardwareNoError);
+    ENGRAM_EXPECT(gDevice.feedback->enabled.load());
+}
+
+static void TestTraceDumpIsPrivate(void) {
+    AudioObjectPropertyAddress address = { kEngramPropertyTrace, kAudioObjectPropertyScopeGlobal, kAudioObjectPropertyElementMain };
+    CFPropertyListRef value = kCFBooleanTrue;
+    ENGRAM_EXPECT_EQ(gInterface->SetPropertyData(NULL, gDevice.objectID, 0, &address, 0, NULL, sizeof(value), &value), kAudioHardwareNoError);
+    value = kCFBooleanFalse;
+    ENGRAM_EXPECT_EQ(gInterface->SetPropertyData(NULL, gDevice.objectID, 0, &address, 0, NULL, sizeof(value), &value), kAudioHardwareNoError);
+
+    // Switching tracing off dumps it into the configured directory, for this user only
+    char path[kEngramMaxPathLength];
+    EngramFiles_Join(path, sizeof(path), gDiagnostics, kEngramTraceFileName);
+    struct stat info;
+    ENGRAM_EXPECT(lstat(path, &info) == 0 && S_ISREG(info.st_mode) && (info.st_mode & 0777) == 0600);
+    ENGRAM_EXPECT(lstat(gDiagnostics, &info) == 0 && (info.st_mode & 0777) == 0700);
+}
+
+static void TestAGCProperty(void) {
+    AudioObjectPropertyAddress address = { kEngramPropertyAGC, kAudioObjectPropertyScopeGlobal, kAudioObjectPropertyElementMain };
+    CFPropertyListRef value = NULL;
+    UInt32 size = 0;
+    static Float32 buffer[128 * kEngramChannels];
+
+    // Off by default, so the simulator's reference holds
+    ENGRAM_EXPECT_EQ(GetProperty(kEngramPropertyAGC, sizeof(value), &size, &value), kAudioHardwareNoError);
+    ENGRAM_EXPECT(value == kCFBooleanFalse);
+    ENGRAM_EXPECT_EQ(gDevice.dsp->enabledStages, (UInt32)kEngramDefaultDSPStages);
+
+    // The IO thread picks the stage up at its next cycle
+    value = kCFBooleanTrue;
+    ENGRAM_EXPECT_EQ(gInterface->SetPropertyData(NULL, gDevice.objectID, 0, &address, 0, NULL, sizeof(value), &value), kAudioHardwareNoError);
+    ENGRAM_EXPECT_EQ(GetProperty(kEngramPropertyAGC, sizeof(value), &size, &value), kAudioHardwareNoError);
+    ENGRAM_EXPECT(value == kCFBooleanTrue);
+    ENGRAM_EXPECT_EQ(gInterface->StartIO(NULL, gDevice.objectID, 1), kAudioHardwareNoError);
+    ENGRAM_EXPECT_EQ(ClientCycle(1, kAudioServerPlugInIOOperationReadInput, 128, 1, buffer), kAudioHardwareNoError);
+    ENGRAM_EXPECT_EQ(gDevice.dsp->enabledStages, (UInt32)(kEngramDefaultDSPStages | kEngramDSPStageAGC));
+
+    value = kCFBooleanFalse;
+    ENGRAM_EXPECT_EQ(gInterface->SetPropertyData(NULL, gDevice.objectID, 0, &address, 0, NULL, sizeof(value), &value), kAudioHardwareNoError);
+    ENGRAM_EXPECT_EQ(ClientCycle(1, kAudioServerPlugInIOOperationReadInput, 128, 2, buffer), kAudioHardwareNoError);
+    ENGRAM_EXPECT_EQ(gDevice.dsp->enabledStages, (UInt32)kEngramDefaultDSPStages);
+    ENGRAM_EXPECT_EQ(gInterface->StopIO(NULL, gDevice.objectID, 1), kAudioHardwareNoError);
+}
+
+static void TestRelease(void) {
+    ENGRAM_EXPECT_EQ(gInterface->Release(NULL), 0u);
+}
+
+int main(void) {
+    // Whatever the plugin writes goes into a directory this run removes again
+    char root[kEngramMaxPathLength];
+    ENGRAM_EXPECT(EngramTest_MakeTempDirectory(root, sizeof(root)) != NULL);
+    EngramFiles_Join(gDiagnostics, sizeof(gDiagnostics), root, "diagnostics");
+    setenv(kEngramDiagnosticsDirectoryEnvironment, gDiagnostics, 1);
+
+    ENGRAM_RUN_TEST(TestCreateAndInitialize);
+    ENGRAM_RUN_TEST(TestBasicProperties);
+    ENGRAM_RUN_TEST(TestCustomPropertyList);
+    ENGRAM_RUN_TEST(TestMalformedPropertyQueries);
+    ENGRAM_RUN_TEST(TestReadInputDrainsRing);
+    ENGRAM_RUN_TEST(TestZeroTimeStampDuringRestarts);
+    ENGRAM_RUN_TEST(TestProducerSleepsUntilStartIO);
+    ENGRAM_RUN_TEST(TestStatsPageMirrorsTheGate);
+    ENGRAM_RUN_TEST(TestIOLeavesFloatingPointControl);
+    ENGRAM_RUN_TEST(TestLowWaterWakesProducer);
+    ENGRAM_RUN_TEST(TestLowWaterPropertyWakesOtherProcesses);
+    ENGRAM_RUN_TEST(TestPullModeRendersOnDemand);
+    ENGRAM_RUN_TEST(TestPullModeMissFallsBackToRing);
+    ENGRAM_RUN_TEST(TestQueueResidencyUsesProducerStamp);
+    ENGRAM_RUN_TEST(TestDeclaredOperations);
+    ENGRAM_RUN_TEST(TestWriteMixReachesSpeakerSide);
+    ENGRAM_RUN_TEST(TestUndrainedMixIsDropped);
+    ENGRAM_RUN_TEST(TestProcessOutputScrubsNonFinite);
+    ENGRAM_RUN_TEST(TestClientsShareOneInputCycle);
+    ENGRAM_RUN_TEST(TestOversizedCycleIsRefused);
+    ENGRAM_RUN_TEST(TestLoopbackIsMixMinus);
+    ENGRAM_RUN_TEST(TestFeedbackProperty);
+    ENGRAM_RUN_TEST(TestAGCProperty);
+    ENGRAM_RUN_TEST(TestTraceDumpIsPrivate);
+    ENGRAM_RUN_TEST(TestRelease);
+    EngramTest_RemoveDirectory(root);
+    return ENGRAM_TEST_RESULT();
+}
@@ -0,0 +1,172 @@
+//
+//  EngramRenderTests.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramRender.h"
+#include "EngramTestSupport.h"
+#include "EngramWait.h"
+#include <thread>
+
+#define kChannels 2
+#define kFrames 256
+#define kMillis 1000000ull
+
+static EngramArena gArena;
+static EngramRender gRender;
+
+static void Setup(void) {
+    EngramArena_Release(&gArena);
+    EngramArena_Reserve(&gArena, EngramRender_RequiredBytes(kChannels));
+    EngramRender_Init(&gRender, &gArena, kChannels);
+}
+
+static void RenderPattern(const EngramRenderRequest* request, Float32 base) {
+    for (UInt32 i = 0; i < request->frames * request->channels; i++) {
+        request->buffer[i] = base + 0.001f * (Float32)i;
+    }
+}
+
+static void TestOffByDefault(void) {
+    Setup();
+    Float32 out[kFrames * kChannels];
+    UInt64 waited = 1;
+    ENGRAM_EXPECT(!EngramRender_Request(&gRender, 1, 0.0, 0, kFrames));
+    ENGRAM_EXPECT(!EngramRender_Collect(&gRender, out, kFrames, 10 * kMillis, &waited));
+    ENGRAM_EXPECT_EQ(waited, 0u);
+
+    EngramRenderRequest request;
+    ENGRAM_EXPECT(!EngramRender_Pending(&gRender, &request));
+}
+
+static void TestRequestRenderCollect(void) {
+    Setup();
+    gRender.enabled.store(true);
+    ENGRAM_EXPECT(EngramRender_Request(&gRender, 7, 1792.0, 1234, kFrames));
+
+    EngramRenderRequest request;
+    ENGRAM_EXPECT(EngramRender_Pending(&gRender, &request));
+    ENGRAM_EXPECT_EQ(request.cycle, 7u);
+    ENGRAM_EXPECT_EQ(request.hostTime, 1234u);
+    ENGRAM_EXPECT_EQ(request.sampleTime, 1792.0);
+    ENGRAM_EXPECT_EQ(request.frames, (UInt32)kFrames);
+    ENGRAM_EXPECT_EQ(request.channels, (UInt32)kChannels);
+    RenderPattern(&request, 0.25f);
+    EngramRender_Complete(&gRender, &request);
+    ENGRAM_EXPECT(!EngramRender_Pending(&gRender, &request));
+
+    Float32 out[kFrames * kChannels];
+    UInt64 waited = 0;
+    ENGRAM_EXPECT(EngramRender_Collect(&gRender, out, kFrames, 10 * kMillis, &waited));
+    ENGRAM_EXPECT(waited < 10 * kMillis);
+    ENGRAM_EXPECT_EQ(out[0], 0.25f);
+    ENGRAM_EXPECT_NEAR(out[kFrames * kChannels - 1], 0.25f + 0.001f * (kFrames * kChannels - 1), 1e-6);
+
+    // Each request is collected once
+    ENGRAM_EXPECT(!EngramRender_Collect(&gRender, out, kFrames, 10 * kMillis, &waited));
+}
+
+static void TestMissIsBounded(void) {
+    Setup();
+    gRender.enabled.store(true);
+    ENGRAM_EXPECT(EngramRender_Request(&gRender, 1, 0.0, 0, kFrames));
+
+    Float32 out[kFrames * kChannels];
+    UInt64 waited = 0;
+    UInt64 start = EngramWait_Now();
+    ENGRAM_EXPECT(!EngramRender_Collect(&gRender, out, kFrames, 2 * kMillis, &waited));
+    UInt64 elapsed = EngramWait_Now() - start;
+    ENGRAM_EXPECT(waited >= 2 * kMillis);
+    ENGRAM_EXPECT(elapsed < 200 * kMillis);
+
+    // A different buffer size than was requested never waits
+    ENGRAM_EXPECT(EngramRender_Request(&gRender, 2, 0.0, 0, kFrames));
+    ENGRAM_EXPECT(!EngramRender_Collect(&gRender, out, kFrames / 2, 2 * kMillis, &waited));
+    ENGRAM_EXPECT_EQ(waited, 0u);
+
+    ENGRAM_EXPECT(!EngramRender_Request(&gRender, 3, 0.0, 0, kEngramRenderMaxFrames + 1));
+}
+
+static void TestLateRenderKeepsItsSlot(void) {
+    Setup();
+    gRender.enabled.store(true);
+    Float32 out[kFrames * kChannels];
+    UInt64 waited = 0;
+
+    EngramRenderRequest late;
+    ENGRAM_EXPECT(EngramRender_Request(&gRender, 1, 0.0, 0, kFrames));
+    ENGRAM_EXPECT(EngramRender_Pending(&gRender, &late));
+    ENGRAM_EXPECT(!EngramRender_Collect(&gRender, out, kFrames, kMillis, &waited));
+
+    // The next cycle's request replaces it; finishing the old one satisfies nothing
+    EngramRenderRequest current;
+    ENGRAM_EXPECT(EngramRender_Request(&gRender, 2, (Float64)kFrames, 0, kFrames));
+    ENGRAM_EXPECT(EngramRender_Pending(&gRender, &current));
+    ENGRAM_EXPECT(current.sequence != late.sequence);
+    ENGRAM_EXPECT(current.buffer != late.buffer);
+    RenderPattern(&current, 0.5f);
+    RenderPattern(&late, -0.5f);
+    EngramRender_Complete(&gRender, &late);
+    ENGRAM_EXPECT(EngramRender_Pending(&gRender, &current));
+    EngramRender_Complete(&gRender, &current);
+
+    ENGRAM_EXPECT(EngramRender_Collect(&gRender, out, kFrames, 10 * kMillis, &waited));
+    ENGRAM_EXPECT_EQ(out[0], 0.5f);
+}
+
+static void TestProducerThread(void) {
+    Setup();
+    gRender.enabled.store(true);
+    std::atomic<Boolean> running(true);
+    std::atomic<UInt32> rendered(0);
+
+    std::thread producer([&running, &rendered]() {
+        while (running.load()) {
+            EngramRenderRequest request;
+            UInt32 sequence = EngramRender_Arm(&gRender);
+            if (!running.load()) {
+                break;
+            }
+            if (!EngramRender_Pending(&gRender, &request)) {
+                EngramWait_WhileEqual(&gRender.requested, sequence, 0);
+                continue;
+            }
+            EngramRender_Disarm(&gRender);
+            RenderPattern(&request, (Float32)request.cycle);
+            EngramRender_Complete(&gRender, &request);
+            rendered++;
+        }
+        EngramRender_Disarm(&gRender);
+    });
+
+    Float32 out[kFrames * kChannels];
+    UInt32 collected = 0;
+    for (UInt64 cycle = 1; cycle <= 50; cycle++) {
+        UInt64 waited = 0;
+        ENGRAM_EXPECT(EngramRender_Request(&gRender, cycle, 0.0, 0, kFrames));
+        // Generous, so a loaded test machine doesn't fail the run
+        if (EngramRender_Collect(&gRender, out, kFrames, 500 * kMillis, &waited)) {
+            collected++;
+            ENGRAM_EXPECT_EQ(out[0], (Float32)cycle);
+        }
+    }
+    ENGRAM_EXPECT_EQ(collected, 50u);
+
+    running.store(false);
+    EngramRender_Nudge(&gRender);
+    producer.join();
+    ENGRAM_EXPECT_EQ(rendered.load(), 50u);
+}
+
+int main(void) {
+    ENGRAM_RUN_TEST(TestOffByDefault);
+    ENGRAM_RUN_TEST(TestRequestRenderCollect);
+    ENGRAM_RUN_TEST(TestMissIsBounded);
+    ENGRAM_RUN_TEST(TestLateRenderKeepsItsSlot);
+    ENGRAM_RUN_TEST(TestProducerThread);
+    EngramArena_Release(&gArena);
+    return ENGRAM_TEST_RESULT();
+}
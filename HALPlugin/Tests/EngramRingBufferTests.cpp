@@ -0,0 +1,195 @@
+//
+//  EngramRingBufferTests.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramRingBuffer.h"
+#include "EngramTestSupport.h"
+#include <thread>
+
+static void TestWriteReadWrapsAround(void) {
+    Float32 storage[8];
+    EngramRingBuffer rb;
+    EngramRingBuffer_Init(&rb, storage, 8);
+
+    Float32 in[6] = { 1, 2, 3, 4, 5, 6 };
+    Float32 out[6] = {};
+    ENGRAM_EXPECT_EQ(EngramRingBuffer_Write(&rb, in, 6), 6u);
+    ENGRAM_EXPECT_EQ(EngramRingBuffer_Read(&rb, out, 4), 4u);
+
+    // Second write straddles the end of the storage
+    ENGRAM_EXPECT_EQ(EngramRingBuffer_Write(&rb, in, 5), 5u);
+    ENGRAM_EXPECT_EQ(EngramRingBuffer_GetAvailableRead(&rb), 7u);
+    ENGRAM_EXPECT_EQ(EngramRingBuffer_Read(&rb, out, 2), 2u);
+    ENGRAM_EXPECT_EQ(out[0], 5.0f);
+    ENGRAM_EXPECT_EQ(out[1], 6.0f);
+    ENGRAM_EXPECT_EQ(EngramRingBuffer_Read(&rb, out, 5), 5u);
+    for (UInt32 i = 0; i < 5; i++) {
+        ENGRAM_EXPECT_EQ(out[i], in[i]);
+    }
+}
+
+static void TestOverrunDropsAndCounts(void) {
+    Float32 storage[8];
+    EngramRingBuffer rb;
+    EngramRingBuffer_Init(&rb, storage, 8);
+
+    Float32 in[10] = {};
+    // One slot is always kept free to tell full from empty
+    ENGRAM_EXPECT_EQ(EngramRingBuffer_Write(&rb, in, 10), 7u);
+    ENGRAM_EXPECT_EQ(rb.overrunSamples.load(), 3u);
+    ENGRAM_EXPECT_EQ(EngramRingBuffer_GetAvailableWrite(&rb), 0u);
+}
+
+static void TestUnderrunZeroFills(void) {
+    Float32 storage[8];
+    EngramRingBuffer rb;
+    EngramRingBuffer_Init(&rb, storage, 8);
+
+    Float32 in[2] = { 0.5f, -0.5f };
+    Float32 out[4] = { 9, 9, 9, 9 };
+    EngramRingBuffer_Write(&rb, in, 2);
+    ENGRAM_EXPECT_EQ(EngramRingBuffer_Read(&rb, out, 4), 2u);
+    ENGRAM_EXPECT_EQ(out[1], -0.5f);
+    ENGRAM_EXPECT_EQ(out[2], 0.0f);
+    ENGRAM_EXPECT_EQ(out[3], 0.0f);
+}
+
+static void TestMissingStorageIsSilent(void) {
+    EngramRingBuffer rb;
+    EngramRingBuffer_Init(&rb, NULL, 8);
+
+    Float32 out[2] = { 1, 1 };
+    ENGRAM_EXPECT_EQ(EngramRingBuffer_Write(&rb, out, 2), 0u);
+    ENGRAM_EXPECT_EQ(EngramRingBuffer_Read(&rb, out, 2), 0u);
+    ENGRAM_EXPECT_EQ(out[0], 0.0f);
+    ENGRAM_EXPECT_EQ(EngramRingBuffer_GetAvailableWrite(&rb), 0u);
+}
+
+static void TestStampsFollowTheOldestSample(void) {
+    Float32 storage[64];
+    EngramRingStamp stamps[4];
+    EngramRingBuffer rb;
+    EngramRingBuffer_Init(&rb, storage, 64);
+    EngramRingBuffer_AttachStamps(&rb, stamps, 4);
+
+    Float32 in[10] = {};
+    Float32 out[10];
+    UInt64 hostTime = 1;
+    ENGRAM_EXPECT_EQ(EngramRingBuffer_WriteStamped(&rb, in, 10, 100), 10u);
+    ENGRAM_EXPECT_EQ(EngramRingBuffer_WriteStamped(&rb, in, 10, 200), 10u);
+    ENGRAM_EXPECT_EQ(EngramRingBuffer_Write(&rb, in, 5), 5u);
+    ENGRAM_EXPECT_EQ(EngramRingBuffer_WriteStamped(&rb, in, 5, 300), 5u);
+
+    ENGRAM_EXPECT_EQ(EngramRingBuffer_ReadStamped(&rb, out, 4, &hostTime), 4u);
+    ENGRAM_EXPECT_EQ(hostTime, 100u);
+    // Samples 4-13 straddle the first two writes; the older one counts
+    ENGRAM_EXPECT_EQ(EngramRingBuffer_ReadStamped(&rb, out, 10, &hostTime), 10u);
+    ENGRAM_EXPECT_EQ(hostTime, 100u);
+    ENGRAM_EXPECT_EQ(EngramRingBuffer_ReadStamped(&rb, out, 6, &hostTime), 6u);
+    ENGRAM_EXPECT_EQ(hostTime, 200u);
+    // The unstamped write is covered by the next stamped one
+    ENGRAM_EXPECT_EQ(EngramRingBuffer_ReadStamped(&rb, out, 5, &hostTime), 5u);
+    ENGRAM_EXPECT_EQ(hostTime, 300u);
+    // A plain read retires stamps too
+    ENGRAM_EXPECT_EQ(EngramRingBuffer_Read(&rb, out, 5), 5u);
+    ENGRAM_EXPECT_EQ(rb.stampTail.load(), rb.stampHead.load());
+    ENGRAM_EXPECT_EQ(EngramRingBuffer_ReadStamped(&rb, out, 5, &hostTime), 0u);
+    ENGRAM_EXPECT_EQ(hostTime, 0u);
+}
+
+static void TestFullStampRingDropsAndCounts(void) {
+    Float32 storage[64];
+    EngramRingStamp stamps[2];
+    EngramRingBuffer rb;
+    EngramRingBuffer_Init(&rb, storage, 64);
+    EngramRingBuffer_AttachStamps(&rb, stamps, 2);
+
+    Float32 in[8] = {};
+    Float32 out[8];
+    UInt64 hostTime = 0;
+    ENGRAM_EXPECT_EQ(EngramRingBuffer_WriteStamped(&rb, in, 8, 10), 8u);
+    ENGRAM_EXPECT_EQ(EngramRingBuffer_WriteStamped(&rb, in, 8, 20), 8u);
+    ENGRAM_EXPECT_EQ(EngramRingBuffer_WriteStamped(&rb, in, 8, 30), 8u);
+    ENGRAM_EXPECT_EQ(rb.droppedStamps.load(), 1u);
+
+    ENGRAM_EXPECT_EQ(EngramRingBuffer_ReadStamped(&rb, out, 8, &hostTime), 8u);
+    ENGRAM_EXPECT_EQ(hostTime, 10u);
+    ENGRAM_EXPECT_EQ(EngramRingBuffer_ReadStamped(&rb, out, 8, &hostTime), 8u);
+    ENGRAM_EXPECT_EQ(hostTime, 20u);
+    // The third write's samples had no stamp of their own left to find
+    ENGRAM_EXPECT_EQ(EngramRingBuffer_ReadStamped(&rb, out, 8, &hostTime), 8u);
+    ENGRAM_EXPECT_EQ(hostTime, 0u);
+
+    // Not a power of two: stamping stays off
+    EngramRingBuffer_Init(&rb, storage, 64);
+    EngramRingBuffer_AttachStamps(&rb, stamps, 3);
+    ENGRAM_EXPECT(rb.stamps == NULL);
+}
+
+static void TestProducerConsumerPreservesOrder(void) {
+    static Float32 storage[1024];
+    static EngramRingStamp stamps[64];
+    EngramRingBuffer rb;
+    EngramRingBuffer_Init(&rb, storage, 1024);
+    EngramRingBuffer_AttachStamps(&rb, stamps, 64);
+
+    const UInt32 total = 200000;
+    std::thread producer([&rb, total]() {
+        Float32 block[64];
+        UInt32 next = 0;
+        while (next < total) {
+            UInt32 count = (total - next < 64) ? total - next : 64;
+            for (UInt32 i = 0; i < count; i++) {
+                block[i] = (Float32)((next + i) % 65536);
+            }
+            UInt32 space = EngramRingBuffer_GetAvailableWrite(&rb);
+            if (space < count) {
+                std::this_thread::yield();
+                continue;
+            }
+            // Each write is stamped with its first sample's position, plus one
+            next += EngramRingBuffer_WriteStamped(&rb, block, count, next + 1);
+        }
+    });
+
+    Float32 block[48];
+    UInt32 received = 0;
+    UInt32 mismatches = 0;
+    UInt32 misstamped = 0;
+    while (received < total) {
+        UInt32 available = EngramRingBuffer_GetAvailableRead(&rb);
+        if (available == 0) {
+            std::this_thread::yield();
+            continue;
+        }
+        UInt32 count = (available < 48) ? available : 48;
+        UInt64 stamp = 0;
+        EngramRingBuffer_ReadStamped(&rb, block, count, &stamp);
+        // The first sample came from a write starting at most 63 samples earlier
+        misstamped += (stamp == 0 || stamp > received + 1 || stamp + 63 < received + 1);
+        for (UInt32 i = 0; i < count; i++) {
+            mismatches += (block[i] != (Float32)((received + i) % 65536));
+        }
+        received += count;
+    }
+    producer.join();
+
+    ENGRAM_EXPECT_EQ(mismatches, 0u);
+    ENGRAM_EXPECT_EQ(misstamped, 0u);
+    ENGRAM_EXPECT_EQ(rb.overrunSamples.load(), 0u);
+}
+
+int main(void) {
+    ENGRAM_RUN_TEST(TestWriteReadWrapsAround);
+    ENGRAM_RUN_TEST(TestOverrunDropsAndCounts);
+    ENGRAM_RUN_TEST(TestUnderrunZeroFills);
+    ENGRAM_RUN_TEST(TestMissingStorageIsSilent);
+    ENGRAM_RUN_TEST(TestStampsFollowTheOldestSample);
+    ENGRAM_RUN_TEST(TestFullStampRingDropsAndCounts);
+    ENGRAM_RUN_TEST(TestProducerConsumerPreservesOrder);
+    return ENGRAM_TEST_RESULT();
+}
@@ -0,0 +1,396 @@
+//
+//  EngramSIMDTests.cpp
+//  Engram Virtual Audio Device
+//
+//  Every SIMD implementation this machine can run, against the scalar
+//  reference: every length through a few vectors' worth of remainder, every
+//  misalignment, every channel count, all Int16 values and every rounding
+//  boundary, plus the IEEE special values. Results must match bit for bit.
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramSIMD.h"
+#include "EngramTestSupport.h"
+#include <math.h>
+#include <string.h>
+
+#define kMaxCount 67
+#define kMaxOffset 8
+#define kMaxChannels 9
+#define kBufferSamples ((kMaxCount + kMaxOffset) * kMaxChannels * 2)
+
+static const Float32 kSpecialValues[] = {
+    0.0f, -0.0f, 1.0f, -1.0f, 0.5f, 1.0e-40f, -1.0e-40f, 1.0e30f, -1.0e30f,
+    INFINITY, -INFINITY, NAN, 32767.5f / 32768.0f, -32768.5f / 32768.0f, 1.5f / 32768.0f, -2.5f / 32768.0f
+};
+
+static UInt64 gRandomState = 0x53494D4453494D44ull;
+
+static Float32 RandomSample(Boolean hostile) {
+    gRandomState ^= gRandomState >> 12;
+    gRandomState ^= gRandomState << 25;
+    gRandomState ^= gRandomState >> 27;
+    UInt64 value = gRandomState * 0x2545F4914F6CDD1Dull;
+    // Mostly audio range, now and then something hostile
+    if (hostile && (value & 0x1F) == 0) {
+        return kSpecialValues[(value >> 8) % (sizeof(kSpecialValues) / sizeof(kSpecialValues[0]))];
+    }
+    return (Float32)((Float64)(value >> 11) / (Float64)(1ull << 53) * 2.5 - 1.25);
+}
+
+static void Fill(Float32* samples, UInt32 count) {
+    for (UInt32 i = 0; i < count; i++) {
+        samples[i] = RandomSample(true);
+    }
+}
+
+// Recursive filters never recover from one NaN, which would hide everything after it
+static void FillAudio(Float32* samples, UInt32 count) {
+    for (UInt32 i = 0; i < count; i++) {
+        samples[i] = RandomSample(false);
+    }
+}
+
+// NaN payloads depend on operand order, which the compiler is free to pick
+static Boolean SameSamples(const Float32* a, const Float32* b, UInt32 count) {
+    for (UInt32 i = 0; i < count; i++) {
+        if (isnan(a[i]) && isnan(b[i])) {
+            continue;
+        }
+        if (memcmp(&a[i], &b[i], sizeof(Float32)) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// MARK: - Dispatch
+
+static void TestDispatchPicksBestAvailable(void) {
+    const EngramSIMDKernels* scalar = EngramSIMD_KernelsForLevel(kEngramSIMDLevelScalar);
+    ENGRAM_EXPECT(scalar != NULL);
+    ENGRAM_EXPECT(EngramSIMD_KernelsForLevel(kEngramSIMDLevelCount) == NULL);
+
+    const EngramSIMDKernels* selected = EngramSIMD_Kernels();
+    ENGRAM_EXPECT(selected != NULL);
+    ENGRAM_EXPECT(selected == EngramSIMD_Kernels());
+
+    for (UInt32 level = 0; level < kEngramSIMDLevelCount; level++) {
+        const EngramSIMDKernels* kernels = EngramSIMD_KernelsForLevel((EngramSIMDLevel)level);
+        if (kernels != NULL) {
+            ENGRAM_EXPECT_EQ(kernels->level, (EngramSIMDLevel)level);
+            ENGRAM_EXPECT(strcmp(kernels->name, EngramSIMD_LevelName((EngramSIMDLevel)level)) == 0);
+            printf("  %s available\n", kernels->name);
+        }
+    }
+
+    // Widest first; SSE4.1 only wins on an x86 CPU without AVX2
+    EngramSIMDLevel best = kEngramSIMDLevelScalar;
+    if (EngramSIMD_KernelsForLevel(kEngramSIMDLevelAVX2) != NULL) {
+        best = kEngramSIMDLevelAVX2;
+    } else if (EngramSIMD_KernelsForLevel(kEngramSIMDLevelNEON) != NULL) {
+        best = kEngramSIMDLevelNEON;
+    } else if (EngramSIMD_KernelsForLevel(kEngramSIMDLevelSSE41) != NULL) {
+        best = kEngramSIMDLevelSSE41;
+    }
+    ENGRAM_EXPECT_EQ(selected->level, best);
+
+#if defined(__x86_64__) && defined(__AVX2__)
+    // Built for an AVX2 baseline, so the CPU has it
+    ENGRAM_EXPECT(EngramSIMD_KernelsForLevel(kEngramSIMDLevelAVX2) != NULL);
+#endif
+#if defined(__aarch64__)
+    ENGRAM_EXPECT(EngramSIMD_KernelsForLevel(kEngramSIMDLevelNEON) != NULL);
+#endif
+}
+
+// MARK: - Equivalence
+
+static void CheckMix(const EngramSIMDKernels* simd, const EngramSIMDKernels* scalar) {
+    static Float32 src[kBufferSamples];
+    static Float32 expected[kBufferSamples];
+    static Float32 actual[kBufferSamples];
+    static const Float32 kGains[] = { 0.0f, 1.0f, -0.5f, 0.70710678f, INFINITY };
+
+    Boolean identical = true;
+    for (Float32 gain : kGains) {
+        for (UInt32 offset = 0; offset < kMaxOffset; offset++) {
+            for (UInt32 count = 0; count <= kMaxCount; count++) {
+                Fill(src, count + kMaxOffset);
+                Fill(expected, count + kMaxOffset);
+                memcpy(actual, expected, sizeof(expected));
+                scalar->mix(expected + offset, src + (kMaxOffset - 1 - offset), gain, count);
+                simd->mix(actual + offset, src + (kMaxOffset - 1 - offset), gain, count);
+                identical &= SameSamples(expected, actual, kBufferSamples);
+            }
+        }
+    }
+    ENGRAM_EXPECT(identical);
+}
+
+static void CheckGainRamp(const EngramSIMDKernels* simd, const EngramSIMDKernels* scalar) {
+    static Float32 expected[kBufferSamples];
+    static Float32 actual[kBufferSamples];
+    static const Float32 kRamps[][2] = { { 0.0f, 1.0f }, { 1.0f, 0.0f }, { 0.25f, 0.25f }, { 2.0f, -3.0f } };
+
+    Boolean identical = true;
+    for (UInt32 r = 0; r < sizeof(kRamps) / sizeof(kRamps[0]); r++) {
+        for (UInt32 channels = 1; channels <= kMaxChannels; channels++) {
+            for (UInt32 offset = 0; offset < kMaxOffset; offset++) {
+                for (UInt32 frames = 0; frames <= kMaxCount; frames++) {
+                    Fill(expected, kBufferSamples);
+                    memcpy(actual, expected, sizeof(expected));
+                    scalar->gainRamp(expected + offset, frames, channels, kRamps[r][0], kRamps[r][1]);
+                    simd->gainRamp(actual + offset, frames, channels, kRamps[r][0], kRamps[r][1]);
+                    identical &= SameSamples(expected, actual, kBufferSamples);
+                }
+            }
+        }
+    }
+    ENGRAM_EXPECT(identical);
+}
+
+static void CheckInt16ToFloat(const EngramSIMDKernels* simd, const EngramSIMDKernels* scalar) {
+    static SInt16 all[65536 + kMaxOffset];
+    static Float32 expected[65536 + kMaxOffset];
+    static Float32 actual[65536 + kMaxOffset];
+
+    // Every value, at every alignment
+    Boolean identical = true;
+    for (UInt32 offset = 0; offset < kMaxOffset; offset++) {
+        for (UInt32 i = 0; i < 65536; i++) {
+            all[offset + i] = (SInt16)(i - 32768);
+        }
+        memset(expected, 0, sizeof(expected));
+        memset(actual, 0, sizeof(actual));
+        scalar->int16ToFloat(expected + offset, all + offset, 65536);
+        simd->int16ToFloat(actual + offset, all + offset, 65536);
+        identical &= (memcmp(expected, actual, sizeof(expected)) == 0);
+    }
+
+    // And every length
+    for (UInt32 count = 0; count <= kMaxCount; count++) {
+        memset(expected, 0, sizeof(Float32) * (kMaxCount + 1));
+        memset(actual, 0, sizeof(Float32) * (kMaxCount + 1));
+        scalar->int16ToFloat(expected, all + 32768 - count / 2, count);
+        simd->int16ToFloat(actual, all + 32768 - count / 2, count);
+        identical &= (memcmp(expected, actual, sizeof(Float32) * (kMaxCount + 1)) == 0);
+    }
+    ENGRAM_EXPECT(identical);
+
+    // The scale is a power of two, so the round trip through Float32 is exact
+    ENGRAM_EXPECT_EQ(expected[0], (Float32)all[32768 - kMaxCount / 2] / 32768.0f);
+}
+
+static void CheckFloatToInt16(const EngramSIMDKernels* simd, const EngramSIMDKernels* scalar) {
+    // Every integer and every halfway point in range and just past it, each
+    // with its neighbours one ulp either side
+    static Float32 src[(65540 * 2) * 3 + kMaxOffset];
+    static SInt16 expected[(65540 * 2) * 3 + kMaxOffset];
+    static SInt16 actual[(65540 * 2) * 3 + kMaxOffset];
+
+    UInt32 count = 0;
+    for (SInt32 k = -32770; k < 32770; k++) {
+        Float32 points[2] = { (Float32)k / 32768.0f, ((Float32)k + 0.5f) / 32768.0f };
+        for (Float32 x : points) {
+            src[count++] = nextafterf(x, -INFINITY);
+            src[count++] = x;
+            src[count++] = nextafterf(x, INFINITY);
+        }
+    }
+
+    Boolean identical = true;
+    for (UInt32 offset = 0; offset < kMaxOffset; offset++) {
+        memset(expected, 0, sizeof(expected));
+        memset(actual, 0, sizeof(actual));
+        scalar->floatToInt16(expected + offset, src, count);
+        simd->floatToInt16(actual + offset, src, count);
+        identical &= (memcmp(expected, actual, sizeof(expected)) == 0);
+    }
+
+    // Every length, with the special values mixed in
+    Float32 specials[kMaxCount + 1];
+    for (UInt32 n = 0; n <= kMaxCount; n++) {
+        Fill(specials, kMaxCount + 1);
+        for (UInt32 i = 0; i < n && i < sizeof(kSpecialValues) / sizeof(kSpecialValues[0]); i++) {
+            specials[(i * 5) % (n + 1)] = kSpecialValues[i];
+        }
+        memset(expected, 0, sizeof(SInt16) * (kMaxCount + 1));
+        memset(actual, 0, sizeof(SInt16) * (kMaxCount + 1));
+        scalar->floatToInt16(expected, specials, n);
+        simd->floatToInt16(actual, specials, n);
+        identical &= (memcmp(expected, actual, sizeof(SInt16) * (kMaxCount + 1)) == 0);
+    }
+    ENGRAM_EXPECT(identical);
+
+    // The edges: clamp, round half to even, NaN to the floor
+    const Float32 edges[] = { 1.0f, -1.0f, 2.0f, NAN, 0.5f / 32768.0f, 1.5f / 32768.0f, -0.5f / 32768.0f };
+    const SInt16 wanted[] = { 32767, -32768, 32767, -32768, 0, 2, 0 };
+    SInt16 converted[sizeof(edges) / sizeof(edges[0])];
+    simd->floatToInt16(converted, edges, sizeof(edges) / sizeof(edges[0]));
+    for (UInt32 i = 0; i < sizeof(edges) / sizeof(edges[0]); i++) {
+        ENGRAM_EXPECT_EQ(converted[i], wanted[i]);
+    }
+}
+
+static void CheckInterleave(const EngramSIMDKernels* simd, const EngramSIMDKernels* scalar) {
+    static Float32 left[kMaxCount + kMaxOffset];
+    static Float32 right[kMaxCount + kMaxOffset];
+    static Float32 expected[2 * (kMaxCount + kMaxOffset)];
+    static Float32 actual[2 * (kMaxCount + kMaxOffset)];
+    static Float32 expectedRight[kMaxCount + kMaxOffset];
+    static Float32 actualRight[kMaxCount + kMaxOffset];
+
+    Boolean identical = true;
+    for (UInt32 offset = 0; offset < kMaxOffset; offset++) {
+        for (UInt32 frames = 0; frames <= kMaxCount; frames++) {
+            Fill(left, kMaxCount + kMaxOffset);
+            Fill(right, kMaxCount + kMaxOffset);
+            memset(expected, 0, sizeof(expected));
+            memset(actual, 0, sizeof(actual));
+            scalar->interleave2(expected + offset, left + offset, right + (kMaxOffset - 1 - offset), frames);
+            simd->interleave2(actual + offset, left + offset, right + (kMaxOffset - 1 - offset), frames);
+            identical &= (memcmp(expected, actual, sizeof(expected)) == 0);
+
+            memset(left, 0, sizeof(left));
+            memset(right, 0, sizeof(right));
+            memset(expectedRight, 0, sizeof(expectedRight));
+            memset(actualRight, 0, sizeof(actualRight));
+            Fill(expected, 2 * (kMaxCount + kMaxOffset));
+            scalar->deinterleave2(left + offset, expectedRight + offset, expected + (kMaxOffset - 1 - offset), frames);
+            simd->deinterleave2(right + offset, actualRight + offset, expected + (kMaxOffset - 1 - offset), frames);
+            identical &= (memcmp(left, right, sizeof(left)) == 0);
+            identical &= (memcmp(expectedRight, actualRight, sizeof(expectedRight)) == 0);
+        }
+    }
+    ENGRAM_EXPECT(identical);
+}
+
+static void CheckBiquad(const EngramSIMDKernels* simd, const EngramSIMDKernels* scalar) {
+    static Float32 expected[kBufferSamples];
+    static Float32 actual[kBufferSamples];
+
+    EngramBiquadCoefficients filters[2];
+    EngramBiquad_MakeHighPass(&filters[0], 48000.0, 10.0, M_SQRT1_2);
+    EngramBiquad_MakeLowPass(&filters[1], 48000.0, 1000.0, 0.5);
+
+    Boolean identical = true;
+    for (const EngramBiquadCoefficients& filter : filters) {
+        for (UInt32 channels = 1; channels <= kMaxChannels; channels++) {
+            EngramBiquadState expectedStates[kMaxChannels] = {};
+            EngramBiquadState actualStates[kMaxChannels] = {};
+
+            // Consecutive blocks of every length carry state across calls
+            for (UInt32 frames = 0; frames <= kMaxCount; frames++) {
+                UInt32 offset = frames % kMaxOffset;
+                FillAudio(expected, kBufferSamples);
+                memcpy(actual, expected, sizeof(expected));
+                scalar->biquad(&filter, expectedStates, expected + offset, frames, channels);
+                simd->biquad(&filter, actualStates, actual + offset, frames, channels);
+                identical &= SameSamples(expected, actual, kBufferSamples);
+            }
+            for (UInt32 ch = 0; ch < channels; ch++) {
+                identical &= SameSamples(&expectedStates[ch].z1, &actualStates[ch].z1, 1);
+                identical &= SameSamples(&expectedStates[ch].z2, &actualStates[ch].z2, 1);
+            }
+        }
+    }
+    ENGRAM_EXPECT(identical);
+}
+
+static void CheckFFTButterflies(const EngramSIMDKernels* simd, const EngramSIMDKernels* scalar) {
+    static Float32 expectedRe[kBufferSamples];
+    static Float32 expectedIm[kBufferSamples];
+    static Float32 actualRe[kBufferSamples];
+    static Float32 actualIm[kBufferSamples];
+    static Float32 twiddleRe[kBufferSamples];
+    static Float32 twiddleIm[kBufferSamples];
+
+    // Every pass width up to a few vectors' worth, ragged ones included, over
+    // blocks that don't divide the count
+    Boolean identical = true;
+    for (UInt32 half = 1; half <= kMaxCount; half++) {
+        UInt32 count = 2 * half * 3 + half;
+        UInt32 offset = half % kMaxOffset;
+        Fill(expectedRe, kBufferSamples);
+        Fill(expectedIm, kBufferSamples);
+        FillAudio(twiddleRe, kBufferSamples);
+        FillAudio(twiddleIm, kBufferSamples);
+        memcpy(actualRe, expectedRe, sizeof(expectedRe));
+        memcpy(actualIm, expectedIm, sizeof(expectedIm));
+        scalar->fftButterflies(expectedRe + offset, expectedIm + offset, twiddleRe, twiddleIm, count, half);
+        simd->fftButterflies(actualRe + offset, actualIm + offset, twiddleRe, twiddleIm, count, half);
+        identical &= SameSamples(expectedRe, actualRe, kBufferSamples);
+        identical &= SameSamples(expectedIm, actualIm, kBufferSamples);
+    }
+    ENGRAM_EXPECT(identical);
+}
+
+static void TestEveryLevelMatchesScalar(void) {
+    const EngramSIMDKernels* scalar = EngramSIMD_KernelsForLevel(kEngramSIMDLevelScalar);
+
+    for (UInt32 level = kEngramSIMDLevelScalar + 1; level < kEngramSIMDLevelCount; level++) {
+        const EngramSIMDKernels* simd = EngramSIMD_KernelsForLevel((EngramSIMDLevel)level);
+        if (simd == NULL) {
+            continue;
+        }
+        int failuresBefore = gEngramTestFailures;
+        CheckMix(simd, scalar);
+        CheckGainRamp(simd, scalar);
+        CheckInt16ToFloat(simd, scalar);
+        CheckFloatToInt16(simd, scalar);
+        CheckInterleave(simd, scalar);
+        CheckBiquad(simd, scalar);
+        CheckFFTButterflies(simd, scalar);
+        printf("  %s %s\n", simd->name, (gEngramTestFailures == failuresBefore) ? "matches" : "DIFFERS");
+    }
+}
+
+// MARK: - Reference Behavior
+
+static void TestGainRampReachesEndGain(void) {
+    const EngramSIMDKernels* kernels = EngramSIMD_Kernels();
+    Float32 samples[2 * 64];
+    for (UInt32 i = 0; i < 2 * 64; i++) {
+        samples[i] = 1.0f;
+    }
+    kernels->gainRamp(samples, 64, 2, 0.0f, 1.0f);
+
+    // Starts exactly at the start gain, and the next block would start at the end gain
+    ENGRAM_EXPECT_EQ(samples[0], 0.0f);
+    ENGRAM_EXPECT_EQ(samples[1], 0.0f);
+    ENGRAM_EXPECT_NEAR(samples[2 * 63], 63.0 / 64.0, 1.0e-6);
+    ENGRAM_EXPECT_EQ(samples[2 * 63], samples[2 * 63 + 1]);
+}
+
+static void TestBiquadMatchesDSPChain(void) {
+    // The chain's DC blocker and the SIMD biquad are the same filter. The
+    // chain isn't built with contraction off, so only to within rounding.
+    const EngramSIMDKernels* kernels = EngramSIMD_Kernels();
+    EngramDSPChain chain;
+    EngramDSPChain_Init(&chain, 48000.0, 4, kEngramDSPStageDCBlock);
+    EngramBiquadState states[4] = {};
+
+    static Float32 viaChain[4 * 512];
+    static Float32 viaSIMD[4 * 512];
+    FillAudio(viaChain, 4 * 512);
+    memcpy(viaSIMD, viaChain, sizeof(viaChain));
+    EngramDSPChain_ProcessGeneric(&chain, viaChain, 512);
+    kernels->biquad(&chain.dcBlock, states, viaSIMD, 512, 4);
+
+    Float64 maxError = 0.0;
+    for (UInt32 i = 0; i < 4 * 512; i++) {
+        maxError = fmax(maxError, fabs((Float64)viaChain[i] - (Float64)viaSIMD[i]));
+    }
+    ENGRAM_EXPECT_NEAR(maxError, 0.0, 1.0e-6);
+    ENGRAM_EXPECT_NEAR(states[3].z1, chain.dcBlockState[3].z1, 1.0e-6);
+}
+
+int main(void) {
+    ENGRAM_RUN_TEST(TestDispatchPicksBestAvailable);
+    ENGRAM_RUN_TEST(TestEveryLevelMatchesScalar);
+    ENGRAM_RUN_TEST(TestGainRampReachesEndGain);
+    ENGRAM_RUN_TEST(TestBiquadMatchesDSPChain);
+    return ENGRAM_TEST_RESULT();
+}
@@ -0,0 +1,108 @@
+//
+//  EngramSoakTests.cpp
+//  Engram Virtual Audio Device
+//
+//  Shortened soaks with every pathology turned up, so each one happens
+//  several times per run. The full eight-hour soak is `ctest -C Soak`.
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "Simulator/EngramSoak.h"
+#include "EngramFiles.h"
+#include "EngramTestSupport.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define kNanosPerMinute 60000000000ull
+
+static void StressConfig(EngramSoakConfig* config, UInt64 minutes) {
+    EngramSoak_DefaultConfig(config);
+    config->durationNanos = minutes * kNanosPerMinute;
+    config->warmupNanos = 5 * kNanosPerMinute;
+    config->sim.producerSkewPeriodNanos = 5 * kNanosPerMinute;
+    config->stallsPerHour = 240.0;
+    config->burstsPerHour = 240.0;
+    config->clientChangesPerHour = 360.0;
+    config->restartsPerHour = 30.0;
+    config->rateChangesPerHour = 120.0;
+}
+
+static void TestStressSoakHoldsInvariants(void) {
+    EngramSoakConfig config;
+    StressConfig(&config, 30);
+
+    EngramSoakReport report;
+    ENGRAM_EXPECT(EngramSoak_Run(&config, &report, NULL, NULL));
+
+    const EngramSimReport* sim = &report.sim;
+    ENGRAM_EXPECT_EQ(sim->mismatchedSamples, 0u);
+    ENGRAM_EXPECT_EQ(sim->channelSwaps, 0u);
+    ENGRAM_EXPECT_EQ(sim->accountingErrors, 0u);
+    ENGRAM_EXPECT_EQ(sim->overrunSamples, 0u);
+    ENGRAM_EXPECT_EQ(sim->timestampErrors, 0u);
+    ENGRAM_EXPECT_EQ(sim->lateZeroTimeStamps, 0u);
+    ENGRAM_EXPECT_EQ(sim->failedCalls, 0u);
+    ENGRAM_EXPECT_EQ(sim->idleWrites, 0u);
+    ENGRAM_EXPECT_EQ(report.latencyViolations, 0u);
+    ENGRAM_EXPECT_EQ(report.liveObjectGrowth, 0);
+    ENGRAM_EXPECT(report.heapGrowthBytes <= (SInt64)config.maxHeapGrowthBytes);
+    ENGRAM_EXPECT(sim->maxQueuedFrames <= report.latencyBoundFrames);
+    ENGRAM_EXPECT(sim->simulatedNanos >= config.durationNanos);
+
+    // Every pathology actually happened, and the stalls hurt
+    ENGRAM_EXPECT(report.stalls > 0);
+    ENGRAM_EXPECT(report.bursts > 0);
+    ENGRAM_EXPECT(report.clientAttaches > 0);
+    ENGRAM_EXPECT(report.clientDetaches > 0);
+    ENGRAM_EXPECT(sim->restarts > 0);
+    ENGRAM_EXPECT(report.bufferChanges > 0);
+    ENGRAM_EXPECT(report.producerChanges > 0);
+    ENGRAM_EXPECT(sim->underrunCycles > 0);
+    printf("  %llu stalls, %llu bursts, %llu restarts, max latency %llu of %llu frames\n",
+           (unsigned long long)report.stalls, (unsigned long long)report.bursts,
+           (unsigned long long)sim->restarts, (unsigned long long)sim->maxQueuedFrames,
+           (unsigned long long)report.latencyBoundFrames);
+}
+
+static void TestSoakIsReproducible(void) {
+    EngramSoakConfig config;
+    StressConfig(&config, 10);
+
+    EngramSoakReport first;
+    EngramSoakReport second;
+    EngramSoak_Run(&config, &first, NULL, NULL);
+    EngramSoak_Run(&config, &second, NULL, NULL);
+
+    ENGRAM_EXPECT_EQ(first.sim.cycles, second.sim.cycles);
+    ENGRAM_EXPECT_EQ(first.sim.underrunSamples, second.sim.underrunSamples);
+    ENGRAM_EXPECT_EQ(first.sim.maxQueuedFrames, second.sim.maxQueuedFrames);
+    ENGRAM_EXPECT_EQ(first.stalls, second.stalls);
+    ENGRAM_EXPECT_EQ(first.clientAttaches, second.clientAttaches);
+    ENGRAM_EXPECT_EQ(first.sim.restarts, second.sim.restarts);
+}
+
+static void TestUnholdableBoundIsRejected(void) {
+    // Pathologies the ring can't absorb would only ever report overruns
+    EngramSoakConfig config;
+    StressConfig(&config, 1);
+    config.maxStallNanos = 2000000000ull;
+
+    EngramSoakReport report;
+    ENGRAM_EXPECT(!EngramSoak_Run(&config, &report, NULL, NULL));
+    ENGRAM_EXPECT(!report.passed);
+    ENGRAM_EXPECT_EQ(report.steps, 0u);
+}
+
+int main(void) {
+    // The soak provokes glitches on purpose; their snapshots go to a directory this run removes again
+    char diagnostics[kEngramMaxPathLength];
+    ENGRAM_EXPECT(EngramTest_MakeTempDirectory(diagnostics, sizeof(diagnostics)) != NULL);
+    setenv(kEngramDiagnosticsDirectoryEnvironment, diagnostics, 1);
+
+    ENGRAM_RUN_TEST(TestStressSoakHoldsInvariants);
+    ENGRAM_RUN_TEST(TestSoakIsReproducible);
+    ENGRAM_RUN_TEST(TestUnholdableBoundIsRejected);
+    EngramTest_RemoveDirectory(diagnostics);
+    return ENGRAM_TEST_RESULT();
+}
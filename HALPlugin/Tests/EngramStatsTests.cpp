@@ -0,0 +1,155 @@
+//
+//  EngramStatsTests.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramStats.h"
+#include "EngramTestSupport.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static void TestBucketBoundsRoundTrip(void) {
+    for (UInt32 bucket = 0; bucket < kEngramHistogramBuckets - 1; bucket++) {
+        UInt64 lower = EngramHistogram_BucketLowerBound(bucket);
+        ENGRAM_EXPECT_EQ(EngramHistogram_BucketForValue(lower), bucket);
+        ENGRAM_EXPECT_EQ(EngramHistogram_BucketForValue(EngramHistogram_BucketLowerBound(bucket + 1) - 1), bucket);
+    }
+}
+
+static void TestBucketRelativeError(void) {
+    for (UInt64 value = 1; value < (1ull << 36); value = value * 3 + 1) {
+        UInt64 lower = EngramHistogram_BucketLowerBound(EngramHistogram_BucketForValue(value));
+        ENGRAM_EXPECT(lower <= value);
+        ENGRAM_EXPECT((Float64)(value - lower) <= 0.125 * (Float64)value);
+    }
+}
+
+static void TestPercentiles(void) {
+    EngramStatsPage* page = (EngramStatsPage*)calloc(1, sizeof(EngramStatsPage));
+    EngramStats_InitPage(page);
+    for (UInt64 value = 1; value <= 1000; value++) {
+        EngramHistogram_Record(&page->ioDurationNs, value);
+    }
+
+    EngramStatsSnapshot* snapshot = (EngramStatsSnapshot*)calloc(1, sizeof(EngramStatsSnapshot));
+    EngramStats_Snapshot(page, snapshot);
+    ENGRAM_EXPECT_EQ(snapshot->magic, kEngramStatsMagic);
+    ENGRAM_EXPECT_EQ(snapshot->ioDurationNs.count, 1000u);
+    ENGRAM_EXPECT_EQ(snapshot->ioDurationNs.min, 1u);
+    ENGRAM_EXPECT_EQ(snapshot->ioDurationNs.max, 1000u);
+    ENGRAM_EXPECT_EQ(snapshot->ioDurationNs.sum, 500500u);
+
+    UInt64 p50 = EngramHistogram_ValueAtPercentile(&snapshot->ioDurationNs, 50.0);
+    UInt64 p99 = EngramHistogram_ValueAtPercentile(&snapshot->ioDurationNs, 99.0);
+    ENGRAM_EXPECT(p50 >= 500 && p50 <= 500 * 9 / 8 + 1);
+    ENGRAM_EXPECT(p99 >= 990 && p99 <= 1000);
+    ENGRAM_EXPECT_EQ(EngramHistogram_ValueAtPercentile(&snapshot->cycleJitterNs, 50.0), 0u);
+
+    free(snapshot);
+    free(page);
+}
+
+static void TestIOGateMirror(void) {
+    EngramStatsPage* page = (EngramStatsPage*)calloc(1, sizeof(EngramStatsPage));
+    EngramStats_InitPage(page);
+    EngramGate gate;
+    EngramGate_Init(&gate);
+    ENGRAM_EXPECT(!EngramStats_IOActive(page));
+    ENGRAM_EXPECT(!EngramStats_WaitForIO(page, 1000000));
+
+    // The page follows the gate only as it is published, and never drives it
+    EngramGate_Started(&gate);
+    EngramGate_Started(&gate);
+    ENGRAM_EXPECT(!EngramStats_IOActive(page));
+    EngramStats_PublishIO(page, &gate);
+    ENGRAM_EXPECT(EngramStats_IOActive(page));
+    ENGRAM_EXPECT(EngramStats_WaitForIO(page, 0));
+    page->ioClients.store(0);
+    ENGRAM_EXPECT(EngramGate_IsRunning(gate.clients.load()));
+
+    EngramGate_Stopped(&gate);
+    EngramGate_Stopped(&gate);
+    EngramStats_PublishIO(page, &gate);
+    ENGRAM_EXPECT(!EngramStats_IOActive(page));
+
+    EngramStatsSnapshot* snapshot = (EngramStatsSnapshot*)calloc(1, sizeof(EngramStatsSnapshot));
+    EngramStats_Snapshot(page, snapshot);
+    ENGRAM_EXPECT_EQ(snapshot->ioClients, 0u);
+    ENGRAM_EXPECT_EQ(snapshot->ioActivations, 1u);
+
+    // Closing reaches waiters on the mirror too
+    EngramGate_Started(&gate);
+    EngramGate_Close(&gate);
+    EngramStats_PublishIO(page, &gate);
+    ENGRAM_EXPECT(!EngramStats_IOActive(page));
+    ENGRAM_EXPECT(!EngramStats_WaitForIO(page, 0));
+
+    free(snapshot);
+    free(page);
+}
+
+// A pid that belonged to a process which has since exited
+static UInt32 ExitedPid(void) {
+    pid_t child = fork();
+    if (child == 0) {
+        _exit(0);
+    }
+    waitpid(child, NULL, 0);
+    return (UInt32)child;
+}
+
+static void TestSharedPageOwnership(void) {
+    char name[kEngramStatsMaxNameLength];
+    snprintf(name, sizeof(name), "/engram.test.%d", (int)getpid());
+
+    EngramStatsSharedPage first;
+    ENGRAM_EXPECT(EngramStats_OpenSharedPage(name, &first));
+    ENGRAM_EXPECT_EQ(first.page->ownerPid, (UInt32)getpid());
+    EngramStats_Add(&first.page->ioCycles, 42);
+
+    // A live owner's page is neither reinitialised nor taken over
+    EngramStatsSharedPage second;
+    ENGRAM_EXPECT(!EngramStats_OpenSharedPage(name, &second));
+    ENGRAM_EXPECT(second.page == NULL);
+    ENGRAM_EXPECT_EQ(first.page->ioCycles.load(), 42ull);
+    const EngramStatsPage* reader = EngramStats_MapSharedPageReadOnly(name);
+    ENGRAM_EXPECT(reader != NULL && reader->ioCycles.load() == 42);
+
+    // A page whose owner has exited is replaced, and the old owner's close
+    // leaves the replacement linked
+    UInt32 ownerPid = first.page->ownerPid;
+    first.page->ownerPid = ExitedPid();
+    ENGRAM_EXPECT(EngramStats_OpenSharedPage(name, &second));
+    ENGRAM_EXPECT_EQ(second.page->ioCycles.load(), 0ull);
+    first.page->ownerPid = ownerPid;
+    EngramStats_CloseSharedPage(&first);
+    ENGRAM_EXPECT(first.page == NULL);
+    const EngramStatsPage* replacement = EngramStats_MapSharedPageReadOnly(name);
+    ENGRAM_EXPECT(replacement != NULL);
+
+    // The reader that mapped the old page keeps it until it lets go
+    ENGRAM_EXPECT_EQ(reader->ioCycles.load(), 42ull);
+
+    EngramStats_CloseSharedPage(&second);
+    ENGRAM_EXPECT(EngramStats_MapSharedPageReadOnly(name) == NULL);
+    munmap((void*)reader, sizeof(EngramStatsPage));
+    munmap((void*)replacement, sizeof(EngramStatsPage));
+
+    // Names macOS would refuse are refused everywhere
+    ENGRAM_EXPECT(!EngramStats_OpenSharedPage("/engram.this.name.is.far.too.long.for.macos", &second));
+}
+
+int main(void) {
+    ENGRAM_RUN_TEST(TestBucketBoundsRoundTrip);
+    ENGRAM_RUN_TEST(TestBucketRelativeError);
+    ENGRAM_RUN_TEST(TestPercentiles);
+    ENGRAM_RUN_TEST(TestIOGateMirror);
+    ENGRAM_RUN_TEST(TestSharedPageOwnership);
+    return ENGRAM_TEST_RESULT();
+}
@@ -0,0 +1,75 @@
+//
+//  EngramTestSupport.h
+//  Engram Virtual Audio Device
+//
+//  Minimal assertion helpers for the host-side unit tests. Each test file is
+//  its own executable and registers with CTest.
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#ifndef EngramTestSupport_h
+#define EngramTestSupport_h
+
+#include <ftw.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static int gEngramTestFailures = 0;
+
+#define ENGRAM_EXPECT(condition)                                                        \
+    do {                                                                                \
+        if (!(condition)) {                                                             \
+            fprintf(stderr, "%s:%d: expected %s\n", __FILE__, __LINE__, #condition);    \
+            gEngramTestFailures++;                                                      \
+        }                                                                               \
+    } while (0)
+
+#define ENGRAM_EXPECT_EQ(actual, expected)                                              \
+    do {                                                                                \
+        if (!((actual) == (expected))) {                                                \
+            fprintf(stderr, "%s:%d: expected %s == %s (got %.17g, want %.17g)\n",       \
+                    __FILE__, __LINE__, #actual, #expected,                             \
+                    (double)(actual), (double)(expected));                              \
+            gEngramTestFailures++;                                                      \
+        }                                                                               \
+    } while (0)
+
+#define ENGRAM_EXPECT_NEAR(actual, expected, tolerance)                                 \
+    do {                                                                                \
+        if (fabs((double)(actual) - (double)(expected)) > (double)(tolerance)) {        \
+            fprintf(stderr, "%s:%d: expected %s ~= %s (got %.17g, want %.17g)\n",       \
+                    __FILE__, __LINE__, #actual, #expected,                             \
+                    (double)(actual), (double)(expected));                              \
+            gEngramTestFailures++;                                                      \
+        }                                                                               \
+    } while (0)
+
+#define ENGRAM_RUN_TEST(test)                                                           \
+    do {                                                                                \
+        int failuresBefore = gEngramTestFailures;                                       \
+        test();                                                                         \
+        printf("%s %s\n", (gEngramTestFailures == failuresBefore) ? "PASS" : "FAIL", #test); \
+    } while (0)
+
+#define ENGRAM_TEST_RESULT() (gEngramTestFailures == 0 ? 0 : 1)
+
+// A new, empty directory under $TMPDIR (or /tmp) for one test run's files.
+// Returns NULL if it could not be made.
+static inline const char* EngramTest_MakeTempDirectory(char* path, size_t pathSize) {
+    const char* base = getenv("TMPDIR");
+    snprintf(path, pathSize, "%s/engram-test.XXXXXX", (base != NULL && base[0] == '/') ? base : "/tmp");
+    return mkdtemp(path);
+}
+
+static inline int EngramTest_RemoveEntry(const char* path, const struct stat*, int, struct FTW*) {
+    return remove(path);
+}
+
+// Removes a directory made by EngramTest_MakeTempDirectory and everything in it
+static inline void EngramTest_RemoveDirectory(const char* path) {
+    nftw(path, EngramTest_RemoveEntry, 16, FTW_DEPTH | FTW_PHYS);
+}
+
+#endif /* EngramTestSupport_h */
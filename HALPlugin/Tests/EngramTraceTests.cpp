@@ -0,0 +1,132 @@
+//
+//  EngramTraceTests.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramTrace.h"
+#include "EngramFiles.h"
+#include "EngramTestSupport.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static EngramTraceSlot* AttachFreshSlots(void) {
+    EngramTraceSlot* slots = (EngramTraceSlot*)calloc(kEngramTraceCapacity, sizeof(EngramTraceSlot));
+    EngramTrace_Attach(slots);
+    return slots;
+}
+
+static void TestDisabledTraceRecordsNothing(void) {
+    EngramTraceSlot* slots = AttachFreshSlots();
+    ENGRAM_EXPECT(!EngramTrace_IsEnabled());
+    ENGRAM_TRACE(kEngramTraceEventStartIO, 1, 0, 0, 0.0, 0, 0, 0);
+    ENGRAM_EXPECT_EQ(EngramTrace_SerializedSize(), sizeof(EngramTraceHeader));
+
+    EngramTrace_Attach(NULL);
+    EngramTrace_SetEnabled(true);
+    ENGRAM_EXPECT(!EngramTrace_IsEnabled());
+    free(slots);
+}
+
+static void TestSerializeKeepsOrder(void) {
+    EngramTraceSlot* slots = AttachFreshSlots();
+    EngramTrace_SetEnabled(true);
+    for (UInt32 i = 0; i < 10; i++) {
+        ENGRAM_TRACE(kEngramTraceEventDoIOBegin, 100 + i, i, 0, 512.0 * i, 0, 512, i);
+    }
+
+    size_t size = EngramTrace_SerializedSize();
+    ENGRAM_EXPECT_EQ(size, sizeof(EngramTraceHeader) + 10 * sizeof(EngramTraceRecord));
+
+    void* buffer = malloc(size);
+    ENGRAM_EXPECT_EQ(EngramTrace_Serialize(buffer, size, 1.0, 48000.0), size);
+    const EngramTraceHeader* header = (const EngramTraceHeader*)buffer;
+    const EngramTraceRecord* records = (const EngramTraceRecord*)(header + 1);
+    ENGRAM_EXPECT_EQ(header->magic, kEngramTraceMagic);
+    ENGRAM_EXPECT_EQ(header->recordCount, 10u);
+    for (UInt32 i = 0; i < 10; i++) {
+        ENGRAM_EXPECT_EQ(records[i].index, (UInt64)i);
+        ENGRAM_EXPECT_EQ(records[i].hostTime, 100u + i);
+        ENGRAM_EXPECT_EQ(records[i].ringFill, i);
+    }
+
+    EngramTrace_SetEnabled(false);
+    EngramTrace_Attach(NULL);
+    free(buffer);
+    free(slots);
+}
+
+static void TestWrapKeepsNewestRecords(void) {
+    EngramTraceSlot* slots = AttachFreshSlots();
+    EngramTrace_SetEnabled(true);
+    UInt32 total = kEngramTraceCapacity + 100;
+    for (UInt32 i = 0; i < total; i++) {
+        ENGRAM_TRACE(kEngramTraceEventProducerWrite, i, 0, 0, 0.0, 0, 0, 0);
+    }
+
+    size_t size = EngramTrace_SerializedSize();
+    void* buffer = malloc(size);
+    EngramTrace_Serialize(buffer, size, 1.0, 48000.0);
+    const EngramTraceHeader* header = (const EngramTraceHeader*)buffer;
+    const EngramTraceRecord* records = (const EngramTraceRecord*)(header + 1);
+    ENGRAM_EXPECT_EQ(header->recordCount, (UInt32)kEngramTraceCapacity);
+    ENGRAM_EXPECT_EQ(records[0].hostTime, 100u);
+    ENGRAM_EXPECT_EQ(records[kEngramTraceCapacity - 1].hostTime, (UInt64)total - 1);
+
+    EngramTrace_SetEnabled(false);
+    EngramTrace_Attach(NULL);
+    free(buffer);
+    free(slots);
+}
+
+static void TestWriteFileReplacesPrivately(void) {
+    char directory[kEngramMaxPathLength];
+    char path[kEngramMaxPathLength];
+    char target[kEngramMaxPathLength];
+    ENGRAM_EXPECT(EngramTest_MakeTempDirectory(directory, sizeof(directory)) != NULL);
+    EngramFiles_Join(path, sizeof(path), directory, kEngramTraceFileName);
+    EngramFiles_Join(target, sizeof(target), directory, "elsewhere");
+
+    EngramTraceSlot* slots = AttachFreshSlots();
+    EngramTrace_SetEnabled(true);
+    for (UInt32 i = 0; i < 3; i++) {
+        ENGRAM_TRACE(kEngramTraceEventDoIOBegin, 100 + i, i, 0, 0.0, 0, 512, 0);
+    }
+
+    // A symlink planted where the dump goes is replaced, not written through
+    ENGRAM_EXPECT(symlink(target, path) == 0);
+    ENGRAM_EXPECT(EngramTrace_WriteFile(path, 1.0, 48000.0));
+    ENGRAM_EXPECT(access(target, F_OK) != 0);
+
+    struct stat info;
+    ENGRAM_EXPECT(lstat(path, &info) == 0 && S_ISREG(info.st_mode) && (info.st_mode & 0777) == 0600);
+    ENGRAM_EXPECT_EQ((size_t)info.st_size, sizeof(EngramTraceHeader) + 3 * sizeof(EngramTraceRecord));
+
+    // Dumping again replaces the earlier dump
+    ENGRAM_TRACE(kEngramTraceEventDoIOEnd, 200, 0, 0, 0.0, 0, 512, 0);
+    ENGRAM_EXPECT(EngramTrace_WriteFile(path, 1.0, 48000.0));
+    EngramTraceHeader header;
+    FILE* file = fopen(path, "rb");
+    ENGRAM_EXPECT(file != NULL && fread(&header, sizeof(header), 1, file) == 1);
+    if (file != NULL) {
+        fclose(file);
+    }
+    ENGRAM_EXPECT_EQ(header.recordCount, 4u);
+
+    EngramTrace_SetEnabled(false);
+    EngramTrace_Attach(NULL);
+    free(slots);
+    EngramTest_RemoveDirectory(directory);
+}
+
+int main(void) {
+    ENGRAM_RUN_TEST(TestDisabledTraceRecordsNothing);
+    ENGRAM_RUN_TEST(TestSerializeKeepsOrder);
+    ENGRAM_RUN_TEST(TestWrapKeepsNewestRecords);
+    ENGRAM_RUN_TEST(TestWriteFileReplacesPrivately);
+    return ENGRAM_TEST_RESULT();
+}
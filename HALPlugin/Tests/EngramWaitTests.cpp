@@ -0,0 +1,69 @@
+//
+//  EngramWaitTests.cpp
+//  Engram Virtual Audio Device
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "EngramWait.h"
+#include "EngramTestSupport.h"
+#include <thread>
+#include <unistd.h>
+
+#define kMillis 1000000ull
+
+static void TestChangedWordReturnsAtOnce(void) {
+    std::atomic<UInt32> word(1);
+    UInt64 start = EngramWait_Now();
+    EngramWait_WhileEqual(&word, 0, 0);
+    ENGRAM_EXPECT(EngramWait_Now() - start < 50 * kMillis);
+}
+
+static void TestTimeout(void) {
+    std::atomic<UInt32> word(0);
+    UInt64 start = EngramWait_Now();
+    // Spurious returns are allowed, so keep waiting until the deadline
+    while (EngramWait_Now() - start < 20 * kMillis) {
+        EngramWait_WhileEqual(&word, 0, 20 * kMillis - (EngramWait_Now() - start));
+    }
+    UInt64 elapsed = EngramWait_Now() - start;
+    ENGRAM_EXPECT(elapsed >= 20 * kMillis);
+    ENGRAM_EXPECT(elapsed < 1000 * kMillis);
+}
+
+static void TestWakeAllReleasesEveryWaiter(void) {
+    std::atomic<UInt32> word(0);
+    std::atomic<UInt32> asleep(0);
+    std::atomic<UInt32> woken(0);
+
+    std::thread waiters[4];
+    for (UInt32 i = 0; i < 4; i++) {
+        waiters[i] = std::thread([&word, &asleep, &woken]() {
+            asleep++;
+            while (word.load() == 0) {
+                EngramWait_WhileEqual(&word, 0, 0);
+            }
+            woken++;
+        });
+    }
+    while (asleep.load() < 4) {
+        usleep(100);
+    }
+    usleep(5000);
+    ENGRAM_EXPECT_EQ(woken.load(), 0u);
+
+    word.store(1, std::memory_order_release);
+    EngramWait_WakeAll(&word);
+    for (UInt32 i = 0; i < 4; i++) {
+        waiters[i].join();
+    }
+    ENGRAM_EXPECT_EQ(woken.load(), 4u);
+}
+
+int main(void) {
+    ENGRAM_RUN_TEST(TestChangedWordReturnsAtOnce);
+    ENGRAM_RUN_TEST(TestTimeout);
+    ENGRAM_RUN_TEST(TestWakeAllReleasesEveryWaiter);
+    return ENGRAM_TEST_RESULT();
+}
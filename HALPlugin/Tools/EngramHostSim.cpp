@@ -0,0 +1,110 @@
+//
+//  EngramHostSim.cpp
+//  Engram Virtual Audio Device
+//
+//  Runs a simulated coreaudiod session against the plugin on a virtual clock
+//  and prints what it observed as JSON. Exits non-zero if the output audio or
+//  the device timeline was ever wrong.
+//  Usage: engram-hal-sim [--hours H] [--minutes M] [--buffer FRAMES]
+//                        [--producer FRAMES] [--lead FRAMES]
+//                        [--io-jitter-us US] [--producer-jitter-us US] [--seed N]
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "../Simulator/EngramHostSimulator.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static void Usage(void) {
+    fprintf(stderr, "usage: engram-hal-sim [--hours H] [--minutes M] [--buffer FRAMES] [--producer FRAMES]\n"
+                    "                      [--lead FRAMES] [--io-jitter-us US] [--producer-jitter-us US] [--seed N]\n");
+}
+
+int main(int argc, char** argv) {
+    EngramSimConfig config;
+    EngramSim_DefaultConfig(&config);
+    Float64 seconds = 3600.0;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) {
+            Usage();
+            return 2;
+        }
+        const char* option = argv[i];
+        const char* value = argv[++i];
+        if (strcmp(option, "--hours") == 0) {
+            seconds = atof(value) * 3600.0;
+        } else if (strcmp(option, "--minutes") == 0) {
+            seconds = atof(value) * 60.0;
+        } else if (strcmp(option, "--buffer") == 0) {
+            config.bufferFrames = (UInt32)strtoul(value, NULL, 10);
+        } else if (strcmp(option, "--producer") == 0) {
+            config.producerFrames = (UInt32)strtoul(value, NULL, 10);
+        } else if (strcmp(option, "--lead") == 0) {
+            config.producerLeadFrames = (UInt32)strtoul(value, NULL, 10);
+        } else if (strcmp(option, "--io-jitter-us") == 0) {
+            config.ioJitterNanos = strtoull(value, NULL, 10) * 1000;
+        } else if (strcmp(option, "--producer-jitter-us") == 0) {
+            config.producerJitterNanos = strtoull(value, NULL, 10) * 1000;
+        } else if (strcmp(option, "--seed") == 0) {
+            config.seed = strtoull(value, NULL, 0);
+        } else {
+            Usage();
+            return 2;
+        }
+    }
+
+    EngramSimulator* sim = (EngramSimulator*)calloc(1, sizeof(EngramSimulator));
+    struct timespec wallStart, wallEnd;
+    clock_gettime(CLOCK_MONOTONIC, &wallStart);
+
+    if (!EngramSim_Start(sim, &config)) {
+        fprintf(stderr, "engram-hal-sim: plugin failed to start\n");
+        EngramSim_Stop(sim, NULL);
+        return 1;
+    }
+    EngramSim_RunFor(sim, (UInt64)(seconds * 1.0e9));
+    EngramSimReport report;
+    EngramSim_Stop(sim, &report);
+
+    clock_gettime(CLOCK_MONOTONIC, &wallEnd);
+    Float64 wall = (Float64)(wallEnd.tv_sec - wallStart.tv_sec) + (Float64)(wallEnd.tv_nsec - wallStart.tv_nsec) * 1.0e-9;
+
+    printf("{\n");
+    printf("  \"bufferFrames\": %u,\n", config.bufferFrames);
+    printf("  \"producerFrames\": %u,\n", config.producerFrames);
+    printf("  \"producerLeadFrames\": %u,\n", config.producerLeadFrames);
+    printf("  \"simulatedSeconds\": %.3f,\n", (Float64)report.simulatedNanos * 1.0e-9);
+    printf("  \"wallSeconds\": %.3f,\n", wall);
+    printf("  \"cycles\": %llu,\n", (unsigned long long)report.cycles);
+    printf("  \"producerWrites\": %llu,\n", (unsigned long long)report.producerWrites);
+    printf("  \"underrunCycles\": %llu,\n", (unsigned long long)report.underrunCycles);
+    printf("  \"underrunSamples\": %llu,\n", (unsigned long long)report.underrunSamples);
+    printf("  \"overrunSamples\": %llu,\n", (unsigned long long)report.overrunSamples);
+    printf("  \"glitches\": %llu,\n", (unsigned long long)report.glitches);
+    printf("  \"discontinuities\": %llu,\n", (unsigned long long)report.discontinuities);
+    printf("  \"clicks\": %llu,\n", (unsigned long long)report.clicks);
+    printf("  \"mismatchedSamples\": %llu,\n", (unsigned long long)report.mismatchedSamples);
+    printf("  \"maxAbsError\": %.9g,\n", report.maxAbsError);
+    printf("  \"channelSwaps\": %llu,\n", (unsigned long long)report.channelSwaps);
+    printf("  \"accountingErrors\": %llu,\n", (unsigned long long)report.accountingErrors);
+    printf("  \"maxQueuedFrames\": %llu,\n", (unsigned long long)report.maxQueuedFrames);
+    printf("  \"queueResidencyP50Ns\": %llu,\n", (unsigned long long)report.queueResidencyP50Ns);
+    printf("  \"queueResidencyP99Ns\": %llu,\n", (unsigned long long)report.queueResidencyP99Ns);
+    printf("  \"timestampErrors\": %llu,\n", (unsigned long long)report.timestampErrors);
+    printf("  \"lateZeroTimeStamps\": %llu,\n", (unsigned long long)report.lateZeroTimeStamps);
+    printf("  \"failedCalls\": %llu,\n", (unsigned long long)report.failedCalls);
+    printf("  \"idleWrites\": %llu,\n", (unsigned long long)report.idleWrites);
+    printf("  \"propertyNotifications\": %llu\n", (unsigned long long)report.propertyNotifications);
+    printf("}\n");
+
+    free(sim);
+    Boolean failed = report.mismatchedSamples > 0 || report.channelSwaps > 0 || report.accountingErrors > 0 ||
+                     report.timestampErrors > 0 ||
+                     report.lateZeroTimeStamps > 0 || report.failedCalls > 0 || report.idleWrites > 0;
+    return failed ? 1 : 0;
+}
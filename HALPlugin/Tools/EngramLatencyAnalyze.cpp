@@ -0,0 +1,126 @@
+//
+//  EngramLatencyAnalyze.cpp
+//  Engram Virtual Audio Device
+//
+//  Pairs the probes a producer injected with the arrivals the plugin stamped
+//  at the end of DoIOOperation and prints the producer-to-client latency
+//  distribution as JSON. Both files hold "sequence,hostTimeNanos,sampleTime"
+//  lines as written by EngramLatencyLog_AppendCSV.
+//  Usage: engram-hal-latency probes.csv [arrivals.csv]; without an arrivals
+//  path it reads the log in the diagnostics directory (see EngramFiles.h).
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "../EngramFiles.h"
+#include "../EngramLatency.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct {
+    UInt64* nanos;
+    UInt32 count;
+} TimeList;
+
+static Boolean LoadTimes(const char* path, TimeList* list) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        fprintf(stderr, "engram-hal-latency: cannot open %s\n", path);
+        return false;
+    }
+
+    UInt32 capacity = 1024;
+    list->nanos = (UInt64*)malloc(sizeof(UInt64) * capacity);
+    list->count = 0;
+
+    unsigned long long sequence, nanos;
+    double sampleTime;
+    while (fscanf(file, "%llu,%llu,%lf", &sequence, &nanos, &sampleTime) == 3) {
+        if (list->count == capacity) {
+            capacity *= 2;
+            list->nanos = (UInt64*)realloc(list->nanos, sizeof(UInt64) * capacity);
+        }
+        list->nanos[list->count++] = nanos;
+    }
+
+    fclose(file);
+    return true;
+}
+
+static int CompareUInt64(const void* a, const void* b) {
+    UInt64 x = *(const UInt64*)a;
+    UInt64 y = *(const UInt64*)b;
+    return (x > y) - (x < y);
+}
+
+static Float64 Percentile(const UInt64* sorted, UInt32 count, Float64 percentile) {
+    UInt32 index = (UInt32)(percentile / 100.0 * (Float64)(count - 1) + 0.5);
+    return (Float64)sorted[index] / 1.0e6;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: engram-hal-latency probes.csv [arrivals.csv]\n");
+        return 2;
+    }
+
+    char defaultPath[kEngramMaxPathLength];
+    char directory[kEngramMaxPathLength];
+    if (!EngramFiles_DiagnosticsDirectory(directory, sizeof(directory)) ||
+        !EngramFiles_Join(defaultPath, sizeof(defaultPath), directory, kEngramLatencyArrivalsFileName)) {
+        defaultPath[0] = '\0';
+    }
+
+    TimeList probes, arrivals;
+    if (!LoadTimes(argv[1], &probes) || !LoadTimes((argc > 2) ? argv[2] : defaultPath, &arrivals)) {
+        return 1;
+    }
+    qsort(probes.nanos, probes.count, sizeof(UInt64), CompareUInt64);
+    qsort(arrivals.nanos, arrivals.count, sizeof(UInt64), CompareUInt64);
+
+    // Probes are spaced wider than any plausible latency, so each arrival
+    // belongs to the most recent probe sent before it. Probes overtaken by a
+    // later one without arriving were lost (dropped by a full ring, or
+    // masked by an underrun).
+    UInt64* latencies = (UInt64*)malloc(sizeof(UInt64) * (arrivals.count ? arrivals.count : 1));
+    UInt32 matched = 0;
+    UInt32 unmatchedArrivals = 0;
+    UInt32 probe = 0;
+    for (UInt32 i = 0; i < arrivals.count; i++) {
+        if (probe >= probes.count || probes.nanos[probe] > arrivals.nanos[i]) {
+            unmatchedArrivals++;
+            continue;
+        }
+        while (probe + 1 < probes.count && probes.nanos[probe + 1] <= arrivals.nanos[i]) {
+            probe++;
+        }
+        latencies[matched++] = arrivals.nanos[i] - probes.nanos[probe];
+        probe++;
+    }
+
+    printf("{\n");
+    printf("  \"probes\": %u,\n", probes.count);
+    printf("  \"arrivals\": %u,\n", arrivals.count);
+    printf("  \"matched\": %u,\n", matched);
+    printf("  \"lost\": %u,\n", probes.count - matched);
+    printf("  \"unmatchedArrivals\": %u", unmatchedArrivals);
+
+    if (matched > 0) {
+        qsort(latencies, matched, sizeof(UInt64), CompareUInt64);
+        Float64 sum = 0.0;
+        for (UInt32 i = 0; i < matched; i++) {
+            sum += (Float64)latencies[i];
+        }
+        printf(",\n  \"latencyMs\": {\"min\": %.3f, \"mean\": %.3f, \"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"max\": %.3f}",
+               (Float64)latencies[0] / 1.0e6, sum / (Float64)matched / 1.0e6,
+               Percentile(latencies, matched, 50.0), Percentile(latencies, matched, 90.0),
+               Percentile(latencies, matched, 99.0), (Float64)latencies[matched - 1] / 1.0e6);
+    }
+    printf("\n}\n");
+
+    free(latencies);
+    free(probes.nanos);
+    free(arrivals.nanos);
+    return 0;
+}
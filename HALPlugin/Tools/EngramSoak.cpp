@@ -0,0 +1,125 @@
+//
+//  EngramSoak.cpp
+//  Engram Virtual Audio Device
+//
+//  Soaks the plugin through a long simulated meeting full of producer and
+//  host pathologies, then prints what happened as JSON. Progress goes to
+//  stderr once per simulated hour. Exits non-zero if any invariant broke.
+//  Usage: engram-hal-soak [--hours H] [--minutes M] [--seed N] [--skew-ppm PPM]
+//                         [--stalls-per-hour N] [--bursts-per-hour N]
+//                         [--client-changes-per-hour N] [--restarts-per-hour N]
+//                         [--rate-changes-per-hour N]
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "../Simulator/EngramSoak.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static void Usage(void) {
+    fprintf(stderr, "usage: engram-hal-soak [--hours H] [--minutes M] [--seed N] [--skew-ppm PPM]\n"
+                    "                       [--stalls-per-hour N] [--bursts-per-hour N] [--client-changes-per-hour N]\n"
+                    "                       [--restarts-per-hour N] [--rate-changes-per-hour N]\n");
+}
+
+static Float64 WallSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (Float64)ts.tv_sec + (Float64)ts.tv_nsec * 1.0e-9;
+}
+
+static void PrintProgress(const EngramSoakReport* report, void* context) {
+    Float64 wallStart = *(const Float64*)context;
+    fprintf(stderr, "engram-hal-soak: %5.2f h simulated in %6.1f s, max latency %llu/%llu frames, %s\n",
+            (Float64)report->sim.simulatedNanos / 3.6e12, WallSeconds() - wallStart,
+            (unsigned long long)report->sim.maxQueuedFrames, (unsigned long long)report->latencyBoundFrames,
+            (report->firstFailureNanos == 0) ? "clean" : "FAILING");
+}
+
+int main(int argc, char** argv) {
+    EngramSoakConfig config;
+    EngramSoak_DefaultConfig(&config);
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) {
+            Usage();
+            return 2;
+        }
+        const char* option = argv[i];
+        const char* value = argv[++i];
+        if (strcmp(option, "--hours") == 0) {
+            config.durationNanos = (UInt64)(atof(value) * 3.6e12);
+        } else if (strcmp(option, "--minutes") == 0) {
+            config.durationNanos = (UInt64)(atof(value) * 6.0e10);
+        } else if (strcmp(option, "--seed") == 0) {
+            config.sim.seed = strtoull(value, NULL, 0);
+        } else if (strcmp(option, "--skew-ppm") == 0) {
+            config.sim.producerSkewPpm = atof(value);
+        } else if (strcmp(option, "--stalls-per-hour") == 0) {
+            config.stallsPerHour = atof(value);
+        } else if (strcmp(option, "--bursts-per-hour") == 0) {
+            config.burstsPerHour = atof(value);
+        } else if (strcmp(option, "--client-changes-per-hour") == 0) {
+            config.clientChangesPerHour = atof(value);
+        } else if (strcmp(option, "--restarts-per-hour") == 0) {
+            config.restartsPerHour = atof(value);
+        } else if (strcmp(option, "--rate-changes-per-hour") == 0) {
+            config.rateChangesPerHour = atof(value);
+        } else {
+            Usage();
+            return 2;
+        }
+    }
+
+    Float64 wallStart = WallSeconds();
+    EngramSoakReport report;
+    Boolean passed = EngramSoak_Run(&config, &report, PrintProgress, &wallStart);
+    Float64 wall = WallSeconds() - wallStart;
+    const EngramSimReport* sim = &report.sim;
+
+    printf("{\n");
+    printf("  \"passed\": %s,\n", passed ? "true" : "false");
+    printf("  \"simulatedSeconds\": %.3f,\n", (Float64)sim->simulatedNanos * 1.0e-9);
+    printf("  \"wallSeconds\": %.3f,\n", wall);
+    printf("  \"firstFailureSeconds\": %.3f,\n", (Float64)report.firstFailureNanos * 1.0e-9);
+    printf("  \"pathologies\": {\n");
+    printf("    \"stalls\": %llu,\n", (unsigned long long)report.stalls);
+    printf("    \"bursts\": %llu,\n", (unsigned long long)report.bursts);
+    printf("    \"clientAttaches\": %llu,\n", (unsigned long long)report.clientAttaches);
+    printf("    \"clientDetaches\": %llu,\n", (unsigned long long)report.clientDetaches);
+    printf("    \"restarts\": %llu,\n", (unsigned long long)sim->restarts);
+    printf("    \"bufferChanges\": %llu,\n", (unsigned long long)report.bufferChanges);
+    printf("    \"producerChanges\": %llu,\n", (unsigned long long)report.producerChanges);
+    printf("    \"skewPpm\": %.3f\n", config.sim.producerSkewPpm);
+    printf("  },\n");
+    printf("  \"invariants\": {\n");
+    printf("    \"mismatchedSamples\": %llu,\n", (unsigned long long)sim->mismatchedSamples);
+    printf("    \"channelSwaps\": %llu,\n", (unsigned long long)sim->channelSwaps);
+    printf("    \"accountingErrors\": %llu,\n", (unsigned long long)sim->accountingErrors);
+    printf("    \"overrunSamples\": %llu,\n", (unsigned long long)sim->overrunSamples);
+    printf("    \"maxQueuedFrames\": %llu,\n", (unsigned long long)sim->maxQueuedFrames);
+    printf("    \"latencyBoundFrames\": %llu,\n", (unsigned long long)report.latencyBoundFrames);
+    printf("    \"latencyViolations\": %llu,\n", (unsigned long long)report.latencyViolations);
+    printf("    \"timestampErrors\": %llu,\n", (unsigned long long)sim->timestampErrors);
+    printf("    \"lateZeroTimeStamps\": %llu,\n", (unsigned long long)sim->lateZeroTimeStamps);
+    printf("    \"failedCalls\": %llu,\n", (unsigned long long)sim->failedCalls);
+    printf("    \"idleWrites\": %llu,\n", (unsigned long long)sim->idleWrites);
+    printf("    \"heapGrowthBytes\": %lld,\n", (long long)report.heapGrowthBytes);
+    printf("    \"liveObjectGrowth\": %lld\n", (long long)report.liveObjectGrowth);
+    printf("  },\n");
+    printf("  \"cycles\": %llu,\n", (unsigned long long)sim->cycles);
+    printf("  \"underrunCycles\": %llu,\n", (unsigned long long)sim->underrunCycles);
+    printf("  \"underrunSamples\": %llu,\n", (unsigned long long)sim->underrunSamples);
+    printf("  \"glitches\": %llu,\n", (unsigned long long)sim->glitches);
+    printf("  \"ioDurationP99Ns\": %llu,\n", (unsigned long long)sim->ioDurationP99Ns);
+    printf("  \"cycleJitterP99Ns\": %llu,\n", (unsigned long long)sim->cycleJitterP99Ns);
+    printf("  \"queueResidencyP50Ns\": %llu,\n", (unsigned long long)sim->queueResidencyP50Ns);
+    printf("  \"queueResidencyP99Ns\": %llu\n", (unsigned long long)sim->queueResidencyP99Ns);
+    printf("}\n");
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+//
+//  EngramStatsDump.cpp
+//  Engram Virtual Audio Device
+//
+//  Prints the plugin's shared-memory stats page as JSON for monitoring and
+//  alerting. Usage: engram-hal-stats [shm-name]; the name defaults to
+//  $ENGRAM_HAL_STATS_NAME, then to the plugin's standard page.
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "../EngramStats.h"
+#include <stdio.h>
+
+static void PrintHistogram(const char* name, const EngramHistogramSnapshot* histogram, Boolean last) {
+    printf("  \"%s\": {\"count\": %llu, \"min\": %llu, \"max\": %llu, \"mean\": %.1f, "
+           "\"p50\": %llu, \"p99\": %llu, \"p999\": %llu}%s\n",
+           name,
+           (unsigned long long)histogram->count,
+           (unsigned long long)histogram->min,
+           (unsigned long long)histogram->max,
+           histogram->count ? (double)histogram->sum / (double)histogram->count : 0.0,
+           (unsigned long long)EngramHistogram_ValueAtPercentile(histogram, 50.0),
+           (unsigned long long)EngramHistogram_ValueAtPercentile(histogram, 99.0),
+           (unsigned long long)EngramHistogram_ValueAtPercentile(histogram, 99.9),
+           last ? "" : ",");
+}
+
+int main(int argc, char** argv) {
+    const char* name = (argc > 1) ? argv[1] : EngramStats_SharedPageName();
+
+    const EngramStatsPage* page = EngramStats_MapSharedPageReadOnly(name);
+    if (page == NULL) {
+        fprintf(stderr, "engram-hal-stats: no stats page at %s (is the plugin loaded?)\n", name);
+        return 1;
+    }
+
+    static EngramStatsSnapshot snapshot;
+    EngramStats_Snapshot(page, &snapshot);
+
+    printf("{\n");
+    printf("  \"version\": %u,\n", snapshot.version);
+    printf("  \"ioClients\": %u,\n", snapshot.ioClients & ~kEngramGateClosed);
+    printf("  \"ioClosed\": %s,\n", (snapshot.ioClients & kEngramGateClosed) ? "true" : "false");
+    printf("  \"ioActivations\": %llu,\n", (unsigned long long)snapshot.ioActivations);
+    printf("  \"lowWaterFrames\": %u,\n", snapshot.lowWaterFrames);
+    printf("  \"lowWaterSignals\": %llu,\n", (unsigned long long)snapshot.lowWaterSignals);
+    printf("  \"ioCycles\": %llu,\n", (unsigned long long)snapshot.ioCycles);
+    printf("  \"underruns\": %llu,\n", (unsigned long long)snapshot.underruns);
+    printf("  \"underrunSamples\": %llu,\n", (unsigned long long)snapshot.underrunSamples);
+    printf("  \"overrunSamples\": %llu,\n", (unsigned long long)snapshot.overrunSamples);
+    printf("  \"glitches\": %llu,\n", (unsigned long long)snapshot.glitches);
+    printf("  \"discontinuities\": %llu,\n", (unsigned long long)snapshot.discontinuities);
+    printf("  \"clicks\": %llu,\n", (unsigned long long)snapshot.clicks);
+    printf("  \"glitchSnapshotsDropped\": %llu,\n", (unsigned long long)snapshot.glitchSnapshotsDropped);
+    printf("  \"renderCycles\": %llu,\n", (unsigned long long)snapshot.renderCycles);
+    printf("  \"renderMisses\": %llu,\n", (unsigned long long)snapshot.renderMisses);
+    printf("  \"residencyStampsDropped\": %llu,\n", (unsigned long long)snapshot.residencyStampsDropped);
+    printf("  \"mixCycles\": %llu,\n", (unsigned long long)snapshot.mixCycles);
+    printf("  \"mixOverrunSamples\": %llu,\n", (unsigned long long)snapshot.mixOverrunSamples);
+    printf("  \"outputSamplesScrubbed\": %llu,\n", (unsigned long long)snapshot.outputSamplesScrubbed);
+    printf("  \"loopbackCycles\": %llu,\n", (unsigned long long)snapshot.loopbackCycles);
+    printf("  \"feedbackEvents\": %llu,\n", (unsigned long long)snapshot.feedbackEvents);
+    printf("  \"feedbackNotches\": %u,\n", snapshot.feedbackNotches);
+    printf("  \"feedbackGainCut\": %s,\n", snapshot.feedbackGainCut ? "true" : "false");
+    PrintHistogram("ioDurationNs", &snapshot.ioDurationNs, false);
+    PrintHistogram("ringFillFrames", &snapshot.ringFillFrames, false);
+    PrintHistogram("cycleJitterNs", &snapshot.cycleJitterNs, false);
+    PrintHistogram("renderWaitNs", &snapshot.renderWaitNs, false);
+    PrintHistogram("queueResidencyNs", &snapshot.queueResidencyNs, true);
+    printf("}\n");
+    return 0;
+}
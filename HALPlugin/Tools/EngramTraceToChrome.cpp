@@ -0,0 +1,216 @@
+//
+//  EngramTraceToChrome.cpp
+//  Engram Virtual Audio Device
+//
+//  Converts a binary IO trace (kEngramPropertyTrace payload, or the file the
+//  plugin writes when tracing is switched off) into Chrome trace-event JSON,
+//  which chrome://tracing and ui.perfetto.dev both open directly.
+//  Usage: engram-hal-trace2json [trace.bin] > trace.json; without a path it
+//  reads the dump in the diagnostics directory (see EngramFiles.h).
+//
+//  Copyright © 2024-2026 Bala Kumar. All rights reserved.
+//  https://balakumar.dev
+//
+
+#include "../EngramFiles.h"
+#include "../EngramTrace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <utility>
+
+// Chrome trace "threads" the events are laid out on
+enum {
+    kTrackIO = 1,
+    kTrackProducer = 2,
+    kTrackControl = 3
+};
+
+static Float64 gNanosPerHostTick = 1.0;
+static UInt64 gBaseHostTime = 0;
+static Boolean gFirstEvent = true;
+
+static Float64 HostTimeToMicros(UInt64 hostTime) {
+    if (hostTime >= gBaseHostTime) {
+        return (Float64)(hostTime - gBaseHostTime) * gNanosPerHostTick / 1000.0;
+    }
+    return -(Float64)(gBaseHostTime - hostTime) * gNanosPerHostTick / 1000.0;
+}
+
+static Float64 HostTicksToMicros(Float64 ticks) {
+    return ticks * gNanosPerHostTick / 1000.0;
+}
+
+static void BeginEvent(void) {
+    printf(gFirstEvent ? "\n    " : ",\n    ");
+    gFirstEvent = false;
+}
+
+static const char* OperationName(UInt32 operation) {
+    switch (operation) {
+        case 'thrd': return "Thread";
+        case 'cycl': return "Cycle";
+        case 'read': return "ReadInput";
+        case 'cinp': return "ConvertInput";
+        case 'pinp': return "ProcessInput";
+        case 'pout': return "ProcessOutput";
+        case 'mixo': return "MixOutput";
+        case 'pmix': return "ProcessMix";
+        case 'cmix': return "ConvertMix";
+        case 'rite': return "WriteMix";
+        default: return "IO";
+    }
+}
+
+// Spans still waiting for their end record. Several operations, and several
+// clients' copies of one, can be in flight within a cycle, so each begin is
+// kept under its (cycle, operation) until the matching end takes it out.
+typedef std::pair<UInt64, UInt32> SpanKey;
+typedef std::map<SpanKey, const EngramTraceRecord*> OpenSpans;
+
+static const EngramTraceRecord* TakeOpenSpan(OpenSpans* spans, const EngramTraceRecord* end) {
+    OpenSpans::iterator found = spans->find(SpanKey(end->cycle, end->operation));
+    if (found == spans->end()) {
+        return NULL;
+    }
+    const EngramTraceRecord* begin = found->second;
+    spans->erase(found);
+    return begin;
+}
+
+static void PrintThreadName(UInt32 track, const char* name) {
+    BeginEvent();
+    printf("{\"ph\": \"M\", \"pid\": 1, \"tid\": %u, \"name\": \"thread_name\", \"args\": {\"name\": \"%s\"}}", track, name);
+}
+
+static void PrintRingFill(UInt64 hostTime, UInt32 ringFill) {
+    BeginEvent();
+    printf("{\"ph\": \"C\", \"pid\": 1, \"tid\": %u, \"name\": \"ringFillFrames\", \"ts\": %.3f, \"args\": {\"frames\": %u}}",
+           kTrackIO, HostTimeToMicros(hostTime), ringFill);
+}
+
+int main(int argc, char** argv) {
+    char defaultPath[kEngramMaxPathLength];
+    char directory[kEngramMaxPathLength];
+    if (!EngramFiles_DiagnosticsDirectory(directory, sizeof(directory)) ||
+        !EngramFiles_Join(defaultPath, sizeof(defaultPath), directory, kEngramTraceFileName)) {
+        defaultPath[0] = '\0';
+    }
+    const char* path = (argc > 1) ? argv[1] : defaultPath;
+
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        fprintf(stderr, "engram-hal-trace2json: cannot open %s\n", path);
+        return 1;
+    }
+
+    EngramTraceHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != kEngramTraceMagic ||
+        header.version != kEngramTraceVersion || header.recordSize != sizeof(EngramTraceRecord)) {
+        fprintf(stderr, "engram-hal-trace2json: %s is not a version %u Engram trace\n", path, kEngramTraceVersion);
+        fclose(file);
+        return 1;
+    }
+
+    EngramTraceRecord* records = (EngramTraceRecord*)calloc(header.recordCount ? header.recordCount : 1, sizeof(EngramTraceRecord));
+    UInt32 count = (UInt32)fread(records, sizeof(EngramTraceRecord), header.recordCount, file);
+    fclose(file);
+
+    gNanosPerHostTick = (header.nanosPerHostTick > 0.0) ? header.nanosPerHostTick : 1.0;
+    gBaseHostTime = (count > 0) ? records[0].hostTime : 0;
+
+    printf("{\"displayTimeUnit\": \"ns\", \"otherData\": {\"sampleRate\": %.1f, \"records\": %u}, \"traceEvents\": [", header.sampleRate, count);
+    BeginEvent();
+    printf("{\"ph\": \"M\", \"pid\": 1, \"name\": \"process_name\", \"args\": {\"name\": \"Engram HAL\"}}");
+    PrintThreadName(kTrackIO, "IO");
+    PrintThreadName(kTrackProducer, "Producer");
+    PrintThreadName(kTrackControl, "Control");
+
+    // Open Begin/EndIOOperation and DoIOOperation spans
+    OpenSpans openOperations;
+    OpenSpans openDoIO;
+    UInt64 lastWriteHostTime = 0;
+
+    for (UInt32 i = 0; i < count; i++) {
+        const EngramTraceRecord* record = &records[i];
+
+        switch (record->event) {
+            case kEngramTraceEventStartIO:
+            case kEngramTraceEventStopIO:
+                BeginEvent();
+                printf("{\"ph\": \"i\", \"s\": \"p\", \"pid\": 1, \"tid\": %u, \"name\": \"%s\", \"ts\": %.3f, \"args\": {\"client\": %u}}",
+                       kTrackControl, record->event == kEngramTraceEventStartIO ? "StartIO" : "StopIO",
+                       HostTimeToMicros(record->hostTime), record->operation);
+                break;
+
+            case kEngramTraceEventBeginIO:
+                openOperations[SpanKey(record->cycle, record->operation)] = record;
+                break;
+
+            case kEngramTraceEventEndIO: {
+                const EngramTraceRecord* begin = TakeOpenSpan(&openOperations, record);
+                if (begin != NULL) {
+                    BeginEvent();
+                    printf("{\"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"name\": \"%s\", \"cat\": \"operation\", \"ts\": %.3f, \"dur\": %.3f, "
+                           "\"args\": {\"cycle\": %llu, \"frames\": %u}}",
+                           kTrackIO, OperationName(record->operation), HostTimeToMicros(begin->hostTime),
+                           HostTimeToMicros(record->hostTime) - HostTimeToMicros(begin->hostTime),
+                           (unsigned long long)record->cycle, record->frames);
+                }
+                PrintRingFill(record->hostTime, record->ringFill);
+                break;
+            }
+
+            case kEngramTraceEventDoIOBegin:
+                openDoIO[SpanKey(record->cycle, record->operation)] = record;
+                PrintRingFill(record->hostTime, record->ringFill);
+                break;
+
+            case kEngramTraceEventDoIOEnd: {
+                const EngramTraceRecord* begin = TakeOpenSpan(&openDoIO, record);
+                if (begin != NULL) {
+                    // Slack is how far the IO thread ran from the time the
+                    // operation was due; age is how stale the producer's last
+                    // write was when the IO thread got here.
+                    Float64 slack = HostTicksToMicros((Float64)record->deadlineHostTime - (Float64)record->hostTime);
+                    Float64 age = (lastWriteHostTime != 0)
+                        ? HostTicksToMicros((Float64)begin->hostTime - (Float64)lastWriteHostTime) : -1.0;
+                    BeginEvent();
+                    printf("{\"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"name\": \"DoIO %s\", \"cat\": \"io\", \"ts\": %.3f, \"dur\": %.3f, "
+                           "\"args\": {\"cycle\": %llu, \"sampleTime\": %.0f, \"frames\": %u, \"ringFillBefore\": %u, "
+                           "\"ringFillAfter\": %u, \"deadlineTs\": %.3f, \"slackUs\": %.3f, \"lastWriteAgeUs\": %.3f}}",
+                           kTrackIO, OperationName(record->operation), HostTimeToMicros(begin->hostTime),
+                           HostTimeToMicros(record->hostTime) - HostTimeToMicros(begin->hostTime),
+                           (unsigned long long)record->cycle, record->sampleTime, record->frames, begin->ringFill,
+                           record->ringFill, HostTimeToMicros(record->deadlineHostTime), slack, age);
+                }
+                PrintRingFill(record->hostTime, record->ringFill);
+                break;
+            }
+
+            case kEngramTraceEventProducerWrite:
+                lastWriteHostTime = record->hostTime;
+                BeginEvent();
+                printf("{\"ph\": \"i\", \"s\": \"t\", \"pid\": 1, \"tid\": %u, \"name\": \"write\", \"ts\": %.3f, "
+                       "\"args\": {\"requestedFrames\": %u, \"writtenFrames\": %u}}",
+                       kTrackProducer, HostTimeToMicros(record->hostTime), record->operation, record->frames);
+                PrintRingFill(record->hostTime, record->ringFill);
+                break;
+
+            case kEngramTraceEventUnderrun:
+                BeginEvent();
+                printf("{\"ph\": \"i\", \"s\": \"p\", \"pid\": 1, \"tid\": %u, \"name\": \"underrun\", \"ts\": %.3f, "
+                       "\"args\": {\"cycle\": %llu, \"missingFrames\": %u}}",
+                       kTrackIO, HostTimeToMicros(record->hostTime), (unsigned long long)record->cycle, record->frames);
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    printf("\n]}\n");
+    free(records);
+    return 0;
+}